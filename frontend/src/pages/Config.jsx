@@ -62,6 +62,10 @@ export function Config() {
         mqtt_username: config.mqtt?.username || '',
         mqtt_password: '',
         mqtt_json_aggregate_enabled: config.mqtt?.json_aggregate_enabled || false,
+        mqtt_state_document_enabled: config.mqtt?.state_document_enabled || false,
+        mqtt_aggregate_format: config.mqtt?.aggregate_format || 'json',
+        mqtt_aggregate_fields: config.mqtt?.aggregate_fields ||
+          ['sensors', 'valve', 'pid', 'control', 'diagnostics', 'health', 'memory'],
         knx_area: config.knx?.area || 0,
         knx_line: config.knx?.line || 0,
         knx_member: config.knx?.member || 0,
@@ -535,6 +539,58 @@ export function Config() {
               Publish all data as JSON on 'telegraph' topic
             </span>
           </div>
+          ${formData.mqtt_json_aggregate_enabled && html`
+            <div class="mt-4 grid grid-cols-1 md:grid-cols-2 gap-4">
+              <div>
+                <label class="block text-sm font-medium text-gray-700 dark:text-gray-300 mb-2">
+                  Aggregate Format
+                </label>
+                <select
+                  value=${formData.mqtt_aggregate_format || 'json'}
+                  onInput=${(e) => updateFormData('mqtt_aggregate_format', e.target.value)}
+                  class="w-full px-4 py-2 bg-gray-50 dark:bg-gray-700 border border-gray-300 dark:border-gray-600 rounded-lg text-gray-900 dark:text-white"
+                >
+                  <option value="json">JSON</option>
+                  <option value="msgpack">MessagePack (smaller, binary)</option>
+                </select>
+              </div>
+              <div>
+                <label class="block text-sm font-medium text-gray-700 dark:text-gray-300 mb-2">
+                  Aggregate Fields
+                </label>
+                <div class="flex flex-wrap gap-x-4 gap-y-2">
+                  ${['sensors', 'valve', 'pid', 'control', 'diagnostics', 'health', 'memory'].map(group => html`
+                    <label class="flex items-center gap-2 text-sm text-gray-700 dark:text-gray-300">
+                      <input
+                        type="checkbox"
+                        checked=${(formData.mqtt_aggregate_fields || []).includes(group)}
+                        onChange=${(e) => updateFormData('mqtt_aggregate_fields', e.target.checked
+                          ? [...(formData.mqtt_aggregate_fields || []), group]
+                          : (formData.mqtt_aggregate_fields || []).filter(g => g !== group))}
+                        class="w-4 h-4 rounded"
+                      />
+                      ${group}
+                    </label>
+                  `)}
+                </div>
+              </div>
+            </div>
+          `}
+          <div class="mt-4 flex items-center gap-3">
+            <input
+              type="checkbox"
+              id="mqtt_state_document_enabled"
+              checked=${formData.mqtt_state_document_enabled || false}
+              onChange=${(e) => updateFormData('mqtt_state_document_enabled', e.target.checked)}
+              class="w-4 h-4 rounded"
+            />
+            <label for="mqtt_state_document_enabled" class="text-sm font-medium text-gray-700 dark:text-gray-300">
+              Single Home Assistant State Message
+            </label>
+            <span class="text-xs text-gray-500 dark:text-gray-400">
+              One JSON message on 'esp32_thermostat/state' per cycle instead of a topic per value
+            </span>
+          </div>
           <button
             onClick=${() => saveConfig('mqtt', {
               server: formData.mqtt_server,
@@ -542,6 +598,9 @@ export function Config() {
               username: formData.mqtt_username || undefined,
               password: formData.mqtt_password || undefined,
               json_aggregate_enabled: formData.mqtt_json_aggregate_enabled,
+              state_document_enabled: formData.mqtt_state_document_enabled,
+              aggregate_format: formData.mqtt_aggregate_format,
+              aggregate_fields: formData.mqtt_aggregate_fields,
             })}
             disabled=${saving}
             class="mt-4 px-4 py-2 bg-primary-500 hover:bg-primary-600 disabled:bg-gray-400 text-white rounded-lg font-medium transition-all"
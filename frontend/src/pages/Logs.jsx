@@ -1,9 +1,11 @@
 import { h } from 'preact';
-import { useState, useEffect } from 'preact/hooks';
+import { useState, useEffect, useRef } from 'preact/hooks';
 import htm from 'htm';
 
 const html = htm.bind(h);
 
+const MAX_LOGS = 100; // Matches the device's event log ring
+
 /**
  * Logs Page
  * Displays event logs from the ESP32
@@ -20,16 +22,35 @@ export function Logs() {
     return () => clearInterval(interval);
   }, []);
 
+  // Sequence number of the newest entry received; later polls only fetch newer ones
+  const lastSeq = useRef(null);
+
   const fetchLogs = async () => {
     try {
-      const response = await fetch('/api/logs');
+      const query = lastSeq.current === null ? '' : `?after=${lastSeq.current}`;
+      const response = await fetch(`/api/logs${query}`);
+      const nextSeq = parseInt(response.headers.get('X-Log-Next-Seq'), 10);
       const data = await response.json();
       // API returns flat array, normalize level to lowercase for filtering
-      const normalizedLogs = (Array.isArray(data) ? data : data.logs || []).map(log => ({
+      const newLogs = (Array.isArray(data) ? data : data.logs || []).map(log => ({
         ...log,
         level: log.level?.toLowerCase() || 'info'
       }));
-      setLogs(normalizedLogs);
+
+      // Numbering restarted (device rebooted with an empty log): take the full list
+      const restarted = lastSeq.current !== null && !isNaN(nextSeq) && nextSeq <= lastSeq.current;
+      if (restarted) {
+        lastSeq.current = null;
+        setLogs([]);
+        return fetchLogs();
+      }
+
+      if (newLogs.length > 0) {
+        const newest = newLogs[newLogs.length - 1].seq;
+        const append = lastSeq.current !== null && newest !== undefined;
+        lastSeq.current = newest ?? null;
+        setLogs(prev => (append ? [...prev, ...newLogs] : newLogs).slice(-MAX_LOGS));
+      }
       setLoading(false);
     } catch (err) {
       setError(err.message);
@@ -170,7 +191,7 @@ export function Logs() {
               const style = getLevelStyle(log.level);
               return html`
                 <div
-                  key=${index}
+                  key=${log.seq ?? index}
                   class="${style.bg} border ${style.text} rounded-lg p-4 transition-all hover:shadow-md"
                 >
                   <div class="flex items-start gap-3">
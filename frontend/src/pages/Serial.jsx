@@ -12,6 +12,7 @@ export function Serial() {
   const [lines, setLines] = useState([]);
   const [isConnected, setIsConnected] = useState(false);
   const [autoscroll, setAutoscroll] = useState(true);
+  const [command, setCommand] = useState('');
   const scrollRef = useRef(null);
   const wsRef = useRef(null);
 
@@ -29,9 +30,10 @@ export function Serial() {
     };
 
     ws.onmessage = (event) => {
-      const line = event.data;
-      if (line && line.trim()) {
-        setLines(prev => [...prev, line].slice(-500)); // Keep last 500 lines
+      // Each frame carries all lines since the previous flush
+      const received = event.data.split('\n').filter(line => line.trim());
+      if (received.length > 0) {
+        setLines(prev => [...prev, ...received].slice(-500)); // Keep last 500 lines
       }
     };
 
@@ -68,6 +70,16 @@ export function Serial() {
     setLines([]);
   };
 
+  // Commands run on the device's serial console; replies arrive as serial output
+  const sendCommand = (e) => {
+    e.preventDefault();
+    const ws = wsRef.current;
+    if (command.trim() && ws?.readyState === WebSocket.OPEN) {
+      ws.send(command.trim());
+      setCommand('');
+    }
+  };
+
   return html`
     <div class="space-y-4">
       <!-- Header with Controls -->
@@ -126,6 +138,17 @@ export function Serial() {
             </div>
           `)}
         </div>
+        <form onSubmit=${sendCommand} class="flex gap-2 mt-3 border-t border-gray-700 pt-3">
+          <span class="text-gray-500 py-2">&gt;</span>
+          <input
+            type="text"
+            value=${command}
+            onInput=${(e) => setCommand(e.target.value)}
+            placeholder="Command (type help)"
+            disabled=${!isConnected}
+            class="flex-1 bg-transparent text-green-400 outline-none placeholder-gray-600"
+          />
+        </form>
       </div>
 
       <!-- Info Card -->
@@ -139,6 +162,7 @@ export function Serial() {
               <li>Maximum 500 lines are kept in memory</li>
               <li>Disable auto-scroll to review previous output</li>
               <li>Use Clear to remove all lines</li>
+              <li>Type <code>help</code> below for console commands (perf, heap, hist, log, setpoint)</li>
               <li>Reconnects automatically if connection is lost</li>
             </ul>
           </div>
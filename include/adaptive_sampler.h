@@ -0,0 +1,109 @@
+/**
+ * @file adaptive_sampler.h
+ * @brief Activity-driven sensor sampling interval
+ *
+ * Replaces the fixed sensor update interval with one that follows what the
+ * room is doing. The interval collapses to the configured minimum as soon
+ * as the temperature moves quickly, the setpoint changes or the valve
+ * travels, and stretches geometrically towards the maximum while the room
+ * stays stable. Sampling drives KNX/MQTT publishing and history ingestion,
+ * so quiet periods also cost less I2C, radio and logging work.
+ *
+ * @par Decision Rules (per sample)
+ * - |dT/dt| >= SLOPE_FAST_C_PER_MIN, setpoint or valve change: minimum interval
+ * - |dT/dt| >= SLOPE_QUIET_C_PER_MIN: keep the current interval
+ * - otherwise: interval *= STRETCH_FACTOR, capped at the maximum
+ *
+ * @see ConfigManager::getAdaptiveSamplingEnabled() for persisted bounds
+ */
+
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <Arduino.h>
+
+/**
+ * @class AdaptiveSampler
+ * @brief Computes the next sensor sampling interval from recent activity
+ */
+class AdaptiveSampler {
+public:
+    /// Temperature slope that counts as a transient (°C per minute)
+    static constexpr float SLOPE_FAST_C_PER_MIN = 0.10f;
+
+    /// Temperature slope below which the room is considered stable (°C per minute)
+    static constexpr float SLOPE_QUIET_C_PER_MIN = 0.03f;
+
+    /// Setpoint change that resets the interval (°C)
+    static constexpr float SETPOINT_CHANGE_C = 0.1f;
+
+    /// Valve travel that resets the interval (%)
+    static constexpr float VALVE_CHANGE_PERCENT = 5.0f;
+
+    /// Growth factor applied to the interval on each quiet sample
+    static constexpr float STRETCH_FACTOR = 1.5f;
+
+    AdaptiveSampler();
+
+    /**
+     * @brief Apply sampling bounds
+     * @param enabled false keeps getInterval() pinned to the minimum
+     * @param minIntervalMs Shortest interval used during transients
+     * @param maxIntervalMs Longest interval used while the room is stable
+     */
+    void configure(bool enabled, uint32_t minIntervalMs, uint32_t maxIntervalMs);
+
+    bool isEnabled() const { return _enabled; }
+
+    /**
+     * @brief Observe control inputs between samples
+     *
+     * Cheap enough to call every loop iteration. A setpoint change or valve
+     * movement drops the interval to the minimum immediately, so the next
+     * sample is not delayed by a stretched interval.
+     *
+     * @param setpoint Current temperature setpoint (°C)
+     * @param valvePosition Current valve position (0-100%)
+     */
+    void noteControlState(float setpoint, float valvePosition);
+
+    /**
+     * @brief Record a completed sample and compute the next interval
+     * @param temperature Sampled (filtered) temperature in °C
+     * @param now millis() timestamp of the sample
+     * @return Interval until the next sample in milliseconds
+     */
+    uint32_t recordSample(float temperature, unsigned long now);
+
+    /**
+     * @brief Interval until the next sample in milliseconds
+     */
+    uint32_t getInterval() const { return _intervalMs; }
+
+    /**
+     * @brief Absolute temperature slope seen at the last sample (°C per minute)
+     */
+    float getLastSlope() const { return _lastSlope; }
+
+    /**
+     * @brief Clear sample history (bounds are kept)
+     */
+    void reset();
+
+private:
+    bool _enabled;
+    uint32_t _minIntervalMs;
+    uint32_t _maxIntervalMs;
+    uint32_t _intervalMs;
+
+    float _lastTemperature;
+    unsigned long _lastSampleTime;
+    bool _hasSample;
+    float _lastSlope;
+
+    float _lastSetpoint;
+    float _lastValvePosition;
+    bool _hasControlState;
+};
+
+#endif // ADAPTIVE_SAMPLER_H
@@ -2,12 +2,20 @@
 #define BME280_SENSOR_H
 
 #include <Adafruit_BME280.h>
+#include "sensor_driver.h"
 
-class BME280Sensor {
+/**
+ * @brief BME280 temperature/humidity/pressure sensor (I2C, address 0x76)
+ *
+ * Runs in the Adafruit library's default normal mode, so the sensor
+ * converts continuously on its own and a scheduler "conversion" only
+ * needs a register read.
+ */
+class BME280Sensor : public SensorDriver {
 public:
     BME280Sensor();
 
-    bool begin();
+    bool begin() override;
     float readTemperature();
     float readHumidity();
     float readPressure();
@@ -15,9 +23,16 @@ public:
     // CRITICAL FIX: Add health check method (Audit Fix #3)
     bool isHealthy();
 
+    // SensorDriver interface
+    const char* getName() const override { return "BME280"; }
+    SensorBus getBus() const override { return SENSOR_BUS_I2C; }
+    bool startConversion() override;
+    uint32_t getConversionTimeMs() const override { return 0; }
+    bool readSample(SensorSample& sample) override;
+
 private:
     Adafruit_BME280 bme;
     bool initialized;
 };
 
-#endif // BME280_SENSOR_H
\ No newline at end of file
+#endif // BME280_SENSOR_H
@@ -0,0 +1,78 @@
+/**
+ * @file command_coalescer.h
+ * @brief Debounces persistence and echo of setpoint, preset and mode commands
+ *
+ * Dragging the Home Assistant thermostat slider or tapping +/- in the web UI
+ * produces a burst of setpoint commands. The caller applies each one to the
+ * controller at once and hands it here; the coalescer keeps only the latest
+ * value and releases it through take() once no command has arrived for the
+ * quiet window (or the max delay has passed since the first one). The main
+ * loop then writes NVS once and publishes one state echo for the whole burst.
+ *
+ * Commands come from the web server task and the main loop, so the pending
+ * state is guarded by a portMUX critical section.
+ *
+ * @par Memory Usage
+ * ~40 bytes.
+ */
+
+#ifndef COMMAND_COALESCER_H
+#define COMMAND_COALESCER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Which parts of a CoalescedCommand changed
+enum CoalescedChange : uint8_t {
+    COALESCED_SETPOINT = 0x01,
+    COALESCED_PRESET = 0x02,
+    COALESCED_MODE = 0x04
+};
+
+/**
+ * @brief The latest value of everything changed during one burst
+ */
+struct CoalescedCommand {
+    uint8_t changes;            // CoalescedChange bits
+    float setpoint;             // °C
+    bool heat;                  // Mode: heat (true) or off
+    char preset[16];
+};
+
+class CommandCoalescer {
+public:
+    CommandCoalescer(uint32_t quietMs = COMMAND_COALESCE_QUIET_MS,
+                     uint32_t maxDelayMs = COMMAND_COALESCE_MAX_DELAY_MS);
+
+    // Record a command (any task); the caller has already applied it to the controller
+    void setpoint(float value, uint32_t now);
+    void preset(const char* name, float temperature, uint32_t now);  // Also sets the setpoint
+    void mode(bool heat, uint32_t now);
+
+    /**
+     * @brief Hand over the pending burst once input has settled (main loop)
+     * @return true and fills out when something is due; the pending state is cleared
+     */
+    bool take(uint32_t now, CoalescedCommand& out);
+
+    // Anything waiting for take()
+    bool isPending() const { return _pending.changes != 0; }
+
+    // Commands recorded and bursts handed over
+    uint32_t getReceivedCount() const { return _received; }
+    uint32_t getCommittedCount() const { return _committed; }
+
+private:
+    void touch(uint32_t now);
+
+    const uint32_t _quietMs;
+    const uint32_t _maxDelayMs;
+    portMUX_TYPE _lock;
+    CoalescedCommand _pending;
+    uint32_t _firstInput;
+    uint32_t _lastInput;
+    uint32_t _received;
+    uint32_t _committed;
+};
+
+#endif // COMMAND_COALESCER_H
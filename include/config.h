@@ -49,6 +49,17 @@
 #define MQTT_USER ""        // Replace with your MQTT username
 #define MQTT_PASSWORD "" // Replace with your MQTT password
 
+// PubSubClient buffer: bounds messages sent with publish() and messages received.
+// Discovery configs, log batches and the JSON aggregate are streamed past it.
+#ifndef MQTT_BUFFER_SIZE
+#define MQTT_BUFFER_SIZE 384
+#endif
+
+// Longest command payload accepted on a subscribed topic; longer ones are dropped
+#ifndef MQTT_COMMAND_PAYLOAD_MAX
+#define MQTT_COMMAND_PAYLOAD_MAX 64
+#endif
+
 // MQTT Topics
 #define MQTT_TOPIC_TEMPERATURE "thermostat/temperature"
 #define MQTT_TOPIC_HUMIDITY "thermostat/humidity"
@@ -62,6 +73,15 @@
 #define PID_ADAPTATION_INTERVAL_SEC 1800.0f  // PID parameter adaptation interval (30 minutes)
 #define PID_CONFIG_WRITE_INTERVAL_MS 300000  // Write PID config to flash max once per 5 minutes
 
+// Setpoint/preset/mode commands: persisted and echoed once input has been quiet this long,
+// and no later than the max delay while input keeps arriving (see CommandCoalescer)
+#ifndef COMMAND_COALESCE_QUIET_MS
+#define COMMAND_COALESCE_QUIET_MS 1500
+#endif
+#ifndef COMMAND_COALESCE_MAX_DELAY_MS
+#define COMMAND_COALESCE_MAX_DELAY_MS 10000
+#endif
+
 // Initial PID Parameters (will be auto-tuned)
 #define PID_KP_INITIAL 2.0      // Proportional gain
 #define PID_KI_INITIAL 0.1      // Integral gain
@@ -76,6 +96,11 @@
 #define SENSOR_UPDATE_INTERVAL_MS 30000     // Sensor reading update interval (30 seconds)
 #define CONNECTIVITY_CHECK_INTERVAL_MS 300000  // Connectivity check interval in main loop (5 minutes)
 
+// Additional sensors (driven by SensorScheduler alongside the BME280)
+#define SENSOR_SHT_TYPE 0                // 0 = none, 3 = SHT3x, 4 = SHT4x on the shared I2C bus
+#define SENSOR_SHT_ADDRESS 0x44          // SHT3x/SHT4x I2C address
+#define SENSOR_DS18B20_PIN -1            // GPIO of the DS18B20 radiator return probe (-1 = none)
+
 // Watchdog timer configurations
 #define SYSTEM_WATCHDOG_TIMEOUT 2700000  // 45-minute system watchdog (in ms)
 #define WIFI_WATCHDOG_TIMEOUT 1800000    // 30-minute WiFi watchdog (in ms)
@@ -223,6 +223,42 @@ public:
      */
     void setMqttJsonAggregateEnabled(bool enabled);
 
+    /**
+     * @brief Check if Home Assistant states go out as one JSON state document
+     * @return true for one message on esp32_thermostat/state, false for a topic per state
+     */
+    bool getMqttStateDocumentEnabled();
+
+    /**
+     * @brief Enable or disable the consolidated Home Assistant state document
+     * @param enabled true to publish one JSON document per cycle (applied at once while connected)
+     */
+    void setMqttStateDocumentEnabled(bool enabled);
+
+    /**
+     * @brief Get the encoding of the 'telegraph' aggregate
+     * @return TelegraphFormat value (TELEGRAPH_JSON or TELEGRAPH_MSGPACK)
+     */
+    uint8_t getMqttAggregateFormat();
+
+    /**
+     * @brief Set the encoding of the 'telegraph' aggregate
+     * @param format TelegraphFormat value (TELEGRAPH_JSON or TELEGRAPH_MSGPACK)
+     */
+    void setMqttAggregateFormat(uint8_t format);
+
+    /**
+     * @brief Get the field groups carried by the 'telegraph' aggregate
+     * @return TelegraphField bits (TELEGRAPH_ALL_FIELDS by default)
+     */
+    uint8_t getMqttAggregateFields();
+
+    /**
+     * @brief Set the field groups carried by the 'telegraph' aggregate
+     * @param fields TelegraphField bits
+     */
+    void setMqttAggregateFields(uint8_t fields);
+
     // KNX settings
     /**
      * @brief Get the KNX area address component
@@ -409,6 +445,20 @@ public:
     uint32_t getSensorUpdateInterval();
     void setSensorUpdateInterval(uint32_t interval);
 
+    /**
+     * @brief Check if adaptive sensor sampling is enabled
+     * @return true to vary the sampling interval between the min/max bounds,
+     *         false to sample at the fixed sensor update interval
+     */
+    bool getAdaptiveSamplingEnabled();
+    void setAdaptiveSamplingEnabled(bool enabled);
+
+    uint32_t getSensorMinInterval();
+    void setSensorMinInterval(uint32_t interval);
+
+    uint32_t getSensorMaxInterval();
+    void setSensorMaxInterval(uint32_t interval);
+
     uint32_t getHistoryUpdateInterval();
     void setHistoryUpdateInterval(uint32_t interval);
 
@@ -442,6 +492,119 @@ public:
     bool getAdaptationEnabled();
     void setAdaptationEnabled(bool enabled);
 
+    // Sensor filter settings (see SensorFilterPipeline)
+    /**
+     * @brief Get the median filter window size
+     * @return Window size in samples (1 = disabled, 3 or 5)
+     */
+    uint8_t getFilterMedianWindow();
+
+    /**
+     * @brief Set the median filter window size
+     * @param window Window size in samples (1, 3 or 5)
+     */
+    void setFilterMedianWindow(uint8_t window);
+
+    /**
+     * @brief Get the smoothing stage mode
+     * @return SensorSmoothingMode value (0 = none, 1 = EMA, 2 = Kalman)
+     */
+    uint8_t getFilterSmoothing();
+
+    /**
+     * @brief Set the smoothing stage mode
+     * @param mode SensorSmoothingMode value (0 = none, 1 = EMA, 2 = Kalman)
+     */
+    void setFilterSmoothing(uint8_t mode);
+
+    float getFilterEmaAlpha();
+    void setFilterEmaAlpha(float alpha);
+
+    float getFilterKalmanQ();
+    void setFilterKalmanQ(float q);
+
+    float getFilterKalmanR();
+    void setFilterKalmanR(float r);
+
+    /**
+     * @brief Get the outlier gate threshold
+     * @return Maximum accepted step from the last good reading in °C (0 = disabled)
+     */
+    float getFilterOutlierThreshold();
+
+    /**
+     * @brief Set the outlier gate threshold
+     * @param threshold Maximum accepted step in °C (0 = disabled)
+     */
+    void setFilterOutlierThreshold(float threshold);
+
+    // Window-open detection settings (see WindowOpenDetector)
+    bool getWindowOpenEnabled();
+    void setWindowOpenEnabled(bool enabled);
+
+    /**
+     * @brief Get the drop rate that triggers window-open detection
+     * @return Temperature drop rate in °C per minute
+     */
+    float getWindowOpenDropRate();
+    void setWindowOpenDropRate(float rate);
+
+    /**
+     * @brief Get how long control stays suspended after a detection
+     * @return Hold time in seconds
+     */
+    uint32_t getWindowOpenHoldTime();
+    void setWindowOpenHoldTime(uint32_t seconds);
+
+    /**
+     * @brief Get the valve position applied while a window is open
+     * @return Valve position (0-100%)
+     */
+    uint8_t getWindowOpenValvePosition();
+    void setWindowOpenValvePosition(uint8_t position);
+
+    // Logging settings (see Logger::setTagLevel())
+    /**
+     * @brief Get the global log level
+     * @return LogLevel value (0 = none ... 5 = verbose)
+     */
+    uint8_t getLogLevel();
+    void setLogLevel(uint8_t level);
+
+    /**
+     * @brief Get the per-tag log levels
+     * @return Comma-separated "TAG=level" pairs, e.g. "KNX=4,PID=2"
+     */
+    String getLogTagLevels();
+    void setLogTagLevels(const String& levels);
+
+    /**
+     * @brief Set or remove one tag's level in the stored per-tag list
+     * @param tag Log tag, e.g. "KNX" (1-15 characters)
+     * @param level LogLevel value, or -1 to remove the override
+     * @return false if the tag is invalid or MAX_LOG_TAG_LEVELS is reached
+     */
+    bool setLogTagLevel(const char* tag, int level);
+
+    /**
+     * @brief Iterate the "TAG=level" pairs returned by getLogTagLevels()
+     * @param cursor Start of the list; advanced past the returned pair
+     * @return false when no pairs are left
+     */
+    static bool nextLogTagLevel(const char*& cursor, char* tag, size_t tagSize, uint8_t& level);
+
+    /**
+     * @brief Parse a log level name ("debug", "WARN", "4", ...)
+     * @return LogLevel value, or -1 if not recognised
+     */
+    static int parseLogLevel(const char* name);
+
+    /// Lower-case name of a LogLevel value
+    static const char* logLevelName(uint8_t level);
+
+    /// Most per-tag levels stored
+    static constexpr uint8_t MAX_LOG_TAG_LEVELS = 16;
+
     // Preset mode settings
     /**
      * @brief Get the current active preset mode
@@ -449,6 +612,12 @@ public:
      */
     String getCurrentPreset();
 
+    /**
+     * @brief Read the current preset into a buffer, without a String
+     * @return out, holding "none" if no preset was stored
+     */
+    const char* getCurrentPreset(char* out, size_t size);
+
     /**
      * @brief Set the current active preset mode
      * @param preset Preset name (none, eco, comfort, away, sleep, boost)
@@ -601,6 +770,23 @@ public:
      */
     static float roundToPrecision(float value, int decimals);
 
+    /// Setpoint range accepted on every path (web, MQTT, console, config import)
+    static constexpr float MIN_SETPOINT = 5.0f;
+    static constexpr float MAX_SETPOINT = 30.0f;
+
+    /**
+     * @brief Round a requested setpoint to 0.1 °C and check its range
+     * @param setpoint Rounded value when valid
+     * @return false if NaN or outside MIN_SETPOINT..MAX_SETPOINT after rounding
+     */
+    static bool validateSetpoint(float value, float& setpoint);
+
+    /**
+     * @brief Parse a setpoint command payload ("21.5"), then validateSetpoint()
+     * @return false unless the whole text is a number in range
+     */
+    static bool parseSetpoint(const char* text, float& setpoint);
+
 private:
     ConfigManager();
     static ConfigManager* _instance;
@@ -618,6 +804,8 @@ private:
 
     // Default timing values (matching config.h constants)
     static constexpr uint32_t DEFAULT_SENSOR_UPDATE_INTERVAL_MS = 30000;
+    static constexpr uint32_t DEFAULT_SENSOR_MIN_INTERVAL_MS = 10000;   // Adaptive sampling bounds
+    static constexpr uint32_t DEFAULT_SENSOR_MAX_INTERVAL_MS = 120000;
     static constexpr uint32_t DEFAULT_HISTORY_UPDATE_INTERVAL_MS = 30000;  // 30 seconds (configurable via web UI)
     static constexpr uint32_t DEFAULT_PID_UPDATE_INTERVAL_MS = 10000;
     static constexpr uint32_t DEFAULT_CONNECTIVITY_CHECK_INTERVAL_MS = 300000;
@@ -633,6 +821,23 @@ private:
     static constexpr float DEFAULT_WEBHOOK_TEMP_LOW_THRESHOLD = 15.0f;
     static constexpr float DEFAULT_WEBHOOK_TEMP_HIGH_THRESHOLD = 30.0f;
 
+    // Default sensor filter settings
+    static constexpr uint8_t DEFAULT_FILTER_MEDIAN_WINDOW = 3;
+    static constexpr uint8_t DEFAULT_FILTER_SMOOTHING = 1;  // EMA
+    static constexpr float DEFAULT_FILTER_EMA_ALPHA = 0.5f;
+    static constexpr float DEFAULT_FILTER_KALMAN_Q = 0.001f;
+    static constexpr float DEFAULT_FILTER_KALMAN_R = 0.01f;
+    static constexpr float DEFAULT_FILTER_OUTLIER_THRESHOLD = 2.0f;
+
+    // Default window-open detection settings
+    static constexpr bool DEFAULT_WINDOW_OPEN_ENABLED = false;
+    static constexpr float DEFAULT_WINDOW_OPEN_DROP_RATE = 0.3f;      // °C per minute
+    static constexpr uint32_t DEFAULT_WINDOW_OPEN_HOLD_SEC = 900;     // 15 minutes
+    static constexpr uint8_t DEFAULT_WINDOW_OPEN_VALVE_POSITION = 0;
+
+    // Default logging settings
+    static constexpr uint8_t DEFAULT_LOG_LEVEL = 3;  // LOG_INFO
+
     // Default preset temperatures
     static constexpr float DEFAULT_PRESET_ECO = 18.0f;
     static constexpr float DEFAULT_PRESET_COMFORT = 19.0f;
@@ -650,6 +855,9 @@ private:
     bool validateAndApplyTimingSettings(const JsonDocument& doc, String& errorMessage);
     bool validateAndApplyWebhookSettings(const JsonDocument& doc, String& errorMessage);
     bool validateAndApplyPresetSettings(const JsonDocument& doc, String& errorMessage);
+    bool validateAndApplyFilterSettings(const JsonDocument& doc, String& errorMessage);
+    bool validateAndApplyWindowOpenSettings(const JsonDocument& doc, String& errorMessage);
+    bool validateAndApplyLoggingSettings(const JsonDocument& doc, String& errorMessage);
 
 public:
         /**
@@ -0,0 +1,25 @@
+/**
+ * @file console_commands.h
+ * @brief Field-debugging commands for the serial console
+ *
+ * perf, heap, hist, log and setpoint; see SerialConsole. Registered once at
+ * startup. Log level changes made here are runtime only and are not saved.
+ */
+
+#ifndef CONSOLE_COMMANDS_H
+#define CONSOLE_COMMANDS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Add the thermostat's commands to SerialConsole
+ */
+void registerConsoleCommands();
+
+/**
+ * @brief Account one main loop pass for the perf command
+ * @param micros Duration of the pass
+ */
+void recordLoopTime(uint32_t micros);
+
+#endif // CONSOLE_COMMANDS_H
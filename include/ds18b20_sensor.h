@@ -0,0 +1,30 @@
+#ifndef DS18B20_SENSOR_H
+#define DS18B20_SENSOR_H
+
+#include <OneWire.h>
+#include "sensor_driver.h"
+
+/**
+ * @brief DS18B20 1-Wire temperature probe (e.g. radiator return temperature)
+ *
+ * One probe per GPIO, addressed with SKIP ROM. The 750 ms 12-bit
+ * conversion runs while the scheduler services other sensors; nothing
+ * here waits for it.
+ */
+class Ds18b20Sensor : public SensorDriver {
+public:
+    explicit Ds18b20Sensor(uint8_t pin);
+
+    const char* getName() const override { return "DS18B20"; }
+    SensorBus getBus() const override { return SENSOR_BUS_ONEWIRE; }
+    bool begin() override;
+    bool startConversion() override;
+    uint32_t getConversionTimeMs() const override { return 750; }
+    bool readSample(SensorSample& sample) override;
+
+private:
+    OneWire _oneWire;
+    bool _firstConversion;
+};
+
+#endif // DS18B20_SENSOR_H
@@ -0,0 +1,180 @@
+/**
+ * @file event_archive.h
+ * @brief Compressed long-term archive of event log entries on LittleFS
+ *
+ * The EventLog ring only holds the last 100 entries. Entries are sealed
+ * into pages of EVENT_ARCHIVE_PAGE_ENTRIES compact records (see
+ * EventJournal::encodeCompact()), compressed with LZSS and appended to
+ * segment files /evarch/<n>.lz. A new segment is started once the current
+ * one passes EVENT_ARCHIVE_SEGMENT_SIZE, and whole segments are deleted
+ * oldest first to keep the archive within EVENT_ARCHIVE_BUDGET.
+ *
+ * Page layout:
+ *
+ *   [sync 0xA7][version][raw length u16][compressed length u16][record count u16]
+ *   [first seq u32][first timestamp u32][CRC-32 u32][compressed records]
+ *
+ * The CRC covers the compressed data followed by the header bytes before it. A page
+ * is written with a zero compressed length and patched once complete, so a
+ * page torn by a reset is recognised and the rest of its segment ignored.
+ *
+ * Not thread-safe. EventLog writes pages (beginPage() to sealPage()) on the
+ * main loop without its mutex; readers only see the segments and end
+ * sequence number copied by publish(), which runs under the mutex like
+ * every other call.
+ *
+ * @par Memory Usage
+ * Writer: one LzssEncoder (~1.1 KB). Each EventArchiveReader: ~700 bytes.
+ */
+
+#ifndef EVENT_ARCHIVE_H
+#define EVENT_ARCHIVE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "event_journal.h"
+#include "lzss.h"
+
+// Total flash the archive may use
+#ifndef EVENT_ARCHIVE_BUDGET
+#define EVENT_ARCHIVE_BUDGET (128 * 1024)
+#endif
+
+// Segment file size at which a new segment is started (unit of eviction)
+#ifndef EVENT_ARCHIVE_SEGMENT_SIZE
+#define EVENT_ARCHIVE_SEGMENT_SIZE (16 * 1024)
+#endif
+
+// Entries per sealed page
+#ifndef EVENT_ARCHIVE_PAGE_ENTRIES
+#define EVENT_ARCHIVE_PAGE_ENTRIES 32
+#endif
+
+/**
+ * @class EventArchive
+ * @brief Writer side: sealed pages in size-bounded segment files
+ */
+class EventArchive {
+public:
+    static const size_t PAGE_HEADER_SIZE = 20;
+
+    EventArchive();
+
+    /**
+     * @brief Find existing segments and where the archive ends
+     * @return false if the archive directory cannot be used
+     */
+    bool begin();
+
+    /**
+     * @brief Start a page; records must follow with consecutive sequence numbers
+     */
+    bool beginPage(uint32_t firstSeq, uint32_t firstTimestamp);
+
+    bool addRecord(uint32_t timestamp, uint8_t level, const char* tag, const char* message);
+
+    /**
+     * @brief Finish the page, then evict old segments if over budget
+     */
+    bool sealPage();
+
+    /**
+     * @brief Delete every segment
+     */
+    void clear();
+
+    /**
+     * @brief Make pages sealed since the last call visible to readers
+     */
+    void publish();
+
+    /// Sequence number after the newest published entry (0 if empty)
+    uint32_t getEndSeq() const { return _published.endSeq; }
+
+    /// Published segment range [first, last]; empty if first > last
+    uint32_t getFirstSegment() const { return _published.firstSegment; }
+    uint32_t getLastSegment() const { return _published.lastSegment; }
+
+    /// Bytes of flash used by the published segments
+    size_t getSize() const { return _published.size; }
+
+    static void segmentPath(char* path, size_t size, uint32_t segment);
+
+private:
+    // What readers see; copied from the writer's fields by publish()
+    struct Extent {
+        uint32_t firstSegment;
+        uint32_t lastSegment;
+        uint32_t endSeq;
+        size_t size;
+    };
+
+    static bool writeCompressed(void* context, const uint8_t* data, size_t length);
+    void scanSegment(uint32_t segment);
+    void evict();
+
+    LzssEncoder _encoder;
+    File _file;
+    bool _ready;
+    bool _pageOpen;
+    bool _pageFailed;
+    size_t _pageStart;
+    uint32_t _pageFirstSeq;
+    uint32_t _pageFirstTimestamp;
+    uint32_t _pageLastTimestamp;
+    uint16_t _pageRecords;
+    uint32_t _pageRawLength;
+    uint32_t _pageCrc;
+    uint32_t _firstSegment;
+    uint32_t _lastSegment;
+    size_t _lastSegmentSize;
+    bool _lastSegmentClosed;        // Damaged tail: next page starts a new segment
+    size_t _size;
+    uint32_t _endSeq;
+    Extent _published;
+};
+
+/**
+ * @class EventArchiveReader
+ * @brief Reads archived records in order, decompressing on the fly
+ *
+ * Copyable so it can live in a streaming response's state.
+ */
+class EventArchiveReader {
+public:
+    EventArchiveReader();
+
+    /**
+     * @brief Position at the first archived entry with a sequence number >= seq
+     */
+    void begin(const EventArchive& archive, uint32_t seq);
+
+    /**
+     * @brief Read the next record (record.seq is set)
+     * @return false at the end of the archive
+     */
+    bool next(const EventArchive& archive, EventJournalRecord& record);
+
+private:
+    bool openPage(const EventArchive& archive);
+    bool openSegment(uint32_t segment);
+    size_t fillRaw(uint8_t* out, size_t size);
+
+    File _file;
+    uint32_t _segment;
+    uint32_t _seq;                  // Skip records below this
+    LzssDecoder _decoder;
+    uint8_t _input[32];
+    uint8_t _inputLength;
+    uint8_t _inputPos;
+    uint16_t _compressedRemaining;
+    uint16_t _rawRemaining;
+    uint16_t _recordsRemaining;
+    uint32_t _pageSeq;              // Sequence number of the next record in the page
+    uint32_t _timestamp;            // Timestamp of the previous record in the page
+    uint8_t _raw[EventJournal::MAX_COMPACT_SIZE];
+    uint8_t _rawLength;
+    bool _done;
+};
+
+#endif // EVENT_ARCHIVE_H
@@ -0,0 +1,108 @@
+/**
+ * @file event_journal.h
+ * @brief Append-only binary journal format for EventLog records
+ *
+ * The event log is persisted as a header followed by variable-length
+ * records, each appended as it is flushed rather than rewriting the whole
+ * log:
+ *
+ *   [sync 0xE5][level][tag length][message length][seq u32][timestamp u32]
+ *   [tag bytes][message bytes][CRC-32 u32]
+ *
+ * All integers are little-endian and the CRC covers every preceding byte
+ * of the record. A torn or corrupted record fails its CRC; decode() then
+ * skips a byte so the reader can resynchronise on the next sync byte.
+ *
+ * Archive pages (see EventArchive) use a compact variant without sync byte,
+ * sequence number or CRC - the page carries those once - and with the
+ * timestamp stored as a varint delta from the previous record:
+ *
+ *   [level][tag length][message length][timestamp delta][tag][message]
+ *
+ * Pure encoding/decoding only - file handling lives in EventLog.
+ */
+
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief One decoded journal record (tag and message NUL-terminated)
+ */
+struct EventJournalRecord {
+    uint32_t seq;
+    uint32_t timestamp;
+    uint8_t level;
+    char tag[16];
+    char message[118];
+};
+
+class EventJournal {
+public:
+    static const size_t HEADER_SIZE = 8;
+    static const size_t MAX_TAG_LENGTH = sizeof(EventJournalRecord::tag) - 1;
+    static const size_t MAX_MESSAGE_LENGTH = sizeof(EventJournalRecord::message) - 1;
+    static const size_t RECORD_OVERHEAD = 16;   // Fixed fields plus CRC
+    static const size_t MAX_RECORD_SIZE = RECORD_OVERHEAD + MAX_TAG_LENGTH + MAX_MESSAGE_LENGTH;
+    static const size_t MAX_COMPACT_SIZE = 8 + MAX_TAG_LENGTH + MAX_MESSAGE_LENGTH;
+
+    enum Result {
+        RESULT_OK,
+        RESULT_INCOMPLETE,  ///< Need more bytes (or the file ends mid-record)
+        RESULT_CORRUPT      ///< Bad sync byte, length or CRC; skip consumed bytes
+    };
+
+    /**
+     * @brief Write the file header ("ELOG", version, reserved)
+     * @param out At least HEADER_SIZE bytes
+     */
+    static void encodeHeader(uint8_t* out);
+
+    /**
+     * @brief Check a file header written by encodeHeader()
+     */
+    static bool checkHeader(const uint8_t* in, size_t length);
+
+    /**
+     * @brief Encode one record; tag and message are truncated to their maximum length
+     * @param out At least MAX_RECORD_SIZE bytes
+     * @return Bytes written
+     */
+    static size_t encode(uint8_t* out, uint32_t seq, uint32_t timestamp, uint8_t level,
+                         const char* tag, const char* message);
+
+    /**
+     * @brief Decode the record at the start of in
+     * @param consumed Bytes to drop from the input (valid for OK and CORRUPT)
+     */
+    static Result decode(const uint8_t* in, size_t length, EventJournalRecord& record, size_t& consumed);
+
+    /**
+     * @brief Encode one record in the compact archive form
+     * @param previousTimestamp Timestamp of the record before it in the page
+     * @param out At least MAX_COMPACT_SIZE bytes
+     * @return Bytes written
+     */
+    static size_t encodeCompact(uint8_t* out, uint32_t previousTimestamp, uint32_t timestamp,
+                                uint8_t level, const char* tag, const char* message);
+
+    /**
+     * @brief Decode a compact record; record.seq is left for the caller to set
+     * @return Bytes used, or 0 if the input is short or malformed
+     */
+    static size_t decodeCompact(const uint8_t* in, size_t length, uint32_t previousTimestamp,
+                                EventJournalRecord& record);
+
+    /**
+     * @brief CRC-32 (IEEE 802.3, reflected), chainable via crc
+     */
+    static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+private:
+    static const uint8_t SYNC_BYTE = 0xE5;
+    static const uint8_t VERSION = 1;
+};
+
+#endif // EVENT_JOURNAL_H
@@ -3,31 +3,54 @@
 
 #include <Arduino.h>
 #include <LittleFS.h>
-#include <vector>
 #include <ArduinoJson.h>
+#include <functional>
 #include "logger.h"
+#include "event_journal.h"
+#include "event_archive.h"
 
 /**
- * @brief Structure representing a single log entry
+ * @brief One event log entry: fixed size, no heap
  */
-struct LogEntry {
-    unsigned long timestamp;  // Milliseconds since boot
-    LogLevel level;
-    String tag;
-    String message;
-
-    LogEntry() : timestamp(0), level(LOG_INFO) {}
+struct EventRecord {
+    uint32_t seq;           // Sequence number, increasing across reboots
+    uint32_t timestamp;     // Milliseconds since boot
+    uint8_t level;          // LogLevel
+    uint8_t tagId;          // Interned tag, see Logger::getTagName()
+    char message[sizeof(EventJournalRecord::message)];  // Truncated, NUL-terminated
+};
 
-    LogEntry(unsigned long ts, LogLevel lvl, const char* t, const char* msg)
-        : timestamp(ts), level(lvl), tag(t), message(msg) {}
+/**
+ * @brief Position and filters of a streaming log query (see EventLog::readEntryJSON())
+ */
+struct EventLogQuery {
+    uint32_t next;              // Next sequence number to examine
+    LogLevel minLevel;          // Least important level included
+    char tag[LOG_TAG_SIZE];     // Tag to match, empty for all
+    uint16_t remaining;         // Entries still to return
 };
 
 /**
  * @brief EventLog class for persistent logging
  *
  * Stores important events (errors, warnings, info) in LittleFS for troubleshooting.
- * Implements a circular buffer approach with configurable maximum entries.
- * Also publishes logs to MQTT if enabled.
+ * Entries live in a fixed ring of fixed-size records, so adding one never
+ * allocates and the oldest entry is overwritten in place. Persistence is an
+ * append-only journal (see EventJournal): new entries are appended as a few
+ * dozen bytes each, and the file is compacted to the current ring contents
+ * once it grows past JOURNAL_COMPACT_SIZE. Every EVENT_ARCHIVE_PAGE_ENTRIES
+ * entries are also sealed into the compressed long-term EventArchive, which
+ * keeps weeks of history within a fixed flash budget. Also publishes logs
+ * to MQTT if enabled.
+ *
+ * Entries arrive from the log drain task as well as the main loop, so the
+ * ring is guarded by a mutex. addEntry() only copies the entry into the
+ * ring; journal appends, compaction and archive pages are written by loop()
+ * on the main loop. Those copy each record out under the mutex and write
+ * it without, so addEntry() and readers wait for a record copy, never for
+ * flash or compression; a sealed archive page becomes visible to readers
+ * when it is published under the mutex afterwards. A second mutex keeps the flash writers and clear() apart. MQTT
+ * publishing is deferred to loop() as well.
  */
 class EventLog {
 public:
@@ -43,12 +66,19 @@ public:
     bool begin();
 
     /**
-     * @brief Flush pending log writes when the write interval has elapsed.
+     * @brief Publish pending MQTT log entries, seal due archive pages and
+     *        flush pending log writes when the write interval has elapsed
+     *        (or an error was logged). Main loop only.
      */
     void loop();
 
     /**
-     * @brief Add a log entry
+     * @brief Write everything pending now (before a deliberate restart)
+     */
+    void flush();
+
+    /**
+     * @brief Add a log entry (any task; never touches flash)
      * @param level Log level
      * @param tag Log tag/category
      * @param message Log message
@@ -69,6 +99,51 @@ public:
      */
     String getFilteredEntriesJSON(LogLevel minLevel = LOG_INFO, const char* tag = nullptr);
 
+    /**
+     * @brief Start a query at sequence number next
+     *
+     * A cursor outside the range held (from before a reboot or clear(), or
+     * already overwritten) starts at the oldest entry instead.
+     * @param next First sequence number wanted - the last one seen plus one, or 0 for all
+     * @param minLevel Least important level to include
+     * @param tag Tag to match, nullptr or empty for all
+     * @param limit Maximum number of entries returned
+     */
+    EventLogQuery beginQuery(uint32_t next, LogLevel minLevel, const char* tag, uint16_t limit);
+
+    /**
+     * @brief Format the next entry matching a query as a JSON object and advance it
+     *
+     * Lets callers stream entries straight from the ring without building a
+     * document; entries are formatted one at a time under the lock.
+     * @param out At least MAX_ENTRY_JSON bytes; not NUL-terminated
+     * @return Bytes written, 0 once the query is exhausted
+     */
+    size_t readEntryJSON(EventLogQuery& query, char* out, size_t size);
+
+    /**
+     * @brief Start reading the archive at sequence number next (see beginQuery())
+     */
+    void beginArchiveQuery(EventArchiveReader& reader, uint32_t next);
+
+    /**
+     * @brief Like readEntryJSON(), but from the compressed archive
+     *
+     * Returns 0 once the archive is exhausted or reaches entries still held
+     * in the ring; continue with readEntryJSON() on the same query.
+     */
+    size_t readArchiveEntryJSON(EventArchiveReader& reader, EventLogQuery& query, char* out, size_t size);
+
+    /**
+     * @brief Sequence number the next entry will get
+     */
+    uint32_t getNextSeq() const;
+
+    /**
+     * @brief Flash used by the compressed archive in bytes
+     */
+    size_t getArchiveSize() const;
+
     /**
      * @brief Clear all log entries
      */
@@ -92,15 +167,28 @@ public:
 
     /**
      * @brief Set MQTT publish callback
+     *
+     * Called from loop() with each new entry formatted as a JSON object
+     * (same fields as /api/logs). Returning false stops the round; the
+     * entry is offered again on the next loop() while the ring still holds it.
+     *
      * @param callback Function to call for MQTT publishing
      */
-    void setMQTTCallback(std::function<void(LogLevel, const char*, const char*)> callback);
+    void setMQTTCallback(std::function<bool(const char* json, size_t length)> callback);
+
+    /**
+     * @brief Entries overwritten in the ring before the MQTT callback took them
+     */
+    uint32_t getMQTTDroppedCount() const { return _mqttDropped; }
 
     /**
      * @brief Convert LogLevel to string
      */
     static const char* logLevelToString(LogLevel level);
 
+    static const size_t MAX_ENTRY_JSON = 400;     // Longest object readEntryJSON() writes
+    static const uint16_t MAX_ENTRIES = 100;      // Maximum number of log entries to store
+
 private:
     EventLog();
     ~EventLog();
@@ -110,31 +198,69 @@ private:
     EventLog& operator=(const EventLog&) = delete;
 
     /**
-     * @brief Load log entries from LittleFS
+     * @brief Load log entries from the LittleFS journal (or the legacy JSON file)
      */
     bool loadFromLittleFS();
 
     /**
-     * @brief Save log entries to LittleFS
+     * @brief Import and remove the JSON file written by older firmware
+     */
+    bool migrateLegacyJson();
+
+    /**
+     * @brief Append entries not yet journaled (_writeMutex held, _mutex not)
      */
     bool saveToLittleFS();
-    void markDirty();
-    void flushIfDue(bool force = false);
 
     /**
-     * @brief Publish log entry to MQTT
+     * @brief Rewrite the journal with just the current ring contents (_writeMutex held)
      */
-    void publishToMQTT(LogLevel level, const char* tag, const char* message);
+    bool compactJournal();
+
+    void flushIfDue(bool force = false);
+
+    // Append a record with the next sequence number, overwriting the oldest when full
+    void pushRecord(uint32_t timestamp, uint8_t level, uint8_t tagId, const char* message);
+
+    // Seal the next page into the archive once enough entries have accumulated (_writeMutex held)
+    void archiveIfDue();
+
+    // Format one entry as a JSON object; out must hold MAX_ENTRY_JSON bytes
+    static size_t formatEntryJSON(char* out, size_t size, uint32_t seq, uint32_t timestamp,
+                                  uint8_t level, const char* tag, const char* message);
+
+    // Record for a sequence number still held, or nullptr
+    const EventRecord* findRecord(uint32_t seq) const;
+
+    // Copy a record out under the lock; false if it is no longer (or not yet) held
+    bool copyRecord(uint32_t seq, EventRecord& record) const;
+
+    // Sequence number of the oldest record held
+    uint32_t oldestSeq() const { return _nextSeq - _count; }
 
-    static const int MAX_ENTRIES = 100;           // Maximum number of log entries to store
     static const unsigned long SAVE_INTERVAL_MS = 60000;
-    static constexpr const char* LOG_FILE = "/event_log.json";  // LittleFS file path
+    static const size_t JOURNAL_COMPACT_SIZE = 16384;   // Compact once the journal exceeds this
+    static constexpr const char* LOG_FILE = "/event_log.bin";       // LittleFS journal path
+    static constexpr const char* LOG_FILE_TMP = "/event_log.tmp";   // Compaction target
+    static constexpr const char* LEGACY_LOG_FILE = "/event_log.json";  // Pre-journal format
 
-    std::vector<LogEntry> _entries;               // In-memory log entries
-    bool _dirty;                                  // Pending filesystem write
+    EventRecord _ring[MAX_ENTRIES];               // In-memory log entries
+    uint16_t _count;                              // Records held
+    uint32_t _nextSeq;                            // Sequence number of the next entry
+    uint32_t _journaledSeq;                       // Entries below this are in the journal
+    uint32_t _mqttSeq;                            // Entries below this were sent to MQTT
+    uint32_t _mqttDropped;                        // Overwritten before they were sent
+    size_t _journalSize;                          // Current journal file size
+    uint32_t _archivedSeq;                        // Entries below this are in the archive
+    EventArchive _archive;                        // Compressed long-term history
+    SemaphoreHandle_t _mutex;                     // Guards the ring (recursive)
+    SemaphoreHandle_t _writeMutex;                // Serializes flash writers; taken before _mutex
     unsigned long _lastSaveTime;                  // Last successful save timestamp
+    bool _fsAvailable;                            // LittleFS mounted in begin()
+    bool _archiveAvailable;                       // Archive directory usable
     bool _mqttLoggingEnabled;                     // MQTT logging enabled flag
-    std::function<void(LogLevel, const char*, const char*)> _mqttCallback;  // MQTT callback
+    bool _flushRequested;                         // An error was logged; flush on the next loop()
+    std::function<bool(const char*, size_t)> _mqttCallback;  // MQTT callback
 };
 
 #endif // EVENT_LOG_H
@@ -0,0 +1,96 @@
+/**
+ * @file ha_discovery.h
+ * @brief Flash-resident Home Assistant discovery payload templates
+ *
+ * Every discovery payload is one compile-time string constant. The node id
+ * and firmware version are left as single-byte placeholders
+ * (HA_DISCOVERY_NODE_ID, HA_DISCOVERY_VERSION) and substituted while the
+ * payload is written out, so publishing a payload needs neither a String
+ * nor a buffer the size of the payload: discoveryPayloadLength() gives the
+ * length for PubSubClient::beginPublish() and writeDiscoveryPayload()
+ * streams the expanded bytes to the client through a small stack buffer.
+ *
+ * Each expanded payload also has a 32-bit FNV-1a hash. HomeAssistant keeps
+ * the hash of every config it has on the broker and skips unchanged ones;
+ * discoveryDigest() folds them into one value that is kept retained next to
+ * the configs, so after a reconnect one small message tells whether the
+ * broker still holds them.
+ *
+ * Every entity has a second template for the consolidated state option,
+ * reading its value from the state document (ha_state_document.h) with a
+ * value_template instead of from a topic of its own.
+ *
+ * @par Memory Usage
+ * Templates live in flash (~7 KB for both sets); writing one uses a 64-byte
+ * stack buffer.
+ */
+
+#ifndef HA_DISCOVERY_H
+#define HA_DISCOVERY_H
+
+#include <Arduino.h>
+
+// Placeholders inside the templates
+#define HA_DISCOVERY_NODE_ID "\x01"
+#define HA_DISCOVERY_VERSION "\x02"
+
+/**
+ * @brief One discovery config: where it goes and what it says
+ *
+ * Topic: homeassistant/<component>/<node id>[/<objectId>]/config
+ */
+struct HADiscoveryEntity {
+    const char* component;      // "sensor", "climate"
+    const char* objectId;       // nullptr for the climate entity
+    const char* label;          // For the serial log
+    const char* payload;        // Template with placeholders
+    const char* jsonPayload;    // Same, reading the consolidated state document
+};
+
+// Sensors published before the climate entity
+extern const HADiscoveryEntity HA_MEASUREMENT_SENSORS[];
+extern const size_t HA_MEASUREMENT_SENSOR_COUNT;
+
+// The climate entity (published after its retained state topics)
+extern const HADiscoveryEntity HA_CLIMATE_ENTITY;
+
+// PID and system diagnostic sensors, published last
+extern const HADiscoveryEntity HA_DIAGNOSTIC_SENSORS[];
+extern const size_t HA_DIAGNOSTIC_SENSOR_COUNT;
+
+// All of the above: measurement sensors, climate, diagnostic sensors
+#define HA_DISCOVERY_ENTITY_COUNT 10
+
+/**
+ * @brief Entity by index in publish order (see HA_DISCOVERY_ENTITY_COUNT)
+ */
+const HADiscoveryEntity& discoveryEntity(size_t index);
+
+/**
+ * @brief Write the config topic of an entity
+ * @return Length written, or 0 if it does not fit
+ */
+size_t formatDiscoveryTopic(char* out, size_t size, const HADiscoveryEntity& entity, const char* nodeId);
+
+/**
+ * @brief Length of a template once its placeholders are substituted
+ */
+size_t discoveryPayloadLength(const char* payload, const char* nodeId, const char* version);
+
+/**
+ * @brief Write a template with its placeholders substituted
+ * @return Bytes accepted by out
+ */
+size_t writeDiscoveryPayload(Print& out, const char* payload, const char* nodeId, const char* version);
+
+/**
+ * @brief FNV-1a hash of a template with its placeholders substituted
+ */
+uint32_t discoveryPayloadHash(const char* payload, const char* nodeId, const char* version);
+
+/**
+ * @brief Fold the per-entity hashes into one digest (order matters)
+ */
+uint32_t discoveryDigest(const uint32_t* hashes, size_t count);
+
+#endif // HA_DISCOVERY_H
@@ -0,0 +1,56 @@
+/**
+ * @file ha_state_document.h
+ * @brief Consolidated Home Assistant state document
+ *
+ * With the consolidated state option enabled, the sensor readings, valve
+ * position, action, PID gains and diagnostics go out as one compact JSON
+ * object on HA_STATE_DOCUMENT_TOPIC instead of one message per topic. The
+ * discovery configs then read their value from it with a value_template
+ * (see the *_JSON templates in ha_discovery.cpp).
+ *
+ * Example:
+ * {"temperature":21.50,"humidity":45.20,"pressure":1013.25,"valve":40,
+ *  "action":"heating","kp":2.00,"ki":0.100,"kd":0.050,"rssi":-61,"uptime":3600}
+ *
+ * Values that are not known yet (NaN) are written as null.
+ *
+ * @par Memory Usage
+ * 48 bytes per HAStateDocument; formatting needs no heap.
+ */
+
+#ifndef HA_STATE_DOCUMENT_H
+#define HA_STATE_DOCUMENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HA_STATE_DOCUMENT_TOPIC "esp32_thermostat/state"
+
+// Longest document formatStateDocument() writes, plus the terminator
+#define HA_STATE_DOCUMENT_SIZE 192
+
+/**
+ * @brief Latest value of every state carried by the document
+ */
+struct HAStateDocument {
+    float temperature;          // °C
+    float humidity;             // %
+    float pressure;             // hPa
+    int valvePosition;          // %
+    const char* action;         // "heating", "idle", "off"
+    float kp;
+    float ki;
+    float kd;
+    int wifiRSSI;               // dBm, 0 until known
+    uint32_t uptime;            // Seconds
+
+    HAStateDocument();
+};
+
+/**
+ * @brief Write the document as compact JSON
+ * @return Length written, or 0 if it does not fit
+ */
+size_t formatStateDocument(char* out, size_t size, const HAStateDocument& state);
+
+#endif // HA_STATE_DOCUMENT_H
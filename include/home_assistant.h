@@ -3,15 +3,28 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
+#include "publish_policy.h"
+#include "ha_discovery.h"
+#include "ha_state_document.h"
 
 class HomeAssistant {
 public:
     HomeAssistant(PubSubClient& mqttClient, const char* nodeId);
     
-    // Initialize Home Assistant auto discovery
+    // Initialize Home Assistant auto discovery (nothing is published until connected())
     void begin();
-    
-    // Register device entities with Home Assistant
+
+    // Call after every MQTT (re)connect: subscribes to the HA birth topic and the
+    // retained discovery digest; loop() publishes discovery if the digest is missing or stale
+    void connected(uint32_t now);
+
+    // Offer a received message; true if it was on one of our topics (MQTT callback)
+    bool handleMessage(const char* topic, const uint8_t* payload, size_t length);
+
+    // Publish discovery/states due after connected() or a Home Assistant birth message
+    void loop(uint32_t now);
+
+    // Publish the discovery configs that differ from what the broker holds
     void registerEntities();
     
     // Update availability status
@@ -20,6 +33,18 @@ public:
     // Send state updates for all sensors
     void updateStates(float temperature, float humidity, float pressure, int valvePosition);
 
+    // Publish one JSON state document instead of a topic per state (see ha_state_document.h).
+    // Set before connected(): the discovery digest then covers the matching configs.
+    void setStateDocumentEnabled(bool enabled) { _stateDocumentEnabled = enabled; }
+    bool isStateDocumentEnabled() const { return _stateDocumentEnabled; }
+
+    // Switch the state document on or off while connected (MQTT task): republishes
+    // the discovery configs that change with it and every state in the new layout
+    void switchStateDocument(bool enabled);
+
+    // Valve moved: its position and the resulting action (state document or own topics)
+    void updateValvePosition(int position, const char* action);
+
     // Update setpoint temperature
     void updateSetpointTemperature(float setpoint);
 
@@ -42,10 +67,79 @@ public:
     // Call this periodically or after any state change to keep HA in sync
     void syncClimateState();
 
+    // Forget what was published; call after (re)connecting so every state goes out again
+    void resetPublishState();
+
+    // State messages sent and skipped as unchanged (see PublishPolicy)
+    uint32_t getPublishedCount() const { return _publishPolicy.getPublishedCount(); }
+    uint32_t getSkippedCount() const { return _publishPolicy.getSkippedCount(); }
+
+    // Discovery configs sent and skipped as already on the broker
+    uint32_t getDiscoveryPublishedCount() const { return _discoveryPublished; }
+    uint32_t getDiscoverySkippedCount() const { return _discoverySkipped; }
+
 private:
+    // State topics with a publish policy; order matches the table in home_assistant.cpp
+    enum StateTopic : uint8_t {
+        TOPIC_TEMPERATURE,
+        TOPIC_HUMIDITY,
+        TOPIC_PRESSURE,
+        TOPIC_VALVE_POSITION,
+        TOPIC_ACTION,
+        TOPIC_AVAILABILITY,
+        TOPIC_MODE,
+        TOPIC_PRESET,
+        TOPIC_SETPOINT,
+        TOPIC_PID_KP,
+        TOPIC_PID_KI,
+        TOPIC_PID_KD,
+        TOPIC_WIFI_RSSI,
+        TOPIC_UPTIME,
+        TOPIC_STATE_DOCUMENT,
+        TOPIC_COUNT
+    };
+
+    enum DiscoveryState : uint8_t {
+        DISCOVERY_IDLE,             // Broker holds what _discoveryHashes says
+        DISCOVERY_AWAIT_DIGEST,     // Connected, waiting for the retained digest
+        DISCOVERY_PUBLISH           // Digest missing or stale: publish everything
+    };
+
     PubSubClient& _mqttClient;
     String _nodeId;
     String _availabilityTopic;
+    PublishPolicy _publishPolicy;
+    bool _stateDocumentEnabled;
+    HAStateDocument _state;         // Latest values for the state document
+
+    // Discovery bookkeeping (MQTT task only)
+    uint32_t _discoveryHashes[HA_DISCOVERY_ENTITY_COUNT];  // Per config on the broker, 0 = unknown
+    DiscoveryState _discoveryState;
+    uint32_t _digestWaitStart;
+    uint32_t _brokerDigest;
+    bool _birthPending;
+    uint32_t _discoveryPublished;
+    uint32_t _discoverySkipped;
+
+    // Publish a state if its policy says it is due; record it when sent
+    bool publish(StateTopic id, const char* topic, float value, const char* payload, bool retained);
+    bool publish(StateTopic id, const char* topic, const char* payload, bool retained);
+
+    // Publish a state unconditionally (explicit changes) and record it
+    bool publishNow(StateTopic id, const char* topic, float value, const char* payload, bool retained);
+    bool publishNow(StateTopic id, const char* topic, const char* payload, bool retained);
+
+    // Publish the state document when any state in it is due (or always with force)
+    bool publishStateDocument(bool force);
+
+    // Hash of each config as it would be published now
+    void discoveryHashes(uint32_t* hashes) const;
+
+    // Retained mode, setpoint and preset, sent before the climate config
+    void publishClimateStates();
+
+    // Stream one discovery config; needs no MQTT buffer space
+    bool publishDiscovery(const HADiscoveryEntity& entity);
     
     // Kept for backward compatibility - not used anymore
     void publishConfig(const char* component, const char* objectId, const char* name, 
@@ -0,0 +1,79 @@
+/**
+ * @file log_format.h
+ * @brief Compact binary log records with deferred printf formatting
+ *
+ * Most log traffic is a handful of format strings with different numbers.
+ * Instead of formatting every message into a 256-byte line at the call
+ * site, capture() keeps the format string pointer and the raw argument
+ * words; render() produces the text later, only when a consumer (UART,
+ * web serial monitor, log export) actually needs it.
+ *
+ * A format qualifies when all of its arguments can be stored by value:
+ * - integers (%d %i %u %x %X %o %c with h/hh/l/z/t modifiers) and %p
+ * - floating point (%f %e %g %a), stored as float
+ * - strings (%s) that outlive the record, i.e. string literals in flash
+ * Anything else (%lld, %*d, %n, RAM strings, more than LOG_BINARY_MAX_ARGS
+ * arguments) makes capture() fail and the caller formats as text instead.
+ *
+ * @par Memory Usage
+ * 24 bytes per record on the ESP32 (vs. a 256-byte formatted line).
+ */
+
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+// Arguments kept per binary record
+#ifndef LOG_BINARY_MAX_ARGS
+#define LOG_BINARY_MAX_ARGS 3
+#endif
+
+// Record flags
+#define LOG_RECORD_TEXT 0x01    // args[0]/args[1] locate preformatted text (see LogHistory)
+
+/**
+ * @brief One log message in deferred form
+ */
+struct BinaryLogRecord {
+    uint32_t timestamp;
+    const char* format;                     // Kept by reference - must be static
+    uint8_t level;
+    uint8_t tagId;                          // Interned tag, see Logger::internTag()
+    uint8_t argc;
+    uint8_t flags;
+    uintptr_t args[LOG_BINARY_MAX_ARGS];    // Raw argument words (floats as IEEE bits)
+};
+
+class LogFormat {
+public:
+    // Returns true if the pointed-to string is static and may be kept by reference
+    typedef bool (*StaticCheck)(const void* ptr);
+
+    /**
+     * @brief Choose which pointers count as static (format strings and %s arguments)
+     *
+     * Without a check nothing is static and capture() always fails.
+     */
+    static void setStaticCheck(StaticCheck check);
+
+    /**
+     * @brief Store format and arguments in record (format, argc, args)
+     * @param args Consumed; pass a va_copy if the caller needs a fallback
+     * @return false if the format does not qualify; record is then undefined
+     */
+    static bool capture(BinaryLogRecord& record, const char* format, va_list args);
+
+    /**
+     * @brief Format a captured record's message
+     * @return Characters written, excluding the terminating NUL (truncates to size - 1)
+     */
+    static size_t render(char* out, size_t size, const BinaryLogRecord& record);
+
+private:
+    static StaticCheck _staticCheck;
+};
+
+#endif // LOG_FORMAT_H
@@ -0,0 +1,84 @@
+/**
+ * @file log_history.h
+ * @brief In-RAM history of recent log messages in binary form
+ *
+ * Keeps the last LOG_HISTORY_DEPTH messages as 24-byte BinaryLogRecords,
+ * so the same RAM holds roughly ten times more history than formatted
+ * lines. Messages that could not be captured in binary form (RAM strings,
+ * unsupported conversions) keep their preformatted text in a small byte
+ * ring; such a record is marked LOG_RECORD_TEXT and, once its text has been
+ * overwritten, reads back as a placeholder.
+ *
+ * Not thread-safe: the owner (Logger) serialises access.
+ *
+ * @par Memory Usage
+ * LOG_HISTORY_DEPTH * 24 + LOG_HISTORY_TEXT_SIZE bytes (about 8 KB by default)
+ */
+
+#ifndef LOG_HISTORY_H
+#define LOG_HISTORY_H
+
+#include "log_format.h"
+
+// Records kept (power of two)
+#ifndef LOG_HISTORY_DEPTH
+#define LOG_HISTORY_DEPTH 256
+#endif
+
+// Byte ring for messages without a binary form (power of two)
+#ifndef LOG_HISTORY_TEXT_SIZE
+#define LOG_HISTORY_TEXT_SIZE 2048
+#endif
+
+/**
+ * @class LogHistory
+ * @brief Fixed-size ring of binary log records, addressed by sequence number
+ */
+class LogHistory {
+public:
+    /// Longest preformatted message stored; longer ones are truncated
+    static const uint16_t MAX_TEXT_LENGTH = 255;
+
+    LogHistory();
+
+    /**
+     * @brief Append a captured record (see LogFormat::capture())
+     */
+    void append(const BinaryLogRecord& record);
+
+    /**
+     * @brief Append a message that only exists as text
+     */
+    void appendText(uint32_t timestamp, uint8_t level, uint8_t tagId,
+                    const char* text, size_t length);
+
+    /// Sequence number of the oldest record still held
+    uint32_t getStart() const;
+
+    /// Sequence number the next record will get
+    uint32_t getEnd() const { return _next; }
+
+    /**
+     * @brief Read one record and render its message
+     * @param seq Sequence number in [getStart(), getEnd())
+     * @param record Receives timestamp, level and tag id
+     * @param message Receives the message text (NUL-terminated)
+     * @return false if seq is no longer (or not yet) held
+     */
+    bool read(uint32_t seq, BinaryLogRecord& record, char* message, size_t size) const;
+
+    void clear();
+
+private:
+    static_assert((LOG_HISTORY_DEPTH & (LOG_HISTORY_DEPTH - 1)) == 0,
+                  "LOG_HISTORY_DEPTH must be a power of two");
+    static_assert((LOG_HISTORY_TEXT_SIZE & (LOG_HISTORY_TEXT_SIZE - 1)) == 0,
+                  "LOG_HISTORY_TEXT_SIZE must be a power of two");
+
+    BinaryLogRecord _records[LOG_HISTORY_DEPTH];
+    uint32_t _next;                         // Total records appended
+    char _text[LOG_HISTORY_TEXT_SIZE];
+    uint32_t _textPos;                      // Total text bytes written
+};
+
+#endif // LOG_HISTORY_H
@@ -0,0 +1,112 @@
+/**
+ * @file log_rate_limiter.h
+ * @brief Per-call-site token bucket that collapses repeated log messages
+ *
+ * A call site is identified by its (tag id, format string) pair. Each one
+ * that logs gets a slot in a small direct-mapped table, picked by hashing
+ * the pair, holding a token bucket: the first LOG_RATE_BURST messages pass,
+ * after that one more per LOG_RATE_REFILL_MS. Messages beyond that are only
+ * counted. The count comes back as a summary ("... repeated N times") either
+ * with the next message the bucket lets through, or from collect() once the
+ * site has been quiet for a refill interval.
+ *
+ * A storming call site therefore costs at most one message plus one summary
+ * per refill interval, whatever its rate. Two sites hashing to the same slot
+ * do not evict each other while the occupant has suppressed messages
+ * pending; the newcomer is simply not limited until the slot frees up.
+ *
+ * Not thread-safe: Logger calls it under a spinlock. All operations are
+ * O(1) except collect(), which scans the table.
+ *
+ * @par Memory Usage
+ * 20 bytes per slot (LOG_RATE_SLOTS slots).
+ */
+
+#ifndef LOG_RATE_LIMITER_H
+#define LOG_RATE_LIMITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Call sites tracked at once (power of two)
+#ifndef LOG_RATE_SLOTS
+#define LOG_RATE_SLOTS 32
+#endif
+
+// Messages a call site may log back to back
+#ifndef LOG_RATE_BURST
+#define LOG_RATE_BURST 5
+#endif
+
+// One more message allowed per interval once the burst is used up
+#ifndef LOG_RATE_REFILL_MS
+#define LOG_RATE_REFILL_MS 10000
+#endif
+
+/**
+ * @brief Messages suppressed at one call site since its last summary
+ */
+struct LogRepeatSummary {
+    const char* format;     // Format string of the call site
+    uint8_t tagId;
+    uint8_t level;          // Level of the most recent suppressed message
+    uint32_t count;         // Messages suppressed (0 = nothing to report)
+    uint32_t since;         // millis() of the first suppressed message
+};
+
+class LogRateLimiter {
+public:
+    LogRateLimiter();
+
+    /**
+     * @brief Change burst size and refill interval; resets all call sites
+     */
+    void configure(uint8_t burst, uint32_t refillMs);
+
+    /**
+     * @brief Decide whether a message may be logged
+     * @param summary Receives the suppressed-message count to report first
+     *        (count == 0 if none); only set when this returns true
+     * @return false if the message should be dropped
+     */
+    bool check(uint8_t tagId, const char* format, uint8_t level, uint32_t now,
+               LogRepeatSummary& summary);
+
+    /**
+     * @brief Take the summary of one call site that has gone quiet
+     *
+     * Call repeatedly until it returns false.
+     */
+    bool collect(uint32_t now, LogRepeatSummary& summary);
+
+    /// Forget all call sites and counters (pending counts are lost)
+    void reset();
+
+    /// Messages suppressed since the last reset
+    uint32_t getSuppressedCount() const { return _suppressedTotal; }
+
+    /// Slot a call site maps to (exposed for tests)
+    static uint32_t slotIndex(uint8_t tagId, const char* format);
+
+private:
+    struct Slot {
+        const char* format;         // nullptr = free
+        uint8_t tagId;
+        uint8_t level;
+        uint8_t tokens;
+        uint32_t refilledAt;
+        uint32_t suppressed;
+        uint32_t since;
+    };
+
+    void refill(Slot& slot, uint32_t now) const;
+    static void takeSummary(Slot& slot, LogRepeatSummary& summary);
+
+    Slot _slots[LOG_RATE_SLOTS];
+    uint8_t _burst;
+    uint32_t _refillMs;
+    uint32_t _suppressedTotal;
+    uint32_t _collectPos;           // Where the next collect() scan starts
+};
+
+#endif // LOG_RATE_LIMITER_H
@@ -0,0 +1,91 @@
+/**
+ * @file log_shipper.h
+ * @brief Batches event log entries into few, large MQTT publishes
+ *
+ * Entries (JSON objects, see EventLog) are appended to one preallocated
+ * buffer as a JSON array. The array is published when it is three quarters
+ * full, when its oldest entry has waited LOG_SHIP_INTERVAL_MS, or when an
+ * entry no longer fits.
+ *
+ * A batch that cannot be delivered stays in the buffer. It keeps collecting
+ * entries until full and is sent again as soon as the broker is reachable,
+ * at once after a reconnect and otherwise every LOG_SHIP_RETRY_MS. While
+ * it is full, add() refuses entries, so the caller keeps them (EventLog
+ * holds them in its ring) instead of losing them.
+ *
+ * Payload: [{"seq":1,"timestamp":...,"level":"INFO","tag":"MAIN","message":"..."},...]
+ *
+ * @par Memory Usage
+ * LOG_SHIP_BUFFER_SIZE bytes plus ~40 bytes of state.
+ */
+
+#ifndef LOG_SHIPPER_H
+#define LOG_SHIPPER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Batch buffer, including the array brackets
+#ifndef LOG_SHIP_BUFFER_SIZE
+#define LOG_SHIP_BUFFER_SIZE 2048
+#endif
+
+// Longest an entry waits before its batch is published
+#ifndef LOG_SHIP_INTERVAL_MS
+#define LOG_SHIP_INTERVAL_MS 10000
+#endif
+
+// Pause between attempts while the broker keeps refusing a batch
+#ifndef LOG_SHIP_RETRY_MS
+#define LOG_SHIP_RETRY_MS 2000
+#endif
+
+class LogShipper {
+public:
+    /// Sends one batch; returns false if it was not delivered
+    typedef bool (*Publisher)(void* context, const uint8_t* data, size_t length);
+
+    LogShipper();
+
+    void begin(Publisher publisher, void* context);
+
+    /**
+     * @brief Append one JSON object to the current batch
+     * @return false if the batch is full; offer the entry again later
+     */
+    bool add(const char* entry, size_t length, uint32_t now);
+
+    /**
+     * @brief Publish the batch if it is due and the broker is reachable
+     */
+    void loop(uint32_t now, bool connected);
+
+    /// Entries waiting in the buffer
+    uint16_t getPendingCount() const { return _entries; }
+
+    /// Batches and entries delivered, failed attempts, entries too large to ship
+    uint32_t getBatchCount() const { return _batches; }
+    uint32_t getEntryCount() const { return _shipped; }
+    uint32_t getFailureCount() const { return _failures; }
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    bool isDue(uint32_t now, bool reconnected) const;
+
+    char _buffer[LOG_SHIP_BUFFER_SIZE];
+    size_t _length;                 // Bytes used, without the closing bracket
+    uint16_t _entries;
+    uint32_t _firstAt;              // When the oldest pending entry was added
+    uint32_t _lastAttempt;
+    bool _full;                     // An entry was refused since the last publish
+    bool _failed;                   // The last attempt was not delivered
+    bool _wasConnected;
+    Publisher _publisher;
+    void* _context;
+    uint32_t _batches;
+    uint32_t _shipped;
+    uint32_t _failures;
+    uint32_t _dropped;
+};
+
+#endif // LOG_SHIPPER_H
@@ -2,6 +2,11 @@
 #define LOGGER_H
 
 #include <Arduino.h>
+#include <atomic>
+#include "mpsc_ring.h"
+#include "log_format.h"
+#include "log_history.h"
+#include "log_rate_limiter.h"
 
 // Forward declare access to real hardware serial (not redirected)
 extern HardwareSerial* _realSerialForLogger;
@@ -18,6 +23,54 @@ enum LogLevel {
     LOG_VERBOSE     // Verbose debug messages
 };
 
+// Most verbose level compiled into the firmware (1 = ERROR ... 5 = VERBOSE).
+// LOG_x macros above this level expand to nothing, arguments included.
+#ifndef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN 4
+#endif
+
+// Size of the single line buffer each message is formatted into
+#ifndef LOG_LINE_SIZE
+#define LOG_LINE_SIZE 256
+#endif
+
+// Depth of the asynchronous log queue (power of two)
+#ifndef LOG_QUEUE_DEPTH
+#define LOG_QUEUE_DEPTH 32
+#endif
+
+// Capture messages in binary form and format them on the drain task (0 = always format at the call site)
+#ifndef LOG_BINARY_DEFAULT
+#define LOG_BINARY_DEFAULT 1
+#endif
+
+// Distinct tags that get their own id; further tags share id 0 ("*")
+#ifndef LOG_MAX_TAGS
+#define LOG_MAX_TAGS 48
+#endif
+
+// Collapse repeats per call site (see LogRateLimiter; 0 = log everything)
+#ifndef LOG_RATE_LIMIT_DEFAULT
+#define LOG_RATE_LIMIT_DEFAULT 1
+#endif
+
+// Longest tag kept in the tag table, including the NUL
+#define LOG_TAG_SIZE 16
+
+/**
+ * @brief One log message waiting for the drain task
+ *
+ * In binary mode the call site only fills packed; the drain task renders
+ * line just before writing it out.
+ */
+struct LogRecord {
+    BinaryLogRecord packed;     // Timestamp, level and tag id; format and args when deferred
+    bool deferred;              // Message still in binary form, line not built yet
+    uint16_t messageOffset;     // Start of the message text inside line
+    uint16_t length;            // Line length without CR/LF
+    char line[LOG_LINE_SIZE];   // "<timestamp> | <LEVEL> | <tag> | <message>\r\n"
+};
+
 class Logger {
 public:
     static Logger& getInstance() {
@@ -25,116 +78,165 @@ public:
         return instance;
     }
 
-    // Set global log level
-    void setLogLevel(LogLevel level) {
-        _logLevel = level;
-    }
+    /**
+     * Set the global log level. Tags without their own level (see
+     * setTagLevel()) follow it.
+     */
+    void setLogLevel(LogLevel level);
 
     // Get current log level
     LogLevel getLogLevel() const {
         return _logLevel;
     }
 
-    // Log a message with specified level
-    void log(LogLevel level, const char* tag, const char* format, ...) {
-        if (level > _logLevel) return; // Skip if level is higher than current log level
+    /**
+     * Give one tag its own level, e.g. DEBUG for "KNX" while everything
+     * else stays at INFO. The tag need not have logged anything yet.
+     */
+    void setTagLevel(const char* tag, LogLevel level);
 
-        // Get current timestamp
-        unsigned long timestamp = millis();
+    // Drop all per-tag levels; every tag follows the global level again
+    void clearTagLevels();
 
-        // Use direct hardware serial access to bypass web monitor capture
-        if (!_realSerialForLogger) return;
+    // Effective level for a tag id returned by internTag()
+    LogLevel getTagLevel(uint8_t tagId) const {
+        return (LogLevel)_tagLevels[tagId < LOG_MAX_TAGS ? tagId : 0];
+    }
 
-        // Get log level string
-        const char* levelStr;
-        switch (level) {
-            case LOG_ERROR:   levelStr = "ERROR"; break;
-            case LOG_WARNING: levelStr = "WARN "; break;
-            case LOG_INFO:    levelStr = "INFO "; break;
-            case LOG_DEBUG:   levelStr = "DEBUG"; break;
-            case LOG_VERBOSE: levelStr = "VERB "; break;
-            default:          levelStr = "?????"; break;
-        }
+    // Runtime filter: a single table lookup, checked by the LOG_x macros before any formatting
+    bool isEnabled(LogLevel level, uint8_t tagId) const {
+        return level <= _tagLevels[tagId];
+    }
+
+    // Log a message with specified level
+    void log(LogLevel level, const char* tag, const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        vlog(level, tag, format, args);
+        va_end(args);
+    }
 
-        // Format the message content
+    // Log with a tag id already resolved by internTag(); the caller has checked isEnabled()
+    void logTagged(LogLevel level, uint8_t tagId, const char* format, ...) {
         va_list args;
         va_start(args, format);
-        char msgBuffer[256];
-        vsnprintf(msgBuffer, sizeof(msgBuffer), format, args);
+        vlogTagged(level, tagId, format, args);
         va_end(args);
+    }
 
-        // Build complete log line for web monitor
-        char fullLine[512];
-        snprintf(fullLine, sizeof(fullLine), "%lu | %s | %s | %s",
-                 timestamp, levelStr, tag, msgBuffer);
-
-        // Write to hardware serial (bypasses web monitor)
-        _realSerialForLogger->print(timestamp);
-        _realSerialForLogger->print(" | ");
-        _realSerialForLogger->print(levelStr);
-        _realSerialForLogger->print(" | ");
-        _realSerialForLogger->print(tag);
-        _realSerialForLogger->print(" | ");
-        _realSerialForLogger->println(msgBuffer);
-
-        // ALSO send to web monitor
-        captureLogToWebMonitor(fullLine);
-
-        // If we have a log callback registered, call it
-        if (_logCallback) {
-            _logCallback(level, tag, msgBuffer, timestamp);
+    // Look up the tag and apply its level, then log as vlogTagged()
+    void vlog(LogLevel level, const char* tag, const char* format, va_list args) {
+        uint8_t tagId = internTag(tag);
+        if (isEnabled(level, tagId)) {
+            vlogTagged(level, tagId, format, args);
         }
     }
 
+    /**
+     * Apply the call site's rate limit, then format the message exactly
+     * once into a single line buffer. Once
+     * startAsync() has run the line is written straight into a queue slot
+     * and the drain task fans it out; before that it is dispatched inline.
+     */
+    void vlogTagged(LogLevel level, uint8_t tagId, const char* format, va_list args);
+
+    /**
+     * Start the low-priority drain task. Safe to call once Serial is up;
+     * from then on LOG_x calls cost one formatting pass and an O(1) enqueue.
+     */
+    bool startAsync();
+
+    // Wait (up to timeoutMs) for the queue to empty, e.g. before a restart
+    void flush(uint32_t timeoutMs);
+
+    // Messages lost because the queue was full
+    uint32_t getDroppedCount() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    // Messages currently waiting for the drain task
+    uint32_t getQueuedCount() const {
+        return _queue.size();
+    }
+
+    // Defer formatting of eligible messages to the drain task (see LogFormat)
+    void setBinaryMode(bool enabled) {
+        _binaryMode = enabled;
+    }
+
+    bool isBinaryMode() const {
+        return _binaryMode;
+    }
+
+    /**
+     * Limit each call site (tag + static format string) to a burst of
+     * LOG_RATE_BURST messages and one per LOG_RATE_REFILL_MS after that;
+     * the rest are counted and reported as "(repeated N times)".
+     */
+    void setRateLimit(bool enabled);
+
+    bool isRateLimited() const {
+        return _rateLimit;
+    }
+
+    // Messages collapsed by the rate limit
+    uint32_t getSuppressedCount();
+
+    /**
+     * Map a tag to a small integer id, adding it on first use. Lock-free
+     * for tags already known; returns 0 ("*") once the table is full.
+     */
+    uint8_t internTag(const char* tag);
+
+    // Tag name for an id returned by internTag()
+    const char* getTagName(uint8_t id) const;
+
+    // Sequence range [start, end) currently held in the log history
+    uint32_t getHistoryStart();
+    uint32_t getHistoryEnd();
+
+    /**
+     * Render one history entry as "<timestamp> | <LEVEL> | <tag> | <message>"
+     * (no line ending). Formatting happens here, not when the message was logged.
+     * @param size Must be at least LOG_LINE_SIZE
+     * @return Line length, or 0 if seq is no longer held
+     */
+    size_t formatHistoryEntry(uint32_t seq, char* line, size_t size);
+
     // Simplified log methods for common use
     void error(const char* tag, const char* format, ...) {
-        if (LOG_ERROR > _logLevel) return;
         va_list args;
         va_start(args, format);
-        char buffer[512];
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        vlog(LOG_ERROR, tag, format, args);
         va_end(args);
-        log(LOG_ERROR, tag, buffer);
     }
 
     void warning(const char* tag, const char* format, ...) {
-        if (LOG_WARNING > _logLevel) return;
         va_list args;
         va_start(args, format);
-        char buffer[512];
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        vlog(LOG_WARNING, tag, format, args);
         va_end(args);
-        log(LOG_WARNING, tag, buffer);
     }
 
     void info(const char* tag, const char* format, ...) {
-        if (LOG_INFO > _logLevel) return;
         va_list args;
         va_start(args, format);
-        char buffer[512];
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        vlog(LOG_INFO, tag, format, args);
         va_end(args);
-        log(LOG_INFO, tag, buffer);
     }
 
     void debug(const char* tag, const char* format, ...) {
-        if (LOG_DEBUG > _logLevel) return;
         va_list args;
         va_start(args, format);
-        char buffer[512];
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        vlog(LOG_DEBUG, tag, format, args);
         va_end(args);
-        log(LOG_DEBUG, tag, buffer);
     }
 
     void verbose(const char* tag, const char* format, ...) {
-        if (LOG_VERBOSE > _logLevel) return;
         va_list args;
         va_start(args, format);
-        char buffer[512];
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        vlog(LOG_VERBOSE, tag, format, args);
         va_end(args);
-        log(LOG_VERBOSE, tag, buffer);
     }
 
     // Register a callback for logs (useful for storing logs or sending to a server)
@@ -144,7 +246,7 @@ public:
     }
 
     // Helper to get level string
-    const char* getLevelString(LogLevel level) {
+    const char* getLevelString(LogLevel level) const {
         switch (level) {
             case LOG_ERROR: return "ERROR";
             case LOG_WARNING: return "WARN ";
@@ -157,24 +259,94 @@ public:
 
 private:
     // Private constructor for singleton
-    Logger() : _logLevel(LOG_INFO), _logCallback(nullptr) {}
+    Logger();
     
     // Prevent copy/move
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     Logger(Logger&&) = delete;
     Logger& operator=(Logger&&) = delete;
-    
+
+    void enqueue(LogLevel level, uint8_t tagId, const char* format, va_list args);
+    void enqueueFormat(LogLevel level, uint8_t tagId, const char* format, ...);
+    void reportRepeats(const LogRepeatSummary& summary, uint32_t now);
+    void collectRepeats();
+    void dispatch(LogRecord& record);
+    void drain();
+    static void drainTask(void* param);
+
     LogLevel _logLevel;
     LogCallback _logCallback;
+    volatile bool _binaryMode;
+
+    MpscRing<LogRecord, LOG_QUEUE_DEPTH> _queue;
+    std::atomic<uint32_t> _dropped;
+    uint32_t _droppedReported;      // Drain task only
+    TaskHandle_t volatile _drainTask;
+
+    // Tag table: entries below _tagCount are immutable once published
+    char _tagNames[LOG_MAX_TAGS][LOG_TAG_SIZE];
+    const char* _tagPointers[LOG_MAX_TAGS];     // Static tag pointer for the fast path, or nullptr
+    std::atomic<uint8_t> _tagCount;
+    portMUX_TYPE _tagLock;                      // Guards adding tags and changing levels
+
+    // Effective level per tag id (global level unless overridden), read without locking
+    volatile uint8_t _tagLevels[LOG_MAX_TAGS];
+    uint64_t _tagOverrides;                     // Bit n set: tag n has its own level
+    static_assert(LOG_MAX_TAGS <= 64, "LOG_MAX_TAGS must fit the override mask");
+
+    // Per-call-site rate limit; only static formats are tracked
+    LogRateLimiter _rateLimiter;
+    portMUX_TYPE _rateLock;
+    volatile bool _rateLimit;
+    uint32_t _lastRepeatCollect;                // Drain task only
+
+    LogHistory _history;                        // Written by the drain task
+    SemaphoreHandle_t _historyMutex;
 };
 
-// Convenience macros for logging
-#define LOG_E(tag, ...) Logger::getInstance().error(tag, __VA_ARGS__)
-#define LOG_W(tag, ...) Logger::getInstance().warning(tag, __VA_ARGS__)
-#define LOG_I(tag, ...) Logger::getInstance().info(tag, __VA_ARGS__)
-#define LOG_D(tag, ...) Logger::getInstance().debug(tag, __VA_ARGS__)
-#define LOG_V(tag, ...) Logger::getInstance().verbose(tag, __VA_ARGS__)
+// Convenience macros for logging. Each call site resolves its tag to an id
+// once (the tag must be the same every time a given call site runs, as with
+// a TAG constant or a literal); after that the level check is one array
+// lookup, done before the arguments are evaluated. Levels above
+// LOG_LEVEL_MIN vanish entirely.
+#define LOG_AT(level, tag, ...) \
+    do { \
+        static const uint8_t _logTagId = Logger::getInstance().internTag(tag); \
+        if (Logger::getInstance().isEnabled(level, _logTagId)) { \
+            Logger::getInstance().logTagged(level, _logTagId, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if LOG_LEVEL_MIN >= 1
+#define LOG_E(tag, ...) LOG_AT(LOG_ERROR, tag, __VA_ARGS__)
+#else
+#define LOG_E(tag, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL_MIN >= 2
+#define LOG_W(tag, ...) LOG_AT(LOG_WARNING, tag, __VA_ARGS__)
+#else
+#define LOG_W(tag, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL_MIN >= 3
+#define LOG_I(tag, ...) LOG_AT(LOG_INFO, tag, __VA_ARGS__)
+#else
+#define LOG_I(tag, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL_MIN >= 4
+#define LOG_D(tag, ...) LOG_AT(LOG_DEBUG, tag, __VA_ARGS__)
+#else
+#define LOG_D(tag, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL_MIN >= 5
+#define LOG_V(tag, ...) LOG_AT(LOG_VERBOSE, tag, __VA_ARGS__)
+#else
+#define LOG_V(tag, ...) do {} while (0)
+#endif
 
 #define TAG_WIFI "WIFI"
 #define TAG_WATCHDOG "WDOG"
@@ -0,0 +1,113 @@
+/**
+ * @file lzss.h
+ * @brief Small-footprint streaming LZSS codec (heatshrink-style)
+ *
+ * Each token is a 1-bit flag followed by either a literal byte or a
+ * back-reference of LZSS_WINDOW_BITS distance bits and LZSS_LENGTH_BITS
+ * length bits, packed MSB first. Both sides work incrementally, so neither
+ * the input nor the output has to be held in RAM as a whole.
+ *
+ * @par Memory Usage
+ * Encoder: 2 * LZSS_WINDOW_SIZE + ~48 bytes. Decoder: LZSS_WINDOW_SIZE + ~16 bytes.
+ *
+ * The stream carries no length; the caller stores the decompressed size and
+ * stops decoding once it has been produced (the last byte is zero-padded).
+ */
+
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef LZSS_WINDOW_BITS
+#define LZSS_WINDOW_BITS 9
+#endif
+
+#ifndef LZSS_LENGTH_BITS
+#define LZSS_LENGTH_BITS 4
+#endif
+
+#define LZSS_WINDOW_SIZE (1 << LZSS_WINDOW_BITS)
+#define LZSS_MIN_MATCH 2
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + (1 << LZSS_LENGTH_BITS) - 1)
+
+/**
+ * @class LzssEncoder
+ * @brief Streaming compressor writing through a callback
+ */
+class LzssEncoder {
+public:
+    /// Receives compressed output; returns false to abort
+    typedef bool (*Writer)(void* context, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Start a new stream (forgets all history)
+     */
+    void begin(Writer writer, void* context);
+
+    /**
+     * @brief Compress more input
+     * @return false if the writer failed
+     */
+    bool write(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Encode the remaining lookahead and flush the final partial byte
+     * @return false if the writer failed
+     */
+    bool finish();
+
+    /// Compressed bytes produced so far (complete after finish())
+    uint32_t getOutputSize() const { return _outputSize; }
+
+private:
+    void encodeToken();
+    void putBits(uint32_t value, uint8_t count);
+    void flushOutput();
+
+    uint8_t _buffer[2 * LZSS_WINDOW_SIZE];  // History followed by lookahead (circular)
+    uint32_t _head;                         // Input bytes encoded
+    uint32_t _tail;                         // Input bytes received
+    uint32_t _bits;                         // Pending output bits (MSB first)
+    uint8_t _bitCount;
+    uint8_t _out[32];
+    uint8_t _outLength;
+    uint32_t _outputSize;
+    Writer _writer;
+    void* _context;
+    bool _ok;
+};
+
+/**
+ * @class LzssDecoder
+ * @brief Streaming decompressor
+ */
+class LzssDecoder {
+public:
+    /**
+     * @brief Start a new stream
+     */
+    void begin();
+
+    /**
+     * @brief Decompress until out is full or the input runs out
+     * @param consumed Receives the number of input bytes used
+     * @return Bytes written to out
+     */
+    size_t decode(const uint8_t* in, size_t length, size_t& consumed, uint8_t* out, size_t size);
+
+    /// A back-reference pointed before the start of the stream
+    bool isCorrupt() const { return _corrupt; }
+
+private:
+    uint8_t _window[LZSS_WINDOW_SIZE];
+    uint32_t _written;                      // Output bytes produced
+    uint32_t _bits;
+    uint8_t _bitCount;
+    uint16_t _copyDistance;                 // Pending back-reference
+    uint8_t _copyRemaining;
+    bool _corrupt;
+};
+
+#endif // LZSS_H
@@ -0,0 +1,140 @@
+/**
+ * @file mpsc_ring.h
+ * @brief Bounded multi-producer single-consumer ring buffer
+ *
+ * Lock-free for producers: each slot carries a sequence number, and a
+ * producer reserves a slot with a single compare-and-swap on the enqueue
+ * position (Vyukov's bounded queue). Producers may run on either core and
+ * in any task; the single consumer needs no atomic read-modify-write.
+ *
+ * Slots are filled in place: claim() reserves a slot, the producer writes
+ * into at(), and publish() hands it to the consumer. Large records therefore
+ * never need a stack copy. A producer that is preempted between claim() and
+ * publish() delays the consumer (FIFO order is preserved) but never blocks
+ * other producers.
+ *
+ * @par Memory Usage
+ * N * (sizeof(T) + 4) bytes, fixed at compile time. N must be a power of two.
+ */
+
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint32_t N>
+class MpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing size must be a power of two");
+
+public:
+    MpscRing() : _enqueuePos(0), _dequeuePos(0) {
+        for (uint32_t i = 0; i < N; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Reserve a slot (any producer)
+     * @param pos Receives the reservation, passed to at() and publish()
+     * @return false if the ring is full
+     */
+    bool claim(uint32_t& pos) {
+        pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = _cells[pos & (N - 1)];
+            uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+            int32_t diff = (int32_t)(seq - pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return true;
+                }
+                // pos was reloaded by the failed CAS
+            } else if (diff < 0) {
+                return false;  // Slot still holds an unconsumed item: full
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Slot storage for a claimed reservation
+     */
+    T& at(uint32_t pos) {
+        return _cells[pos & (N - 1)].data;
+    }
+
+    /**
+     * @brief Make a claimed slot visible to the consumer
+     */
+    void publish(uint32_t pos) {
+        _cells[pos & (N - 1)].sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copying push (any producer)
+     * @return false if the ring is full
+     */
+    bool tryPush(const T& item) {
+        uint32_t pos;
+        if (!claim(pos)) {
+            return false;
+        }
+        at(pos) = item;
+        publish(pos);
+        return true;
+    }
+
+    /**
+     * @brief Oldest published item, or nullptr if none (consumer only)
+     */
+    T* front() {
+        Cell& cell = _cells[_dequeuePos & (N - 1)];
+        uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+        return seq == _dequeuePos + 1 ? &cell.data : nullptr;
+    }
+
+    /**
+     * @brief Release the item returned by front() (consumer only)
+     */
+    void pop() {
+        _cells[_dequeuePos & (N - 1)].sequence.store(_dequeuePos + N, std::memory_order_release);
+        _dequeuePos++;
+    }
+
+    /**
+     * @brief Copying pop (consumer only)
+     * @return false if the ring is empty
+     */
+    bool tryPop(T& item) {
+        T* head = front();
+        if (head == nullptr) {
+            return false;
+        }
+        item = *head;
+        pop();
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of claimed slots (may include unpublished ones)
+     */
+    uint32_t size() const {
+        return _enqueuePos.load(std::memory_order_relaxed) - _dequeuePos;
+    }
+
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        T data;
+    };
+
+    Cell _cells[N];
+    std::atomic<uint32_t> _enqueuePos;
+    uint32_t _dequeuePos;  // Only touched by the consumer
+};
+
+#endif // MPSC_RING_H
@@ -0,0 +1,92 @@
+/**
+ * @file mqtt_connector.h
+ * @brief MQTT connection state machine with exponential backoff
+ *
+ * Decides when the MQTT task should (re)connect; it never touches the
+ * network itself. poll() is called on every task pass and returns true when
+ * an attempt is due, the caller connects and reports the outcome through
+ * connectFinished().
+ *
+ *   WAIT_NETWORK --WiFi up--> BACKOFF --delay over--> CONNECTING
+ *   CONNECTING --ok--> ONLINE --client lost--> BACKOFF
+ *   CONNECTING --failed--> BACKOFF (delay doubles)
+ *   any state --WiFi down--> WAIT_NETWORK
+ *
+ * The first attempt after WiFi comes up is immediate. After a failure, or
+ * a dropped connection, the delay is MQTT_BACKOFF_INITIAL_MS doubled per
+ * consecutive failure up to MQTT_BACKOFF_MAX_MS, then randomized to between
+ * half and all of that ("equal jitter"), so a group of thermostats does not
+ * hit a restarted broker in lockstep. A successful connect resets it.
+ *
+ * @par Memory Usage
+ * ~32 bytes.
+ */
+
+#ifndef MQTT_CONNECTOR_H
+#define MQTT_CONNECTOR_H
+
+#include <stdint.h>
+
+// Delay before the first retry
+#ifndef MQTT_BACKOFF_INITIAL_MS
+#define MQTT_BACKOFF_INITIAL_MS 1000
+#endif
+
+// Longest delay between attempts
+#ifndef MQTT_BACKOFF_MAX_MS
+#define MQTT_BACKOFF_MAX_MS 60000
+#endif
+
+enum MqttLinkState : uint8_t {
+    MQTT_LINK_WAIT_NETWORK,     // WiFi down
+    MQTT_LINK_BACKOFF,          // Waiting for the next attempt
+    MQTT_LINK_CONNECTING,       // Attempt handed to the caller
+    MQTT_LINK_ONLINE
+};
+
+class MqttConnector {
+public:
+    MqttConnector(uint32_t initialDelayMs = MQTT_BACKOFF_INITIAL_MS,
+                  uint32_t maxDelayMs = MQTT_BACKOFF_MAX_MS);
+
+    /// Seed the jitter generator (esp_random() on the device)
+    void seed(uint32_t value);
+
+    /**
+     * @brief Advance the state machine
+     * @param networkUp WiFi is connected
+     * @param clientConnected The MQTT client still reports a connection
+     * @return true if the caller should start a connection attempt now
+     */
+    bool poll(uint32_t now, bool networkUp, bool clientConnected);
+
+    /// Outcome of the attempt poll() asked for
+    void connectFinished(bool success, uint32_t now);
+
+    MqttLinkState getState() const { return _state; }
+    bool isOnline() const { return _state == MQTT_LINK_ONLINE; }
+
+    /// Wait before the next attempt (valid in BACKOFF)
+    uint32_t getRetryDelay() const { return _retryDelay; }
+
+    /// Consecutive failed attempts (including a dropped connection)
+    uint8_t getFailureCount() const { return _failures; }
+    uint32_t getAttemptCount() const { return _attempts; }
+    uint32_t getConnectCount() const { return _connects; }
+
+private:
+    void scheduleRetry(uint32_t now);
+    uint32_t nextRandom();
+
+    uint32_t _initialDelay;
+    uint32_t _maxDelay;
+    MqttLinkState _state;
+    uint32_t _backoffStart;
+    uint32_t _retryDelay;
+    uint32_t _random;
+    uint8_t _failures;
+    uint32_t _attempts;
+    uint32_t _connects;
+};
+
+#endif // MQTT_CONNECTOR_H
@@ -1,12 +1,52 @@
+/**
+ * @file mqtt_manager.h
+ * @brief MQTT client, run on its own FreeRTOS task
+ *
+ * The PubSubClient belongs to the MQTT task: connecting (paced by
+ * MqttConnector's backoff), subscribing, reading, publishing and the
+ * offline outbox all happen there, so an unreachable broker never blocks
+ * sensor reads or PID ticks in loop().
+ *
+ * The public publish calls may be made from any task. They only post a
+ * small job to a lock-free queue and wake the MQTT task. Commands received
+ * from the broker travel the other way through a second queue and run on
+ * the main loop in loop(), where it is safe to touch the controller, KNX and
+ * configuration. If the task cannot be created, loop() drives the client
+ * itself as before.
+ *
+ * @par Memory Usage
+ * MQTT_JOB_QUEUE_DEPTH * ~24 bytes of jobs, MQTT_COMMAND_QUEUE_DEPTH * ~72
+ * bytes of commands, LOG_SHIP_BUFFER_SIZE for the log batch being handed
+ * over, TELEGRAPH_BUFFER_SIZE for the aggregate, and the task stack (8 KB).
+ */
+
 #ifndef MQTT_MANAGER_H
 #define MQTT_MANAGER_H
 
 #include <Arduino.h>
 #include <PubSubClient.h>
+#include <atomic>
 #include <memory>
 #include "home_assistant.h"
+#include "log_shipper.h"
+#include "mpsc_ring.h"
+#include "mqtt_connector.h"
+#include "mqtt_outbox.h"
+#include "outbox_spill_file.h"
+#include "mqtt_topic_router.h"
+#include "telegraph_aggregate.h"
 #include "config.h"
 
+// Publish requests waiting for the MQTT task (power of two)
+#ifndef MQTT_JOB_QUEUE_DEPTH
+#define MQTT_JOB_QUEUE_DEPTH 16
+#endif
+
+// Received commands waiting for the main loop (power of two)
+#ifndef MQTT_COMMAND_QUEUE_DEPTH
+#define MQTT_COMMAND_QUEUE_DEPTH 8
+#endif
+
 // Forward declaration
 class KNXManager;
 
@@ -14,16 +54,16 @@ class MQTTManager {
 public:
     MQTTManager(PubSubClient& mqttClient);
     ~MQTTManager();
-    
-    // Initialize MQTT communication
+
+    // Initialize MQTT communication and start the MQTT task
     void begin();
-    
-    // Process MQTT messages in the main loop
+
+    // Run received commands (main loop); drives the client too if there is no task
     void loop();
-    
+
     // Set KNX manager for cross-communication
     void setKNXManager(KNXManager* knxManager);
-    
+
     // Publish sensor data to MQTT
     void publishSensorData(float temperature, float humidity, float pressure);
 
@@ -33,46 +73,165 @@ public:
     // Publish diagnostic data to MQTT (for Home Assistant)
     void updateDiagnostics(int wifiRSSI, unsigned long uptime);
 
-    // Publish JSON aggregate to 'telegraph' topic (if enabled)
-    void publishJsonAggregate(float temperature, float humidity, float pressure, 
-                              float kp, float ki, float kd, int wifiRSSI, unsigned long uptime);
+    // Reload aggregate enable, format and field groups from ConfigManager
+    void applyAggregateConfig();
+
+    // Reload the mode and preset the aggregate reports from ConfigManager
+    void applyClimateConfig();
+
+    // Record a committed mode or preset for the aggregate (see commitCoalescedCommands())
+    void setClimateMode(bool heat);
+    void setClimatePreset(const char* preset);
+
+    // Apply the Home Assistant state document setting from ConfigManager now
+    void applyStateDocumentConfig();
+
+    // Publish window-open detector state (retained ON/OFF)
+    void publishWindowOpenState(bool open);
 
     // Set valve position (from KNX)
     void setValvePosition(int position);
-    
+
     // Get current valve position
     int getValvePosition() const;
-    
+
+    /**
+     * @brief Hand one log batch to the MQTT task (LogShipper publisher)
+     * @return false while the previous batch has not been sent yet
+     */
+    bool queueLogBatch(const uint8_t* data, size_t length);
+
     // MQTT callback function
     static void mqttCallback(char* topic, byte* payload, unsigned int length);
-    
-    // Check if MQTT is connected
+
+    // Connected and subscribed, as last seen by the MQTT task
     bool isConnected();
-    
-    // Reconnect to MQTT if disconnected
-    void reconnect();
 
     // HA FIX #5: Sync climate state to HA (mode, preset, setpoint)
     // Call this periodically to keep HA in sync with local state
     void syncClimateState();
 
+    // Home Assistant state messages sent and skipped as unchanged
+    uint32_t getStatePublishedCount() const;
+    uint32_t getStateSkippedCount() const;
+
+    // Home Assistant discovery configs sent and skipped as already on the broker
+    uint32_t getDiscoveryPublishedCount() const;
+    uint32_t getDiscoverySkippedCount() const;
+
+    // Readings queued while the broker was unreachable (replayed to esp32_thermostat/backfill)
+    const MqttOutbox& getOutbox() const { return _outbox; }
+
+    // Connection state and backoff
+    const MqttConnector& getConnector() const { return _connector; }
+
+    // Publish requests and received commands lost to a full queue
+    uint32_t getDroppedJobCount() const { return _droppedJobs.load(std::memory_order_relaxed); }
+    uint32_t getDroppedCommandCount() const { return _droppedCommands; }
+
 private:
-    static constexpr unsigned long MQTT_RECONNECT_INTERVAL_MS = 5000;
+    static constexpr unsigned long BACKFILL_INTERVAL_MS = 500;   // Between backfill batches
+    static constexpr size_t BACKFILL_BATCH = 10;                 // Records per backfill message
+
+    // Work posted to the MQTT task
+    enum JobType : uint8_t {
+        JOB_SENSOR_DATA,        // values: temperature, humidity, pressure
+        JOB_PID_PARAMETERS,     // values: kp, ki, kd
+        JOB_DIAGNOSTICS,        // integers: rssi, uptime
+        JOB_WINDOW_OPEN,        // integers: open
+        JOB_VALVE_POSITION,     // integers: position
+        JOB_CLIMATE_SYNC,
+        JOB_STATE_DOCUMENT,     // integers: enabled
+        JOB_RESTART
+    };
+
+    struct Job {
+        JobType type;
+        float values[3];
+        int32_t integers[2];
+    };
+
+    // A received command, waiting for the main loop
+    struct Command {
+        uint8_t route;          // Index into commandRoutes()
+        uint8_t length;
+        char payload[MQTT_COMMAND_PAYLOAD_MAX + 1];
+    };
 
     PubSubClient& _mqttClient;
     KNXManager* _knxManager;
     std::unique_ptr<HomeAssistant> _homeAssistant;
-    int _valvePosition;
-    unsigned long _lastReconnectAttempt;
+    std::atomic<int> _valvePosition;
     String _mqttServer;
     uint16_t _mqttPort;
-    
+    MqttOutbox _outbox;
+    OutboxSpillFile _outboxSpill;
+    unsigned long _lastBackfill;
+
+    // MQTT task side
+    TaskHandle_t volatile _task;
+    MqttConnector _connector;
+    std::atomic<bool> _online;
+    MpscRing<Job, MQTT_JOB_QUEUE_DEPTH> _jobs;
+    std::atomic<uint32_t> _droppedJobs;
+
+    // 'telegraph' aggregate settings (applyAggregateConfig) and its encode buffer
+    std::atomic<bool> _aggregateEnabled;
+    std::atomic<uint8_t> _aggregateFormat;
+    std::atomic<uint8_t> _aggregateFields;
+    uint8_t _aggregateBuffer[TELEGRAPH_BUFFER_SIZE];
+
+    // Mode and preset for the aggregate, kept in RAM so the MQTT task reads no NVS per cycle
+    std::atomic<bool> _climateHeat;
+    char _climatePreset[sizeof(TelegraphSample::preset)];
+    portMUX_TYPE _climateLock;          // Guards _climatePreset
+
+    // Log batch handoff: the main loop fills it while _logBatchLength is 0
+    char _logBatch[LOG_SHIP_BUFFER_SIZE];
+    std::atomic<size_t> _logBatchLength;
+
+    // Main loop side
+    MpscRing<Command, MQTT_COMMAND_QUEUE_DEPTH> _commands;
+    uint32_t _droppedCommands;      // Written by the MQTT task only
+
     // Static pointer to instance for callback
     static MQTTManager* _instance;
-    
-    // Process incoming MQTT message
-    void processMessage(char* topic, byte* payload, unsigned int length);
+
+    // Command handlers get a NUL-terminated copy of at most MQTT_COMMAND_PAYLOAD_MAX bytes
+    typedef void (MQTTManager::*CommandHandler)(const char* payload, size_t length);
+    typedef MqttRoute<CommandHandler> CommandRoute;
+
+    // Subscribed command topics, sorted for findMqttRoute()
+    static const CommandRoute* commandRoutes(size_t& count);
+
+    // MQTT task
+    static void clientTask(void* param);
+    bool startTask();
+    static Job makeJob(JobType type);
+    void post(const Job& job);
+    void serviceClient();
+    bool reconnect();
+    void runJob(const Job& job);
+    void sendSensorData(float temperature, float humidity, float pressure);
+    void sendAggregate(float temperature, float humidity, float pressure,
+                       float kp, float ki, float kd, int wifiRSSI, unsigned long uptime);
+    void sendValvePosition(int position);
+    void sendLogBatch();
     void configureServerFromSettings();
+    void queueOfflineReading(float temperature, float humidity, float pressure);
+    void publishBackfill();
+
+    // Queue an incoming message for the main loop (runs on the MQTT task)
+    void processMessage(char* topic, byte* payload, unsigned int length);
+
+    // Main loop
+    void runCommands();
+    void handleValveCommand(const char* payload, size_t length);
+    void handleSetpointCommand(const char* payload, size_t length);
+    void handlePresetCommand(const char* payload, size_t length);
+    void handleModeCommand(const char* payload, size_t length);
+    void handleLogLevelCommand(const char* payload, size_t length);
+    void handleRestartCommand(const char* payload, size_t length);
 };
 
 #endif // MQTT_MANAGER_H
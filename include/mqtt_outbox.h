@@ -0,0 +1,142 @@
+/**
+ * @file mqtt_outbox.h
+ * @brief Store-and-forward queue for telemetry recorded while MQTT is down
+ *
+ * Readings taken while the broker is unreachable are kept as fixed-size,
+ * timestamped records in a RAM ring. When the ring fills up, its oldest
+ * OUTBOX_SPILL_BATCH records move to an optional spill store (a ring file on
+ * LittleFS on the device); without one, or when the spill store is full too,
+ * the oldest records are evicted and counted.
+ *
+ * Everything in the spill store is older than everything in RAM, so
+ * peek()/pop() hand records out oldest first by draining the spill store
+ * before the RAM ring. MQTTManager publishes them in small JSON batches
+ * (formatBatch()) at a limited rate after reconnecting.
+ *
+ * Not thread-safe. Owned by the MQTT task, which queues readings and
+ * publishes the backfill; other tasks only read the counters for diagnostics.
+ *
+ * @par Memory Usage
+ * 20 bytes per RAM record (OUTBOX_RAM_RECORDS) plus ~40 bytes of state.
+ */
+
+#ifndef MQTT_OUTBOX_H
+#define MQTT_OUTBOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Records kept in RAM
+#ifndef OUTBOX_RAM_RECORDS
+#define OUTBOX_RAM_RECORDS 64
+#endif
+
+// Records moved to the spill store at once when RAM is full
+#ifndef OUTBOX_SPILL_BATCH
+#define OUTBOX_SPILL_BATCH 16
+#endif
+
+// Consecutive failed spill reads after which the spilled records are dropped
+#ifndef OUTBOX_SPILL_READ_RETRIES
+#define OUTBOX_SPILL_READ_RETRIES 3
+#endif
+
+/**
+ * @brief One telemetry reading
+ */
+struct TelemetryRecord {
+    uint32_t timestamp;         // Unix time, or uptime seconds before NTP sync
+    float temperature;          // °C
+    float humidity;             // %, NaN if the sensor has none
+    float pressure;             // hPa, NaN if the sensor has none
+    uint8_t valvePosition;      // %
+};
+
+/**
+ * @brief Slot-addressed backing store for records that do not fit in RAM
+ */
+class OutboxSpill {
+public:
+    virtual ~OutboxSpill() {}
+
+    /// Number of record slots
+    virtual uint32_t capacity() const = 0;
+
+    /// Write count records to consecutive slots starting at slot (no wrap)
+    virtual bool write(uint32_t slot, const TelemetryRecord* records, size_t count) = 0;
+
+    /// Read count records from consecutive slots starting at slot (no wrap)
+    virtual bool read(uint32_t slot, TelemetryRecord* records, size_t count) = 0;
+};
+
+class MqttOutbox {
+public:
+    MqttOutbox();
+
+    /**
+     * @brief Use a spill store for overflow; nullptr for RAM only
+     *
+     * Set it while the outbox is empty.
+     */
+    void setSpill(OutboxSpill* spill);
+
+    /// Queue one record; evicts the oldest one if there is no room
+    void add(const TelemetryRecord& record);
+
+    /**
+     * @brief Copy up to max of the oldest records without removing them
+     *
+     * After OUTBOX_SPILL_READ_RETRIES failed spill reads in a row, the spilled
+     * records are counted as dropped and the RAM records are returned instead,
+     * so an unreadable spill store cannot block the outbox.
+     * @return Records copied (0 if empty or the spill store cannot be read)
+     */
+    size_t peek(TelemetryRecord* out, size_t max);
+
+    /// Remove the count oldest records (after they were published)
+    void pop(size_t count);
+
+    /// Discard the count oldest records without publishing them (unformattable)
+    void drop(size_t count);
+
+    size_t size() const { return _ramCount + _spillCount; }
+    bool empty() const { return size() == 0; }
+
+    /// Records queued in total, delivered, evicted unsent, dropped unsent, and moved to the spill store
+    uint32_t getQueuedCount() const { return _queued; }
+    uint32_t getSentCount() const { return _sent; }
+    uint32_t getEvictedCount() const { return _evicted; }
+    uint32_t getDroppedCount() const { return _dropped; }
+    uint32_t getSpilledCount() const { return _spilled; }
+    uint32_t getSpillPending() const { return _spillCount; }
+
+    /**
+     * @brief Format records as a JSON array
+     *
+     * [{"ts":1700000000,"temperature":21.05,"humidity":45.20,"pressure":1013.25,"valve":35},...]
+     * NaN and infinite readings become null.
+     *
+     * @return Length written, or 0 if it does not fit in size
+     */
+    static size_t formatBatch(const TelemetryRecord* records, size_t count, char* out, size_t size);
+
+private:
+    void spillOldest();
+    size_t removeOldest(size_t count);
+    bool writeSpill(const TelemetryRecord* records, size_t count);
+
+    TelemetryRecord _ram[OUTBOX_RAM_RECORDS];
+    size_t _ramHead;                // Oldest RAM record
+    size_t _ramCount;
+    OutboxSpill* _spill;
+    uint32_t _spillHead;            // Oldest spilled record (slot)
+    uint32_t _spillCount;
+    uint8_t _spillReadFailures;     // Consecutive failed reads
+    uint32_t _queued;
+    uint32_t _sent;
+    uint32_t _evicted;
+    uint32_t _dropped;
+    uint32_t _spilled;
+};
+
+#endif // MQTT_OUTBOX_H
@@ -0,0 +1,75 @@
+/**
+ * @file mqtt_topic_router.h
+ * @brief Sorted topic table lookup for incoming MQTT commands
+ *
+ * A route table is a constexpr array of {topic, handler} entries kept in
+ * strcmp order. mqttRoutesSorted() can be evaluated in a static_assert, so
+ * an out-of-order entry is a compile error rather than a missed command,
+ * and findMqttRoute() resolves a topic with a binary search: a handful of
+ * string compares regardless of how many topics are subscribed.
+ *
+ * Header only; the handler type is whatever the owner dispatches through
+ * (MQTTManager uses member function pointers).
+ */
+
+#ifndef MQTT_TOPIC_ROUTER_H
+#define MQTT_TOPIC_ROUTER_H
+
+#include <stddef.h>
+#include <string.h>
+
+template <typename Handler>
+struct MqttRoute {
+    const char* topic;
+    Handler handler;
+};
+
+/// strcmp() sign as a constant expression
+constexpr int mqttTopicCompare(const char* a, const char* b) {
+    return (*a != *b || *a == '\0')
+        ? (int)(unsigned char)*a - (int)(unsigned char)*b
+        : mqttTopicCompare(a + 1, b + 1);
+}
+
+/// True if topics are strictly ascending (sorted and unique)
+template <typename Route>
+constexpr bool mqttRoutesSorted(const Route* routes, size_t count) {
+    return count < 2 ||
+        (mqttTopicCompare(routes[0].topic, routes[1].topic) < 0 &&
+         mqttRoutesSorted(routes + 1, count - 1));
+}
+
+template <typename Route, size_t N>
+constexpr bool mqttRoutesSorted(const Route (&routes)[N]) {
+    return mqttRoutesSorted(routes, N);
+}
+
+/**
+ * @brief Binary search a sorted route table
+ * @return The matching route, or nullptr
+ */
+template <typename Route>
+const Route* findMqttRoute(const Route* routes, size_t count, const char* topic) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int cmp = strcmp(topic, routes[mid].topic);
+        if (cmp == 0) {
+            return &routes[mid];
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+template <typename Route, size_t N>
+const Route* findMqttRoute(const Route (&routes)[N], const char* topic) {
+    return findMqttRoute(routes, N, topic);
+}
+
+#endif // MQTT_TOPIC_ROUTER_H
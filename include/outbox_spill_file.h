@@ -0,0 +1,38 @@
+/**
+ * @file outbox_spill_file.h
+ * @brief LittleFS ring file backing the MQTT outbox
+ *
+ * OUTBOX_SPILL_RECORDS fixed-size slots in /mqtt_outbox.bin, written as
+ * raw TelemetryRecord structs. The file is recreated empty by begin(): the
+ * outbox keeps its head and count in RAM only, so anything spilled before
+ * a reboot could not be ordered and is discarded.
+ *
+ * @par Memory Usage
+ * No buffers; records are read and written straight from the caller's.
+ */
+
+#ifndef OUTBOX_SPILL_FILE_H
+#define OUTBOX_SPILL_FILE_H
+
+#include <Arduino.h>
+#include "mqtt_outbox.h"
+
+// Slots in the spill file (12 hours of 30 s readings, ~29 KB)
+#ifndef OUTBOX_SPILL_RECORDS
+#define OUTBOX_SPILL_RECORDS 1440
+#endif
+
+class OutboxSpillFile : public OutboxSpill {
+public:
+    /**
+     * @brief Create an empty spill file
+     * @return false if LittleFS is not available
+     */
+    bool begin();
+
+    uint32_t capacity() const override { return OUTBOX_SPILL_RECORDS; }
+    bool write(uint32_t slot, const TelemetryRecord* records, size_t count) override;
+    bool read(uint32_t slot, TelemetryRecord* records, size_t count) override;
+};
+
+#endif // OUTBOX_SPILL_FILE_H
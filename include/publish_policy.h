@@ -0,0 +1,107 @@
+/**
+ * @file publish_policy.h
+ * @brief Per-topic publish-on-change filter for MQTT state topics
+ *
+ * Each topic id has a policy: a deadband (absolute, or relative to the last
+ * published value), a minimum interval between publishes and a heartbeat
+ * interval after which an unchanged value is published anyway. due() decides
+ * whether a new value is worth sending; published() records what was sent.
+ *
+ * Text states (mode, preset, action) are compared by a 32-bit FNV-1a hash
+ * of the payload, so the table never stores strings.
+ *
+ * Several states sent in one message (the consolidated Home Assistant state
+ * document) use changed() on each part, dueOnChange() on the message's own
+ * topic id and carried() to record each part without counting it.
+ *
+ * @par Memory Usage
+ * 12 bytes per topic (PUBLISH_POLICY_MAX_TOPICS topics) plus counters.
+ */
+
+#ifndef PUBLISH_POLICY_H
+#define PUBLISH_POLICY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Topic ids a PublishPolicy can track
+#ifndef PUBLISH_POLICY_MAX_TOPICS
+#define PUBLISH_POLICY_MAX_TOPICS 16
+#endif
+
+/**
+ * @brief How often one topic may or must be published
+ */
+struct TopicPolicy {
+    float absDeadband;          // Publish when the value moved at least this much
+    float relDeadband;          // ... or this fraction of the last published value
+    uint32_t minIntervalMs;     // Changes closer together than this wait
+    uint32_t heartbeatMs;       // Publish an unchanged value this often (0 = never)
+};
+
+class PublishPolicy {
+public:
+    /**
+     * @param policies One entry per topic id; must outlive this object
+     * @param count Number of topic ids (at most PUBLISH_POLICY_MAX_TOPICS)
+     */
+    PublishPolicy(const TopicPolicy* policies, uint8_t count);
+
+    /**
+     * @brief Decide whether a numeric value should be published now
+     *
+     * Always true for a topic that has not been published since the last
+     * invalidate(). Counts a skip when false.
+     */
+    bool due(uint8_t topicId, float value, uint32_t now);
+
+    /// Same for a text payload; any change counts as outside the deadband
+    bool due(uint8_t topicId, const char* text, uint32_t now);
+
+    /// Record a value that was actually sent
+    void published(uint8_t topicId, float value, uint32_t now);
+    void published(uint8_t topicId, const char* text, uint32_t now);
+
+    /// Whether a value is outside its deadband (or was never sent); counts nothing
+    bool changed(uint8_t topicId, float value) const;
+    bool changed(uint8_t topicId, const char* text) const;
+
+    /// due() for a combined message whose parts were checked with changed()
+    bool dueOnChange(uint8_t topicId, bool changed, uint32_t now);
+
+    /// Record a value sent inside a combined message; not counted as a message
+    void carried(uint8_t topicId, float value, uint32_t now);
+    void carried(uint8_t topicId, const char* text, uint32_t now);
+
+    /// Forget what was sent; every topic is due on its next check
+    void invalidate();
+
+    /// Messages sent and skipped since construction
+    uint32_t getPublishedCount() const { return _published; }
+    uint32_t getSkippedCount() const { return _skipped; }
+
+    /// FNV-1a hash used for text payloads (exposed for tests)
+    static uint32_t hashText(const char* text);
+
+private:
+    struct TopicState {
+        union {
+            float value;
+            uint32_t hash;
+        } last;
+        uint32_t publishedAt;
+        bool valid;
+    };
+
+    bool decide(uint8_t topicId, bool changed, uint32_t now);
+    bool outsideDeadband(const TopicPolicy& policy, float last, float value) const;
+    void record(uint8_t topicId, uint32_t now);
+
+    const TopicPolicy* _policies;
+    uint8_t _count;
+    TopicState _states[PUBLISH_POLICY_MAX_TOPICS];
+    uint32_t _published;
+    uint32_t _skipped;
+};
+
+#endif // PUBLISH_POLICY_H
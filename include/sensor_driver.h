@@ -0,0 +1,108 @@
+/**
+ * @file sensor_driver.h
+ * @brief Non-blocking sensor driver interface
+ *
+ * Every measurement is split into three phases so that slow conversions
+ * (a DS18B20 takes 750 ms at 12-bit resolution) never stall the main loop:
+ *
+ * 1. startConversion() - short bus transaction that triggers a measurement
+ * 2. isReady()         - polled by SensorScheduler until the result is available
+ * 3. readSample()      - short bus transaction that fetches the result
+ *
+ * Drivers never wait inside these calls; timing is owned by SensorScheduler.
+ *
+ * @see SensorScheduler for the state machine driving these phases
+ */
+
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Physical bus a sensor lives on
+ *
+ * Sensors sharing a bus are interleaved by the scheduler so that at most
+ * one transaction per bus happens in each loop iteration.
+ */
+enum SensorBus : uint8_t {
+    SENSOR_BUS_I2C = 0,
+    SENSOR_BUS_ONEWIRE = 1,
+    SENSOR_BUS_COUNT
+};
+
+/**
+ * @brief What a sensor measures in the installation
+ */
+enum SensorRole : uint8_t {
+    SENSOR_ROLE_ROOM = 0,             ///< Primary room sensor feeding the PID
+    SENSOR_ROLE_RADIATOR_RETURN = 1,  ///< Radiator return-water temperature
+    SENSOR_ROLE_AUXILIARY = 2         ///< Any additional sensor
+};
+
+/**
+ * @brief One measurement result; fields a sensor does not provide are NAN
+ */
+struct SensorSample {
+    float temperature;          ///< °C
+    float humidity;             ///< % relative humidity
+    float pressure;             ///< hPa
+    unsigned long timestamp;    ///< millis() when the result was read
+    bool valid;                 ///< false if the last cycle failed
+
+    SensorSample()
+        : temperature(NAN), humidity(NAN), pressure(NAN), timestamp(0), valid(false) {}
+};
+
+/**
+ * @class SensorDriver
+ * @brief Interface implemented by every sensor driver
+ */
+class SensorDriver {
+public:
+    virtual ~SensorDriver() {}
+
+    /**
+     * @brief Short human-readable sensor name (e.g. "BME280")
+     */
+    virtual const char* getName() const = 0;
+
+    /**
+     * @brief Bus used by this sensor
+     */
+    virtual SensorBus getBus() const = 0;
+
+    /**
+     * @brief Probe and configure the sensor (called once from setup)
+     * @return true if the sensor responded
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Trigger a measurement without waiting for it
+     * @return false if the sensor did not acknowledge the command
+     */
+    virtual bool startConversion() = 0;
+
+    /**
+     * @brief Nominal conversion time in milliseconds
+     */
+    virtual uint32_t getConversionTimeMs() const = 0;
+
+    /**
+     * @brief Check whether the conversion has finished
+     * @param elapsedMs Time since startConversion() succeeded
+     */
+    virtual bool isReady(unsigned long elapsedMs) {
+        return elapsedMs >= getConversionTimeMs();
+    }
+
+    /**
+     * @brief Fetch the result of the finished conversion
+     * @param sample Output sample (timestamp and valid flag set by the scheduler)
+     * @return false on bus or CRC error
+     */
+    virtual bool readSample(SensorSample& sample) = 0;
+};
+
+#endif // SENSOR_DRIVER_H
@@ -0,0 +1,142 @@
+/**
+ * @file sensor_filter.h
+ * @brief Streaming filter pipeline for sensor samples
+ *
+ * Sits between sensor acquisition and its consumers (PID controller,
+ * KNX/MQTT publishing) so that the derivative term of the PID no longer
+ * amplifies BME280 quantization noise and single-sample glitches.
+ * Each scheduler sample is filtered once as it arrives; every consumer
+ * gets that sample's output.
+ *
+ * @par Pipeline Stages (applied in order)
+ * 1. Outlier gate - rejects samples that jump more than a configured step
+ *    away from the last good value held by SensorHealthMonitor. After
+ *    MAX_CONSECUTIVE_REJECTS rejections in a row the step is treated as
+ *    real and the pipeline re-seeds on the new level.
+ * 2. Median-of-N - suppresses isolated spikes (N = 1, 3 or 5).
+ * 3. Smoothing - exponential moving average or a one-dimensional Kalman
+ *    filter (random-walk model).
+ *
+ * @par Memory Usage
+ * All state is fixed-size (one median window of MAX_MEDIAN_WINDOW floats
+ * plus a handful of scalars); processing a sample is O(1) and never
+ * allocates.
+ *
+ * @see SensorHealthMonitor for the reference value used by the gate
+ * @see ConfigManager for the persisted "filter" settings
+ */
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Smoothing stage selection
+ */
+enum SensorSmoothingMode : uint8_t {
+    SMOOTHING_NONE = 0,     ///< Pass median output through unchanged
+    SMOOTHING_EMA = 1,      ///< Exponential moving average
+    SMOOTHING_KALMAN = 2    ///< One-dimensional Kalman filter
+};
+
+/**
+ * @brief Pipeline configuration (mirrors the "filter" section of /api/config)
+ */
+struct SensorFilterConfig {
+    uint8_t medianWindow;           ///< Median window size: 1 (off), 3 or 5
+    uint8_t smoothing;              ///< SensorSmoothingMode
+    float emaAlpha;                 ///< EMA weight of the newest sample (0-1]
+    float kalmanProcessNoise;       ///< Kalman Q - expected drift per sample (°C²)
+    float kalmanMeasurementNoise;   ///< Kalman R - sensor noise variance (°C²)
+    float outlierThreshold;         ///< Max step from last good value (°C), 0 = gate off
+};
+
+/**
+ * @brief Counters describing what the pipeline did with its input
+ */
+struct SensorFilterStats {
+    uint32_t samples;           ///< Samples offered to the pipeline
+    uint32_t outliersRejected;  ///< Samples dropped by the outlier gate
+    uint32_t gateResyncs;       ///< Step changes accepted after repeated rejections
+    uint32_t spikesSuppressed;  ///< Samples the median moved by more than SPIKE_REPORT_DELTA
+    float lastRejected;         ///< Value of the most recently rejected sample
+};
+
+/**
+ * @class SensorFilterPipeline
+ * @brief Allocation-free median / smoothing / outlier-gate chain for one signal
+ */
+class SensorFilterPipeline {
+public:
+    static const uint8_t MAX_MEDIAN_WINDOW = 5;
+
+    /// Rejections in a row before a step change is accepted as genuine.
+    /// Kept below the SensorHealthMonitor alert threshold (3) on purpose.
+    static const uint8_t MAX_CONSECUTIVE_REJECTS = 2;
+
+    /// Median corrections larger than this are reported as suppressed spikes (°C)
+    static constexpr float SPIKE_REPORT_DELTA = 0.3f;
+
+    SensorFilterPipeline();
+
+    /**
+     * @brief Apply a new configuration
+     *
+     * Out-of-range values are clamped. Changing the median window or the
+     * smoothing mode re-seeds the affected stage from the current output.
+     */
+    void configure(const SensorFilterConfig& config);
+
+    const SensorFilterConfig& getConfig() const { return _config; }
+
+    /**
+     * @brief Run one sample through the pipeline
+     * @param raw Validated sensor sample
+     * @param reference Last good value (e.g. SensorHealthMonitor::getLastGoodValue()),
+     *                  NAN if none is known yet
+     * @param filtered Output: filtered value (only written when accepted)
+     * @return false if the outlier gate rejected the sample
+     */
+    bool process(float raw, float reference, float& filtered);
+
+    /**
+     * @brief Check whether the pipeline has produced an output yet
+     */
+    bool hasValue() const { return _seeded; }
+
+    /**
+     * @brief Most recent filtered value (NAN until the first accepted sample)
+     */
+    float getValue() const { return _output; }
+
+    const SensorFilterStats& getStats() const { return _stats; }
+
+    /**
+     * @brief Clear all filter state and counters (configuration is kept)
+     */
+    void reset();
+
+private:
+    void seed(float value);
+    float median(float raw);
+    float smooth(float value);
+
+    SensorFilterConfig _config;
+    SensorFilterStats _stats;
+
+    // Median stage
+    float _window[MAX_MEDIAN_WINDOW];
+    uint8_t _windowIndex;
+    uint8_t _windowCount;
+
+    // Smoothing stage (EMA uses _output only, Kalman adds the error covariance)
+    float _output;
+    float _kalmanP;
+    bool _seeded;
+
+    // Outlier gate
+    uint8_t _consecutiveRejects;
+};
+
+#endif // SENSOR_FILTER_H
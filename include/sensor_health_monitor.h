@@ -3,6 +3,12 @@
 
 #include <Arduino.h>
 
+// Sliding window length for the failure rate (readings). Queries are O(1)
+// regardless of length, so this can be widened to hours via build flags.
+#ifndef SENSOR_HEALTH_HISTORY_SIZE
+#define SENSOR_HEALTH_HISTORY_SIZE 300
+#endif
+
 /**
  * @brief Monitors sensor health and provides failure detection
  *
@@ -94,11 +100,13 @@ private:
     unsigned long _lastGoodReadingTime;
     float _lastGoodValue;
 
-    // Circular buffer for failure rate calculation (5 minutes at 1 reading/sec)
-    static const int SENSOR_HISTORY_SIZE = 300;
-    bool _readingHistory[SENSOR_HISTORY_SIZE];
+    // Circular bitset for failure rate calculation (bit set = failed reading)
+    static const int SENSOR_HISTORY_SIZE = SENSOR_HEALTH_HISTORY_SIZE;
+    static const int SENSOR_HISTORY_WORDS = (SENSOR_HISTORY_SIZE + 31) / 32;
+    uint32_t _failureBits[SENSOR_HISTORY_WORDS];
     int _historyIndex;
-    int _historyCount; // Number of valid entries in history
+    int _historyCount;   // Number of valid entries in history
+    int _windowFailures; // Running count of set bits in the window
 
     // Recovery tracking
     bool _wasUnhealthy;
@@ -0,0 +1,119 @@
+/**
+ * @file sensor_scheduler.h
+ * @brief Interleaves non-blocking conversions across all registered sensors
+ *
+ * A sampling cycle is requested by the main loop (see AdaptiveSampler for
+ * when). The scheduler then walks every registered SensorDriver through
+ * start -> wait -> read, performing at most one bus transaction per bus in
+ * each loop() call. Conversions on different sensors overlap, so a cycle
+ * takes roughly as long as the slowest sensor while the worst-case loop
+ * latency stays bounded by a single short transaction per bus.
+ *
+ * @par Memory Usage
+ * Fixed table of MAX_SENSORS slots; no dynamic allocation.
+ *
+ * @see SensorDriver for the driver contract
+ */
+
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include "sensor_driver.h"
+
+/**
+ * @class SensorScheduler
+ * @brief Round-robin state machine over a fixed set of sensor drivers
+ */
+class SensorScheduler {
+public:
+    static const uint8_t MAX_SENSORS = 6;
+
+    /// Extra time allowed beyond the nominal conversion time before a read is abandoned
+    static const uint32_t CONVERSION_TIMEOUT_MARGIN_MS = 1000;
+
+    SensorScheduler();
+
+    /**
+     * @brief Register a driver (before begin())
+     * @return Slot index, or -1 if the table is full
+     */
+    int addSensor(SensorDriver* driver, SensorRole role);
+
+    /**
+     * @brief Initialize every registered driver
+     * @return Number of sensors that responded
+     */
+    uint8_t begin();
+
+    /**
+     * @brief Request a new sampling cycle
+     * @param now millis() timestamp
+     * @return false if the previous cycle is still in progress
+     */
+    bool requestCycle(unsigned long now);
+
+    /**
+     * @brief Advance the conversion state machines (call every loop iteration)
+     * @param now millis() timestamp
+     */
+    void loop(unsigned long now);
+
+    /**
+     * @brief Check whether a cycle is still running
+     */
+    bool isBusy() const { return _cycleActive; }
+
+    /**
+     * @brief Returns true exactly once after each completed cycle
+     */
+    bool consumeCycle();
+
+    uint8_t getSensorCount() const { return _count; }
+
+    /**
+     * @brief Find the first sensor with a given role
+     * @return Slot index, or -1 if none registered
+     */
+    int findByRole(SensorRole role) const;
+
+    const SensorSample& getSample(uint8_t index) const;
+    SensorDriver* getDriver(uint8_t index) const;
+    SensorRole getRole(uint8_t index) const;
+    bool isPresent(uint8_t index) const;
+    uint32_t getErrorCount(uint8_t index) const;
+
+    /**
+     * @brief Duration of the last completed cycle in milliseconds
+     */
+    unsigned long getLastCycleDuration() const { return _lastCycleDuration; }
+
+private:
+    enum SlotState : uint8_t {
+        SLOT_IDLE,
+        SLOT_PENDING,
+        SLOT_CONVERTING,
+        SLOT_DONE
+    };
+
+    struct Slot {
+        SensorDriver* driver;
+        SensorRole role;
+        SlotState state;
+        bool present;
+        unsigned long conversionStart;
+        uint32_t errors;
+        SensorSample sample;
+    };
+
+    void finishSlot(Slot& slot, bool success, unsigned long now);
+
+    Slot _slots[MAX_SENSORS];
+    uint8_t _count;
+    uint8_t _nextSlot;          // Round-robin start position
+    bool _cycleActive;
+    bool _cycleReady;
+    unsigned long _cycleStart;
+    unsigned long _lastCycleDuration;
+};
+
+#endif // SENSOR_SCHEDULER_H
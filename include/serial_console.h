@@ -0,0 +1,115 @@
+/**
+ * @file serial_console.h
+ * @brief Non-blocking command console for the UART and the web serial monitor
+ *
+ * poll() takes whatever bytes the UART already holds and edits a line in a
+ * fixed buffer (echo, backspace), so the main loop never waits for input.
+ * A complete line is split into words and dispatched through a small table
+ * of commands registered with addCommand(). Lines typed into the web serial
+ * monitor arrive through submit() from the AsyncTCP task and are executed
+ * by loop() on the main task, like UART input.
+ *
+ * Command output goes to the Print given to begin(); on the device that is
+ * the captured Serial, so replies show up on both the UART and the web page.
+ *
+ * @par Memory Usage
+ * Two line buffers of SERIAL_CONSOLE_LINE_SIZE plus 12 bytes per command.
+ */
+
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Longest command line, including the NUL
+#ifndef SERIAL_CONSOLE_LINE_SIZE
+#define SERIAL_CONSOLE_LINE_SIZE 96
+#endif
+
+// Commands that can be registered, "help" included
+#ifndef SERIAL_CONSOLE_MAX_COMMANDS
+#define SERIAL_CONSOLE_MAX_COMMANDS 16
+#endif
+
+// Words per line passed to a handler, the command name included
+#ifndef SERIAL_CONSOLE_MAX_ARGS
+#define SERIAL_CONSOLE_MAX_ARGS 6
+#endif
+
+class SerialConsole {
+public:
+    /// argv[0] is the command name; argv[1..argc-1] its arguments
+    typedef void (*Handler)(int argc, char** argv, Print& out);
+
+    static SerialConsole& getInstance() {
+        static SerialConsole instance;
+        return instance;
+    }
+
+    /**
+     * @brief Set where command output goes
+     */
+    void begin(Print* out) { _out = out; }
+
+    /**
+     * @brief Register a command; name and help must be string literals
+     * @return false if the table is full or the name is taken
+     */
+    bool addCommand(const char* name, const char* help, Handler handler);
+
+    /**
+     * @brief Consume the bytes in's receive buffer already holds
+     *
+     * Never waits. Input is echoed back to in; a complete line runs at once.
+     */
+    void poll(Stream& in);
+
+    /**
+     * @brief Queue one line for loop() from one other task (the AsyncTCP task)
+     * @return false if the previous line has not run yet
+     */
+    bool submit(const char* line, size_t len);
+
+    /**
+     * @brief Run a line queued by submit(); call from the main loop
+     */
+    void loop();
+
+    /**
+     * @brief Split line in place and run the matching command
+     * @return false for an empty line or an unknown command
+     */
+    bool execute(char* line);
+
+    /// printf to a Print without needing Print::printf (output truncated at 160 bytes)
+    static void printf(Print& out, const char* format, ...);
+
+private:
+    SerialConsole();
+
+    // Prevent copying
+    SerialConsole(const SerialConsole&) = delete;
+    SerialConsole& operator=(const SerialConsole&) = delete;
+
+    struct Command {
+        const char* name;
+        const char* help;
+        Handler handler;
+    };
+
+    static void printHelp(int argc, char** argv, Print& out);
+
+    Print* _out;
+    Command _commands[SERIAL_CONSOLE_MAX_COMMANDS];
+    uint8_t _commandCount;
+
+    char _line[SERIAL_CONSOLE_LINE_SIZE];       // UART line being edited
+    size_t _lineLength;
+    bool _lastWasCR;                            // Swallow the LF of a CR/LF pair
+
+    char _pending[SERIAL_CONSOLE_LINE_SIZE];    // Line from submit() waiting for loop()
+    std::atomic<bool> _pendingReady;            // Handoff flag: set by submit(), cleared by loop()
+};
+
+#endif // SERIAL_CONSOLE_H
@@ -3,13 +3,39 @@
 
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
-#include <vector>
+
+// Bytes of recent output kept for the web monitor (power of two)
+#ifndef SERIAL_MONITOR_BUFFER_SIZE
+#define SERIAL_MONITOR_BUFFER_SIZE 4096
+#endif
+
+// Longest captured line; longer output is split
+#ifndef SERIAL_MONITOR_LINE_SIZE
+#define SERIAL_MONITOR_LINE_SIZE 512
+#endif
+
+// Lines are collected and sent as one WebSocket frame per interval
+#ifndef SERIAL_MONITOR_FLUSH_MS
+#define SERIAL_MONITOR_FLUSH_MS 100
+#endif
+
+// Clients whose skipped output is tracked individually
+#ifndef SERIAL_MONITOR_MAX_CLIENTS
+#define SERIAL_MONITOR_MAX_CLIENTS 8
+#endif
 
 /**
  * @brief Serial Monitor for web-based serial console
  *
- * Captures ALL Serial output to a circular buffer and streams it via WebSocket
+ * Captures ALL Serial output and streams it via WebSocket.
  * Uses hybrid approach: TeeSerial for Arduino + esp_log_set_vprintf for ESP-IDF
+ *
+ * Complete lines go into a fixed byte ring (newline separated), so capturing
+ * never allocates. loop() sends everything added since the last flush as one
+ * text frame, built once and shared by all clients. A client whose send
+ * queue is full skips that frame and is told how much it missed, instead of
+ * overflowing its queue and being disconnected. Clients must split frames
+ * on '\n'.
  */
 class SerialMonitor {
 public:
@@ -25,10 +51,15 @@ public:
     void begin(AsyncWebServer* server);
 
     /**
-     * @brief Add a line to the buffer and broadcast to clients
-     * @param line Line to add (raw, no formatting)
+     * @brief Add one line (without line ending) to the buffer
+     *
+     * Safe from any task; the line is broadcast on the next flush.
      */
-    void println(const String& line);
+    void println(const char* line, size_t len);
+
+    void println(const char* line) {
+        println(line, strlen(line));
+    }
 
     /**
      * @brief Add raw data (for character-by-character capture)
@@ -37,29 +68,44 @@ public:
      */
     void write(const char* data, size_t len);
 
+    // Partial line assembled from character output
+    struct LineBuffer {
+        char data[SERIAL_MONITOR_LINE_SIZE];
+        size_t length;
+    };
+
     /**
-     * @brief Get number of connected clients
+     * @brief Assemble raw output into lines, adding each complete line
+     *
+     * Runs under the monitor's lock, so one LineBuffer may be fed from
+     * several tasks; a line longer than the buffer is split.
      */
-    size_t getClientCount() const { return _ws ? _ws->count() : 0; }
+    void capture(LineBuffer& line, const char* data, size_t len);
 
     /**
-     * @brief Clean up disconnected WebSocket clients
-     * Should be called periodically from loop()
+     * @brief Broadcast buffered output and clean up disconnected clients
+     * Should be called from loop()
      */
-    void cleanupClients() {
-        if (_ws) {
-            _ws->cleanupClients();
-        }
-    }
+    void loop();
+
+    /**
+     * @brief Get number of connected clients
+     */
+    size_t getClientCount() const { return _ws ? _ws->count() : 0; }
 
 private:
-    SerialMonitor() : _server(nullptr), _ws(nullptr), _lineBuffer("") {}
+    SerialMonitor();
     ~SerialMonitor() = default;
 
     // Prevent copying
     SerialMonitor(const SerialMonitor&) = delete;
     SerialMonitor& operator=(const SerialMonitor&) = delete;
 
+    struct ClientState {
+        uint32_t id;            // 0 = unused
+        uint32_t skipped;       // Bytes not delivered because the client fell behind
+    };
+
     /**
      * @brief WebSocket event handler
      */
@@ -72,17 +118,43 @@ private:
     void sendBufferToClient(AsyncWebSocketClient* client);
 
     /**
-     * @brief Process incoming character and handle line buffering
+     * @brief Send output added since the last flush to all clients
+     */
+    void flush();
+
+    /**
+     * @brief Copy ring bytes [pos, end) into out, advancing pos
+     *
+     * If pos has already been overwritten it first moves to the oldest
+     * complete line, adding the bytes passed over to skipped.
+     */
+    size_t read(uint32_t& pos, uint32_t end, uint8_t* out, size_t size, uint32_t& skipped);
+
+    ClientState* findClient(uint32_t id);
+
+    /**
+     * @brief Copy a line and its newline into the ring (caller holds _lock)
      */
-    void processChar(char c);
+    void store(const char* line, size_t len);
 
     AsyncWebServer* _server;
     AsyncWebSocket* _ws;
-    std::vector<String> _buffer;
-    String _lineBuffer;
 
-    static const size_t MAX_BUFFER_SIZE = 20;    // Last 20 lines (prevent WebSocket queue overflow)
-    static const size_t MAX_LINE_LENGTH = 512;   // Max line length
+    char _ring[SERIAL_MONITOR_BUFFER_SIZE];
+    uint32_t _head;                     // Bytes ever written; always at a line boundary
+    volatile uint32_t _sent;            // Bytes already broadcast (loop() only)
+    portMUX_TYPE _lock;                 // Guards _ring and _head
+
+    LineBuffer _line;                   // ESP-IDF log line being assembled
+
+    ClientState _clients[SERIAL_MONITOR_MAX_CLIENTS];
+    unsigned long _lastFlush;
+    unsigned long _lastCleanup;
+
+    static_assert((SERIAL_MONITOR_BUFFER_SIZE & (SERIAL_MONITOR_BUFFER_SIZE - 1)) == 0,
+                  "SERIAL_MONITOR_BUFFER_SIZE must be a power of two");
+    static_assert(SERIAL_MONITOR_LINE_SIZE < SERIAL_MONITOR_BUFFER_SIZE,
+                  "A line must fit the serial monitor buffer");
 };
 
 /**
@@ -94,7 +166,9 @@ private:
  */
 class TeeSerial : public Print {
 public:
-    TeeSerial() : _hwSerial(nullptr), _lineBuffer("") {}
+    TeeSerial() : _hwSerial(nullptr) {
+        _line.length = 0;
+    }
 
     /**
      * @brief Initialize with hardware serial reference
@@ -112,22 +186,7 @@ public:
         }
 
         // Capture for web monitor - ALWAYS capture, even if hwSerial is null
-        if (c == '\n') {
-            // Line complete, send to monitor
-            if (_lineBuffer.length() > 0) {
-                SerialMonitor::getInstance().println(_lineBuffer);
-            }
-            _lineBuffer = "";
-        } else if (c != '\r') {  // Ignore carriage returns
-            _lineBuffer += (char)c;
-
-            // Prevent buffer overflow
-            if (_lineBuffer.length() > 512) {
-                SerialMonitor::getInstance().println(_lineBuffer);
-                _lineBuffer = "";
-            }
-        }
-
+        SerialMonitor::getInstance().capture(_line, (const char*)&c, 1);
         return result;
     }
 
@@ -139,19 +198,7 @@ public:
         }
 
         // Capture for web monitor
-        for (size_t i = 0; i < size; i++) {
-            char c = buffer[i];
-            if (c == '\n') {
-                SerialMonitor::getInstance().println(_lineBuffer);
-                _lineBuffer = "";
-            } else if (c != '\r') {
-                _lineBuffer += c;
-                if (_lineBuffer.length() > 512) {
-                    SerialMonitor::getInstance().println(_lineBuffer);
-                    _lineBuffer = "";
-                }
-            }
-        }
+        SerialMonitor::getInstance().capture(_line, (const char*)buffer, size);
 
         return result;
     }
@@ -166,7 +213,7 @@ public:
 
 private:
     HardwareSerial* _hwSerial;
-    String _lineBuffer;
+    SerialMonitor::LineBuffer _line;    // Shared by every task that prints
 };
 
 // Global TeeSerial instance
@@ -0,0 +1,39 @@
+#ifndef SHT_SENSOR_H
+#define SHT_SENSOR_H
+
+#include <Wire.h>
+#include "sensor_driver.h"
+
+/**
+ * @brief Sensirion SHT3x / SHT4x temperature and humidity sensor (I2C)
+ *
+ * Uses single-shot, high-repeatability measurements without clock
+ * stretching: startConversion() sends the command, the scheduler waits the
+ * datasheet conversion time, and readSample() fetches and CRC-checks the
+ * six result bytes.
+ */
+class ShtSensor : public SensorDriver {
+public:
+    enum Variant : uint8_t {
+        SHT3X = 3,
+        SHT4X = 4
+    };
+
+    ShtSensor(Variant variant, uint8_t address = 0x44, TwoWire& wire = Wire);
+
+    const char* getName() const override { return _variant == SHT4X ? "SHT4x" : "SHT3x"; }
+    SensorBus getBus() const override { return SENSOR_BUS_I2C; }
+    bool begin() override;
+    bool startConversion() override;
+    uint32_t getConversionTimeMs() const override;
+    bool readSample(SensorSample& sample) override;
+
+private:
+    static uint8_t crc8(const uint8_t* data, uint8_t len);
+
+    Variant _variant;
+    uint8_t _address;
+    TwoWire& _wire;
+};
+
+#endif // SHT_SENSOR_H
@@ -0,0 +1,108 @@
+/**
+ * @file telegraph_aggregate.h
+ * @brief Encoder for the 'telegraph' aggregate (JSON or MessagePack)
+ *
+ * The aggregate carries one sensor cycle for collectors such as Telegraf.
+ * Its fields come in groups that can be switched off one by one, and it is
+ * built as one ArduinoJson document and serialized either as compact JSON or
+ * as MessagePack with the same keys and nesting. MessagePack stores numbers
+ * as float32 or the smallest integer type, and drops quotes and separators.
+ * Consumers that decode binary (Telegraf's xpath_msgpack parser, Node-RED's
+ * msgpack node) get a payload about 17% smaller that needs no number
+ * formatting; dropping unused groups shrinks either format further.
+ *
+ * Example (JSON, all groups):
+ * {"temperature":21.5,"humidity":45.2,"pressure":1013.25,
+ *  "valve_position":40,"action":"heating","heating_state":"ON",
+ *  "pid":{"kp":2,"ki":0.1,"kd":0.05,"setpoint":21},
+ *  "mode":"heat","preset":"comfort","wifi":{"rssi":-61},"uptime":3600,
+ *  "status":"online","health":{"sensor_healthy":true,...,"free_heap":151234,
+ *  "heap_fragmentation":12.5}}
+ *
+ * Readings are rounded (2 decimals for sensors and kp, 3 for ki/kd, 1 for
+ * the rest); values that are not known (NaN) are written as null
+ * (MessagePack nil).
+ *
+ * @par Memory Usage
+ * ~64 bytes per TelegraphSample and a ~450 byte StaticJsonDocument on the
+ * stack while encoding; the caller owns the output buffer.
+ */
+
+#ifndef TELEGRAPH_AGGREGATE_H
+#define TELEGRAPH_AGGREGATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEGRAPH_TOPIC "telegraph"
+
+// Largest aggregate (JSON, all groups, ~520 bytes) plus headroom
+#define TELEGRAPH_BUFFER_SIZE 640
+
+enum TelegraphFormat : uint8_t {
+    TELEGRAPH_JSON = 0,
+    TELEGRAPH_MSGPACK = 1
+};
+
+// Field groups, selectable through mqtt.aggregate_fields
+enum TelegraphField : uint8_t {
+    TELEGRAPH_SENSORS = 0x01,       // temperature, humidity, pressure
+    TELEGRAPH_VALVE = 0x02,         // valve_position, action, heating_state
+    TELEGRAPH_PID = 0x04,           // pid: kp, ki, kd, setpoint
+    TELEGRAPH_CONTROL = 0x08,       // mode, preset
+    TELEGRAPH_DIAGNOSTICS = 0x10,   // wifi: rssi, uptime, status
+    TELEGRAPH_HEALTH = 0x20,        // health: sensor and valve health
+    TELEGRAPH_MEMORY = 0x40         // health: free_heap, heap_fragmentation
+};
+
+#define TELEGRAPH_FIELD_GROUPS 7
+#define TELEGRAPH_ALL_FIELDS 0x7F
+
+/**
+ * @brief Everything the aggregate can carry; only the selected groups are read
+ */
+struct TelegraphSample {
+    float temperature;              // °C
+    float humidity;                 // %
+    float pressure;                 // hPa
+    int valvePosition;              // %
+    float kp;
+    float ki;
+    float kd;
+    float setpoint;                 // °C
+    bool heat;                      // Mode: heat (true) or off
+    char preset[16];
+    int wifiRSSI;                   // dBm
+    uint32_t uptime;                // Seconds
+    bool sensorHealthy;
+    float sensorFailureRate;        // %
+    uint32_t sensorConsecutiveFailures;
+    bool valveHealthy;
+    float valveErrorPct;            // %
+    uint32_t freeHeap;              // Bytes
+    float heapFragmentation;        // %
+
+    TelegraphSample();
+};
+
+/**
+ * @brief Encode the selected groups of a sample
+ * @param fields TelegraphField bits
+ * @return Bytes written, or 0 if it does not fit (JSON is NUL-terminated only if there is room)
+ */
+size_t encodeTelegraph(const TelegraphSample& sample, uint8_t fields, TelegraphFormat format,
+                       uint8_t* out, size_t size);
+
+// Group name for bit index 0..TELEGRAPH_FIELD_GROUPS-1 ("sensors", "valve", ...)
+const char* telegraphFieldName(uint8_t index);
+
+// TelegraphField bit for a group name, 0 if unknown
+uint8_t telegraphFieldBit(const char* name);
+
+// "json" / "msgpack"
+const char* telegraphFormatName(TelegraphFormat format);
+
+// Format for a name, -1 if unknown
+int parseTelegraphFormat(const char* name);
+
+#endif // TELEGRAPH_AGGREGATE_H
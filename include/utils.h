@@ -17,8 +17,7 @@ String decodeKnxData(uint8_t ct, uint8_t* data, uint8_t len);
 // Main function to decode a KNX message into a readable string
 String decodeKnxMessage(knx_command_type_t ct, uint16_t src, uint16_t dst, uint8_t* data, uint8_t len);
 
-// New functions to monitor and decode KNX debug messages from serial output
-void monitorKnxDebugMessages();
+// Decode a raw KNX debug message from the serial output
 void decodeRawKnxDebugMessage(String &message);
 
 // Function to initialize custom log handler
@@ -3,6 +3,12 @@
 
 #include <Arduino.h>
 
+// Sliding window length for error statistics (commands). Queries are O(1)
+// regardless of length, so this can be widened via build flags.
+#ifndef VALVE_HEALTH_HISTORY_SIZE
+#define VALVE_HEALTH_HISTORY_SIZE 100
+#endif
+
 /**
  * @brief Monitors valve actuator health by comparing commanded vs actual position
  *
@@ -94,11 +100,18 @@ private:
     ValveHealthMonitor();
     static ValveHealthMonitor* _instance;
 
-    // Error history (last 100 commands)
-    static const int VALVE_HISTORY_SIZE = 100;
-    float _errorHistory[VALVE_HISTORY_SIZE];
+    // Error history in centi-percent so the running sum stays exact (no float drift)
+    static const int VALVE_HISTORY_SIZE = VALVE_HEALTH_HISTORY_SIZE;
+    static constexpr float ERROR_SCALE = 100.0f;
+    uint16_t _errorHistory[VALVE_HISTORY_SIZE];
     int _historyIndex;
     int _historyCount;
+    uint32_t _errorSum;
+
+    // Monotonic deque of history slots with decreasing errors; front is the window max
+    uint16_t _maxDeque[VALVE_HISTORY_SIZE];
+    int _maxHead;
+    int _maxCount;
 
     // Statistics
     uint32_t _stuckCount;
@@ -134,6 +134,42 @@ private:
      * @param jsonDoc The received configuration JSON
      */
     void handleNTPUpdate(const JsonDocument& jsonDoc);
+
+    /**
+     * @brief Reload the sensor filter pipeline after a config update
+     * @param jsonDoc The received configuration JSON
+     */
+    void handleFilterUpdate(const JsonDocument& jsonDoc);
+
+    /**
+     * @brief Reload adaptive sampling bounds after a config update
+     * @param jsonDoc The received configuration JSON
+     */
+    void handleSamplingUpdate(const JsonDocument& jsonDoc);
+
+    /**
+     * @brief Reload window-open detection settings after a config update
+     * @param jsonDoc The received configuration JSON
+     */
+    void handleWindowOpenUpdate(const JsonDocument& jsonDoc);
+
+    /**
+     * @brief Reload global and per-tag log levels after a config update
+     * @param jsonDoc The received configuration JSON
+     */
+    void handleLoggingUpdate(const JsonDocument& jsonDoc);
+
+    /**
+     * @brief Reload the 'telegraph' aggregate settings after a config update
+     * @param jsonDoc The received configuration JSON
+     */
+    void handleMqttUpdate(const JsonDocument& jsonDoc);
+
+    /**
+     * @brief Refresh the preset the aggregate reports after a config update
+     * @param jsonDoc The received configuration JSON
+     */
+    void handlePresetUpdate(const JsonDocument& jsonDoc);
 };
 
 #endif // WEB_SERVER_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+/**
+ * @file window_open_detector.h
+ * @brief Streaming window-open / rapid heat-loss detector
+ *
+ * An open window shows up as a sharp temperature drop. Left alone the PID
+ * answers it by opening the valve fully, which heats the street and causes
+ * overshoot once the window is closed again. This detector watches the
+ * filtered temperature stream and, when the drop rate exceeds a threshold,
+ * suspends PID control and clamps the valve for a configurable hold time.
+ *
+ * @par Slope Estimate
+ * The slope is taken between the newest sample and the oldest sample of a
+ * short sliding window (SLOPE_WINDOW_MS). Samples are kept in a small ring,
+ * so each update costs a handful of arithmetic operations. The ring keeps at
+ * most one sample per SAMPLE_SPACING_MS, so it spans the window at any
+ * sensor interval, including the 1 s minimum.
+ *
+ * @par Hysteresis
+ * After a hold expires the detector only re-arms once the drop rate has
+ * slowed below RELEASE_RATIO of the threshold, so a window left open does
+ * not retrigger immediately and the PID gets to respond.
+ *
+ * @see ConfigManager::getWindowOpenEnabled() for persisted settings
+ */
+
+#ifndef WINDOW_OPEN_DETECTOR_H
+#define WINDOW_OPEN_DETECTOR_H
+
+#include <Arduino.h>
+
+/**
+ * @class WindowOpenDetector
+ * @brief Detects rapid heat loss from the temperature slope
+ */
+class WindowOpenDetector {
+public:
+    /// Target span of the slope window in milliseconds
+    static constexpr uint32_t SLOPE_WINDOW_MS = 120000;
+
+    /// Minimum span before a slope is trusted (avoids triggering on two close samples)
+    static constexpr uint32_t MIN_SLOPE_SPAN_MS = 60000;
+
+    /// Re-arm once the drop rate falls below this fraction of the threshold
+    static constexpr float RELEASE_RATIO = 0.25f;
+
+    /// Ring capacity
+    static const uint8_t MAX_SAMPLES = 16;
+
+    /// Minimum spacing of stored samples; faster updates still refresh the slope
+    static constexpr uint32_t SAMPLE_SPACING_MS = SLOPE_WINDOW_MS / MAX_SAMPLES;
+
+    enum Event : uint8_t {
+        EVENT_NONE,
+        EVENT_OPENED,   ///< Heat loss detected, control suspended
+        EVENT_CLOSED    ///< Hold time elapsed, control resumed
+    };
+
+    WindowOpenDetector();
+
+    /**
+     * @brief Apply detector settings
+     * @param enabled false disables detection (an active hold is ended)
+     * @param dropRate Drop rate that triggers detection (°C per minute, positive)
+     * @param holdMs How long control stays suspended
+     * @param valvePosition Valve position applied while suspended (0-100%)
+     * @return EVENT_CLOSED if disabling ended an active hold, else EVENT_NONE
+     */
+    Event configure(bool enabled, float dropRate, uint32_t holdMs, float valvePosition);
+
+    bool isEnabled() const { return _enabled; }
+
+    /**
+     * @brief Feed one filtered temperature sample
+     * @param temperature Temperature in °C (NAN is ignored)
+     * @param now millis() timestamp of the sample
+     * @return Event raised by this sample, if any
+     */
+    Event update(float temperature, unsigned long now);
+
+    /**
+     * @brief Check whether control is currently suspended
+     */
+    bool isActive() const { return _active; }
+
+    /**
+     * @brief Valve position to apply while active (0-100%)
+     */
+    float getValvePosition() const { return _valvePosition; }
+
+    /**
+     * @brief Signed temperature slope of the last window (°C per minute)
+     */
+    float getSlope() const { return _slope; }
+
+    /**
+     * @brief Remaining hold time in milliseconds (0 when inactive)
+     */
+    unsigned long getRemainingMs(unsigned long now) const;
+
+    /**
+     * @brief Number of detections since boot
+     */
+    uint32_t getEventCount() const { return _eventCount; }
+
+    /**
+     * @brief Clear sample history and end any active hold (settings are kept)
+     */
+    void reset();
+
+private:
+    bool _enabled;
+    float _dropRate;
+    uint32_t _holdMs;
+    float _valvePosition;
+
+    float _temps[MAX_SAMPLES];
+    unsigned long _times[MAX_SAMPLES];
+    uint8_t _head;      // Index of the oldest sample
+    uint8_t _count;
+
+    float _slope;
+    bool _active;
+    bool _armed;
+    unsigned long _activeSince;
+    uint32_t _eventCount;
+};
+
+#endif // WINDOW_OPEN_DETECTOR_H
@@ -0,0 +1,100 @@
+#include "adaptive_sampler.h"
+#include "logger.h"
+#include <math.h>
+
+static const char* TAG = "SAMPLER";
+
+AdaptiveSampler::AdaptiveSampler()
+    : _enabled(false),
+      _minIntervalMs(10000),
+      _maxIntervalMs(120000),
+      _intervalMs(10000) {
+    reset();
+}
+
+void AdaptiveSampler::configure(bool enabled, uint32_t minIntervalMs, uint32_t maxIntervalMs) {
+    if (minIntervalMs == 0) {
+        minIntervalMs = 1000;
+    }
+    if (maxIntervalMs < minIntervalMs) {
+        maxIntervalMs = minIntervalMs;
+    }
+
+    _enabled = enabled;
+    _minIntervalMs = minIntervalMs;
+    _maxIntervalMs = maxIntervalMs;
+
+    // Restart from the fast end so a config change never leaves a stale long interval
+    _intervalMs = _minIntervalMs;
+
+    LOG_I(TAG, "Adaptive sampling %s (%lu-%lu ms)", enabled ? "enabled" : "disabled",
+          (unsigned long)_minIntervalMs, (unsigned long)_maxIntervalMs);
+}
+
+void AdaptiveSampler::noteControlState(float setpoint, float valvePosition) {
+    if (!_hasControlState) {
+        _lastSetpoint = setpoint;
+        _lastValvePosition = valvePosition;
+        _hasControlState = true;
+        return;
+    }
+
+    bool setpointChanged = fabsf(setpoint - _lastSetpoint) >= SETPOINT_CHANGE_C;
+    bool valveMoved = fabsf(valvePosition - _lastValvePosition) >= VALVE_CHANGE_PERCENT;
+    if (!setpointChanged && !valveMoved) {
+        return;
+    }
+
+    _lastSetpoint = setpoint;
+    _lastValvePosition = valvePosition;
+    if (_enabled && _intervalMs != _minIntervalMs) {
+        LOG_D(TAG, "%s - sampling every %lu ms", setpointChanged ? "Setpoint changed" : "Valve moved",
+              (unsigned long)_minIntervalMs);
+    }
+    _intervalMs = _minIntervalMs;
+}
+
+uint32_t AdaptiveSampler::recordSample(float temperature, unsigned long now) {
+    if (isnan(temperature)) {
+        return _intervalMs;
+    }
+
+    if (!_hasSample) {
+        _lastTemperature = temperature;
+        _lastSampleTime = now;
+        _hasSample = true;
+        return _intervalMs;
+    }
+
+    // Overflow-safe elapsed time; guard against back-to-back samples
+    unsigned long elapsed = now - _lastSampleTime;
+    if (elapsed == 0) {
+        return _intervalMs;
+    }
+
+    _lastSlope = fabsf(temperature - _lastTemperature) * 60000.0f / (float)elapsed;
+    _lastTemperature = temperature;
+    _lastSampleTime = now;
+
+    if (!_enabled) {
+        _intervalMs = _minIntervalMs;
+    } else if (_lastSlope >= SLOPE_FAST_C_PER_MIN) {
+        _intervalMs = _minIntervalMs;
+    } else if (_lastSlope < SLOPE_QUIET_C_PER_MIN) {
+        float stretched = _intervalMs * STRETCH_FACTOR;
+        _intervalMs = stretched >= (float)_maxIntervalMs ? _maxIntervalMs : (uint32_t)stretched;
+    }
+
+    return _intervalMs;
+}
+
+void AdaptiveSampler::reset() {
+    _intervalMs = _minIntervalMs;
+    _lastTemperature = NAN;
+    _lastSampleTime = 0;
+    _hasSample = false;
+    _lastSlope = 0.0f;
+    _lastSetpoint = NAN;
+    _lastValvePosition = NAN;
+    _hasControlState = false;
+}
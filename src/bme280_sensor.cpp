@@ -68,4 +68,19 @@ bool BME280Sensor::isHealthy() {
     // Try to read temperature and check if it's valid
     float temp = bme.readTemperature();
     return !isnan(temp);
-}
\ No newline at end of file
+}
+
+// Normal mode converts continuously - nothing to trigger
+bool BME280Sensor::startConversion() {
+    return initialized;
+}
+
+bool BME280Sensor::readSample(SensorSample& sample) {
+    if (!initialized) {
+        return false;
+    }
+    sample.temperature = readTemperature();
+    sample.humidity = readHumidity();
+    sample.pressure = readPressure();
+    return !isnan(sample.temperature);
+}
@@ -0,0 +1,67 @@
+#include "command_coalescer.h"
+#include <string.h>
+
+CommandCoalescer::CommandCoalescer(uint32_t quietMs, uint32_t maxDelayMs)
+    : _quietMs(quietMs),
+      _maxDelayMs(maxDelayMs < quietMs ? quietMs : maxDelayMs),
+      _firstInput(0),
+      _lastInput(0),
+      _received(0),
+      _committed(0) {
+    portMUX_INITIALIZE(&_lock);
+    memset(&_pending, 0, sizeof(_pending));
+}
+
+// Called with _lock held. Tasks stamp commands with their own millis()
+// reading, so a stamp may be slightly older than the newest one seen
+void CommandCoalescer::touch(uint32_t now) {
+    if (_pending.changes == 0) {
+        _firstInput = now;
+        _lastInput = now;
+    } else if ((int32_t)(now - _lastInput) > 0) {
+        _lastInput = now;
+    }
+    _received++;
+}
+
+void CommandCoalescer::setpoint(float value, uint32_t now) {
+    portENTER_CRITICAL(&_lock);
+    touch(now);
+    _pending.setpoint = value;
+    _pending.changes |= COALESCED_SETPOINT;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void CommandCoalescer::preset(const char* name, float temperature, uint32_t now) {
+    portENTER_CRITICAL(&_lock);
+    touch(now);
+    strncpy(_pending.preset, name, sizeof(_pending.preset) - 1);
+    _pending.preset[sizeof(_pending.preset) - 1] = '\0';
+    _pending.setpoint = temperature;
+    _pending.changes |= COALESCED_PRESET | COALESCED_SETPOINT;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void CommandCoalescer::mode(bool heat, uint32_t now) {
+    portENTER_CRITICAL(&_lock);
+    touch(now);
+    _pending.heat = heat;
+    _pending.changes |= COALESCED_MODE;
+    portEXIT_CRITICAL(&_lock);
+}
+
+bool CommandCoalescer::take(uint32_t now, CoalescedCommand& out) {
+    bool due = false;
+    portENTER_CRITICAL(&_lock);
+    // Signed: a command stamped after the caller read now must not wrap to "long ago"
+    if (_pending.changes != 0 &&
+        ((int32_t)(now - _lastInput) >= (int32_t)_quietMs ||
+         (int32_t)(now - _firstInput) >= (int32_t)_maxDelayMs)) {
+        out = _pending;
+        memset(&_pending, 0, sizeof(_pending));
+        _committed++;
+        due = true;
+    }
+    portEXIT_CRITICAL(&_lock);
+    return due;
+}
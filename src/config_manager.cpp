@@ -1,6 +1,7 @@
 #include "config_manager.h"
 #include "config.h"
 #include "logger.h"
+#include "telegraph_aggregate.h"
 #include <math.h>
 
 // Static tag for logging
@@ -28,6 +29,24 @@ float ConfigManager::roundToPrecision(float value, int decimals) {
     return roundf(value * multiplier) / multiplier;
 }
 
+bool ConfigManager::validateSetpoint(float value, float& setpoint) {
+    float rounded = roundToPrecision(value, 1);
+    if (isnan(rounded) || rounded < MIN_SETPOINT || rounded > MAX_SETPOINT) {
+        return false;
+    }
+    setpoint = rounded;
+    return true;
+}
+
+bool ConfigManager::parseSetpoint(const char* text, float& setpoint) {
+    char* end;
+    float value = strtof(text, &end);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    return validateSetpoint(value, setpoint);
+}
+
 bool ConfigManager::begin() {
     LOG_I(TAG, "Initializing configuration storage");
     if (!_preferences.begin("thermostat", false)) {
@@ -197,6 +216,31 @@ void ConfigManager::setMqttJsonAggregateEnabled(bool enabled) {
     _preferences.putBool("mqtt_json_agg", enabled);
 }
 
+bool ConfigManager::getMqttStateDocumentEnabled() {
+    return _preferences.getBool("mqtt_state_doc", false); // Default: a topic per state
+}
+
+void ConfigManager::setMqttStateDocumentEnabled(bool enabled) {
+    _preferences.putBool("mqtt_state_doc", enabled);
+}
+
+uint8_t ConfigManager::getMqttAggregateFormat() {
+    return _preferences.getUChar("mqtt_agg_fmt", TELEGRAPH_JSON) == TELEGRAPH_MSGPACK
+        ? TELEGRAPH_MSGPACK : TELEGRAPH_JSON;
+}
+
+void ConfigManager::setMqttAggregateFormat(uint8_t format) {
+    _preferences.putUChar("mqtt_agg_fmt", format);
+}
+
+uint8_t ConfigManager::getMqttAggregateFields() {
+    return _preferences.getUChar("mqtt_agg_fld", TELEGRAPH_ALL_FIELDS) & TELEGRAPH_ALL_FIELDS;
+}
+
+void ConfigManager::setMqttAggregateFields(uint8_t fields) {
+    _preferences.putUChar("mqtt_agg_fld", fields & TELEGRAPH_ALL_FIELDS);
+}
+
 // KNX settings
 uint8_t ConfigManager::getKnxArea() {
     return _preferences.getUChar("knx_area", DEFAULT_KNX_AREA);
@@ -353,6 +397,24 @@ uint32_t ConfigManager::getSensorUpdateInterval() {
 void ConfigManager::setSensorUpdateInterval(uint32_t interval) {
     _preferences.putUInt("sens_upd_int", interval);
 }
+bool ConfigManager::getAdaptiveSamplingEnabled() {
+    return _preferences.getBool("adapt_samp", false);  // Opt-in, fixed interval by default
+}
+void ConfigManager::setAdaptiveSamplingEnabled(bool enabled) {
+    _preferences.putBool("adapt_samp", enabled);
+}
+uint32_t ConfigManager::getSensorMinInterval() {
+    return _preferences.getUInt("sens_min_int", DEFAULT_SENSOR_MIN_INTERVAL_MS);
+}
+void ConfigManager::setSensorMinInterval(uint32_t interval) {
+    _preferences.putUInt("sens_min_int", interval);
+}
+uint32_t ConfigManager::getSensorMaxInterval() {
+    return _preferences.getUInt("sens_max_int", DEFAULT_SENSOR_MAX_INTERVAL_MS);
+}
+void ConfigManager::setSensorMaxInterval(uint32_t interval) {
+    _preferences.putUInt("sens_max_int", interval);
+}
 uint32_t ConfigManager::getHistoryUpdateInterval() {
     return _preferences.getUInt("hist_upd_int", DEFAULT_HISTORY_UPDATE_INTERVAL_MS);
 }
@@ -421,11 +483,183 @@ void ConfigManager::setAdaptationEnabled(bool enabled) {
     _preferences.putBool("adapt_en", enabled);
 }
 
+// Sensor filter settings
+uint8_t ConfigManager::getFilterMedianWindow() {
+    return _preferences.getUChar("flt_median", DEFAULT_FILTER_MEDIAN_WINDOW);
+}
+void ConfigManager::setFilterMedianWindow(uint8_t window) {
+    _preferences.putUChar("flt_median", window);
+}
+uint8_t ConfigManager::getFilterSmoothing() {
+    return _preferences.getUChar("flt_mode", DEFAULT_FILTER_SMOOTHING);
+}
+void ConfigManager::setFilterSmoothing(uint8_t mode) {
+    _preferences.putUChar("flt_mode", mode);
+}
+float ConfigManager::getFilterEmaAlpha() {
+    return roundToPrecision(_preferences.getFloat("flt_alpha", DEFAULT_FILTER_EMA_ALPHA), 2);
+}
+void ConfigManager::setFilterEmaAlpha(float alpha) {
+    _preferences.putFloat("flt_alpha", roundToPrecision(alpha, 2));
+}
+float ConfigManager::getFilterKalmanQ() {
+    return _preferences.getFloat("flt_kal_q", DEFAULT_FILTER_KALMAN_Q);
+}
+void ConfigManager::setFilterKalmanQ(float q) {
+    _preferences.putFloat("flt_kal_q", q);
+}
+float ConfigManager::getFilterKalmanR() {
+    return _preferences.getFloat("flt_kal_r", DEFAULT_FILTER_KALMAN_R);
+}
+void ConfigManager::setFilterKalmanR(float r) {
+    _preferences.putFloat("flt_kal_r", r);
+}
+float ConfigManager::getFilterOutlierThreshold() {
+    return roundToPrecision(_preferences.getFloat("flt_gate", DEFAULT_FILTER_OUTLIER_THRESHOLD), 1);
+}
+void ConfigManager::setFilterOutlierThreshold(float threshold) {
+    _preferences.putFloat("flt_gate", roundToPrecision(threshold, 1));
+}
+
+// Window-open detection settings
+bool ConfigManager::getWindowOpenEnabled() {
+    return _preferences.getBool("wo_enabled", DEFAULT_WINDOW_OPEN_ENABLED);
+}
+void ConfigManager::setWindowOpenEnabled(bool enabled) {
+    _preferences.putBool("wo_enabled", enabled);
+}
+float ConfigManager::getWindowOpenDropRate() {
+    return roundToPrecision(_preferences.getFloat("wo_drop", DEFAULT_WINDOW_OPEN_DROP_RATE), 2);
+}
+void ConfigManager::setWindowOpenDropRate(float rate) {
+    _preferences.putFloat("wo_drop", roundToPrecision(rate, 2));
+}
+uint32_t ConfigManager::getWindowOpenHoldTime() {
+    return _preferences.getUInt("wo_hold", DEFAULT_WINDOW_OPEN_HOLD_SEC);
+}
+void ConfigManager::setWindowOpenHoldTime(uint32_t seconds) {
+    _preferences.putUInt("wo_hold", seconds);
+}
+uint8_t ConfigManager::getWindowOpenValvePosition() {
+    return _preferences.getUChar("wo_valve", DEFAULT_WINDOW_OPEN_VALVE_POSITION);
+}
+void ConfigManager::setWindowOpenValvePosition(uint8_t position) {
+    _preferences.putUChar("wo_valve", position);
+}
+
+// Logging settings
+static const char* LOG_LEVEL_NAMES[] = {"none", "error", "warning", "info", "debug", "verbose"};
+static const uint8_t LOG_LEVEL_MAX = 5;
+static const size_t LOG_TAG_MAX_LENGTH = 15;
+
+uint8_t ConfigManager::getLogLevel() {
+    return _preferences.getUChar("log_level", DEFAULT_LOG_LEVEL);
+}
+void ConfigManager::setLogLevel(uint8_t level) {
+    _preferences.putUChar("log_level", level <= LOG_LEVEL_MAX ? level : LOG_LEVEL_MAX);
+}
+String ConfigManager::getLogTagLevels() {
+    return _preferences.getString("log_tags", "");
+}
+void ConfigManager::setLogTagLevels(const String& levels) {
+    _preferences.putString("log_tags", levels);
+}
+
+bool ConfigManager::setLogTagLevel(const char* tag, int level) {
+    size_t tagLength = tag ? strlen(tag) : 0;
+    if (tagLength == 0 || tagLength > LOG_TAG_MAX_LENGTH || strpbrk(tag, ",=") != nullptr) {
+        return false;
+    }
+
+    // Rebuild the list without this tag, then append its new level
+    String current = getLogTagLevels();
+    String updated;
+    uint8_t count = 0;
+    const char* cursor = current.c_str();
+    char existing[LOG_TAG_MAX_LENGTH + 1];
+    uint8_t existingLevel;
+    while (nextLogTagLevel(cursor, existing, sizeof(existing), existingLevel)) {
+        if (strcmp(existing, tag) == 0) {
+            continue;
+        }
+        if (updated.length() > 0) updated += ',';
+        updated += existing;
+        updated += '=';
+        updated += (char)('0' + existingLevel);
+        count++;
+    }
+
+    if (level >= 0) {
+        if (count >= MAX_LOG_TAG_LEVELS) {
+            return false;
+        }
+        if (updated.length() > 0) updated += ',';
+        updated += tag;
+        updated += '=';
+        updated += (char)('0' + (level <= LOG_LEVEL_MAX ? level : LOG_LEVEL_MAX));
+    }
+
+    setLogTagLevels(updated);
+    return true;
+}
+
+bool ConfigManager::nextLogTagLevel(const char*& cursor, char* tag, size_t tagSize, uint8_t& level) {
+    while (cursor != nullptr && *cursor) {
+        const char* entry = cursor;
+        const char* end = strchr(entry, ',');
+        if (end == nullptr) {
+            end = entry + strlen(entry);
+        }
+        cursor = *end ? end + 1 : end;
+
+        // Skip malformed entries rather than dropping the rest of the list
+        const char* eq = static_cast<const char*>(memchr(entry, '=', end - entry));
+        if (eq == nullptr || eq == entry || (size_t)(eq - entry) >= tagSize) {
+            continue;
+        }
+        memcpy(tag, entry, eq - entry);
+        tag[eq - entry] = '\0';
+        int parsed = atoi(eq + 1);
+        level = parsed < 0 ? 0 : (parsed > LOG_LEVEL_MAX ? LOG_LEVEL_MAX : parsed);
+        return true;
+    }
+    return false;
+}
+
+int ConfigManager::parseLogLevel(const char* name) {
+    if (name == nullptr || *name == '\0') {
+        return -1;
+    }
+    if (name[0] >= '0' && name[0] <= '9' && name[1] == '\0') {
+        return name[0] - '0' <= LOG_LEVEL_MAX ? name[0] - '0' : -1;
+    }
+    if (strcasecmp(name, "warn") == 0) {
+        return 2;
+    }
+    for (uint8_t i = 0; i <= LOG_LEVEL_MAX; i++) {
+        if (strcasecmp(name, LOG_LEVEL_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* ConfigManager::logLevelName(uint8_t level) {
+    return LOG_LEVEL_NAMES[level <= LOG_LEVEL_MAX ? level : LOG_LEVEL_MAX];
+}
+
 // Preset mode settings
 String ConfigManager::getCurrentPreset() {
     return _preferences.getString("preset_cur", "none");
 }
 
+const char* ConfigManager::getCurrentPreset(char* out, size_t size) {
+    if (_preferences.getString("preset_cur", out, size) == 0) {
+        snprintf(out, size, "none");
+    }
+    return out;
+}
+
 void ConfigManager::setCurrentPreset(const String& preset) {
     _preferences.putString("preset_cur", preset);
 }
@@ -542,6 +776,15 @@ void ConfigManager::getJson(JsonDocument& doc) {
     doc["mqtt"]["username"] = getMqttUsername();
     doc["mqtt"]["password"] = "**********"; // Don't expose password in JSON
     doc["mqtt"]["json_aggregate_enabled"] = getMqttJsonAggregateEnabled();
+    doc["mqtt"]["state_document_enabled"] = getMqttStateDocumentEnabled();
+    doc["mqtt"]["aggregate_format"] = telegraphFormatName((TelegraphFormat)getMqttAggregateFormat());
+    JsonArray aggregateFields = doc["mqtt"].createNestedArray("aggregate_fields");
+    uint8_t fields = getMqttAggregateFields();
+    for (uint8_t i = 0; i < TELEGRAPH_FIELD_GROUPS; i++) {
+        if (fields & (1 << i)) {
+            aggregateFields.add(telegraphFieldName(i));
+        }
+    }
     
     doc["knx"]["area"] = getKnxArea();
     doc["knx"]["line"] = getKnxLine();
@@ -586,6 +829,9 @@ void ConfigManager::getJson(JsonDocument& doc) {
 
     // Add timing parameters
     doc["timing"]["sensor_update_interval"] = getSensorUpdateInterval();
+    doc["timing"]["adaptive_sampling"] = getAdaptiveSamplingEnabled();
+    doc["timing"]["sensor_min_interval"] = getSensorMinInterval();
+    doc["timing"]["sensor_max_interval"] = getSensorMaxInterval();
     doc["timing"]["history_update_interval"] = getHistoryUpdateInterval();
     doc["timing"]["pid_update_interval"] = getPidUpdateInterval();
     doc["timing"]["connectivity_check_interval"] = getConnectivityCheckInterval();
@@ -595,6 +841,33 @@ void ConfigManager::getJson(JsonDocument& doc) {
     doc["timing"]["system_watchdog_timeout"] = getSystemWatchdogTimeout();
     doc["timing"]["wifi_watchdog_timeout"] = getWifiWatchdogTimeout();
 
+    // Add sensor filter parameters
+    static const char* smoothingNames[] = {"none", "ema", "kalman"};
+    uint8_t smoothing = getFilterSmoothing();
+    doc["filter"]["median_window"] = getFilterMedianWindow();
+    doc["filter"]["smoothing"] = smoothingNames[smoothing <= 2 ? smoothing : 0];
+    doc["filter"]["ema_alpha"] = getFilterEmaAlpha();
+    doc["filter"]["kalman_q"] = getFilterKalmanQ();
+    doc["filter"]["kalman_r"] = getFilterKalmanR();
+    doc["filter"]["outlier_threshold"] = getFilterOutlierThreshold();
+
+    // Add window-open detection parameters
+    doc["window_open"]["enabled"] = getWindowOpenEnabled();
+    doc["window_open"]["drop_rate"] = getWindowOpenDropRate();
+    doc["window_open"]["hold_time"] = getWindowOpenHoldTime();
+    doc["window_open"]["valve_position"] = getWindowOpenValvePosition();
+
+    // Add logging levels (global and per tag)
+    doc["logging"]["level"] = logLevelName(getLogLevel());
+    JsonObject tagLevels = doc["logging"].createNestedObject("tags");
+    String levels = getLogTagLevels();
+    const char* cursor = levels.c_str();
+    char tag[LOG_TAG_MAX_LENGTH + 1];
+    uint8_t level;
+    while (nextLogTagLevel(cursor, tag, sizeof(tag), level)) {
+        tagLevels[tag] = logLevelName(level);
+    }
+
     // Add webhook parameters
     doc["webhook"]["enabled"] = getWebhookEnabled();
     doc["webhook"]["url"] = getWebhookUrl();
@@ -746,6 +1019,52 @@ bool ConfigManager::validateAndApplyMQTTSettings(const JsonDocument& doc, String
         setMqttJsonAggregateEnabled(doc["mqtt"]["json_aggregate_enabled"].as<bool>());
         LOG_D(TAG, "MQTT JSON aggregate enabled: %s", doc["mqtt"]["json_aggregate_enabled"].as<bool>() ? "true" : "false");
     }
+
+    if (doc["mqtt"].containsKey("state_document_enabled")) {
+        setMqttStateDocumentEnabled(doc["mqtt"]["state_document_enabled"].as<bool>());
+        LOG_D(TAG, "MQTT state document enabled: %s", doc["mqtt"]["state_document_enabled"].as<bool>() ? "true" : "false");
+    }
+
+    // Validate both aggregate settings before storing either
+    int aggregateFormat = -1;
+    if (doc["mqtt"].containsKey("aggregate_format")) {
+        aggregateFormat = parseTelegraphFormat(doc["mqtt"]["aggregate_format"] | "");
+        if (aggregateFormat < 0) {
+            errorMessage = "MQTT aggregate format must be json or msgpack";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+    }
+
+    int aggregateFields = -1;
+    if (doc["mqtt"].containsKey("aggregate_fields")) {
+        JsonArrayConst names = doc["mqtt"]["aggregate_fields"].as<JsonArrayConst>();
+        if (names.isNull()) {
+            errorMessage = "MQTT aggregate fields must be a list of field groups";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        aggregateFields = 0;
+        for (JsonVariantConst name : names) {
+            uint8_t bit = telegraphFieldBit(name | "");
+            if (bit == 0) {
+                errorMessage = "Unknown MQTT aggregate field group: ";
+                errorMessage += name | "?";
+                LOG_W(TAG, "%s", errorMessage.c_str());
+                return false;
+            }
+            aggregateFields |= bit;
+        }
+    }
+
+    if (aggregateFormat >= 0) {
+        setMqttAggregateFormat((uint8_t)aggregateFormat);
+        LOG_D(TAG, "MQTT aggregate format: %s", telegraphFormatName((TelegraphFormat)aggregateFormat));
+    }
+    if (aggregateFields >= 0) {
+        setMqttAggregateFields((uint8_t)aggregateFields);
+        LOG_D(TAG, "MQTT aggregate fields: 0x%02x", aggregateFields);
+    }
     
     return true;
 }
@@ -921,9 +1240,8 @@ bool ConfigManager::validateAndApplyPIDSettings(const JsonDocument& doc, String&
         setPidKd(kd);
     }
     if (doc["pid"].containsKey("setpoint")) {
-        float setpoint = roundToPrecision(doc["pid"]["setpoint"].as<float>(), 1);
-        LOG_D(TAG, "Parsed setpoint: %.1f (rounded)", setpoint);
-        if (setpoint < 5 || setpoint > 30) {
+        float setpoint;
+        if (!validateSetpoint(doc["pid"]["setpoint"].as<float>(), setpoint)) {
             errorMessage = "Temperature setpoint must be between 5°C and 30°C";
             LOG_W(TAG, "%s", errorMessage.c_str());
             return false;
@@ -1004,6 +1322,22 @@ bool ConfigManager::validateAndApplyTimingSettings(const JsonDocument& doc, Stri
         }
         setSensorUpdateInterval(interval);
     }
+    if (doc["timing"].containsKey("adaptive_sampling")) {
+        setAdaptiveSamplingEnabled(doc["timing"]["adaptive_sampling"].as<bool>());
+    }
+    if (doc["timing"].containsKey("sensor_min_interval") || doc["timing"].containsKey("sensor_max_interval")) {
+        uint32_t minInterval = doc["timing"].containsKey("sensor_min_interval") ?
+            doc["timing"]["sensor_min_interval"].as<uint32_t>() : getSensorMinInterval();
+        uint32_t maxInterval = doc["timing"].containsKey("sensor_max_interval") ?
+            doc["timing"]["sensor_max_interval"].as<uint32_t>() : getSensorMaxInterval();
+        if (minInterval < 3000 || maxInterval > 600000 || minInterval > maxInterval) {
+            errorMessage = "Adaptive sampling bounds must satisfy 3000ms <= min <= max <= 600000ms";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setSensorMinInterval(minInterval);
+        setSensorMaxInterval(maxInterval);
+    }
     if (doc["timing"].containsKey("history_update_interval")) {
         uint32_t interval = doc["timing"]["history_update_interval"].as<uint32_t>();
         if (interval < 3000 || interval > 3600000) {
@@ -1140,6 +1474,9 @@ bool ConfigManager::setFromJson(const JsonDocument& doc, String& errorMessage) {
     if (!validateAndApplyTimingSettings(doc, errorMessage)) return false;
     if (!validateAndApplyWebhookSettings(doc, errorMessage)) return false;
     if (!validateAndApplyPresetSettings(doc, errorMessage)) return false;
+    if (!validateAndApplyFilterSettings(doc, errorMessage)) return false;
+    if (!validateAndApplyWindowOpenSettings(doc, errorMessage)) return false;
+    if (!validateAndApplyLoggingSettings(doc, errorMessage)) return false;
     LOG_I(TAG, "Configuration imported successfully");
     return true;
 }
@@ -1180,6 +1517,186 @@ bool ConfigManager::validateAndApplyPresetSettings(const JsonDocument& doc, Stri
 }
 
 
+bool ConfigManager::validateAndApplyFilterSettings(const JsonDocument& doc, String& errorMessage) {
+    if (!doc.containsKey("filter")) {
+        return true;  // Filter section is optional
+    }
+
+    if (doc["filter"].containsKey("median_window")) {
+        uint8_t window = doc["filter"]["median_window"].as<uint8_t>();
+        if (window != 1 && window != 3 && window != 5) {
+            errorMessage = "Median window must be 1 (off), 3 or 5 samples";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setFilterMedianWindow(window);
+    }
+    if (doc["filter"].containsKey("smoothing")) {
+        String mode = doc["filter"]["smoothing"].as<String>();
+        if (mode == "none") {
+            setFilterSmoothing(0);
+        } else if (mode == "ema") {
+            setFilterSmoothing(1);
+        } else if (mode == "kalman") {
+            setFilterSmoothing(2);
+        } else {
+            errorMessage = "Invalid smoothing mode: must be none, ema or kalman";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+    }
+    if (doc["filter"].containsKey("ema_alpha")) {
+        float alpha = doc["filter"]["ema_alpha"].as<float>();
+        if (alpha < 0.05f || alpha > 1.0f) {
+            errorMessage = "EMA alpha must be between 0.05 and 1.0";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setFilterEmaAlpha(alpha);
+    }
+    if (doc["filter"].containsKey("kalman_q")) {
+        float q = doc["filter"]["kalman_q"].as<float>();
+        if (q <= 0.0f || q > 1.0f) {
+            errorMessage = "Kalman process noise must be between 0 and 1";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setFilterKalmanQ(q);
+    }
+    if (doc["filter"].containsKey("kalman_r")) {
+        float r = doc["filter"]["kalman_r"].as<float>();
+        if (r <= 0.0f || r > 10.0f) {
+            errorMessage = "Kalman measurement noise must be between 0 and 10";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setFilterKalmanR(r);
+    }
+    if (doc["filter"].containsKey("outlier_threshold")) {
+        float threshold = doc["filter"]["outlier_threshold"].as<float>();
+        if (threshold < 0.0f || threshold > 20.0f) {
+            errorMessage = "Outlier threshold must be between 0 (off) and 20°C";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setFilterOutlierThreshold(threshold);
+    }
+
+    return true;
+}
+
+bool ConfigManager::validateAndApplyWindowOpenSettings(const JsonDocument& doc, String& errorMessage) {
+    if (!doc.containsKey("window_open")) {
+        return true;  // Window-open section is optional
+    }
+
+    if (doc["window_open"].containsKey("enabled")) {
+        setWindowOpenEnabled(doc["window_open"]["enabled"].as<bool>());
+    }
+    if (doc["window_open"].containsKey("drop_rate")) {
+        float rate = doc["window_open"]["drop_rate"].as<float>();
+        if (rate < 0.05f || rate > 5.0f) {
+            errorMessage = "Window-open drop rate must be between 0.05 and 5.0 °C/min";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setWindowOpenDropRate(rate);
+    }
+    if (doc["window_open"].containsKey("hold_time")) {
+        uint32_t hold = doc["window_open"]["hold_time"].as<uint32_t>();
+        if (hold < 60 || hold > 7200) {
+            errorMessage = "Window-open hold time must be between 60 and 7200 seconds";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setWindowOpenHoldTime(hold);
+    }
+    if (doc["window_open"].containsKey("valve_position")) {
+        int position = doc["window_open"]["valve_position"].as<int>();
+        if (position < 0 || position > 100) {
+            errorMessage = "Window-open valve position must be between 0 and 100%";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+        setWindowOpenValvePosition(position);
+    }
+
+    return true;
+}
+
+// Accepts a level name ("debug") or number (4); returns -1 if invalid
+static int jsonLogLevel(JsonVariantConst value) {
+    if (value.is<int>()) {
+        int level = value.as<int>();
+        return (level >= 0 && level <= LOG_LEVEL_MAX) ? level : -1;
+    }
+    return ConfigManager::parseLogLevel(value.as<const char*>());
+}
+
+bool ConfigManager::validateAndApplyLoggingSettings(const JsonDocument& doc, String& errorMessage) {
+    if (!doc.containsKey("logging")) {
+        return true;  // Logging section is optional
+    }
+
+    int level = -1;
+    if (doc["logging"].containsKey("level")) {
+        level = jsonLogLevel(doc["logging"]["level"]);
+        if (level < 0) {
+            errorMessage = "Log level must be one of none, error, warning, info, debug, verbose";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+    }
+
+    // "tags" replaces the whole per-tag list; null or "default" drops a tag's override
+    String tagLevels;
+    bool hasTags = doc["logging"].containsKey("tags");
+    if (hasTags) {
+        JsonObjectConst tags = doc["logging"]["tags"].as<JsonObjectConst>();
+        if (tags.isNull()) {
+            errorMessage = "Log tags must be an object of tag: level pairs";
+            LOG_W(TAG, "%s", errorMessage.c_str());
+            return false;
+        }
+
+        uint8_t count = 0;
+        for (JsonPairConst pair : tags) {
+            const char* tag = pair.key().c_str();
+            if (pair.value().isNull() || (pair.value().is<const char*>() &&
+                                          strcasecmp(pair.value().as<const char*>(), "default") == 0)) {
+                continue;
+            }
+            int tagLevel = jsonLogLevel(pair.value());
+            size_t tagLength = strlen(tag);
+            if (tagLevel < 0 || tagLength == 0 || tagLength > LOG_TAG_MAX_LENGTH ||
+                strpbrk(tag, ",=") != nullptr) {
+                errorMessage = "Invalid log level for tag ";
+                errorMessage += tag;
+                LOG_W(TAG, "%s", errorMessage.c_str());
+                return false;
+            }
+            if (++count > MAX_LOG_TAG_LEVELS) {
+                errorMessage = "Too many per-tag log levels";
+                LOG_W(TAG, "%s", errorMessage.c_str());
+                return false;
+            }
+            if (tagLevels.length() > 0) tagLevels += ',';
+            tagLevels += tag;
+            tagLevels += '=';
+            tagLevels += (char)('0' + tagLevel);
+        }
+    }
+
+    // Validate everything before storing anything
+    if (level >= 0) {
+        setLogLevel(level);
+    }
+    if (hasTags) {
+        setLogTagLevels(tagLevels);
+    }
+    return true;
+}
+
 void ConfigManager::setLastRebootReason(const String& reason) {
     _preferences.putString("reboot_reason", reason);
 }
@@ -0,0 +1,133 @@
+#include "console_commands.h"
+#include "serial_console.h"
+#include "logger.h"
+#include "config_manager.h"
+#include "history_manager.h"
+#include "adaptive_pid_controller.h"
+#include "serial_monitor.h"
+#include "command_coalescer.h"
+#include <esp_heap_caps.h>
+
+// Globals from main.cpp
+extern CommandCoalescer commandCoalescer;
+extern unsigned long g_lastSensorUpdate;
+extern unsigned long g_lastHistoryUpdate;
+extern unsigned long g_historyUpdateCount;
+extern unsigned long g_sensorUpdateCount;
+extern void applyLoggingConfig();
+
+// Main loop timing since the last "perf reset"
+static uint32_t loopCount = 0;
+static uint64_t loopTotalMicros = 0;
+static uint32_t loopMaxMicros = 0;
+static unsigned long loopStatsSince = 0;
+
+void recordLoopTime(uint32_t micros) {
+    loopCount++;
+    loopTotalMicros += micros;
+    if (micros > loopMaxMicros) {
+        loopMaxMicros = micros;
+    }
+}
+
+static void cmdPerf(int argc, char** argv, Print& out) {
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        loopCount = 0;
+        loopTotalMicros = 0;
+        loopMaxMicros = 0;
+        loopStatsSince = millis();
+        SerialConsole::printf(out, "Loop counters reset\n");
+        return;
+    }
+
+    Logger& logger = Logger::getInstance();
+    unsigned long now = millis();
+    SerialConsole::printf(out, "Uptime:        %lu s\n", now / 1000);
+    SerialConsole::printf(out, "Loop:          %lu passes in %lu s, avg %lu us, max %lu us\n",
+                          (unsigned long)loopCount, (now - loopStatsSince) / 1000,
+                          (unsigned long)(loopCount > 0 ? loopTotalMicros / loopCount : 0),
+                          (unsigned long)loopMaxMicros);
+    SerialConsole::printf(out, "Log:           %lu queued, %lu dropped, %lu suppressed\n",
+                          (unsigned long)logger.getQueuedCount(), (unsigned long)logger.getDroppedCount(),
+                          (unsigned long)logger.getSuppressedCount());
+    SerialConsole::printf(out, "Sensor:        %lu updates, last %lu ms ago\n",
+                          g_sensorUpdateCount, now - g_lastSensorUpdate);
+    SerialConsole::printf(out, "Web monitor:   %u client(s)\n",
+                          (unsigned)SerialMonitor::getInstance().getClientCount());
+}
+
+static void cmdHeap(int argc, char** argv, Print& out) {
+    (void)argc;
+    (void)argv;
+    uint32_t freeHeap = ESP.getFreeHeap();
+    size_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    SerialConsole::printf(out, "Free:          %lu of %lu bytes\n",
+                          (unsigned long)freeHeap, (unsigned long)ESP.getHeapSize());
+    SerialConsole::printf(out, "Minimum free:  %lu bytes\n", (unsigned long)ESP.getMinFreeHeap());
+    SerialConsole::printf(out, "Largest block: %lu bytes (fragmentation %.1f%%)\n",
+                          (unsigned long)largestBlock,
+                          freeHeap > 0 ? 100.0f * (1.0f - (float)largestBlock / freeHeap) : 0.0f);
+}
+
+static void cmdHist(int argc, char** argv, Print& out) {
+    (void)argc;
+    (void)argv;
+    unsigned long now = millis();
+    SerialConsole::printf(out, "Points:        %d\n", HistoryManager::getInstance()->getDataPointCount());
+    SerialConsole::printf(out, "Updates:       %lu, last %lu ms ago (interval %lu ms)\n",
+                          g_historyUpdateCount, now - g_lastHistoryUpdate,
+                          (unsigned long)ConfigManager::getInstance()->getHistoryUpdateInterval());
+}
+
+static void cmdLog(int argc, char** argv, Print& out) {
+    Logger& logger = Logger::getInstance();
+    if (argc == 1) {
+        SerialConsole::printf(out, "Log level %s (log <level> | log <tag> <level> | log reset)\n",
+                              ConfigManager::logLevelName(logger.getLogLevel()));
+        return;
+    }
+    if (argc == 2 && strcasecmp(argv[1], "reset") == 0) {
+        applyLoggingConfig();
+        SerialConsole::printf(out, "Configured log levels restored\n");
+        return;
+    }
+
+    int level = ConfigManager::parseLogLevel(argv[argc - 1]);
+    if (level < 0) {
+        SerialConsole::printf(out, "Unknown level '%s'\n", argv[argc - 1]);
+        return;
+    }
+    if (argc == 2) {
+        logger.setLogLevel((LogLevel)level);
+        SerialConsole::printf(out, "Log level %s (until restart)\n", ConfigManager::logLevelName(level));
+    } else {
+        logger.setTagLevel(argv[1], (LogLevel)level);
+        SerialConsole::printf(out, "%s logs at %s (until restart)\n", argv[1], ConfigManager::logLevelName(level));
+    }
+}
+
+static void cmdSetpoint(int argc, char** argv, Print& out) {
+    if (argc < 2) {
+        SerialConsole::printf(out, "Setpoint %.1f C\n", g_pid_input.setpoint_temp);
+        return;
+    }
+
+    // Same validation, rounding and side effects as POST /api/setpoint and MQTT
+    float setpoint;
+    if (!ConfigManager::parseSetpoint(argv[1], setpoint)) {
+        SerialConsole::printf(out, "Setpoint must be between 5 and 30 C\n");
+        return;
+    }
+    setTemperatureSetpoint(setpoint);
+    commandCoalescer.setpoint(setpoint, millis());
+    SerialConsole::printf(out, "Setpoint set to %.1f C\n", setpoint);
+}
+
+void registerConsoleCommands() {
+    SerialConsole& console = SerialConsole::getInstance();
+    console.addCommand("perf", "Loop timing and log counters (perf reset)", cmdPerf);
+    console.addCommand("heap", "Heap usage and fragmentation", cmdHeap);
+    console.addCommand("hist", "History buffer statistics", cmdHist);
+    console.addCommand("log", "Show or change log levels (not saved)", cmdLog);
+    console.addCommand("setpoint", "Show or set the temperature setpoint", cmdSetpoint);
+}
@@ -0,0 +1,69 @@
+#include "ds18b20_sensor.h"
+#include "logger.h"
+
+static const char* TAG = "DS18B20";
+
+static const uint8_t DS18B20_CMD_CONVERT_T = 0x44;
+static const uint8_t DS18B20_CMD_READ_SCRATCHPAD = 0xBE;
+
+// Configuration register (scratchpad byte 4): bit 7 reads 0 and bits 4-0
+// read 1; bits 6-5 hold the resolution
+static const uint8_t DS18B20_CONFIG_RESERVED_MASK = 0x9F;
+static const uint8_t DS18B20_CONFIG_RESERVED_BITS = 0x1F;
+
+// Power-on reset value of the temperature register (85.0°C)
+static const int16_t DS18B20_POWER_ON_RAW = 0x0550;
+
+Ds18b20Sensor::Ds18b20Sensor(uint8_t pin) : _oneWire(pin), _firstConversion(true) {
+}
+
+bool Ds18b20Sensor::begin() {
+    // reset() returns 1 when a device answers with a presence pulse
+    if (!_oneWire.reset()) {
+        LOG_W(TAG, "No presence pulse on 1-Wire bus");
+        return false;
+    }
+    return true;
+}
+
+bool Ds18b20Sensor::startConversion() {
+    if (!_oneWire.reset()) {
+        return false;
+    }
+    _oneWire.skip();
+    _oneWire.write(DS18B20_CMD_CONVERT_T, 0);  // Externally powered, no strong pull-up
+    return true;
+}
+
+bool Ds18b20Sensor::readSample(SensorSample& sample) {
+    if (!_oneWire.reset()) {
+        return false;
+    }
+    _oneWire.skip();
+    _oneWire.write(DS18B20_CMD_READ_SCRATCHPAD);
+
+    uint8_t scratchpad[9];
+    _oneWire.read_bytes(scratchpad, sizeof(scratchpad));
+    if (OneWire::crc8(scratchpad, 8) != scratchpad[8]) {
+        LOG_D(TAG, "Scratchpad CRC mismatch");
+        return false;
+    }
+
+    // A shorted or stuck-low bus reads all zeros, which also passes the CRC
+    if ((scratchpad[4] & DS18B20_CONFIG_RESERVED_MASK) != DS18B20_CONFIG_RESERVED_BITS) {
+        LOG_D(TAG, "Scratchpad config register invalid (0x%02X)", scratchpad[4]);
+        return false;
+    }
+
+    int16_t raw = (int16_t)(((uint16_t)scratchpad[1] << 8) | scratchpad[0]);
+
+    // A first reading of exactly 85°C is the power-on value, not a measurement
+    if (_firstConversion && raw == DS18B20_POWER_ON_RAW) {
+        _firstConversion = false;
+        return false;
+    }
+    _firstConversion = false;
+
+    sample.temperature = raw / 16.0f;
+    return true;
+}
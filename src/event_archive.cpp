@@ -0,0 +1,468 @@
+#include "event_archive.h"
+#include "serial_redirect.h"
+
+// Redirect Serial to CapturedSerial for web monitor
+#define Serial CapturedSerial
+
+static const char* ARCHIVE_DIR = "/evarch";
+static const uint8_t PAGE_SYNC = 0xA7;
+static const uint8_t PAGE_VERSION = 1;
+static const size_t PAGE_CRC_OFFSET = 16;
+
+struct PageHeader {
+    uint16_t rawLength;
+    uint16_t compressedLength;
+    uint16_t records;
+    uint32_t firstSeq;
+    uint32_t firstTimestamp;
+    uint32_t crc;
+};
+
+static void putU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void putU32(uint8_t* out, uint32_t value) {
+    putU16(out, (uint16_t)value);
+    putU16(out + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return getU16(in) | ((uint32_t)getU16(in + 2) << 16);
+}
+
+static void encodeHeader(uint8_t* out, const PageHeader& header) {
+    out[0] = PAGE_SYNC;
+    out[1] = PAGE_VERSION;
+    putU16(out + 2, header.rawLength);
+    putU16(out + 4, header.compressedLength);
+    putU16(out + 6, header.records);
+    putU32(out + 8, header.firstSeq);
+    putU32(out + 12, header.firstTimestamp);
+    putU32(out + PAGE_CRC_OFFSET, header.crc);
+}
+
+// Parse a complete page header; unwritten (torn) and nonsensical headers fail
+static bool decodeHeader(const uint8_t* in, PageHeader& header) {
+    if (in[0] != PAGE_SYNC || in[1] != PAGE_VERSION) {
+        return false;
+    }
+    header.rawLength = getU16(in + 2);
+    header.compressedLength = getU16(in + 4);
+    header.records = getU16(in + 6);
+    header.firstSeq = getU32(in + 8);
+    header.firstTimestamp = getU32(in + 12);
+    header.crc = getU32(in + PAGE_CRC_OFFSET);
+    return header.compressedLength > 0 && header.records > 0 &&
+           header.rawLength <= header.records * EventJournal::MAX_COMPACT_SIZE;
+}
+
+// Segment number from a file name like "/evarch/12.lz" or "12.lz"; 0 if not a segment
+static uint32_t parseSegmentName(const char* name) {
+    const char* base = strrchr(name, '/');
+    base = base ? base + 1 : name;
+    char* end;
+    unsigned long segment = strtoul(base, &end, 10);
+    return (end != base && strcmp(end, ".lz") == 0) ? segment : 0;
+}
+
+void EventArchive::segmentPath(char* path, size_t size, uint32_t segment) {
+    snprintf(path, size, "%s/%lu.lz", ARCHIVE_DIR, (unsigned long)segment);
+}
+
+EventArchive::EventArchive()
+    : _ready(false),
+      _pageOpen(false),
+      _pageFailed(false),
+      _pageStart(0),
+      _pageFirstSeq(0),
+      _pageFirstTimestamp(0),
+      _pageLastTimestamp(0),
+      _pageRecords(0),
+      _pageRawLength(0),
+      _pageCrc(0),
+      _firstSegment(1),
+      _lastSegment(0),
+      _lastSegmentSize(0),
+      _lastSegmentClosed(false),
+      _size(0),
+      _endSeq(0)
+{
+    publish();
+}
+
+void EventArchive::publish() {
+    _published.firstSegment = _firstSegment;
+    _published.lastSegment = _lastSegment;
+    _published.endSeq = _endSeq;
+    _published.size = _size;
+}
+
+bool EventArchive::begin() {
+    if (!LittleFS.exists(ARCHIVE_DIR) && !LittleFS.mkdir(ARCHIVE_DIR)) {
+        Serial.println("EventArchive: Failed to create archive directory");
+        return false;
+    }
+
+    File dir = LittleFS.open(ARCHIVE_DIR);
+    if (!dir || !dir.isDirectory()) {
+        Serial.println("EventArchive: Archive path is not a directory");
+        return false;
+    }
+
+    _firstSegment = UINT32_MAX;
+    _lastSegment = 0;
+    _size = 0;
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+        uint32_t segment = parseSegmentName(file.name());
+        if (segment == 0) {
+            continue;
+        }
+        _size += file.size();
+        if (segment < _firstSegment) _firstSegment = segment;
+        if (segment > _lastSegment) _lastSegment = segment;
+    }
+    dir.close();
+
+    if (_lastSegment == 0) {
+        _firstSegment = 1;
+    } else {
+        scanSegment(_lastSegment);
+    }
+
+    _ready = true;
+    Serial.print("EventArchive: ");
+    Serial.print(_lastSegment >= _firstSegment ? _lastSegment - _firstSegment + 1 : 0);
+    Serial.print(" segments, ");
+    Serial.print(_size);
+    Serial.println(" bytes");
+    evict();
+    publish();
+    return true;
+}
+
+// Find where the newest segment ends, checking each page's CRC
+void EventArchive::scanSegment(uint32_t segment) {
+    char path[32];
+    segmentPath(path, sizeof(path), segment);
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        _lastSegmentClosed = true;
+        return;
+    }
+
+    size_t fileSize = file.size();
+    size_t position = 0;
+    uint8_t buffer[64];
+    while (position + PAGE_HEADER_SIZE <= fileSize) {
+        PageHeader header;
+        if (file.read(buffer, PAGE_HEADER_SIZE) != PAGE_HEADER_SIZE || !decodeHeader(buffer, header) ||
+            position + PAGE_HEADER_SIZE + header.compressedLength > fileSize) {
+            break;
+        }
+
+        uint8_t headerBytes[PAGE_CRC_OFFSET];
+        memcpy(headerBytes, buffer, sizeof(headerBytes));
+        uint32_t crc = 0;
+        size_t remaining = header.compressedLength;
+        while (remaining > 0) {
+            size_t chunk = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+            if (file.read(buffer, chunk) != chunk) {
+                break;
+            }
+            crc = EventJournal::crc32(buffer, chunk, crc);
+            remaining -= chunk;
+        }
+        if (remaining > 0 || EventJournal::crc32(headerBytes, sizeof(headerBytes), crc) != header.crc) {
+            break;
+        }
+
+        position += PAGE_HEADER_SIZE + header.compressedLength;
+        _endSeq = header.firstSeq + header.records;
+    }
+    file.close();
+
+    _lastSegmentSize = fileSize;
+    if (position != fileSize) {
+        Serial.println("EventArchive: Damaged page at end of archive, starting a new segment");
+        _lastSegmentClosed = true;
+    }
+}
+
+bool EventArchive::beginPage(uint32_t firstSeq, uint32_t firstTimestamp) {
+    if (!_ready || _pageOpen) {
+        return false;
+    }
+
+    // Start a new segment when the current one is full (or its tail is damaged)
+    bool newSegment = _lastSegment < _firstSegment || _lastSegmentClosed ||
+                      _lastSegmentSize >= EVENT_ARCHIVE_SEGMENT_SIZE;
+    if (newSegment) {
+        _lastSegment++;
+        _lastSegmentSize = 0;
+        _lastSegmentClosed = false;
+    }
+
+    char path[32];
+    segmentPath(path, sizeof(path), _lastSegment);
+    _file = LittleFS.open(path, newSegment ? "w" : "r+");
+    if (!_file) {
+        Serial.println("EventArchive: Failed to open segment for writing");
+        _lastSegmentClosed = true;
+        return false;
+    }
+    _file.seek(_lastSegmentSize);
+
+    // Placeholder header (zero compressed length) until sealPage() patches it
+    uint8_t buffer[PAGE_HEADER_SIZE];
+    PageHeader header = {};
+    encodeHeader(buffer, header);
+    _pageStart = _lastSegmentSize;
+    _pageFailed = _file.write(buffer, sizeof(buffer)) != sizeof(buffer);
+
+    _pageFirstSeq = firstSeq;
+    _pageFirstTimestamp = firstTimestamp;
+    _pageLastTimestamp = firstTimestamp;
+    _pageRecords = 0;
+    _pageRawLength = 0;
+    _pageCrc = 0;
+    _encoder.begin(writeCompressed, this);
+    _pageOpen = true;
+    return !_pageFailed;
+}
+
+bool EventArchive::addRecord(uint32_t timestamp, uint8_t level, const char* tag, const char* message) {
+    if (!_pageOpen || _pageFailed) {
+        return false;
+    }
+
+    uint8_t buffer[EventJournal::MAX_COMPACT_SIZE];
+    size_t length = EventJournal::encodeCompact(buffer, _pageLastTimestamp, timestamp, level, tag, message);
+    _pageLastTimestamp = timestamp;
+    _pageRecords++;
+    _pageRawLength += length;
+    if (!_encoder.write(buffer, length)) {
+        _pageFailed = true;
+    }
+    return !_pageFailed;
+}
+
+bool EventArchive::writeCompressed(void* context, const uint8_t* data, size_t length) {
+    EventArchive* archive = static_cast<EventArchive*>(context);
+    archive->_pageCrc = EventJournal::crc32(data, length, archive->_pageCrc);
+    return archive->_file.write(data, length) == length;
+}
+
+bool EventArchive::sealPage() {
+    if (!_pageOpen) {
+        return false;
+    }
+    _pageOpen = false;
+
+    if (!_pageFailed && !_encoder.finish()) {
+        _pageFailed = true;
+    }
+
+    PageHeader header;
+    header.rawLength = (uint16_t)_pageRawLength;
+    header.compressedLength = (uint16_t)_encoder.getOutputSize();
+    header.records = _pageRecords;
+    header.firstSeq = _pageFirstSeq;
+    header.firstTimestamp = _pageFirstTimestamp;
+    header.crc = 0;
+    if (_pageRecords == 0 || _encoder.getOutputSize() > UINT16_MAX) {
+        _pageFailed = true;
+    }
+
+    if (!_pageFailed) {
+        uint8_t buffer[PAGE_HEADER_SIZE];
+        encodeHeader(buffer, header);
+        header.crc = EventJournal::crc32(buffer, PAGE_CRC_OFFSET, _pageCrc);
+        encodeHeader(buffer, header);
+        _file.seek(_pageStart);
+        _pageFailed = _file.write(buffer, sizeof(buffer)) != sizeof(buffer);
+    }
+
+    size_t segmentSize = _file.size();
+    _file.close();
+    _size += segmentSize - _lastSegmentSize;
+    _lastSegmentSize = segmentSize;
+
+    if (_pageFailed) {
+        Serial.println("EventArchive: Failed to write page");
+        _lastSegmentClosed = true;
+        return false;
+    }
+
+    _endSeq = _pageFirstSeq + _pageRecords;
+    evict();
+    return true;
+}
+
+// Delete whole segments, oldest first, until within budget; the newest is always kept
+void EventArchive::evict() {
+    while (_size > EVENT_ARCHIVE_BUDGET && _firstSegment < _lastSegment) {
+        char path[32];
+        segmentPath(path, sizeof(path), _firstSegment);
+        File file = LittleFS.open(path, "r");
+        size_t size = file ? file.size() : 0;
+        file.close();
+        if (LittleFS.exists(path) && !LittleFS.remove(path)) {
+            break;  // Still open by a reader; try again after the next page
+        }
+        _size -= size < _size ? size : _size;
+        _firstSegment++;
+    }
+}
+
+void EventArchive::clear() {
+    for (uint32_t segment = _firstSegment; segment <= _lastSegment; segment++) {
+        char path[32];
+        segmentPath(path, sizeof(path), segment);
+        LittleFS.remove(path);
+    }
+    // Keep numbering segments upwards so readers never mistake a new one for an old one
+    _firstSegment = _lastSegment + 1;
+    _lastSegmentSize = 0;
+    _lastSegmentClosed = false;
+    _size = 0;
+    publish();
+}
+
+EventArchiveReader::EventArchiveReader()
+    : _segment(0),
+      _seq(0),
+      _inputLength(0),
+      _inputPos(0),
+      _compressedRemaining(0),
+      _rawRemaining(0),
+      _recordsRemaining(0),
+      _pageSeq(0),
+      _timestamp(0),
+      _rawLength(0),
+      _done(true)
+{
+}
+
+void EventArchiveReader::begin(const EventArchive& archive, uint32_t seq) {
+    _file = File();
+    _segment = archive.getFirstSegment();
+    _seq = seq;
+    _recordsRemaining = 0;
+    _done = archive.getLastSegment() < archive.getFirstSegment() ||
+            (int32_t)(archive.getEndSeq() - seq) <= 0;
+}
+
+bool EventArchiveReader::openSegment(uint32_t segment) {
+    char path[32];
+    EventArchive::segmentPath(path, sizeof(path), segment);
+    _file = LittleFS.open(path, "r");
+    _segment = segment;
+    return (bool)_file;
+}
+
+// Move to the next page holding records >= _seq, across segments
+bool EventArchiveReader::openPage(const EventArchive& archive) {
+    while (!_done) {
+        // Segments evicted while reading are skipped
+        if (_segment < archive.getFirstSegment()) {
+            _file = File();
+            _segment = archive.getFirstSegment();
+        }
+        if (!_file && _segment > archive.getLastSegment()) {
+            _done = true;
+            break;
+        }
+        if (!_file && !openSegment(_segment)) {
+            // Evicted by the writer, which publishes the new first segment afterwards
+            _segment++;
+            continue;
+        }
+
+        uint8_t buffer[EventArchive::PAGE_HEADER_SIZE];
+        PageHeader header;
+        if (_file.read(buffer, sizeof(buffer)) != sizeof(buffer) || !decodeHeader(buffer, header)) {
+            // End of this segment (or a torn page): continue with the next one
+            _file.close();
+            _file = File();
+            _segment++;
+            continue;
+        }
+
+        if ((int32_t)(header.firstSeq + header.records - _seq) <= 0) {
+            _file.seek(_file.position() + header.compressedLength);
+            continue;
+        }
+
+        _decoder.begin();
+        _inputLength = 0;
+        _inputPos = 0;
+        _rawLength = 0;
+        _compressedRemaining = header.compressedLength;
+        _rawRemaining = header.rawLength;
+        _recordsRemaining = header.records;
+        _pageSeq = header.firstSeq;
+        _timestamp = header.firstTimestamp;
+        return true;
+    }
+    return false;
+}
+
+// Decompress up to size more bytes of the current page
+size_t EventArchiveReader::fillRaw(uint8_t* out, size_t size) {
+    if (size > _rawRemaining) {
+        size = _rawRemaining;
+    }
+    size_t produced = 0;
+    while (produced < size && !_decoder.isCorrupt()) {
+        if (_inputPos == _inputLength) {
+            if (_compressedRemaining == 0) {
+                break;
+            }
+            size_t chunk = _compressedRemaining < sizeof(_input) ? _compressedRemaining : sizeof(_input);
+            if (_file.read(_input, chunk) != chunk) {
+                break;
+            }
+            _inputLength = chunk;
+            _inputPos = 0;
+            _compressedRemaining -= chunk;
+        }
+        size_t consumed;
+        produced += _decoder.decode(_input + _inputPos, _inputLength - _inputPos, consumed,
+                                    out + produced, size - produced);
+        _inputPos += consumed;
+    }
+    _rawRemaining -= produced;
+    return produced;
+}
+
+bool EventArchiveReader::next(const EventArchive& archive, EventJournalRecord& record) {
+    for (;;) {
+        if (_recordsRemaining == 0 && !openPage(archive)) {
+            return false;
+        }
+
+        _rawLength += fillRaw(_raw + _rawLength, sizeof(_raw) - _rawLength);
+        size_t length = EventJournal::decodeCompact(_raw, _rawLength, _timestamp, record);
+        if (length == 0) {
+            // Corrupt page: drop the rest of it
+            _file.seek(_file.position() + _compressedRemaining);
+            _recordsRemaining = 0;
+            continue;
+        }
+
+        memmove(_raw, _raw + length, _rawLength - length);
+        _rawLength -= length;
+        _timestamp = record.timestamp;
+        record.seq = _pageSeq++;
+        _recordsRemaining--;
+        if ((int32_t)(record.seq - _seq) >= 0) {
+            return true;
+        }
+    }
+}
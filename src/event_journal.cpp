@@ -0,0 +1,164 @@
+#include "event_journal.h"
+#include <string.h>
+
+static const uint8_t MAGIC[4] = {'E', 'L', 'O', 'G'};
+
+static void putU32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void EventJournal::encodeHeader(uint8_t* out) {
+    memcpy(out, MAGIC, sizeof(MAGIC));
+    out[4] = VERSION;
+    out[5] = 0;
+    out[6] = 0;
+    out[7] = 0;
+}
+
+bool EventJournal::checkHeader(const uint8_t* in, size_t length) {
+    return length >= HEADER_SIZE && memcmp(in, MAGIC, sizeof(MAGIC)) == 0 && in[4] == VERSION;
+}
+
+size_t EventJournal::encode(uint8_t* out, uint32_t seq, uint32_t timestamp, uint8_t level,
+                            const char* tag, const char* message) {
+    size_t tagLength = tag ? strnlen(tag, MAX_TAG_LENGTH) : 0;
+    size_t messageLength = message ? strnlen(message, MAX_MESSAGE_LENGTH) : 0;
+
+    out[0] = SYNC_BYTE;
+    out[1] = level;
+    out[2] = (uint8_t)tagLength;
+    out[3] = (uint8_t)messageLength;
+    putU32(out + 4, seq);
+    putU32(out + 8, timestamp);
+    size_t length = 12;
+    if (tagLength > 0) {
+        memcpy(out + length, tag, tagLength);
+        length += tagLength;
+    }
+    if (messageLength > 0) {
+        memcpy(out + length, message, messageLength);
+        length += messageLength;
+    }
+    putU32(out + length, crc32(out, length));
+    return length + 4;
+}
+
+EventJournal::Result EventJournal::decode(const uint8_t* in, size_t length,
+                                          EventJournalRecord& record, size_t& consumed) {
+    consumed = 0;
+    if (length == 0) {
+        return RESULT_INCOMPLETE;
+    }
+
+    // Anything that cannot start a record is skipped a byte at a time
+    consumed = 1;
+    if (in[0] != SYNC_BYTE) {
+        return RESULT_CORRUPT;
+    }
+    if (length < 12) {
+        consumed = 0;
+        return RESULT_INCOMPLETE;
+    }
+
+    size_t tagLength = in[2];
+    size_t messageLength = in[3];
+    if (tagLength > MAX_TAG_LENGTH || messageLength > MAX_MESSAGE_LENGTH) {
+        return RESULT_CORRUPT;
+    }
+
+    size_t bodyLength = 12 + tagLength + messageLength;
+    if (length < bodyLength + 4) {
+        consumed = 0;
+        return RESULT_INCOMPLETE;
+    }
+    if (crc32(in, bodyLength) != getU32(in + bodyLength)) {
+        return RESULT_CORRUPT;
+    }
+
+    record.level = in[1];
+    record.seq = getU32(in + 4);
+    record.timestamp = getU32(in + 8);
+    memcpy(record.tag, in + 12, tagLength);
+    record.tag[tagLength] = '\0';
+    memcpy(record.message, in + 12 + tagLength, messageLength);
+    record.message[messageLength] = '\0';
+    consumed = bodyLength + 4;
+    return RESULT_OK;
+}
+
+size_t EventJournal::encodeCompact(uint8_t* out, uint32_t previousTimestamp, uint32_t timestamp,
+                                   uint8_t level, const char* tag, const char* message) {
+    size_t tagLength = tag ? strnlen(tag, MAX_TAG_LENGTH) : 0;
+    size_t messageLength = message ? strnlen(message, MAX_MESSAGE_LENGTH) : 0;
+
+    out[0] = level;
+    out[1] = (uint8_t)tagLength;
+    out[2] = (uint8_t)messageLength;
+    size_t length = 3;
+
+    // Wraps correctly if timestamps go backwards (reboot within a page)
+    uint32_t delta = timestamp - previousTimestamp;
+    do {
+        out[length++] = (uint8_t)((delta & 0x7F) | (delta > 0x7F ? 0x80 : 0));
+        delta >>= 7;
+    } while (delta != 0);
+
+    memcpy(out + length, tag, tagLength);
+    length += tagLength;
+    memcpy(out + length, message, messageLength);
+    return length + messageLength;
+}
+
+size_t EventJournal::decodeCompact(const uint8_t* in, size_t length, uint32_t previousTimestamp,
+                                   EventJournalRecord& record) {
+    if (length < 4) {
+        return 0;
+    }
+    size_t tagLength = in[1];
+    size_t messageLength = in[2];
+    if (tagLength > MAX_TAG_LENGTH || messageLength > MAX_MESSAGE_LENGTH) {
+        return 0;
+    }
+
+    uint32_t delta = 0;
+    size_t offset = 3;
+    for (uint8_t shift = 0; ; shift += 7) {
+        if (offset >= length || shift > 28) {
+            return 0;
+        }
+        uint8_t value = in[offset++];
+        delta |= (uint32_t)(value & 0x7F) << shift;
+        if (!(value & 0x80)) {
+            break;
+        }
+    }
+    if (length - offset < tagLength + messageLength) {
+        return 0;
+    }
+
+    record.level = in[0];
+    record.timestamp = previousTimestamp + delta;
+    memcpy(record.tag, in + offset, tagLength);
+    record.tag[tagLength] = '\0';
+    memcpy(record.message, in + offset + tagLength, messageLength);
+    record.message[messageLength] = '\0';
+    return offset + tagLength + messageLength;
+}
+
+uint32_t EventJournal::crc32(const uint8_t* data, size_t length, uint32_t crc) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
@@ -5,12 +5,35 @@
 // Redirect Serial to CapturedSerial for web monitor
 #define Serial CapturedSerial
 
+// Scoped lock for the recursive entry mutex
+class EventLogLock {
+public:
+    explicit EventLogLock(SemaphoreHandle_t mutex) : _mutex(mutex) {
+        xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    }
+    ~EventLogLock() {
+        xSemaphoreGiveRecursive(_mutex);
+    }
+private:
+    SemaphoreHandle_t _mutex;
+};
+
 EventLog::EventLog()
-    : _dirty(false),
+    : _count(0),
+      _nextSeq(0),
+      _journaledSeq(0),
+      _mqttSeq(0),
+      _mqttDropped(0),
+      _journalSize(0),
+      _archivedSeq(0),
+      _mutex(xSemaphoreCreateRecursiveMutex()),
+      _writeMutex(xSemaphoreCreateRecursiveMutex()),
       _lastSaveTime(0),
-      _mqttLoggingEnabled(false)
+      _fsAvailable(false),
+      _archiveAvailable(false),
+      _mqttLoggingEnabled(false),
+      _flushRequested(false)
 {
-    _entries.reserve(MAX_ENTRIES);
 }
 
 EventLog::~EventLog() {
@@ -34,34 +57,167 @@ bool EventLog::begin() {
     }
 
     // Load existing logs from LittleFS
+    EventLogLock writeLock(_writeMutex);
+    EventLogLock lock(_mutex);
+    _fsAvailable = true;
+    _archiveAvailable = _archive.begin();
     bool loaded = loadFromLittleFS();
+
+    // Keep numbering above the archive when the journal was empty
+    if (_count == 0 && (int32_t)(_archive.getEndSeq() - _nextSeq) > 0) {
+        _nextSeq = _archive.getEndSeq();
+        _journaledSeq = _nextSeq;
+        _mqttSeq = _nextSeq;
+    }
+    _archivedSeq = _archive.getEndSeq();
+    if ((int32_t)(oldestSeq() - _archivedSeq) > 0 || (int32_t)(_archivedSeq - _nextSeq) > 0) {
+        _archivedSeq = oldestSeq();
+    }
+
     _lastSaveTime = millis();
     return loaded;
 }
 
 void EventLog::loop() {
-    flushIfDue(false);
+    // Hand entries queued since the last call to the MQTT callback, oldest first,
+    // without holding the lock while it runs
+    while (_mqttLoggingEnabled && _mqttCallback) {
+        char json[MAX_ENTRY_JSON];
+        size_t length;
+        uint32_t seq;
+        {
+            EventLogLock lock(_mutex);
+            if ((int32_t)(oldestSeq() - _mqttSeq) > 0) {
+                // Overwritten before they could be sent
+                _mqttDropped += oldestSeq() - _mqttSeq;
+                _mqttSeq = oldestSeq();
+            }
+            if (_mqttSeq == _nextSeq) {
+                break;
+            }
+            seq = _mqttSeq;
+            const EventRecord& record = *findRecord(seq);
+            length = formatEntryJSON(json, sizeof(json), seq, record.timestamp, record.level,
+                                     Logger::getInstance().getTagName(record.tagId), record.message);
+        }
+        if (!_mqttCallback(json, length)) {
+            break;  // Receiver is full; offer this entry again next time
+        }
+
+        EventLogLock lock(_mutex);
+        if (_mqttSeq == seq) {
+            _mqttSeq++;
+        }
+    }
+
+    // Flash work happens here rather than in addEntry(), off the callers' tasks
+    bool force;
+    {
+        EventLogLock lock(_mutex);
+        force = _flushRequested;
+        _flushRequested = false;
+    }
+    EventLogLock writeLock(_writeMutex);
+    archiveIfDue();
+    flushIfDue(force);
+}
+
+void EventLog::flush() {
+    {
+        EventLogLock lock(_mutex);
+        _flushRequested = false;
+    }
+    EventLogLock writeLock(_writeMutex);
+    archiveIfDue();
+    flushIfDue(true);
 }
 
 void EventLog::addEntry(LogLevel level, const char* tag, const char* message) {
-    // Create new log entry
-    LogEntry entry(millis(), level, tag, message);
+    uint8_t tagId = Logger::getInstance().internTag(tag);
+    uint32_t timestamp = millis();
+
+    EventLogLock lock(_mutex);
+    pushRecord(timestamp, level, tagId, message);
 
-    // Add to in-memory vector
-    _entries.push_back(entry);
+    // Only entries added while MQTT logging is on are published (from loop())
+    if (!_mqttLoggingEnabled || !_mqttCallback) {
+        _mqttSeq = _nextSeq;
+    }
+
+    // Errors are written out on the next loop() instead of waiting for the save interval
+    if (level == LOG_ERROR) {
+        _flushRequested = true;
+    }
+}
 
-    // If we exceed max entries, remove the oldest
-    if (_entries.size() > MAX_ENTRIES) {
-        _entries.erase(_entries.begin());
+void EventLog::archiveIfDue() {
+    if (!_archiveAvailable) {
+        return;
     }
 
-    markDirty();
-    flushIfDue(level == LOG_ERROR);
+    uint32_t first;
+    {
+        EventLogLock lock(_mutex);
+        if (_nextSeq - _archivedSeq < EVENT_ARCHIVE_PAGE_ENTRIES) {
+            return;
+        }
+        // Entries overwritten before they could be archived are lost
+        if ((int32_t)(oldestSeq() - _archivedSeq) > 0) {
+            _archivedSeq = oldestSeq();
+        }
+        first = _archivedSeq;
+    }
 
-    // Publish to MQTT if enabled
-    if (_mqttLoggingEnabled && _mqttCallback) {
-        publishToMQTT(level, tag, message);
+    // Compress and write without the lock, copying the records out one at a
+    // time; a page ends early if the ring overtakes it
+    Logger& logger = Logger::getInstance();
+    EventRecord record;
+    uint32_t count = 0;
+    if (copyRecord(first, record) && _archive.beginPage(first, record.timestamp)) {
+        do {
+            _archive.addRecord(record.timestamp, record.level, logger.getTagName(record.tagId),
+                               record.message);
+            count++;
+        } while (count < EVENT_ARCHIVE_PAGE_ENTRIES && copyRecord(first + count, record));
+        _archive.sealPage();
     }
+
+    EventLogLock lock(_mutex);
+    _archive.publish();
+    // Move on even after a failed write rather than retrying on every loop()
+    _archivedSeq = first + (count > 0 ? count : EVENT_ARCHIVE_PAGE_ENTRIES);
+}
+
+void EventLog::pushRecord(uint32_t timestamp, uint8_t level, uint8_t tagId, const char* message) {
+    EventRecord& record = _ring[_nextSeq % MAX_ENTRIES];
+    record.seq = _nextSeq;
+    record.timestamp = timestamp;
+    record.level = level;
+    record.tagId = tagId;
+    strncpy(record.message, message ? message : "", sizeof(record.message) - 1);
+    record.message[sizeof(record.message) - 1] = '\0';
+
+    _nextSeq++;
+    if (_count < MAX_ENTRIES) {
+        _count++;
+    }
+}
+
+const EventRecord* EventLog::findRecord(uint32_t seq) const {
+    if (seq - oldestSeq() >= _count) {
+        return nullptr;
+    }
+    return &_ring[seq % MAX_ENTRIES];
+}
+
+bool EventLog::copyRecord(uint32_t seq, EventRecord& record) const {
+    EventLogLock lock(_mutex);
+    const EventRecord* held = findRecord(seq);
+    if (held == nullptr) {
+        return false;
+    }
+    record = *held;
+    return true;
 }
 
 String EventLog::getEntriesJSON() {
@@ -69,35 +225,147 @@ String EventLog::getEntriesJSON() {
 }
 
 String EventLog::getFilteredEntriesJSON(LogLevel minLevel, const char* tag) {
-    DynamicJsonDocument doc(8192);  // Adjust size as needed
-    JsonArray array = doc.to<JsonArray>();
+    EventLogQuery query = beginQuery(0, minLevel, tag, MAX_ENTRIES);
+    char entry[MAX_ENTRY_JSON + 1];
+    String result = "[";
+    size_t length;
+    while ((length = readEntryJSON(query, entry, MAX_ENTRY_JSON)) > 0) {
+        if (result.length() > 1) {
+            result += ',';
+        }
+        entry[length] = '\0';
+        result += entry;
+    }
+    result += ']';
+    return result;
+}
+
+EventLogQuery EventLog::beginQuery(uint32_t next, LogLevel minLevel, const char* tag, uint16_t limit) {
+    EventLogQuery query;
+    query.minLevel = minLevel;
+    strncpy(query.tag, tag ? tag : "", sizeof(query.tag) - 1);
+    query.tag[sizeof(query.tag) - 1] = '\0';
+    query.remaining = limit;
+
+    EventLogLock lock(_mutex);
+    query.next = next - oldestSeq() <= _count ? next : oldestSeq();
+    return query;
+}
+
+static_assert(EventLog::MAX_ENTRY_JSON >= 80 + 2 * (LOG_TAG_SIZE + sizeof(EventRecord::message)),
+              "MAX_ENTRY_JSON too small for a fully escaped entry");
+
+// Write s as JSON string content: quote and backslash escaped, control characters as spaces
+static size_t writeJsonText(char* out, const char* s) {
+    size_t length = 0;
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            out[length++] = '\\';
+            out[length++] = *s;
+        } else {
+            out[length++] = (uint8_t)*s < 0x20 ? ' ' : *s;
+        }
+    }
+    return length;
+}
+
+size_t EventLog::formatEntryJSON(char* out, size_t size, uint32_t seq, uint32_t timestamp,
+                                 uint8_t level, const char* tag, const char* message) {
+    int length = snprintf(out, size, "{\"seq\":%u,\"timestamp\":%u,\"level\":\"%s\",\"tag\":\"",
+                          (unsigned)seq, (unsigned)timestamp, logLevelToString((LogLevel)level));
+    length += writeJsonText(out + length, tag);
+    memcpy(out + length, "\",\"message\":\"", 13);
+    length += 13;
+    length += writeJsonText(out + length, message);
+    out[length++] = '"';
+    out[length++] = '}';
+    return length;
+}
+
+size_t EventLog::readEntryJSON(EventLogQuery& query, char* out, size_t size) {
+    if (query.remaining == 0 || size < MAX_ENTRY_JSON) {
+        return 0;
+    }
+
+    Logger& logger = Logger::getInstance();
+    EventLogLock lock(_mutex);
+
+    // Entries overwritten since the last call are gone; carry on from the oldest
+    if ((int32_t)(oldestSeq() - query.next) > 0) {
+        query.next = oldestSeq();
+    }
+
+    while (query.next != _nextSeq) {
+        const EventRecord& entry = *findRecord(query.next++);
+        const char* entryTag = logger.getTagName(entry.tagId);
 
-    for (const auto& entry : _entries) {
         // Apply filters (higher level = less important, so we skip if entry.level > minLevel)
-        if (entry.level > minLevel) continue;
-        if (tag != nullptr && entry.tag != tag) continue;
+        if (entry.level > query.minLevel) continue;
+        if (query.tag[0] != '\0' && strcmp(entryTag, query.tag) != 0) continue;
 
-        // Create JSON object for this entry
-        JsonObject obj = array.createNestedObject();
-        obj["timestamp"] = entry.timestamp;
-        obj["level"] = logLevelToString(entry.level);
-        obj["tag"] = entry.tag;
-        obj["message"] = entry.message;
+        query.remaining--;
+        return formatEntryJSON(out, size, entry.seq, entry.timestamp, entry.level, entryTag, entry.message);
     }
+    return 0;
+}
 
-    String result;
-    serializeJson(doc, result);
-    return result;
+void EventLog::beginArchiveQuery(EventArchiveReader& reader, uint32_t next) {
+    EventLogLock lock(_mutex);
+    reader.begin(_archive, next);
+}
+
+size_t EventLog::readArchiveEntryJSON(EventArchiveReader& reader, EventLogQuery& query, char* out, size_t size) {
+    if (query.remaining == 0 || size < MAX_ENTRY_JSON) {
+        return 0;
+    }
+
+    EventLogLock lock(_mutex);
+    EventJournalRecord record;
+    while (reader.next(_archive, record)) {
+        // The ring takes over from here
+        if ((int32_t)(record.seq - oldestSeq()) >= 0) {
+            break;
+        }
+        query.next = record.seq + 1;
+
+        if (record.level > query.minLevel) continue;
+        if (query.tag[0] != '\0' && strcmp(record.tag, query.tag) != 0) continue;
+
+        query.remaining--;
+        return formatEntryJSON(out, size, record.seq, record.timestamp, record.level, record.tag, record.message);
+    }
+    return 0;
+}
+
+uint32_t EventLog::getNextSeq() const {
+    EventLogLock lock(_mutex);
+    return _nextSeq;
+}
+
+size_t EventLog::getArchiveSize() const {
+    EventLogLock lock(_mutex);
+    return _archive.getSize();
 }
 
 void EventLog::clear() {
-    _entries.clear();
-    markDirty();
-    flushIfDue(true);
+    EventLogLock writeLock(_writeMutex);
+    EventLogLock lock(_mutex);
+    // Sequence numbers keep counting so clients never see one reused
+    _count = 0;
+    _journaledSeq = _nextSeq;
+    _mqttSeq = _nextSeq;
+    _archivedSeq = _nextSeq;
+    if (_fsAvailable) {
+        compactJournal();
+    }
+    if (_archiveAvailable) {
+        _archive.clear();
+    }
 }
 
 size_t EventLog::getCount() const {
-    return _entries.size();
+    EventLogLock lock(_mutex);
+    return _count;
 }
 
 void EventLog::setMQTTLoggingEnabled(bool enabled) {
@@ -108,7 +376,7 @@ bool EventLog::isMQTTLoggingEnabled() const {
     return _mqttLoggingEnabled;
 }
 
-void EventLog::setMQTTCallback(std::function<void(LogLevel, const char*, const char*)> callback) {
+void EventLog::setMQTTCallback(std::function<bool(const char*, size_t)> callback) {
     _mqttCallback = callback;
 }
 
@@ -125,127 +393,246 @@ const char* EventLog::logLevelToString(LogLevel level) {
 }
 
 bool EventLog::loadFromLittleFS() {
-    // Check if LittleFS is mounted before attempting file operations
-    // LittleFS.begin(false) returns true if already mounted, false if not mounted
-    // Specify partition name "spiffs" to match partition table (PlatformIO requirement)
-    // Mount at "/littlefs" (can't mount to root "/" - it's reserved)
-    if (!LittleFS.begin(false, "/littlefs", 5, "spiffs")) {
-        Serial.println("EventLog: LittleFS not mounted, skipping load");
-        return false;
+    // A compaction interrupted between remove and rename leaves only the new file
+    if (!LittleFS.exists(LOG_FILE) && LittleFS.exists(LOG_FILE_TMP)) {
+        LittleFS.rename(LOG_FILE_TMP, LOG_FILE);
     }
 
-    // LOG_FILE is "/event_log.json" - LittleFS.open() uses filesystem-relative paths
-    // When mounted at "/littlefs", filesystem root "/" maps to VFS "/littlefs"
-    // So we use LOG_FILE directly (it already has leading "/")
-    String logPath = String(LOG_FILE);
-    if (!LittleFS.exists(logPath)) {
+    if (!LittleFS.exists(LOG_FILE)) {
+        if (LittleFS.exists(LEGACY_LOG_FILE)) {
+            return migrateLegacyJson();
+        }
         Serial.println("EventLog: No existing log file found, starting fresh");
-        return true;
+        return compactJournal();
     }
 
-    File file = LittleFS.open(logPath, "r");
+    File file = LittleFS.open(LOG_FILE, "r");
     if (!file) {
         Serial.println("EventLog: Failed to open log file for reading");
         return false;
     }
 
-    // Read the file content
-    DynamicJsonDocument doc(8192);
-    DeserializationError error = deserializeJson(doc, file);
-    file.close();
+    uint8_t header[EventJournal::HEADER_SIZE];
+    if (file.read(header, sizeof(header)) != sizeof(header) ||
+        !EventJournal::checkHeader(header, sizeof(header))) {
+        file.close();
+        Serial.println("EventLog: Unrecognised journal, starting fresh");
+        return compactJournal();
+    }
 
-    if (error) {
-        Serial.print("EventLog: Failed to parse log file: ");
-        Serial.println(error.c_str());
-        return false;
+    // Stream records through a small buffer; a record never spans more than half of it
+    uint8_t buffer[2 * EventJournal::MAX_RECORD_SIZE];
+    size_t filled = 0;
+    bool endOfFile = false;
+    bool damaged = false;
+    bool first = true;
+    Logger& logger = Logger::getInstance();
+    EventJournalRecord record;
+
+    for (;;) {
+        if (!endOfFile && filled < sizeof(buffer)) {
+            size_t bytesRead = file.read(buffer + filled, sizeof(buffer) - filled);
+            endOfFile = bytesRead == 0;
+            filled += bytesRead;
+        }
+        if (filled == 0) {
+            break;
+        }
+
+        size_t consumed;
+        EventJournal::Result result = EventJournal::decode(buffer, filled, record, consumed);
+        if (result == EventJournal::RESULT_INCOMPLETE) {
+            if (endOfFile) {
+                damaged = true;  // Torn final record
+                break;
+            }
+            continue;
+        }
+
+        if (result == EventJournal::RESULT_CORRUPT) {
+            damaged = true;
+        } else {
+            // Keep numbering contiguous; a gap from skipped records gets renumbered on compaction
+            if (first) {
+                _nextSeq = record.seq;
+                first = false;
+            } else if (record.seq != _nextSeq) {
+                damaged = true;
+            }
+            pushRecord(record.timestamp, record.level, logger.internTag(record.tag), record.message);
+        }
+
+        memmove(buffer, buffer + consumed, filled - consumed);
+        filled -= consumed;
     }
 
-    // Clear existing entries
-    _entries.clear();
+    _journalSize = file.size();
+    file.close();
+    _journaledSeq = _nextSeq;
+    _mqttSeq = _nextSeq;
 
-    // Load entries from JSON
-    JsonArray array = doc.as<JsonArray>();
-    for (JsonObject obj : array) {
-        unsigned long timestamp = obj["timestamp"];
-        String levelStr = obj["level"].as<String>();
-        String tag = obj["tag"].as<String>();
-        String message = obj["message"].as<String>();
+    Serial.print("EventLog: Loaded ");
+    Serial.print(_count);
+    Serial.println(" log entries from LittleFS");
 
-        // Convert level string to LogLevel enum
-        LogLevel level = LOG_INFO;
-        if (levelStr == "ERROR") level = LOG_ERROR;
-        else if (levelStr == "WARNING") level = LOG_WARNING;
-        else if (levelStr == "INFO") level = LOG_INFO;
-        else if (levelStr == "DEBUG") level = LOG_DEBUG;
-        else if (levelStr == "VERBOSE") level = LOG_VERBOSE;
+    if (damaged) {
+        Serial.println("EventLog: Skipped damaged journal records, compacting");
+    }
+    if (damaged || _journalSize > JOURNAL_COMPACT_SIZE) {
+        compactJournal();
+    }
+    return true;
+}
 
-        LogEntry entry(timestamp, level, tag.c_str(), message.c_str());
-        _entries.push_back(entry);
+bool EventLog::migrateLegacyJson() {
+    File file = LittleFS.open(LEGACY_LOG_FILE, "r");
+    if (!file) {
+        Serial.println("EventLog: Failed to open legacy log file");
+        return false;
     }
 
-    Serial.print("EventLog: Loaded ");
-    Serial.print(_entries.size());
-    Serial.println(" log entries from LittleFS");
+    // One-time import of the JSON array written by older firmware
+    DynamicJsonDocument doc(8192);
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
 
-    return true;
+    if (error) {
+        Serial.print("EventLog: Failed to parse legacy log file: ");
+        Serial.println(error.c_str());
+    } else {
+        Logger& logger = Logger::getInstance();
+        for (JsonObject obj : doc.as<JsonArray>()) {
+            String levelStr = obj["level"].as<String>();
+
+            // Convert level string to LogLevel enum
+            LogLevel level = LOG_INFO;
+            if (levelStr == "ERROR") level = LOG_ERROR;
+            else if (levelStr == "WARNING") level = LOG_WARNING;
+            else if (levelStr == "INFO") level = LOG_INFO;
+            else if (levelStr == "DEBUG") level = LOG_DEBUG;
+            else if (levelStr == "VERBOSE") level = LOG_VERBOSE;
+
+            pushRecord(obj["timestamp"].as<uint32_t>(), level,
+                       logger.internTag(obj["tag"] | ""), obj["message"] | "");
+        }
+        Serial.print("EventLog: Migrated ");
+        Serial.print(_count);
+        Serial.println(" log entries to the journal");
+    }
+
+    _journaledSeq = _nextSeq;
+    _mqttSeq = _nextSeq;
+    if (!compactJournal()) {
+        return false;
+    }
+    LittleFS.remove(LEGACY_LOG_FILE);
+    return !error;
 }
 
 bool EventLog::saveToLittleFS() {
-    // Check if LittleFS is mounted before attempting file operations
-    // LittleFS.begin(false) returns true if already mounted, false if not mounted
-    // Specify partition name "spiffs" to match partition table (PlatformIO requirement)
-    // Mount at "/littlefs" (can't mount to root "/" - it's reserved)
-    if (!LittleFS.begin(false, "/littlefs", 5, "spiffs")) {
-        // Silently fail - filesystem not available, use memory-only logging
+    if (!_fsAvailable) {
+        // Filesystem not available, use memory-only logging
         return false;
     }
 
-    // LOG_FILE is "/event_log.json" - LittleFS.open() uses filesystem-relative paths
-    String logPath = String(LOG_FILE);
-    File file = LittleFS.open(logPath, "w");
+    uint32_t end;
+    {
+        EventLogLock lock(_mutex);
+        // Entries overwritten in a burst before they could be written are lost
+        if ((int32_t)(oldestSeq() - _journaledSeq) > 0) {
+            _journaledSeq = oldestSeq();
+        }
+        end = _nextSeq;
+    }
+
+    File file = LittleFS.open(LOG_FILE, "a");
     if (!file) {
         Serial.println("EventLog: Failed to open log file for writing");
         return false;
     }
 
-    // Create JSON array
-    DynamicJsonDocument doc(8192);
-    JsonArray array = doc.to<JsonArray>();
-
-    for (const auto& entry : _entries) {
-        JsonObject obj = array.createNestedObject();
-        obj["timestamp"] = entry.timestamp;
-        obj["level"] = logLevelToString(entry.level);
-        obj["tag"] = entry.tag;
-        obj["message"] = entry.message;
+    // Append only the new records - a few dozen bytes each. Each record is
+    // copied out under the lock and written without it, so addEntry() and
+    // readers never wait on flash.
+    uint8_t buffer[EventJournal::MAX_RECORD_SIZE];
+    Logger& logger = Logger::getInstance();
+    EventRecord record;
+    bool ok = true;
+    for (; (int32_t)(end - _journaledSeq) > 0; _journaledSeq++) {
+        if (!copyRecord(_journaledSeq, record)) {
+            continue;  // Overwritten while writing
+        }
+        size_t length = EventJournal::encode(buffer, record.seq, record.timestamp, record.level,
+                                             logger.getTagName(record.tagId), record.message);
+        if (file.write(buffer, length) != length) {
+            ok = false;
+            break;
+        }
+        _journalSize += length;
     }
-
-    // Write to file
-    size_t bytesWritten = serializeJson(doc, file);
     file.close();
 
-    if (bytesWritten == 0) {
+    if (!ok) {
         Serial.println("EventLog: Failed to write log file");
         return false;
     }
 
-    _dirty = false;
     _lastSaveTime = millis();
+    if (_journalSize > JOURNAL_COMPACT_SIZE) {
+        compactJournal();
+    }
     return true;
 }
 
-void EventLog::publishToMQTT(LogLevel level, const char* tag, const char* message) {
-    if (_mqttCallback) {
-        _mqttCallback(level, tag, message);
+bool EventLog::compactJournal() {
+    File file = LittleFS.open(LOG_FILE_TMP, "w");
+    if (!file) {
+        Serial.println("EventLog: Failed to open log file for compaction");
+        return false;
     }
-}
 
-void EventLog::markDirty() {
-    _dirty = true;
+    uint8_t buffer[EventJournal::MAX_RECORD_SIZE];
+    EventJournal::encodeHeader(buffer);
+    size_t size = file.write(buffer, EventJournal::HEADER_SIZE);
+    bool ok = size == EventJournal::HEADER_SIZE;
+
+    uint32_t seq;
+    uint32_t end;
+    {
+        EventLogLock lock(_mutex);
+        seq = oldestSeq();
+        end = _nextSeq;
+    }
+
+    Logger& logger = Logger::getInstance();
+    EventRecord record;
+    for (; ok && seq != end; seq++) {
+        if (!copyRecord(seq, record)) {
+            continue;  // Overwritten while compacting
+        }
+        size_t length = EventJournal::encode(buffer, record.seq, record.timestamp, record.level,
+                                             logger.getTagName(record.tagId), record.message);
+        ok = file.write(buffer, length) == length;
+        size += length;
+    }
+    file.close();
+
+    if (!ok) {
+        Serial.println("EventLog: Failed to write compacted log file");
+        LittleFS.remove(LOG_FILE_TMP);
+        return false;
+    }
+
+    LittleFS.remove(LOG_FILE);
+    LittleFS.rename(LOG_FILE_TMP, LOG_FILE);
+    _journalSize = size;
+    _journaledSeq = end;
+    _lastSaveTime = millis();
+    return true;
 }
 
 void EventLog::flushIfDue(bool force) {
-    if (!_dirty) {
+    if (_journaledSeq == getNextSeq()) {
         return;
     }
 
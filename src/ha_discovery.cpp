@@ -0,0 +1,352 @@
+#include "ha_discovery.h"
+#include "ha_state_document.h"
+#include <stdio.h>
+#include <string.h>
+
+#define HA_DISCOVERY_PREFIX "homeassistant"
+#define HA_AVAILABILITY_TOPIC "esp32_thermostat/status"
+
+// Shared fragments (origin uses full keys, device abbreviated keys)
+#define HA_ORIGIN \
+    "{\"name\":\"ESP32-KNX-Thermostat\",\"sw_version\":\"" HA_DISCOVERY_VERSION "\"," \
+    "\"support_url\":\"https://github.com/yourusername/ESP32-KNX-Thermostat\"}"
+
+#define HA_DEVICE \
+    "{\"ids\":[\"" HA_DISCOVERY_NODE_ID "\"],\"name\":\"ESP32 KNX Thermostat\",\"mf\":\"DIY\"," \
+    "\"mdl\":\"ESP32-KNX-Thermostat\",\"sw\":\"" HA_DISCOVERY_VERSION "\"}"
+
+#define HA_SENSOR_TAIL ",\"origin\":" HA_ORIGIN ",\"device\":" HA_DEVICE "}"
+
+// Each sensor template is instantiated twice: reading its own state topic,
+// and reading its key from the consolidated state document
+#define HA_STATE_TOPIC(topic) "esp32_thermostat/" topic
+#define HA_VALUE "{{ value }}"
+#define HA_JSON_VALUE(key) "{{ value_json." key " }}"
+
+#define HA_TEMPERATURE_CONFIG(stateTopic, valueTemplate) \
+    "{\"name\":\"Temperature\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_temperature\"," \
+    "\"device_class\":\"temperature\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"unit_of_measurement\":\"°C\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"state_class\":\"measurement\"," \
+    "\"suggested_display_precision\":1" \
+    HA_SENSOR_TAIL
+
+#define HA_HUMIDITY_CONFIG(stateTopic, valueTemplate) \
+    "{\"name\":\"Humidity\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_humidity\"," \
+    "\"device_class\":\"humidity\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"unit_of_measurement\":\"%\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"state_class\":\"measurement\"," \
+    "\"suggested_display_precision\":1" \
+    HA_SENSOR_TAIL
+
+#define HA_PRESSURE_CONFIG(stateTopic, valueTemplate) \
+    "{\"name\":\"Pressure\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_pressure\"," \
+    "\"device_class\":\"pressure\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"unit_of_measurement\":\"hPa\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"state_class\":\"measurement\"," \
+    "\"suggested_display_precision\":1" \
+    HA_SENSOR_TAIL
+
+#define HA_VALVE_POSITION_CONFIG(stateTopic, valueTemplate) \
+    "{\"name\":\"Valve Position\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_valve_position\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"unit_of_measurement\":\"%\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"state_class\":\"measurement\"," \
+    "\"icon\":\"mdi:valve\"" \
+    HA_SENSOR_TAIL
+
+static const char TEMPERATURE_CONFIG[] PROGMEM =
+    HA_TEMPERATURE_CONFIG(HA_STATE_TOPIC("temperature"), HA_VALUE);
+static const char TEMPERATURE_JSON_CONFIG[] PROGMEM =
+    HA_TEMPERATURE_CONFIG(HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("temperature"));
+static const char HUMIDITY_CONFIG[] PROGMEM =
+    HA_HUMIDITY_CONFIG(HA_STATE_TOPIC("humidity"), HA_VALUE);
+static const char HUMIDITY_JSON_CONFIG[] PROGMEM =
+    HA_HUMIDITY_CONFIG(HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("humidity"));
+static const char PRESSURE_CONFIG[] PROGMEM =
+    HA_PRESSURE_CONFIG(HA_STATE_TOPIC("pressure"), HA_VALUE);
+static const char PRESSURE_JSON_CONFIG[] PROGMEM =
+    HA_PRESSURE_CONFIG(HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("pressure"));
+static const char VALVE_POSITION_CONFIG[] PROGMEM =
+    HA_VALVE_POSITION_CONFIG(HA_STATE_TOPIC("valve/position"), HA_VALUE);
+static const char VALVE_POSITION_JSON_CONFIG[] PROGMEM =
+    HA_VALVE_POSITION_CONFIG(HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("valve"));
+
+// Climate entity, abbreviated keys throughout to keep it short.
+// currentTemperature and action are the topic (and template) fragments.
+#define HA_CLIMATE_CONFIG(currentTemperature, action) \
+    "{\"name\":\"Thermostat\"," \
+    "\"uniq_id\":\"" HA_DISCOVERY_NODE_ID "_climate\"," \
+    "\"dev\":" HA_DEVICE "," \
+    /* Mode control */ \
+    "\"mode_cmd_t\":\"" HA_DISCOVERY_NODE_ID "/mode/set\"," \
+    "\"mode_stat_t\":\"" HA_DISCOVERY_NODE_ID "/mode/state\"," \
+    "\"modes\":[\"off\",\"heat\"]," \
+    /* Temperature control */ \
+    "\"temp_cmd_t\":\"" HA_DISCOVERY_NODE_ID "/temperature/set\"," \
+    "\"temp_stat_t\":\"" HA_DISCOVERY_NODE_ID "/temperature/setpoint\"," \
+    currentTemperature "," \
+    "\"min_temp\":15," \
+    "\"max_temp\":30," \
+    "\"temp_step\":0.5," \
+    "\"temp_unit\":\"C\"," \
+    /* Preset modes; no "none", HA handles "no preset" itself */ \
+    "\"pr_mode_cmd_t\":\"" HA_DISCOVERY_NODE_ID "/preset/set\"," \
+    "\"pr_mode_stat_t\":\"" HA_DISCOVERY_NODE_ID "/preset/state\"," \
+    "\"pr_modes\":[\"eco\",\"comfort\",\"away\",\"sleep\",\"boost\"]," \
+    /* Availability */ \
+    "\"avty_t\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"pl_avail\":\"online\"," \
+    "\"pl_not_avail\":\"offline\"," \
+    /* Action */ \
+    action "," \
+    "\"qos\":0," \
+    "\"ret\":true}"
+
+static const char CLIMATE_CONFIG[] PROGMEM = HA_CLIMATE_CONFIG(
+    "\"curr_temp_t\":\"" HA_DISCOVERY_NODE_ID "/temperature\"",
+    "\"act_t\":\"" HA_DISCOVERY_NODE_ID "/action\"");
+static const char CLIMATE_JSON_CONFIG[] PROGMEM = HA_CLIMATE_CONFIG(
+    "\"curr_temp_t\":\"" HA_DISCOVERY_NODE_ID "/state\","
+    "\"curr_temp_tpl\":\"" HA_JSON_VALUE("temperature") "\"",
+    "\"act_t\":\"" HA_DISCOVERY_NODE_ID "/state\","
+    "\"act_tpl\":\"" HA_JSON_VALUE("action") "\"");
+
+#define HA_PID_CONFIG(name, id, stateTopic, valueTemplate) \
+    "{\"name\":\"PID " name "\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_pid_" id "\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"icon\":\"mdi:chart-bell-curve\"" \
+    HA_SENSOR_TAIL
+
+static const char PID_KP_CONFIG[] PROGMEM = HA_PID_CONFIG("Kp", "kp", HA_STATE_TOPIC("pid/kp"), HA_VALUE);
+static const char PID_KI_CONFIG[] PROGMEM = HA_PID_CONFIG("Ki", "ki", HA_STATE_TOPIC("pid/ki"), HA_VALUE);
+static const char PID_KD_CONFIG[] PROGMEM = HA_PID_CONFIG("Kd", "kd", HA_STATE_TOPIC("pid/kd"), HA_VALUE);
+static const char PID_KP_JSON_CONFIG[] PROGMEM =
+    HA_PID_CONFIG("Kp", "kp", HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("kp"));
+static const char PID_KI_JSON_CONFIG[] PROGMEM =
+    HA_PID_CONFIG("Ki", "ki", HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("ki"));
+static const char PID_KD_JSON_CONFIG[] PROGMEM =
+    HA_PID_CONFIG("Kd", "kd", HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("kd"));
+
+#define HA_WIFI_SIGNAL_CONFIG(stateTopic, valueTemplate) \
+    "{\"name\":\"WiFi Signal\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_wifi_signal\"," \
+    "\"device_class\":\"signal_strength\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"unit_of_measurement\":\"dBm\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"state_class\":\"measurement\"," \
+    "\"icon\":\"mdi:wifi\"" \
+    HA_SENSOR_TAIL
+
+#define HA_UPTIME_CONFIG(stateTopic, valueTemplate) \
+    "{\"name\":\"Uptime\"," \
+    "\"unique_id\":\"" HA_DISCOVERY_NODE_ID "_uptime\"," \
+    "\"device_class\":\"duration\"," \
+    "\"state_topic\":\"" stateTopic "\"," \
+    "\"unit_of_measurement\":\"s\"," \
+    "\"value_template\":\"" valueTemplate "\"," \
+    "\"availability_topic\":\"" HA_AVAILABILITY_TOPIC "\"," \
+    "\"state_class\":\"total_increasing\"," \
+    "\"icon\":\"mdi:clock-outline\"" \
+    HA_SENSOR_TAIL
+
+static const char WIFI_SIGNAL_CONFIG[] PROGMEM =
+    HA_WIFI_SIGNAL_CONFIG(HA_STATE_TOPIC("wifi/rssi"), HA_VALUE);
+static const char WIFI_SIGNAL_JSON_CONFIG[] PROGMEM =
+    HA_WIFI_SIGNAL_CONFIG(HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("rssi"));
+static const char UPTIME_CONFIG[] PROGMEM =
+    HA_UPTIME_CONFIG(HA_STATE_TOPIC("uptime"), HA_VALUE);
+static const char UPTIME_JSON_CONFIG[] PROGMEM =
+    HA_UPTIME_CONFIG(HA_STATE_DOCUMENT_TOPIC, HA_JSON_VALUE("uptime"));
+
+const HADiscoveryEntity HA_MEASUREMENT_SENSORS[] = {
+    {"sensor", "temperature", "temperature", TEMPERATURE_CONFIG, TEMPERATURE_JSON_CONFIG},
+    {"sensor", "humidity", "humidity", HUMIDITY_CONFIG, HUMIDITY_JSON_CONFIG},
+    {"sensor", "pressure", "pressure", PRESSURE_CONFIG, PRESSURE_JSON_CONFIG},
+    {"sensor", "valve_position", "valve position", VALVE_POSITION_CONFIG, VALVE_POSITION_JSON_CONFIG},
+};
+const size_t HA_MEASUREMENT_SENSOR_COUNT = sizeof(HA_MEASUREMENT_SENSORS) / sizeof(HA_MEASUREMENT_SENSORS[0]);
+
+const HADiscoveryEntity HA_CLIMATE_ENTITY = {"climate", nullptr, "climate", CLIMATE_CONFIG, CLIMATE_JSON_CONFIG};
+
+const HADiscoveryEntity HA_DIAGNOSTIC_SENSORS[] = {
+    {"sensor", "pid_kp", "PID Kp", PID_KP_CONFIG, PID_KP_JSON_CONFIG},
+    {"sensor", "pid_ki", "PID Ki", PID_KI_CONFIG, PID_KI_JSON_CONFIG},
+    {"sensor", "pid_kd", "PID Kd", PID_KD_CONFIG, PID_KD_JSON_CONFIG},
+    {"sensor", "wifi_signal", "WiFi signal", WIFI_SIGNAL_CONFIG, WIFI_SIGNAL_JSON_CONFIG},
+    {"sensor", "uptime", "uptime", UPTIME_CONFIG, UPTIME_JSON_CONFIG},
+};
+const size_t HA_DIAGNOSTIC_SENSOR_COUNT = sizeof(HA_DIAGNOSTIC_SENSORS) / sizeof(HA_DIAGNOSTIC_SENSORS[0]);
+
+static_assert(sizeof(HA_MEASUREMENT_SENSORS) / sizeof(HA_MEASUREMENT_SENSORS[0]) + 1 +
+              sizeof(HA_DIAGNOSTIC_SENSORS) / sizeof(HA_DIAGNOSTIC_SENSORS[0]) == HA_DISCOVERY_ENTITY_COUNT,
+              "HA_DISCOVERY_ENTITY_COUNT must match the entity tables");
+
+const HADiscoveryEntity& discoveryEntity(size_t index) {
+    if (index < HA_MEASUREMENT_SENSOR_COUNT) {
+        return HA_MEASUREMENT_SENSORS[index];
+    }
+    if (index == HA_MEASUREMENT_SENSOR_COUNT) {
+        return HA_CLIMATE_ENTITY;
+    }
+    return HA_DIAGNOSTIC_SENSORS[index - HA_MEASUREMENT_SENSOR_COUNT - 1];
+}
+
+size_t formatDiscoveryTopic(char* out, size_t size, const HADiscoveryEntity& entity, const char* nodeId) {
+    int length;
+    if (entity.objectId != nullptr) {
+        length = snprintf(out, size, HA_DISCOVERY_PREFIX "/%s/%s/%s/config",
+                          entity.component, nodeId, entity.objectId);
+    } else {
+        length = snprintf(out, size, HA_DISCOVERY_PREFIX "/%s/%s/config", entity.component, nodeId);
+    }
+    return (length > 0 && (size_t)length < size) ? (size_t)length : 0;
+}
+
+size_t discoveryPayloadLength(const char* payload, const char* nodeId, const char* version) {
+    size_t nodeIdLength = strlen(nodeId);
+    size_t versionLength = strlen(version);
+    size_t length = 0;
+    for (const char* p = payload; *p != '\0'; p++) {
+        if (*p == HA_DISCOVERY_NODE_ID[0]) {
+            length += nodeIdLength;
+        } else if (*p == HA_DISCOVERY_VERSION[0]) {
+            length += versionLength;
+        } else {
+            length++;
+        }
+    }
+    return length;
+}
+
+namespace {
+
+const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+const uint32_t FNV_PRIME = 16777619u;
+
+// Hashes whatever is written to it
+class HashPrint : public Print {
+public:
+    HashPrint() : _hash(FNV_OFFSET_BASIS) {}
+
+    size_t write(uint8_t c) override {
+        _hash = (_hash ^ c) * FNV_PRIME;
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            _hash = (_hash ^ buffer[i]) * FNV_PRIME;
+        }
+        return size;
+    }
+
+    uint32_t hash() const { return _hash; }
+
+private:
+    uint32_t _hash;
+};
+
+// Collects small pieces so the client sees a few large writes instead of many tiny ones
+class ChunkWriter {
+public:
+    explicit ChunkWriter(Print& out) : _out(out), _used(0), _written(0) {}
+
+    void append(const char* data, size_t length) {
+        while (length > 0) {
+            size_t n = sizeof(_chunk) - _used;
+            if (n > length) {
+                n = length;
+            }
+            memcpy(_chunk + _used, data, n);
+            _used += n;
+            data += n;
+            length -= n;
+            if (_used == sizeof(_chunk)) {
+                flush();
+            }
+        }
+    }
+
+    size_t finish() {
+        flush();
+        return _written;
+    }
+
+private:
+    void flush() {
+        if (_used > 0) {
+            _written += _out.write(_chunk, _used);
+            _used = 0;
+        }
+    }
+
+    Print& _out;
+    uint8_t _chunk[64];
+    size_t _used;
+    size_t _written;
+};
+
+}  // namespace
+
+size_t writeDiscoveryPayload(Print& out, const char* payload, const char* nodeId, const char* version) {
+    size_t nodeIdLength = strlen(nodeId);
+    size_t versionLength = strlen(version);
+    ChunkWriter writer(out);
+
+    const char* run = payload;
+    for (const char* p = payload; ; p++) {
+        bool isNodeId = *p == HA_DISCOVERY_NODE_ID[0];
+        bool isVersion = *p == HA_DISCOVERY_VERSION[0];
+        if (!isNodeId && !isVersion && *p != '\0') {
+            continue;
+        }
+        writer.append(run, p - run);
+        if (*p == '\0') {
+            break;
+        }
+        if (isNodeId) {
+            writer.append(nodeId, nodeIdLength);
+        } else {
+            writer.append(version, versionLength);
+        }
+        run = p + 1;
+    }
+    return writer.finish();
+}
+
+uint32_t discoveryPayloadHash(const char* payload, const char* nodeId, const char* version) {
+    HashPrint hash;
+    writeDiscoveryPayload(hash, payload, nodeId, version);
+    return hash.hash();
+}
+
+uint32_t discoveryDigest(const uint32_t* hashes, size_t count) {
+    HashPrint digest;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t bytes[4] = {(uint8_t)hashes[i], (uint8_t)(hashes[i] >> 8),
+                            (uint8_t)(hashes[i] >> 16), (uint8_t)(hashes[i] >> 24)};
+        digest.write(bytes, sizeof(bytes));
+    }
+    return digest.hash();
+}
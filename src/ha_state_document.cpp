@@ -0,0 +1,74 @@
+#include "ha_state_document.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+HAStateDocument::HAStateDocument()
+    : temperature(NAN), humidity(NAN), pressure(NAN), valvePosition(0), action("idle"),
+      kp(NAN), ki(NAN), kd(NAN), wifiRSSI(0), uptime(0) {
+}
+
+namespace {
+
+// Appends to a fixed buffer; remembers if anything did not fit
+class DocumentWriter {
+public:
+    DocumentWriter(char* out, size_t size) : _out(out), _size(size), _length(0), _overflow(size == 0) {
+        if (size > 0) {
+            out[0] = '\0';
+        }
+    }
+
+    void append(const char* format, ...) {
+        if (_overflow) {
+            return;
+        }
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(_out + _length, _size - _length, format, args);
+        va_end(args);
+        if (n < 0 || (size_t)n >= _size - _length) {
+            _overflow = true;
+            return;
+        }
+        _length += n;
+    }
+
+    // Same precision as the per-topic payloads; null when not known
+    void number(const char* key, float value, int decimals) {
+        if (isfinite(value)) {
+            append(",\"%s\":%.*f", key, decimals, (double)value);
+        } else {
+            append(",\"%s\":null", key);
+        }
+    }
+
+    size_t finish() const {
+        return _overflow ? 0 : _length;
+    }
+
+private:
+    char* _out;
+    size_t _size;
+    size_t _length;
+    bool _overflow;
+};
+
+}  // namespace
+
+size_t formatStateDocument(char* out, size_t size, const HAStateDocument& state) {
+    DocumentWriter writer(out, size);
+    if (isfinite(state.temperature)) {
+        writer.append("{\"temperature\":%.2f", (double)state.temperature);
+    } else {
+        writer.append("{\"temperature\":null");
+    }
+    writer.number("humidity", state.humidity, 2);
+    writer.number("pressure", state.pressure, 2);
+    writer.append(",\"valve\":%d,\"action\":\"%s\"", state.valvePosition, state.action);
+    writer.number("kp", state.kp, 2);
+    writer.number("ki", state.ki, 3);
+    writer.number("kd", state.kd, 3);
+    writer.append(",\"rssi\":%d,\"uptime\":%lu}", state.wifiRSSI, (unsigned long)state.uptime);
+    return writer.finish();
+}
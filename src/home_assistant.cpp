@@ -3,16 +3,48 @@
 #include "config_manager.h"
 #include "serial_monitor.h"
 #include "serial_redirect.h"
+#include "ha_discovery.h"
 
 // Redirect Serial to CapturedSerial for web monitor
 #define Serial CapturedSerial
 
-// Define discovery topic prefix according to Home Assistant standard
-#define HA_DISCOVERY_PREFIX "homeassistant"
+// Home Assistant announces itself here ("online"/"offline")
+static const char* HA_BIRTH_TOPIC = "homeassistant/status";
+
+// Digest of the discovery configs on the broker (retained, 8 hex digits)
+static const char* HA_DISCOVERY_DIGEST_TOPIC = "esp32_thermostat/discovery/digest";
+
+// How long to wait for the retained digest after connecting
+static const uint32_t HA_DISCOVERY_DIGEST_WAIT_MS = 3000;
+
+// Publish policy per state topic, indexed by StateTopic:
+// {absolute deadband, relative deadband, min interval ms, heartbeat ms}
+static const TopicPolicy STATE_POLICIES[] = {
+    {0.05f, 0.0f, 10000, 300000},   // Temperature (°C)
+    {0.5f, 0.0f, 10000, 300000},    // Humidity (%)
+    {0.3f, 0.0f, 10000, 300000},    // Pressure (hPa)
+    {1.0f, 0.0f, 0, 300000},        // Valve position (%)
+    {0.0f, 0.0f, 0, 300000},        // Action
+    {0.0f, 0.0f, 0, 600000},        // Availability (retained)
+    {0.0f, 0.0f, 0, 600000},        // Mode (retained)
+    {0.0f, 0.0f, 0, 600000},        // Preset (retained)
+    {0.05f, 0.0f, 0, 600000},       // Setpoint (retained)
+    {0.005f, 0.0f, 0, 600000},      // PID Kp (2 decimals published)
+    {0.0005f, 0.0f, 0, 600000},     // PID Ki (3 decimals published)
+    {0.0005f, 0.0f, 0, 600000},     // PID Kd (3 decimals published)
+    {3.0f, 0.0f, 60000, 300000},    // WiFi RSSI (dBm)
+    {0.0f, 0.0f, 300000, 0},        // Uptime (always changes; rate only)
+    {0.0f, 0.0f, 10000, 300000},    // State document (due when any state in it is)
+};
 
 // Constructor
 HomeAssistant::HomeAssistant(PubSubClient& mqttClient, const char* nodeId) 
-    : _mqttClient(mqttClient), _nodeId(nodeId) {
+    : _mqttClient(mqttClient), _nodeId(nodeId), _publishPolicy(STATE_POLICIES, TOPIC_COUNT),
+      _stateDocumentEnabled(false), _discoveryState(DISCOVERY_IDLE), _digestWaitStart(0),
+      _brokerDigest(0), _birthPending(false), _discoveryPublished(0), _discoverySkipped(0) {
+    memset(_discoveryHashes, 0, sizeof(_discoveryHashes));
+    static_assert(sizeof(STATE_POLICIES) / sizeof(STATE_POLICIES[0]) == TOPIC_COUNT,
+                  "STATE_POLICIES must have one entry per StateTopic");
     
     // Set up availability topic
     _availabilityTopic = String("esp32_thermostat/status");
@@ -20,131 +52,140 @@ HomeAssistant::HomeAssistant(PubSubClient& mqttClient, const char* nodeId)
 
 // Initialize Home Assistant auto discovery
 void HomeAssistant::begin() {
-    Serial.println("Initializing Home Assistant auto discovery...");
-    
-    // First ensure we're connected
-    if (!_mqttClient.connected()) {
-        Serial.println("MQTT client not connected, cannot initialize Home Assistant discovery");
-        return;
+    // Nothing is known to be on the broker yet; connected() finds out
+    memset(_discoveryHashes, 0, sizeof(_discoveryHashes));
+    _brokerDigest = 0;
+    _discoveryState = DISCOVERY_IDLE;
+    _birthPending = false;
+
+    Serial.println("Home Assistant discovery will be checked on every MQTT connect");
+}
+
+// Call after every (re)connect: subscribe, then wait briefly for the retained digest
+void HomeAssistant::connected(uint32_t now) {
+    _mqttClient.subscribe(HA_BIRTH_TOPIC);
+    _mqttClient.subscribe(HA_DISCOVERY_DIGEST_TOPIC);
+    _discoveryState = DISCOVERY_AWAIT_DIGEST;
+    _digestWaitStart = now;
+}
+
+// Runs inside PubSubClient::loop(), whose buffer holds the payload: only note what to do
+bool HomeAssistant::handleMessage(const char* topic, const uint8_t* payload, size_t length) {
+    if (strcmp(topic, HA_BIRTH_TOPIC) == 0) {
+        if (length == 6 && memcmp(payload, "online", 6) == 0) {
+            _birthPending = true;
+        }
+        return true;
     }
-    
-    // Register auto-discovery information
-    registerEntities();
-    
-    // Set initial availability
-    updateAvailability(true);
-    
-    Serial.println("Home Assistant auto discovery initialized");
+    if (strcmp(topic, HA_DISCOVERY_DIGEST_TOPIC) != 0) {
+        return false;
+    }
+
+    // Only the retained copy delivered on subscribe matters, not our own updates
+    if (_discoveryState != DISCOVERY_AWAIT_DIGEST) {
+        return true;
+    }
+    char digestStr[9];
+    if (length >= sizeof(digestStr)) {
+        length = sizeof(digestStr) - 1;
+    }
+    memcpy(digestStr, payload, length);
+    digestStr[length] = '\0';
+    uint32_t digest = (uint32_t)strtoul(digestStr, nullptr, 16);
+
+    uint32_t hashes[HA_DISCOVERY_ENTITY_COUNT];
+    discoveryHashes(hashes);
+    if (digest == discoveryDigest(hashes, HA_DISCOVERY_ENTITY_COUNT)) {
+        // The broker still holds exactly these configs
+        memcpy(_discoveryHashes, hashes, sizeof(_discoveryHashes));
+        _brokerDigest = digest;
+        _discoveryState = DISCOVERY_IDLE;
+    } else {
+        _discoveryState = DISCOVERY_PUBLISH;
+    }
+    return true;
 }
 
-// Register all entities for auto discovery
-void HomeAssistant::registerEntities() {
-    // Get current timestamp for debugging
-    unsigned long now = millis();
-    String timestamp = String(now);
+// MQTT task, outside PubSubClient::loop()
+void HomeAssistant::loop(uint32_t now) {
+    if (_discoveryState == DISCOVERY_AWAIT_DIGEST && now - _digestWaitStart >= HA_DISCOVERY_DIGEST_WAIT_MS) {
+        // No retained digest: the broker lost its retained messages (or never had them)
+        Serial.println("No discovery digest on the broker - publishing discovery");
+        _discoveryState = DISCOVERY_PUBLISH;
+    }
+    if (_discoveryState == DISCOVERY_PUBLISH) {
+        // Whatever the broker holds, it is not what we last sent
+        memset(_discoveryHashes, 0, sizeof(_discoveryHashes));
+        _brokerDigest = 0;
+        registerEntities();
+        _discoveryState = DISCOVERY_IDLE;
+    }
 
-    Serial.println("Registering entities with Home Assistant at time: " + timestamp);
+    if (_birthPending && _discoveryState == DISCOVERY_IDLE) {
+        // Home Assistant (re)started: it may have dropped entities whatever the
+        // broker holds, so every config goes out again, and it has missed every
+        // non-retained state
+        _birthPending = false;
+        Serial.println("Home Assistant is online - republishing discovery and states");
+        memset(_discoveryHashes, 0, sizeof(_discoveryHashes));
+        registerEntities();
+        resetPublishState();
+        syncClimateState();
+        updateAvailability(true);
+    }
+}
 
-    // Create origin info (for sensors - full keys)
-    String originInfo = "{\"name\":\"ESP32-KNX-Thermostat\",\"sw_version\":\"" + String(FIRMWARE_VERSION) + "\",\"support_url\":\"https://github.com/yourusername/ESP32-KNX-Thermostat\"}";
+void HomeAssistant::switchStateDocument(bool enabled) {
+    if (enabled == _stateDocumentEnabled) {
+        return;
+    }
+    _stateDocumentEnabled = enabled;
+    Serial.print("State document ");
+    Serial.println(enabled ? "enabled" : "disabled");
 
-    // Create device info JSON string using ABBREVIATED keys for climate entity
-    // Using abbreviated keys: ids, mf, mdl, sw (instead of identifiers, manufacturer, model, sw_version)
-    String deviceInfo = "{\"ids\":[\"" + String(_nodeId) + "\"],\"name\":\"ESP32 KNX Thermostat\",\"mf\":\"DIY\",\"mdl\":\"ESP32-KNX-Thermostat\",\"sw\":\"" + String(FIRMWARE_VERSION) + "\"}";
-    
-    // Temperature sensor with enhanced attributes
-    String tempTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/temperature/config";
-    String tempPayload = "{";
-    tempPayload += "\"name\":\"Temperature\",";
-    tempPayload += "\"unique_id\":\"" + String(_nodeId) + "_temperature\",";
-    tempPayload += "\"device_class\":\"temperature\",";
-    tempPayload += "\"state_topic\":\"esp32_thermostat/temperature\",";
-    tempPayload += "\"unit_of_measurement\":\"°C\",";
-    tempPayload += "\"value_template\":\"{{ value }}\",";
-    tempPayload += "\"availability_topic\":\"esp32_thermostat/status\",";
-    tempPayload += "\"state_class\":\"measurement\",";  // Add state_class for proper history
-    tempPayload += "\"suggested_display_precision\":1,"; // Precision for display
-    tempPayload += "\"origin\":" + originInfo + ",";
-    tempPayload += "\"device\":" + deviceInfo;
-    tempPayload += "}";
-    
-    bool tempSuccess = _mqttClient.publish(tempTopic.c_str(), tempPayload.c_str(), true);
-    Serial.print("Published temperature config: ");
-    Serial.println(tempSuccess ? "Success" : "FAILED");
-    
-    // Humidity sensor with enhanced attributes
-    String humTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/humidity/config";
-    String humPayload = "{";
-    humPayload += "\"name\":\"Humidity\",";
-    humPayload += "\"unique_id\":\"" + String(_nodeId) + "_humidity\",";
-    humPayload += "\"device_class\":\"humidity\",";
-    humPayload += "\"state_topic\":\"esp32_thermostat/humidity\",";
-    humPayload += "\"unit_of_measurement\":\"%\",";
-    humPayload += "\"value_template\":\"{{ value }}\",";
-    humPayload += "\"availability_topic\":\"esp32_thermostat/status\",";
-    humPayload += "\"state_class\":\"measurement\",";  // Add state_class for proper history
-    humPayload += "\"suggested_display_precision\":1,"; // Precision for display
-    humPayload += "\"origin\":" + originInfo + ",";
-    humPayload += "\"device\":" + deviceInfo;
-    humPayload += "}";
-    
-    bool humSuccess = _mqttClient.publish(humTopic.c_str(), humPayload.c_str(), true);
-    Serial.print("Published humidity config: ");
-    Serial.println(humSuccess ? "Success" : "FAILED");
-    
-    // Pressure sensor with enhanced attributes
-    String presTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/pressure/config";
-    String presPayload = "{";
-    presPayload += "\"name\":\"Pressure\",";
-    presPayload += "\"unique_id\":\"" + _nodeId + "_pressure\",";
-    presPayload += "\"device_class\":\"pressure\",";
-    presPayload += "\"state_topic\":\"esp32_thermostat/pressure\",";
-    presPayload += "\"unit_of_measurement\":\"hPa\",";
-    presPayload += "\"value_template\":\"{{ value }}\",";
-    presPayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    presPayload += "\"state_class\":\"measurement\",";  // Add state_class for proper history
-    presPayload += "\"suggested_display_precision\":1,"; // Precision for display
-    presPayload += "\"origin\":" + originInfo + ",";
-    presPayload += "\"device\":" + deviceInfo;
-    presPayload += "}";
-    
-    bool presSuccess = _mqttClient.publish(presTopic.c_str(), presPayload.c_str(), true);
-    Serial.print("Published pressure config: ");
-    Serial.println(presSuccess ? "Success" : "FAILED");
-    
-    // Valve position sensor with enhanced attributes
-    String valvePosTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/valve_position/config";
-    String valuePosPayload = "{";
-    valuePosPayload += "\"name\":\"Valve Position\",";
-    valuePosPayload += "\"unique_id\":\"" + _nodeId + "_valve_position\",";
-    valuePosPayload += "\"state_topic\":\"esp32_thermostat/valve/position\",";
-    valuePosPayload += "\"unit_of_measurement\":\"%\",";
-    valuePosPayload += "\"value_template\":\"{{ value }}\",";
-    valuePosPayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    valuePosPayload += "\"state_class\":\"measurement\",";  // Add state_class for proper history
-    valuePosPayload += "\"icon\":\"mdi:valve\",";           // Add an appropriate icon
-    valuePosPayload += "\"origin\":" + originInfo + ",";
-    valuePosPayload += "\"device\":" + deviceInfo;
-    valuePosPayload += "}";
-    
-    bool valvePosSuccess = _mqttClient.publish(valvePosTopic.c_str(), valuePosPayload.c_str(), true);
-    Serial.print("Published valve position config: ");
-    Serial.println(valvePosSuccess ? "Success" : "FAILED");
+    // While the digest check is pending it already compares against the new layout
+    if (_discoveryState == DISCOVERY_IDLE) {
+        registerEntities();
+    }
+    resetPublishState();
+}
 
-    // ========================================================================
-    // CRITICAL: Publish ALL climate state topics BEFORE discovery config
-    // This ensures Home Assistant finds retained messages when it subscribes
-    // ========================================================================
+// Hash of every config as it would be published now, in publish order
+void HomeAssistant::discoveryHashes(uint32_t* hashes) const {
+    for (size_t i = 0; i < HA_DISCOVERY_ENTITY_COUNT; i++) {
+        const HADiscoveryEntity& entity = discoveryEntity(i);
+        const char* payload = _stateDocumentEnabled ? entity.jsonPayload : entity.payload;
+        hashes[i] = discoveryPayloadHash(payload, _nodeId.c_str(), FIRMWARE_VERSION);
+    }
+}
 
-    // Get ConfigManager instance early for all state publishing
+// Stream one discovery config from its flash template (see ha_discovery.h)
+bool HomeAssistant::publishDiscovery(const HADiscoveryEntity& entity) {
+    char topic[96];
+    if (formatDiscoveryTopic(topic, sizeof(topic), entity, _nodeId.c_str()) == 0) {
+        return false;
+    }
+
+    const char* payload = _stateDocumentEnabled ? entity.jsonPayload : entity.payload;
+    size_t length = discoveryPayloadLength(payload, _nodeId.c_str(), FIRMWARE_VERSION);
+    if (!_mqttClient.beginPublish(topic, length, true)) {
+        return false;
+    }
+    size_t written = writeDiscoveryPayload(_mqttClient, payload, _nodeId.c_str(), FIRMWARE_VERSION);
+    return _mqttClient.endPublish() && written == length;
+}
+
+// Climate state topics, retained, published BEFORE the climate discovery config
+// so Home Assistant finds them as soon as it subscribes
+void HomeAssistant::publishClimateStates() {
     extern ConfigManager* configManager;
 
     Serial.println("\n=== Publishing Climate State Topics (BEFORE Discovery) ===");
 
     // 1. Publish mode state from ConfigManager (not hardcoded "heat")
     const char* initMode = (configManager && configManager->getThermostatEnabled()) ? "heat" : "off";
-    bool modeSuccess = _mqttClient.publish("esp32_thermostat/mode/state", initMode, true);
-    Serial.print("  [1/4] Mode state: ");
+    bool modeSuccess = publishNow(TOPIC_MODE, "esp32_thermostat/mode/state", initMode, true);
+    Serial.print("  [1/3] Mode state: ");
     Serial.print(initMode);
     Serial.print(" - ");
     Serial.println(modeSuccess ? "OK" : "FAILED");
@@ -153,8 +194,8 @@ void HomeAssistant::registerEntities() {
     char setpointStr[8];
     float initialSetpoint = configManager ? configManager->getSetpoint() : PID_SETPOINT;
     dtostrf(initialSetpoint, 1, 1, setpointStr);
-    bool setpointSuccess = _mqttClient.publish("esp32_thermostat/temperature/setpoint", setpointStr, true);
-    Serial.print("  [2/4] Setpoint from ConfigManager: ");
+    bool setpointSuccess = publishNow(TOPIC_SETPOINT, "esp32_thermostat/temperature/setpoint", initialSetpoint, setpointStr, true);
+    Serial.print("  [2/3] Setpoint from ConfigManager: ");
     Serial.print(setpointStr);
     Serial.print("°C - ");
     Serial.println(setpointSuccess ? "OK" : "FAILED");
@@ -164,7 +205,7 @@ void HomeAssistant::registerEntities() {
 
     if (configManager) {
         currentPreset = configManager->getCurrentPreset();
-        Serial.print("  [3/4] Preset from ConfigManager: '");
+        Serial.print("  [3/3] Preset from ConfigManager: '");
         Serial.print(currentPreset);
         Serial.println("'");
 
@@ -186,213 +227,60 @@ void HomeAssistant::registerEntities() {
             configManager->setCurrentPreset("comfort");
         }
     } else {
-        Serial.println("  [3/4] WARNING: ConfigManager is NULL - using default 'comfort'");
+        Serial.println("  [3/3] WARNING: ConfigManager is NULL - using default 'comfort'");
         currentPreset = "comfort";
     }
 
-    bool presetSuccess = _mqttClient.publish("esp32_thermostat/preset/state", currentPreset.c_str(), true);
+    bool presetSuccess = publishNow(TOPIC_PRESET, "esp32_thermostat/preset/state", currentPreset.c_str(), true);
     Serial.print("        Preset state: '");
     Serial.print(currentPreset);
     Serial.print("' - ");
     Serial.println(presetSuccess ? "OK" : "FAILED");
+}
+
+// Publish the discovery configs the broker does not hold yet
+void HomeAssistant::registerEntities() {
+    uint32_t hashes[HA_DISCOVERY_ENTITY_COUNT];
+    discoveryHashes(hashes);
+
+    Serial.print("Registering entities with Home Assistant at time: ");
+    Serial.println(millis());
+
+    for (size_t i = 0; i < HA_DISCOVERY_ENTITY_COUNT; i++) {
+        const HADiscoveryEntity& entity = discoveryEntity(i);
+        if (hashes[i] == _discoveryHashes[i]) {
+            _discoverySkipped++;
+            continue;
+        }
+        if (&entity == &HA_CLIMATE_ENTITY) {
+            publishClimateStates();
+        }
 
-    // 4. Publish initial action state (idle at startup)
-    bool actionSuccess = _mqttClient.publish("esp32_thermostat/action", "idle", true);
-    Serial.print("  [4/4] Action state: idle - ");
-    Serial.println(actionSuccess ? "OK" : "FAILED");
-
-    // Note: No delay needed - MQTT broker will process retained messages asynchronously
-    Serial.println("  Waiting for broker to process retained messages...");
-
-    Serial.println("=== All State Topics Published Successfully ===\n");
-
-    // ========================================================================
-    // NOW publish the climate discovery config
-    // Home Assistant will immediately subscribe and find the retained states
-    // ========================================================================
-
-    Serial.println("=== Publishing Climate Discovery Config ===");
-
-    String climateTopic = String(HA_DISCOVERY_PREFIX) + "/climate/" + _nodeId + "/config";
-    String climatePayload = "{";
-    climatePayload += "\"name\":\"Thermostat\",";
-    climatePayload += "\"uniq_id\":\"" + String(_nodeId) + "_climate\",";
-    climatePayload += "\"dev\":" + deviceInfo + ",";
-    // Mode control (abbreviated)
-    climatePayload += "\"mode_cmd_t\":\"" + String(_nodeId) + "/mode/set\",";
-    climatePayload += "\"mode_stat_t\":\"" + String(_nodeId) + "/mode/state\",";
-    climatePayload += "\"modes\":[\"off\",\"heat\"],";
-    // Temperature control (abbreviated)
-    climatePayload += "\"temp_cmd_t\":\"" + String(_nodeId) + "/temperature/set\",";
-    climatePayload += "\"temp_stat_t\":\"" + String(_nodeId) + "/temperature/setpoint\",";
-    climatePayload += "\"curr_temp_t\":\"" + String(_nodeId) + "/temperature\",";
-    climatePayload += "\"min_temp\":15,";
-    climatePayload += "\"max_temp\":30,";
-    climatePayload += "\"temp_step\":0.5,";
-    climatePayload += "\"temp_unit\":\"C\",";
-    // Preset modes (abbreviated)
-    climatePayload += "\"pr_mode_cmd_t\":\"" + String(_nodeId) + "/preset/set\",";
-    climatePayload += "\"pr_mode_stat_t\":\"" + String(_nodeId) + "/preset/state\",";
-    // Note: Do NOT include "none" - HA handles "no preset" internally
-    climatePayload += "\"pr_modes\":[\"eco\",\"comfort\",\"away\",\"sleep\",\"boost\"],";
-    // Availability (abbreviated)
-    climatePayload += "\"avty_t\":\"" + _availabilityTopic + "\",";
-    climatePayload += "\"pl_avail\":\"online\",";
-    climatePayload += "\"pl_not_avail\":\"offline\",";
-    // Action (abbreviated)
-    climatePayload += "\"act_t\":\"" + String(_nodeId) + "/action\",";
-    climatePayload += "\"qos\":0,";
-    climatePayload += "\"ret\":true";
-    climatePayload += "}";
-
-    Serial.print("  Discovery payload size: ");
-    Serial.print(climatePayload.length());
-    Serial.println(" bytes");
-
-    bool climateSuccess = _mqttClient.publish(climateTopic.c_str(), climatePayload.c_str(), true);
-    Serial.print("  Published to: ");
-    Serial.println(climateTopic);
-    Serial.print("  Result: ");
-    Serial.println(climateSuccess ? "SUCCESS" : "FAILED");
-
-    if (!climateSuccess) {
-        Serial.println("  ERROR: Climate discovery publish failed!");
-        Serial.println("  Check MQTT buffer size and broker connection");
+        bool success = publishDiscovery(entity);
+        Serial.print("Published ");
+        Serial.print(entity.label);
+        Serial.print(" config: ");
+        Serial.println(success ? "Success" : "FAILED");
+        if (success) {
+            _discoveryHashes[i] = hashes[i];
+            _discoveryPublished++;
+        }
     }
 
-    Serial.println("=== Climate Discovery Complete ===\n");
-
-    // Subscribe to the thermostat control topics
-    _mqttClient.subscribe("esp32_thermostat/mode/set");
-    _mqttClient.subscribe("esp32_thermostat/temperature/set");
-    _mqttClient.subscribe("esp32_thermostat/preset/set");
-    Serial.println("Subscribed to thermostat control topics");
-
-    // Re-publish states one more time to ensure HA picks them up
-    // (Some sources suggest this helps with initialization)
-    // Note: No delay needed - publishing happens immediately
-    Serial.println("\n=== Re-publishing States After Discovery ===");
-    const char* modeState = (configManager && configManager->getThermostatEnabled()) ? "heat" : "off";
-    _mqttClient.publish("esp32_thermostat/mode/state", modeState, true);
-    _mqttClient.publish("esp32_thermostat/temperature/setpoint", setpointStr, true);
-    _mqttClient.publish("esp32_thermostat/preset/state", currentPreset.c_str(), true);
-    _mqttClient.publish("esp32_thermostat/action", "idle", true);
-    Serial.println("  All states re-published");
-    Serial.println("=== Climate Entity Initialization Complete ===\n");
-
-    // Add restart command option
-    _mqttClient.subscribe("esp32_thermostat/restart");
-
-    // NOTE: Removed redundant "Heating Status" binary sensor
-    // The climate entity's "action" attribute already shows heating/idle/off state
-
-    // PID Kp parameter sensor
-    String kpTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/pid_kp/config";
-    String kpPayload = "{";
-    kpPayload += "\"name\":\"PID Kp\",";
-    kpPayload += "\"unique_id\":\"" + String(_nodeId) + "_pid_kp\",";
-    kpPayload += "\"state_topic\":\"esp32_thermostat/pid/kp\",";
-    kpPayload += "\"value_template\":\"{{ value }}\",";
-    kpPayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    kpPayload += "\"icon\":\"mdi:chart-bell-curve\",";
-    kpPayload += "\"origin\":" + originInfo + ",";
-    kpPayload += "\"device\":" + deviceInfo;
-    kpPayload += "}";
-    bool kpSuccess = _mqttClient.publish(kpTopic.c_str(), kpPayload.c_str(), true);
-    Serial.print("Published PID Kp config: ");
-    Serial.println(kpSuccess ? "Success" : "FAILED");
-
-    // PID Ki parameter sensor
-    String kiTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/pid_ki/config";
-    String kiPayload = "{";
-    kiPayload += "\"name\":\"PID Ki\",";
-    kiPayload += "\"unique_id\":\"" + String(_nodeId) + "_pid_ki\",";
-    kiPayload += "\"state_topic\":\"esp32_thermostat/pid/ki\",";
-    kiPayload += "\"value_template\":\"{{ value }}\",";
-    kiPayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    kiPayload += "\"icon\":\"mdi:chart-bell-curve\",";
-    kiPayload += "\"origin\":" + originInfo + ",";
-    kiPayload += "\"device\":" + deviceInfo;
-    kiPayload += "}";
-    bool kiSuccess = _mqttClient.publish(kiTopic.c_str(), kiPayload.c_str(), true);
-    Serial.print("Published PID Ki config: ");
-    Serial.println(kiSuccess ? "Success" : "FAILED");
-
-    // PID Kd parameter sensor
-    String kdTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/pid_kd/config";
-    String kdPayload = "{";
-    kdPayload += "\"name\":\"PID Kd\",";
-    kdPayload += "\"unique_id\":\"" + String(_nodeId) + "_pid_kd\",";
-    kdPayload += "\"state_topic\":\"esp32_thermostat/pid/kd\",";
-    kdPayload += "\"value_template\":\"{{ value }}\",";
-    kdPayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    kdPayload += "\"icon\":\"mdi:chart-bell-curve\",";
-    kdPayload += "\"origin\":" + originInfo + ",";
-    kdPayload += "\"device\":" + deviceInfo;
-    kdPayload += "}";
-    bool kdSuccess = _mqttClient.publish(kdTopic.c_str(), kdPayload.c_str(), true);
-    Serial.print("Published PID Kd config: ");
-    Serial.println(kdSuccess ? "Success" : "FAILED");
-
-    // WiFi signal strength sensor
-    String wifiTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/wifi_signal/config";
-    String wifiPayload = "{";
-    wifiPayload += "\"name\":\"WiFi Signal\",";
-    wifiPayload += "\"unique_id\":\"" + String(_nodeId) + "_wifi_signal\",";
-    wifiPayload += "\"device_class\":\"signal_strength\",";
-    wifiPayload += "\"state_topic\":\"esp32_thermostat/wifi/rssi\",";
-    wifiPayload += "\"unit_of_measurement\":\"dBm\",";
-    wifiPayload += "\"value_template\":\"{{ value }}\",";
-    wifiPayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    wifiPayload += "\"state_class\":\"measurement\",";
-    wifiPayload += "\"icon\":\"mdi:wifi\",";
-    wifiPayload += "\"origin\":" + originInfo + ",";
-    wifiPayload += "\"device\":" + deviceInfo;
-    wifiPayload += "}";
-    bool wifiSuccess = _mqttClient.publish(wifiTopic.c_str(), wifiPayload.c_str(), true);
-    Serial.print("Published WiFi signal config: ");
-    Serial.println(wifiSuccess ? "Success" : "FAILED");
-
-    // Uptime sensor
-    String uptimeTopic = String(HA_DISCOVERY_PREFIX) + "/sensor/" + _nodeId + "/uptime/config";
-    String uptimePayload = "{";
-    uptimePayload += "\"name\":\"Uptime\",";
-    uptimePayload += "\"unique_id\":\"" + String(_nodeId) + "_uptime\",";
-    uptimePayload += "\"device_class\":\"duration\",";
-    uptimePayload += "\"state_topic\":\"esp32_thermostat/uptime\",";
-    uptimePayload += "\"unit_of_measurement\":\"s\",";
-    uptimePayload += "\"value_template\":\"{{ value }}\",";
-    uptimePayload += "\"availability_topic\":\"" + _availabilityTopic + "\",";
-    uptimePayload += "\"state_class\":\"total_increasing\",";
-    uptimePayload += "\"icon\":\"mdi:clock-outline\",";
-    uptimePayload += "\"origin\":" + originInfo + ",";
-    uptimePayload += "\"device\":" + deviceInfo;
-    uptimePayload += "}";
-    bool uptimeSuccess = _mqttClient.publish(uptimeTopic.c_str(), uptimePayload.c_str(), true);
-    Serial.print("Published uptime config: ");
-    Serial.println(uptimeSuccess ? "Success" : "FAILED");
+    // Retained next to the configs; a failed config leaves a stale hash in it,
+    // so the next connect finds a mismatch and tries again
+    uint32_t digest = discoveryDigest(_discoveryHashes, HA_DISCOVERY_ENTITY_COUNT);
+    if (digest != _brokerDigest) {
+        char digestStr[9];
+        snprintf(digestStr, sizeof(digestStr), "%08lx", (unsigned long)digest);
+        if (_mqttClient.publish(HA_DISCOVERY_DIGEST_TOPIC, digestStr, true)) {
+            _brokerDigest = digest;
+        }
+    }
 }
 
 // Send state updates for each entity
 void HomeAssistant::updateStates(float temperature, float humidity, float pressure, int valvePosition) {
-    // Convert values to strings and publish
-    char tempStr[8];
-    dtostrf(temperature, 1, 2, tempStr);
-    _mqttClient.publish("esp32_thermostat/temperature", tempStr);
-    
-    char humStr[8];
-    dtostrf(humidity, 1, 2, humStr);
-    _mqttClient.publish("esp32_thermostat/humidity", humStr);
-    
-    char presStr[8];
-    dtostrf(pressure, 1, 2, presStr);
-    _mqttClient.publish("esp32_thermostat/pressure", presStr);
-    
-    // For the valve position
-    char valveStr[4];
-    itoa(valvePosition, valveStr, 10);
-    _mqttClient.publish("esp32_thermostat/valve/position", valveStr);
-    
     // HA FIX #2: Update action state based on mode AND valve position
     // When mode is "off", action should be "off", not "idle"
     extern ConfigManager* configManager;
@@ -404,36 +292,133 @@ void HomeAssistant::updateStates(float temperature, float humidity, float pressu
     } else {
         action = "idle";
     }
-    _mqttClient.publish("esp32_thermostat/action", action);
 
-    // Also publish a general "online" status message
-    _mqttClient.publish(_availabilityTopic.c_str(), "online", true);
+    if (_stateDocumentEnabled) {
+        // All states in one message
+        _state.temperature = temperature;
+        _state.humidity = humidity;
+        _state.pressure = pressure;
+        _state.valvePosition = valvePosition;
+        _state.action = action;
+        publishStateDocument(false);
+    } else {
+        // Convert values to strings and publish
+        // Each topic only goes out when it moved past its deadband or its heartbeat is due
+        char tempStr[8];
+        dtostrf(temperature, 1, 2, tempStr);
+        publish(TOPIC_TEMPERATURE, "esp32_thermostat/temperature", temperature, tempStr, false);
+
+        char humStr[8];
+        dtostrf(humidity, 1, 2, humStr);
+        publish(TOPIC_HUMIDITY, "esp32_thermostat/humidity", humidity, humStr, false);
+
+        char presStr[8];
+        dtostrf(pressure, 1, 2, presStr);
+        publish(TOPIC_PRESSURE, "esp32_thermostat/pressure", pressure, presStr, false);
+
+        // For the valve position
+        char valveStr[4];
+        itoa(valvePosition, valveStr, 10);
+        publish(TOPIC_VALVE_POSITION, "esp32_thermostat/valve/position", valvePosition, valveStr, false);
+
+        publish(TOPIC_ACTION, "esp32_thermostat/action", action, false);
+    }
+
+    // Also publish a general "online" status message (retained, so a heartbeat is enough)
+    publish(TOPIC_AVAILABILITY, _availabilityTopic.c_str(), "online", true);
+}
+
+void HomeAssistant::updateValvePosition(int position, const char* action) {
+    if (_stateDocumentEnabled) {
+        // Both travel in the state document, sent at once
+        _state.valvePosition = position;
+        _state.action = action;
+        publishStateDocument(true);
+        return;
+    }
+
+    char valveStr[4];
+    itoa(position, valveStr, 10);
+    publish(TOPIC_VALVE_POSITION, "esp32_thermostat/valve/position", position, valveStr, false);
+    publish(TOPIC_ACTION, "esp32_thermostat/action", action, true);
 }
 
 // Update PID parameters
 void HomeAssistant::updatePIDParameters(float kp, float ki, float kd) {
+    if (_stateDocumentEnabled) {
+        // Sent with the next state document
+        _state.kp = kp;
+        _state.ki = ki;
+        _state.kd = kd;
+        return;
+    }
+
     char kpStr[10];
     dtostrf(kp, 1, 2, kpStr);
-    _mqttClient.publish("esp32_thermostat/pid/kp", kpStr);
+    publish(TOPIC_PID_KP, "esp32_thermostat/pid/kp", kp, kpStr, false);
 
     char kiStr[10];
     dtostrf(ki, 1, 3, kiStr);
-    _mqttClient.publish("esp32_thermostat/pid/ki", kiStr);
+    publish(TOPIC_PID_KI, "esp32_thermostat/pid/ki", ki, kiStr, false);
 
     char kdStr[10];
     dtostrf(kd, 1, 3, kdStr);
-    _mqttClient.publish("esp32_thermostat/pid/kd", kdStr);
+    publish(TOPIC_PID_KD, "esp32_thermostat/pid/kd", kd, kdStr, false);
 }
 
 // Update system diagnostics
 void HomeAssistant::updateDiagnostics(int wifiRSSI, unsigned long uptime) {
+    if (_stateDocumentEnabled) {
+        // Sent with the next state document
+        _state.wifiRSSI = wifiRSSI;
+        _state.uptime = uptime / 1000;
+        return;
+    }
+
     char rssiStr[8];
     itoa(wifiRSSI, rssiStr, 10);
-    _mqttClient.publish("esp32_thermostat/wifi/rssi", rssiStr);
+    publish(TOPIC_WIFI_RSSI, "esp32_thermostat/wifi/rssi", wifiRSSI, rssiStr, false);
 
     char uptimeStr[16];
     ultoa(uptime / 1000, uptimeStr, 10); // Convert ms to seconds
-    _mqttClient.publish("esp32_thermostat/uptime", uptimeStr);
+    publish(TOPIC_UPTIME, "esp32_thermostat/uptime", uptime / 1000, uptimeStr, false);
+}
+
+// Retained, so Home Assistant has every state as soon as it subscribes
+bool HomeAssistant::publishStateDocument(bool force) {
+    uint32_t now = millis();
+
+    // Each state keeps its own deadband; uptime always changes and just rides along
+    bool changed = _publishPolicy.changed(TOPIC_TEMPERATURE, _state.temperature) ||
+                   _publishPolicy.changed(TOPIC_HUMIDITY, _state.humidity) ||
+                   _publishPolicy.changed(TOPIC_PRESSURE, _state.pressure) ||
+                   _publishPolicy.changed(TOPIC_VALVE_POSITION, _state.valvePosition) ||
+                   _publishPolicy.changed(TOPIC_ACTION, _state.action) ||
+                   _publishPolicy.changed(TOPIC_PID_KP, _state.kp) ||
+                   _publishPolicy.changed(TOPIC_PID_KI, _state.ki) ||
+                   _publishPolicy.changed(TOPIC_PID_KD, _state.kd) ||
+                   _publishPolicy.changed(TOPIC_WIFI_RSSI, _state.wifiRSSI);
+    if (!force && !_publishPolicy.dueOnChange(TOPIC_STATE_DOCUMENT, changed, now)) {
+        return false;
+    }
+
+    char payload[HA_STATE_DOCUMENT_SIZE];
+    if (formatStateDocument(payload, sizeof(payload), _state) == 0 ||
+        !_mqttClient.publish(HA_STATE_DOCUMENT_TOPIC, payload, true)) {
+        return false;
+    }
+
+    _publishPolicy.carried(TOPIC_TEMPERATURE, _state.temperature, now);
+    _publishPolicy.carried(TOPIC_HUMIDITY, _state.humidity, now);
+    _publishPolicy.carried(TOPIC_PRESSURE, _state.pressure, now);
+    _publishPolicy.carried(TOPIC_VALVE_POSITION, _state.valvePosition, now);
+    _publishPolicy.carried(TOPIC_ACTION, _state.action, now);
+    _publishPolicy.carried(TOPIC_PID_KP, _state.kp, now);
+    _publishPolicy.carried(TOPIC_PID_KI, _state.ki, now);
+    _publishPolicy.carried(TOPIC_PID_KD, _state.kd, now);
+    _publishPolicy.carried(TOPIC_WIFI_RSSI, _state.wifiRSSI, now);
+    _publishPolicy.published(TOPIC_STATE_DOCUMENT, payload, now);
+    return true;
 }
 
 // Update manual valve override status
@@ -449,7 +434,7 @@ void HomeAssistant::updateManualOverride(bool enabled, int position) {
 
 // Update availability status
 void HomeAssistant::updateAvailability(bool isOnline) {
-    bool published = _mqttClient.publish(_availabilityTopic.c_str(), isOnline ? "online" : "offline", true);
+    bool published = publishNow(TOPIC_AVAILABILITY, _availabilityTopic.c_str(), isOnline ? "online" : "offline", true);
     Serial.print("Published availability status (");
     Serial.print(isOnline ? "online" : "offline");
     Serial.print(") to ");
@@ -469,17 +454,17 @@ void HomeAssistant::publishConfig(const char* component, const char* objectId, c
 void HomeAssistant::updateSetpointTemperature(float setpoint) {
     char setpointStr[8];
     dtostrf(setpoint, 1, 1, setpointStr);
-    _mqttClient.publish("esp32_thermostat/temperature/setpoint", setpointStr, true);
+    publishNow(TOPIC_SETPOINT, "esp32_thermostat/temperature/setpoint", setpoint, setpointStr, true);
 }
 
 // NEW: Update the thermostat mode
 void HomeAssistant::updateMode(const char* mode) {
-    _mqttClient.publish("esp32_thermostat/mode/state", mode, true);
+    publishNow(TOPIC_MODE, "esp32_thermostat/mode/state", mode, true);
 }
 
 // NEW: Update the preset mode
 void HomeAssistant::updatePresetMode(const char* preset) {
-    _mqttClient.publish("esp32_thermostat/preset/state", preset, true);
+    publishNow(TOPIC_PRESET, "esp32_thermostat/preset/state", preset, true);
 }
 
 // HA FIX #5: Sync all climate state to HA
@@ -489,31 +474,60 @@ void HomeAssistant::syncClimateState() {
     if (!configManager) return;
 
     // Sync mode state
+    // Retained topics: only republished when they differ from what was last sent
     const char* mode = configManager->getThermostatEnabled() ? "heat" : "off";
-    _mqttClient.publish("esp32_thermostat/mode/state", mode, true);
+    publish(TOPIC_MODE, "esp32_thermostat/mode/state", mode, true);
 
     // Sync preset state
     String preset = configManager->getCurrentPreset();
-    _mqttClient.publish("esp32_thermostat/preset/state", preset.c_str(), true);
-
-    // Sync setpoint - use preset temperature if a valid preset is active
-    float setpoint;
-    if (preset == "eco" || preset == "comfort" || preset == "away" ||
-        preset == "sleep" || preset == "boost") {
-        // Get temperature from the active preset
-        setpoint = configManager->getPresetTemperature(preset);
-    } else {
-        // Fallback to stored setpoint
-        setpoint = configManager->getSetpoint();
-    }
+    publish(TOPIC_PRESET, "esp32_thermostat/preset/state", preset.c_str(), true);
+
+    // Sync setpoint - the stored one the controller runs on. A preset command
+    // stores its temperature here, and a manual setpoint made while a preset
+    // is active must not snap back to the preset temperature.
+    float setpoint = configManager->getSetpoint();
 
     char setpointStr[8];
     dtostrf(setpoint, 1, 1, setpointStr);
-    _mqttClient.publish("esp32_thermostat/temperature/setpoint", setpointStr, true);
+    if (publish(TOPIC_SETPOINT, "esp32_thermostat/temperature/setpoint", setpoint, setpointStr, true)) {
+        // Debug logging
+        Serial.print("syncClimateState: preset=");
+        Serial.print(preset);
+        Serial.print(", setpoint=");
+        Serial.println(setpointStr);
+    }
+}
 
-    // Debug logging
-    Serial.print("syncClimateState: preset=");
-    Serial.print(preset);
-    Serial.print(", setpoint=");
-    Serial.println(setpointStr);
+void HomeAssistant::resetPublishState() {
+    _publishPolicy.invalidate();
+}
+
+bool HomeAssistant::publish(StateTopic id, const char* topic, float value, const char* payload, bool retained) {
+    if (!_publishPolicy.due(id, value, millis())) {
+        return false;
+    }
+    return publishNow(id, topic, value, payload, retained);
+}
+
+bool HomeAssistant::publish(StateTopic id, const char* topic, const char* payload, bool retained) {
+    if (!_publishPolicy.due(id, payload, millis())) {
+        return false;
+    }
+    return publishNow(id, topic, payload, retained);
+}
+
+bool HomeAssistant::publishNow(StateTopic id, const char* topic, float value, const char* payload, bool retained) {
+    if (!_mqttClient.publish(topic, payload, retained)) {
+        return false;
+    }
+    _publishPolicy.published(id, value, millis());
+    return true;
+}
+
+bool HomeAssistant::publishNow(StateTopic id, const char* topic, const char* payload, bool retained) {
+    if (!_mqttClient.publish(topic, payload, retained)) {
+        return false;
+    }
+    _publishPolicy.published(id, payload, millis());
+    return true;
 }
\ No newline at end of file
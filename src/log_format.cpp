@@ -0,0 +1,197 @@
+#include "log_format.h"
+#include <stdio.h>
+#include <string.h>
+
+// Longest conversion spec copied for snprintf, e.g. "%-08.3lf"
+static const size_t MAX_SPEC_LENGTH = 15;
+
+LogFormat::StaticCheck LogFormat::_staticCheck = nullptr;
+
+namespace {
+
+enum ArgKind {
+    ARG_NONE,       // "%%" - no argument
+    ARG_INT,
+    ARG_LONG,
+    ARG_DOUBLE,
+    ARG_STRING,
+    ARG_POINTER,
+    ARG_INVALID     // Not storable by value
+};
+
+// Parse one conversion; p points just past '%' and is advanced past the conversion character
+ArgKind parseConversion(const char*& p) {
+    while (*p && strchr("-+ #0", *p)) p++;
+    if (*p == '*') return ARG_INVALID;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') return ARG_INVALID;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+
+    bool isLong = false;
+    if (*p == 'h') {
+        p++;
+        if (*p == 'h') p++;
+    } else if (*p == 'l') {
+        p++;
+        if (*p == 'l') return ARG_INVALID;
+        isLong = true;
+    } else if (*p == 'z' || *p == 't') {
+        // size_t/ptrdiff_t have the width of long on both the ESP32 and 64-bit hosts
+        p++;
+        isLong = true;
+    } else if (*p == 'j' || *p == 'L' || *p == 'q') {
+        return ARG_INVALID;
+    }
+
+    char conv = *p;
+    if (conv == '\0') return ARG_INVALID;
+    p++;
+
+    switch (conv) {
+        case '%':
+            return ARG_NONE;
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            return isLong ? ARG_LONG : ARG_INT;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            return ARG_DOUBLE;
+        case 's':
+            return isLong ? ARG_INVALID : ARG_STRING;
+        case 'p':
+            return ARG_POINTER;
+        default:
+            return ARG_INVALID;
+    }
+}
+
+} // namespace
+
+void LogFormat::setStaticCheck(StaticCheck check) {
+    _staticCheck = check;
+}
+
+bool LogFormat::capture(BinaryLogRecord& record, const char* format, va_list args) {
+    if (_staticCheck == nullptr || format == nullptr || !_staticCheck(format)) {
+        return false;
+    }
+
+    uint8_t argc = 0;
+    for (const char* p = format; *p; ) {
+        if (*p++ != '%') {
+            continue;
+        }
+        const char* spec = p - 1;
+        ArgKind kind = parseConversion(p);
+        if (kind == ARG_NONE) {
+            continue;
+        }
+        if (kind == ARG_INVALID || argc >= LOG_BINARY_MAX_ARGS ||
+            (size_t)(p - spec) > MAX_SPEC_LENGTH) {
+            return false;
+        }
+
+        uintptr_t word = 0;
+        switch (kind) {
+            case ARG_INT:
+                word = (unsigned int)va_arg(args, int);
+                break;
+            case ARG_LONG:
+                word = (uintptr_t)va_arg(args, unsigned long);
+                break;
+            case ARG_DOUBLE: {
+                float value = (float)va_arg(args, double);
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                word = bits;
+                break;
+            }
+            case ARG_STRING: {
+                const char* text = va_arg(args, const char*);
+                if (text != nullptr && !_staticCheck(text)) {
+                    return false;
+                }
+                word = (uintptr_t)text;
+                break;
+            }
+            case ARG_POINTER:
+                word = (uintptr_t)va_arg(args, void*);
+                break;
+            default:
+                return false;
+        }
+        record.args[argc++] = word;
+    }
+
+    record.format = format;
+    record.argc = argc;
+    return true;
+}
+
+size_t LogFormat::render(char* out, size_t size, const BinaryLogRecord& record) {
+    if (size == 0) {
+        return 0;
+    }
+
+    size_t len = 0;
+    uint8_t argIndex = 0;
+    const char* p = record.format;
+    while (p != nullptr && *p && len < size - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+
+        const char* specStart = p++;
+        ArgKind kind = parseConversion(p);
+        size_t specLength = p - specStart;
+        if (kind == ARG_NONE) {
+            out[len++] = '%';
+            continue;
+        }
+        if (kind == ARG_INVALID || argIndex >= record.argc || specLength > MAX_SPEC_LENGTH) {
+            // Not produced by capture(); emit the spec verbatim
+            size_t count = specLength < size - 1 - len ? specLength : size - 1 - len;
+            memcpy(out + len, specStart, count);
+            len += count;
+            continue;
+        }
+
+        char spec[MAX_SPEC_LENGTH + 1];
+        memcpy(spec, specStart, specLength);
+        spec[specLength] = '\0';
+
+        uintptr_t word = record.args[argIndex++];
+        int written = 0;
+        switch (kind) {
+            case ARG_INT:
+                written = snprintf(out + len, size - len, spec, (int)(unsigned int)word);
+                break;
+            case ARG_LONG:
+                written = snprintf(out + len, size - len, spec, (unsigned long)word);
+                break;
+            case ARG_DOUBLE: {
+                uint32_t bits = (uint32_t)word;
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                written = snprintf(out + len, size - len, spec, (double)value);
+                break;
+            }
+            case ARG_STRING:
+                written = snprintf(out + len, size - len, spec, (const char*)word);
+                break;
+            case ARG_POINTER:
+                written = snprintf(out + len, size - len, spec, (void*)word);
+                break;
+            default:
+                break;
+        }
+        if (written > 0) {
+            len += (size_t)written < size - 1 - len ? (size_t)written : size - 1 - len;
+        }
+    }
+
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,80 @@
+#include "log_history.h"
+#include <string.h>
+
+static const char* EVICTED_TEXT = "[message text overwritten]";
+
+LogHistory::LogHistory() {
+    clear();
+}
+
+void LogHistory::append(const BinaryLogRecord& record) {
+    BinaryLogRecord& slot = _records[_next & (LOG_HISTORY_DEPTH - 1)];
+    slot = record;
+    slot.flags &= ~LOG_RECORD_TEXT;
+    _next++;
+}
+
+void LogHistory::appendText(uint32_t timestamp, uint8_t level, uint8_t tagId,
+                            const char* text, size_t length) {
+    if (length > MAX_TEXT_LENGTH) {
+        length = MAX_TEXT_LENGTH;
+    }
+
+    BinaryLogRecord& slot = _records[_next & (LOG_HISTORY_DEPTH - 1)];
+    slot.timestamp = timestamp;
+    slot.format = nullptr;
+    slot.level = level;
+    slot.tagId = tagId;
+    slot.argc = 0;
+    slot.flags = LOG_RECORD_TEXT;
+    slot.args[0] = _textPos;
+    slot.args[1] = length;
+
+    for (size_t i = 0; i < length; i++) {
+        _text[(_textPos + i) & (LOG_HISTORY_TEXT_SIZE - 1)] = text[i];
+    }
+    _textPos += length;
+    _next++;
+}
+
+uint32_t LogHistory::getStart() const {
+    return _next > LOG_HISTORY_DEPTH ? _next - LOG_HISTORY_DEPTH : 0;
+}
+
+bool LogHistory::read(uint32_t seq, BinaryLogRecord& record, char* message, size_t size) const {
+    if (seq - getStart() >= _next - getStart()) {
+        return false;
+    }
+
+    record = _records[seq & (LOG_HISTORY_DEPTH - 1)];
+    if (size == 0) {
+        return true;
+    }
+
+    if (!(record.flags & LOG_RECORD_TEXT)) {
+        LogFormat::render(message, size, record);
+        return true;
+    }
+
+    uint32_t start = (uint32_t)record.args[0];
+    size_t length = record.args[1];
+    if (_textPos - start > LOG_HISTORY_TEXT_SIZE) {
+        strncpy(message, EVICTED_TEXT, size - 1);
+        message[size - 1] = '\0';
+        return true;
+    }
+
+    if (length > size - 1) {
+        length = size - 1;
+    }
+    for (size_t i = 0; i < length; i++) {
+        message[i] = _text[(start + i) & (LOG_HISTORY_TEXT_SIZE - 1)];
+    }
+    message[length] = '\0';
+    return true;
+}
+
+void LogHistory::clear() {
+    _next = 0;
+    _textPos = 0;
+}
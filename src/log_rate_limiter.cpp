@@ -0,0 +1,109 @@
+#include "log_rate_limiter.h"
+#include <string.h>
+
+static_assert((LOG_RATE_SLOTS & (LOG_RATE_SLOTS - 1)) == 0, "LOG_RATE_SLOTS must be a power of two");
+
+LogRateLimiter::LogRateLimiter()
+    : _burst(LOG_RATE_BURST),
+      _refillMs(LOG_RATE_REFILL_MS),
+      _suppressedTotal(0),
+      _collectPos(0) {
+    reset();
+}
+
+void LogRateLimiter::configure(uint8_t burst, uint32_t refillMs) {
+    _burst = burst > 0 ? burst : 1;
+    _refillMs = refillMs > 0 ? refillMs : 1;
+    reset();
+}
+
+void LogRateLimiter::reset() {
+    memset(_slots, 0, sizeof(_slots));
+    _suppressedTotal = 0;
+    _collectPos = 0;
+}
+
+uint32_t LogRateLimiter::slotIndex(uint8_t tagId, const char* format) {
+    // Fibonacci hashing; the low pointer bits are mostly alignment, so mix before taking the top bits
+    uint32_t key = (uint32_t)(uintptr_t)format ^ ((uint32_t)tagId << 24);
+    uint32_t hash = key * 2654435761u;
+    hash ^= hash >> 15;
+    return (hash * 2654435761u) >> 16 & (LOG_RATE_SLOTS - 1);
+}
+
+void LogRateLimiter::refill(Slot& slot, uint32_t now) const {
+    uint32_t intervals = (now - slot.refilledAt) / _refillMs;
+    if (intervals == 0) {
+        return;
+    }
+    if (intervals >= (uint32_t)(_burst - slot.tokens)) {
+        slot.tokens = _burst;
+        slot.refilledAt = now;
+    } else {
+        slot.tokens += intervals;
+        slot.refilledAt += intervals * _refillMs;
+    }
+}
+
+void LogRateLimiter::takeSummary(Slot& slot, LogRepeatSummary& summary) {
+    summary.format = slot.format;
+    summary.tagId = slot.tagId;
+    summary.level = slot.level;
+    summary.count = slot.suppressed;
+    summary.since = slot.since;
+    slot.suppressed = 0;
+}
+
+bool LogRateLimiter::check(uint8_t tagId, const char* format, uint8_t level, uint32_t now,
+                           LogRepeatSummary& summary) {
+    summary.count = 0;
+    Slot& slot = _slots[slotIndex(tagId, format)];
+
+    if (slot.format != format || slot.tagId != tagId) {
+        if (slot.format != nullptr && slot.suppressed > 0) {
+            // Occupant still owes a summary; let the newcomer through untracked
+            return true;
+        }
+        slot.format = format;
+        slot.tagId = tagId;
+        slot.tokens = _burst;
+        slot.refilledAt = now;
+        slot.suppressed = 0;
+    } else {
+        refill(slot, now);
+    }
+
+    if (slot.tokens > 0) {
+        slot.tokens--;
+        if (slot.suppressed > 0) {
+            takeSummary(slot, summary);
+        }
+        return true;
+    }
+
+    if (slot.suppressed == 0) {
+        slot.since = now;
+    }
+    slot.suppressed++;
+    slot.level = level;
+    _suppressedTotal++;
+    return false;
+}
+
+bool LogRateLimiter::collect(uint32_t now, LogRepeatSummary& summary) {
+    summary.count = 0;
+    for (uint32_t i = 0; i < LOG_RATE_SLOTS; i++) {
+        Slot& slot = _slots[(_collectPos + i) & (LOG_RATE_SLOTS - 1)];
+        if (slot.suppressed == 0) {
+            continue;
+        }
+        // A token came back and the site did not use it: the storm is over
+        refill(slot, now);
+        if (slot.tokens > 0) {
+            _collectPos = (_collectPos + i + 1) & (LOG_RATE_SLOTS - 1);
+            takeSummary(slot, summary);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,77 @@
+#include "log_shipper.h"
+#include <string.h>
+
+LogShipper::LogShipper()
+    : _length(0),
+      _entries(0),
+      _firstAt(0),
+      _lastAttempt(0),
+      _full(false),
+      _failed(false),
+      _wasConnected(false),
+      _publisher(nullptr),
+      _context(nullptr),
+      _batches(0),
+      _shipped(0),
+      _failures(0),
+      _dropped(0) {
+}
+
+void LogShipper::begin(Publisher publisher, void* context) {
+    _publisher = publisher;
+    _context = context;
+}
+
+bool LogShipper::add(const char* entry, size_t length, uint32_t now) {
+    // '[' or ',' before the entry, ']' after the last one
+    if (length + 2 > LOG_SHIP_BUFFER_SIZE) {
+        _dropped++;
+        return true;  // Could never be shipped; do not block the entries behind it
+    }
+    if (_length + 1 + length + 1 > LOG_SHIP_BUFFER_SIZE) {
+        _full = true;
+        return false;
+    }
+
+    if (_entries == 0) {
+        _firstAt = now;
+    }
+    _buffer[_length++] = _entries == 0 ? '[' : ',';
+    memcpy(_buffer + _length, entry, length);
+    _length += length;
+    _entries++;
+    return true;
+}
+
+bool LogShipper::isDue(uint32_t now, bool reconnected) const {
+    if (reconnected) {
+        return true;
+    }
+    if (_failed) {
+        return now - _lastAttempt >= LOG_SHIP_RETRY_MS;
+    }
+    return _full || _length >= LOG_SHIP_BUFFER_SIZE * 3 / 4 || now - _firstAt >= LOG_SHIP_INTERVAL_MS;
+}
+
+void LogShipper::loop(uint32_t now, bool connected) {
+    bool reconnected = connected && !_wasConnected;
+    _wasConnected = connected;
+    if (_entries == 0 || !connected || _publisher == nullptr || !isDue(now, reconnected)) {
+        return;
+    }
+
+    _lastAttempt = now;
+    _buffer[_length] = ']';
+    if (!_publisher(_context, reinterpret_cast<const uint8_t*>(_buffer), _length + 1)) {
+        _failed = true;
+        _failures++;
+        return;
+    }
+
+    _batches++;
+    _shipped += _entries;
+    _length = 0;
+    _entries = 0;
+    _full = false;
+    _failed = false;
+}
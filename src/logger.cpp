@@ -0,0 +1,421 @@
+#include "logger.h"
+#include <soc/soc_memory_layout.h>
+
+static const char* TAG = "LOG";
+
+// Drain task settings: low priority on the protocol core, away from the Arduino loop (core 1)
+static const uint32_t DRAIN_TASK_STACK = 6144;
+static const UBaseType_t DRAIN_TASK_PRIORITY = 1;
+static const BaseType_t DRAIN_TASK_CORE = 0;
+static const uint32_t DRAIN_IDLE_TIMEOUT_MS = 100;
+
+// How often the drain task reports call sites whose repeats have stopped
+static const uint32_t REPEAT_COLLECT_INTERVAL_MS = 1000;
+
+// Line building helpers; both stop LOG_LINE_SIZE - 3 bytes in to keep room for CR/LF/NUL
+static size_t appendString(char* line, size_t len, const char* text) {
+    while (*text && len < LOG_LINE_SIZE - 3) {
+        line[len++] = *text++;
+    }
+    return len;
+}
+
+static size_t appendUnsigned(char* line, size_t len, unsigned long value) {
+    char digits[20];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0 && len < LOG_LINE_SIZE - 3) {
+        line[len++] = digits[--count];
+    }
+    return len;
+}
+
+// Flash-mapped rodata (string literals) stays valid forever and may be kept by reference
+static bool isFlashPointer(const void* ptr) {
+    return esp_ptr_in_drom(ptr);
+}
+
+// Write "<timestamp> | <LEVEL> | <tag> | " and return its length
+static size_t formatHeader(char* line, uint32_t timestamp, const char* levelStr, const char* tag) {
+    size_t len = appendUnsigned(line, 0, timestamp);
+    len = appendString(line, len, " | ");
+    len = appendString(line, len, levelStr);
+    len = appendString(line, len, " | ");
+    len = appendString(line, len, tag);
+    return appendString(line, len, " | ");
+}
+
+// Terminate a line built by formatHeader() plus message with CR/LF/NUL
+static void finishLine(LogRecord& record, size_t len) {
+    record.line[len] = '\r';
+    record.line[len + 1] = '\n';
+    record.line[len + 2] = '\0';
+    record.length = len;
+}
+
+// Build the complete line with a single vsnprintf pass
+static void formatRecord(LogRecord& record, const char* levelStr, const char* tag,
+                         const char* format, va_list args) {
+    size_t len = formatHeader(record.line, record.packed.timestamp, levelStr, tag);
+    record.messageOffset = len;
+
+    int written = vsnprintf(record.line + len, LOG_LINE_SIZE - len - 2, format, args);
+    if (written > 0) {
+        len += (size_t)written < LOG_LINE_SIZE - len - 2 ? (size_t)written : LOG_LINE_SIZE - len - 3;
+    }
+    finishLine(record, len);
+}
+
+// Capture without consuming args, so the caller can still fall back to text
+static bool captureDeferred(LogRecord& record, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    bool captured = LogFormat::capture(record.packed, format, copy);
+    va_end(copy);
+    return captured;
+}
+
+// Scoped lock for the history mutex
+class HistoryLock {
+public:
+    explicit HistoryLock(SemaphoreHandle_t mutex) : _mutex(mutex) {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+    }
+    ~HistoryLock() {
+        xSemaphoreGive(_mutex);
+    }
+private:
+    SemaphoreHandle_t _mutex;
+};
+
+Logger::Logger()
+    : _logLevel(LOG_INFO),
+      _logCallback(nullptr),
+      _binaryMode(LOG_BINARY_DEFAULT != 0),
+      _dropped(0),
+      _droppedReported(0),
+      _drainTask(nullptr),
+      _tagCount(1),
+      _tagOverrides(0),
+      _rateLimit(LOG_RATE_LIMIT_DEFAULT != 0),
+      _lastRepeatCollect(0),
+      _historyMutex(xSemaphoreCreateMutex()) {
+    portMUX_INITIALIZE(&_tagLock);
+    portMUX_INITIALIZE(&_rateLock);
+    // Id 0 collects tags that no longer fit the table
+    strcpy(_tagNames[0], "*");
+    _tagPointers[0] = nullptr;
+    for (uint8_t i = 0; i < LOG_MAX_TAGS; i++) {
+        _tagLevels[i] = _logLevel;
+    }
+    LogFormat::setStaticCheck(isFlashPointer);
+}
+
+uint8_t Logger::internTag(const char* tag) {
+    uint8_t count = _tagCount.load(std::memory_order_acquire);
+
+    // Fast path: literal tags are matched by address
+    for (uint8_t i = 1; i < count; i++) {
+        if (_tagPointers[i] == tag) {
+            return i;
+        }
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        if (strncmp(_tagNames[i], tag, LOG_TAG_SIZE - 1) == 0) {
+            return i;
+        }
+    }
+
+    uint8_t id = 0;
+    portENTER_CRITICAL(&_tagLock);
+    uint8_t current = _tagCount.load(std::memory_order_relaxed);
+    // Another producer may have added it since the scan above
+    for (uint8_t i = count; i < current && id == 0; i++) {
+        if (strncmp(_tagNames[i], tag, LOG_TAG_SIZE - 1) == 0) {
+            id = i;
+        }
+    }
+    if (id == 0 && current < LOG_MAX_TAGS) {
+        id = current;
+        strncpy(_tagNames[id], tag, LOG_TAG_SIZE - 1);
+        _tagNames[id][LOG_TAG_SIZE - 1] = '\0';
+        _tagPointers[id] = isFlashPointer(tag) ? tag : nullptr;
+        _tagLevels[id] = _logLevel;
+        _tagCount.store(current + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&_tagLock);
+    return id;
+}
+
+void Logger::setLogLevel(LogLevel level) {
+    portENTER_CRITICAL(&_tagLock);
+    _logLevel = level;
+    for (uint8_t i = 0; i < LOG_MAX_TAGS; i++) {
+        if (!(_tagOverrides & (1ULL << i))) {
+            _tagLevels[i] = level;
+        }
+    }
+    portEXIT_CRITICAL(&_tagLock);
+}
+
+void Logger::setTagLevel(const char* tag, LogLevel level) {
+    uint8_t id = internTag(tag);
+    if (id == 0) {
+        log(LOG_WARNING, TAG, "Tag table full - cannot set level for %s", tag);
+        return;
+    }
+    portENTER_CRITICAL(&_tagLock);
+    _tagOverrides |= 1ULL << id;
+    _tagLevels[id] = level;
+    portEXIT_CRITICAL(&_tagLock);
+}
+
+void Logger::clearTagLevels() {
+    portENTER_CRITICAL(&_tagLock);
+    _tagOverrides = 0;
+    for (uint8_t i = 0; i < LOG_MAX_TAGS; i++) {
+        _tagLevels[i] = _logLevel;
+    }
+    portEXIT_CRITICAL(&_tagLock);
+}
+
+const char* Logger::getTagName(uint8_t id) const {
+    return id < _tagCount.load(std::memory_order_acquire) ? _tagNames[id] : _tagNames[0];
+}
+
+void Logger::vlogTagged(LogLevel level, uint8_t tagId, const char* format, va_list args) {
+    // Use direct hardware serial access to bypass web monitor capture
+    if (!_realSerialForLogger) return;
+
+    // Only static formats identify a call site; a RAM buffer may hold anything
+    if (_rateLimit && isFlashPointer(format)) {
+        uint32_t now = millis();
+        LogRepeatSummary summary;
+        portENTER_CRITICAL(&_rateLock);
+        bool allowed = _rateLimiter.check(tagId, format, level, now, summary);
+        portEXIT_CRITICAL(&_rateLock);
+        if (!allowed) {
+            return;
+        }
+        if (summary.count > 0) {
+            reportRepeats(summary, now);
+        }
+    }
+
+    enqueue(level, tagId, format, args);
+}
+
+void Logger::enqueueFormat(LogLevel level, uint8_t tagId, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    enqueue(level, tagId, format, args);
+    va_end(args);
+}
+
+void Logger::reportRepeats(const LogRepeatSummary& summary, uint32_t now) {
+    // The format itself stands in for the suppressed messages; their arguments are gone
+    enqueueFormat((LogLevel)summary.level, summary.tagId, "%s (repeated %lu times in %lus)",
+                  summary.format, (unsigned long)summary.count,
+                  (unsigned long)((now - summary.since) / 1000));
+}
+
+void Logger::collectRepeats() {
+    uint32_t now = millis();
+    if (now - _lastRepeatCollect < REPEAT_COLLECT_INTERVAL_MS) {
+        return;
+    }
+    _lastRepeatCollect = now;
+
+    LogRepeatSummary summary;
+    for (;;) {
+        portENTER_CRITICAL(&_rateLock);
+        bool found = _rateLimiter.collect(now, summary);
+        portEXIT_CRITICAL(&_rateLock);
+        if (!found) {
+            break;
+        }
+        reportRepeats(summary, now);
+    }
+}
+
+void Logger::setRateLimit(bool enabled) {
+    portENTER_CRITICAL(&_rateLock);
+    _rateLimit = enabled;
+    if (!enabled) {
+        _rateLimiter.reset();
+    }
+    portEXIT_CRITICAL(&_rateLock);
+}
+
+uint32_t Logger::getSuppressedCount() {
+    portENTER_CRITICAL(&_rateLock);
+    uint32_t count = _rateLimiter.getSuppressedCount();
+    portEXIT_CRITICAL(&_rateLock);
+    return count;
+}
+
+void Logger::enqueue(LogLevel level, uint8_t tagId, const char* format, va_list args) {
+    TaskHandle_t drainTask = _drainTask;
+    if (drainTask == nullptr) {
+        // Early boot: no drain task yet, dispatch inline
+        LogRecord record;
+        record.packed.timestamp = millis();
+        record.packed.level = level;
+        record.packed.tagId = tagId;
+        record.packed.flags = 0;
+        record.deferred = false;
+        formatRecord(record, getLevelString(level), getTagName(tagId), format, args);
+        dispatch(record);
+        return;
+    }
+
+    // Task notifications are not ISR-safe; logging from an ISR is not supported
+    uint32_t pos;
+    if (xPortInIsrContext() || !_queue.claim(pos)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Fill the claimed slot in place: raw arguments if possible, else the formatted line
+    LogRecord& record = _queue.at(pos);
+    record.packed.timestamp = millis();
+    record.packed.level = level;
+    record.packed.tagId = tagId;
+    record.packed.flags = 0;
+    record.deferred = _binaryMode && captureDeferred(record, format, args);
+    if (!record.deferred) {
+        formatRecord(record, getLevelString(level), getTagName(tagId), format, args);
+    }
+    _queue.publish(pos);
+    xTaskNotifyGive(drainTask);
+}
+
+void Logger::dispatch(LogRecord& record) {
+    LogLevel level = (LogLevel)record.packed.level;
+
+    if (record.deferred) {
+        // Formatting happens here, on the drain task, instead of at the call site
+        size_t len = formatHeader(record.line, record.packed.timestamp, getLevelString(level),
+                                  getTagName(record.packed.tagId));
+        record.messageOffset = len;
+        len += LogFormat::render(record.line + len, LOG_LINE_SIZE - len - 2, record.packed);
+        finishLine(record, len);
+    }
+
+    // Write to hardware serial (bypasses web monitor) in one call, CR/LF included
+    _realSerialForLogger->write(reinterpret_cast<const uint8_t*>(record.line), record.length + 2);
+    record.line[record.length] = '\0';
+
+    // ALSO send to web monitor
+    captureLogToWebMonitor(record.line);
+
+    // Keep the compact form for /api/logs/recent
+    {
+        HistoryLock lock(_historyMutex);
+        if (record.deferred) {
+            _history.append(record.packed);
+        } else {
+            _history.appendText(record.packed.timestamp, record.packed.level, record.packed.tagId,
+                                record.line + record.messageOffset, record.length - record.messageOffset);
+        }
+    }
+
+    // If we have a log callback registered, call it
+    if (_logCallback) {
+        _logCallback(level, getTagName(record.packed.tagId), record.line + record.messageOffset,
+                     record.packed.timestamp);
+    }
+}
+
+void Logger::drain() {
+    LogRecord* record;
+    while ((record = _queue.front()) != nullptr) {
+        dispatch(*record);
+        _queue.pop();
+    }
+
+    // Report overruns once the queue has room again
+    uint32_t dropped = _dropped.load(std::memory_order_relaxed);
+    if (dropped != _droppedReported) {
+        uint32_t lost = dropped - _droppedReported;
+        _droppedReported = dropped;
+        log(LOG_WARNING, TAG, "Log queue full - %lu message(s) dropped (total %lu)",
+            (unsigned long)lost, (unsigned long)dropped);
+    }
+
+    collectRepeats();
+}
+
+void Logger::drainTask(void* param) {
+    Logger* logger = static_cast<Logger*>(param);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DRAIN_IDLE_TIMEOUT_MS));
+        logger->drain();
+    }
+}
+
+bool Logger::startAsync() {
+    if (_drainTask != nullptr) {
+        return true;
+    }
+
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(drainTask, "log_drain", DRAIN_TASK_STACK, this,
+                                DRAIN_TASK_PRIORITY, &handle, DRAIN_TASK_CORE) != pdPASS) {
+        log(LOG_ERROR, TAG, "Failed to start log drain task - logging stays synchronous");
+        return false;
+    }
+    _drainTask = handle;
+    log(LOG_INFO, TAG, "Asynchronous logging started (queue depth %u)", (unsigned)LOG_QUEUE_DEPTH);
+    return true;
+}
+
+void Logger::flush(uint32_t timeoutMs) {
+    if (_drainTask == nullptr || xTaskGetCurrentTaskHandle() == _drainTask) {
+        return;
+    }
+
+    unsigned long start = millis();
+    while (_queue.size() > 0 && millis() - start < timeoutMs) {
+        xTaskNotifyGive(_drainTask);
+        delay(1);
+    }
+}
+
+uint32_t Logger::getHistoryStart() {
+    HistoryLock lock(_historyMutex);
+    return _history.getStart();
+}
+
+uint32_t Logger::getHistoryEnd() {
+    HistoryLock lock(_historyMutex);
+    return _history.getEnd();
+}
+
+size_t Logger::formatHistoryEntry(uint32_t seq, char* line, size_t size) {
+    // formatHeader() assumes a full-size line buffer
+    if (size < LOG_LINE_SIZE) {
+        return 0;
+    }
+
+    BinaryLogRecord record;
+    char message[LOG_LINE_SIZE];
+    {
+        HistoryLock lock(_historyMutex);
+        if (!_history.read(seq, record, message, sizeof(message))) {
+            return 0;
+        }
+    }
+
+    size_t len = formatHeader(line, record.timestamp, getLevelString((LogLevel)record.level),
+                              getTagName(record.tagId));
+    size_t room = size - 1 - len;
+    size_t messageLength = strnlen(message, room);
+    memcpy(line + len, message, messageLength);
+    len += messageLength;
+    line[len] = '\0';
+    return len;
+}
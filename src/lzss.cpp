@@ -0,0 +1,148 @@
+#include "lzss.h"
+
+static const uint32_t BUFFER_MASK = 2 * LZSS_WINDOW_SIZE - 1;
+static const uint32_t WINDOW_MASK = LZSS_WINDOW_SIZE - 1;
+
+void LzssEncoder::begin(Writer writer, void* context) {
+    _head = 0;
+    _tail = 0;
+    _bits = 0;
+    _bitCount = 0;
+    _outLength = 0;
+    _outputSize = 0;
+    _writer = writer;
+    _context = context;
+    _ok = true;
+}
+
+bool LzssEncoder::write(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length && _ok; i++) {
+        _buffer[_tail & BUFFER_MASK] = data[i];
+        _tail++;
+        if (_tail - _head == LZSS_MAX_MATCH) {
+            encodeToken();
+        }
+    }
+    return _ok;
+}
+
+bool LzssEncoder::finish() {
+    while (_head != _tail && _ok) {
+        encodeToken();
+    }
+    if (_bitCount > 0) {
+        putBits(0, 8 - _bitCount);
+    }
+    flushOutput();
+    return _ok;
+}
+
+void LzssEncoder::encodeToken() {
+    uint32_t lookahead = _tail - _head;
+    if (lookahead > LZSS_MAX_MATCH) {
+        lookahead = LZSS_MAX_MATCH;
+    }
+    uint32_t history = _head < LZSS_WINDOW_SIZE ? _head : LZSS_WINDOW_SIZE;
+
+    // Longest match in the window, nearest first; matches may run into the lookahead
+    uint32_t bestLength = 0;
+    uint32_t bestDistance = 0;
+    for (uint32_t distance = 1; distance <= history; distance++) {
+        uint32_t length = 0;
+        while (length < lookahead &&
+               _buffer[(_head - distance + length) & BUFFER_MASK] == _buffer[(_head + length) & BUFFER_MASK]) {
+            length++;
+        }
+        if (length > bestLength) {
+            bestLength = length;
+            bestDistance = distance;
+            if (length == lookahead) {
+                break;
+            }
+        }
+    }
+
+    if (bestLength >= LZSS_MIN_MATCH) {
+        putBits(0, 1);
+        putBits(bestDistance - 1, LZSS_WINDOW_BITS);
+        putBits(bestLength - LZSS_MIN_MATCH, LZSS_LENGTH_BITS);
+        _head += bestLength;
+    } else {
+        putBits(0x100 | _buffer[_head & BUFFER_MASK], 9);
+        _head++;
+    }
+}
+
+void LzssEncoder::putBits(uint32_t value, uint8_t count) {
+    _bits = (_bits << count) | (value & ((1UL << count) - 1));
+    _bitCount += count;
+    while (_bitCount >= 8) {
+        _bitCount -= 8;
+        _out[_outLength++] = (uint8_t)(_bits >> _bitCount);
+        if (_outLength == sizeof(_out)) {
+            flushOutput();
+        }
+    }
+}
+
+void LzssEncoder::flushOutput() {
+    if (_outLength > 0 && _ok) {
+        _ok = _writer(_context, _out, _outLength);
+        _outputSize += _outLength;
+    }
+    _outLength = 0;
+}
+
+void LzssDecoder::begin() {
+    _written = 0;
+    _bits = 0;
+    _bitCount = 0;
+    _copyDistance = 0;
+    _copyRemaining = 0;
+    _corrupt = false;
+}
+
+size_t LzssDecoder::decode(const uint8_t* in, size_t length, size_t& consumed, uint8_t* out, size_t size) {
+    size_t produced = 0;
+    consumed = 0;
+
+    while (produced < size && !_corrupt) {
+        if (_copyRemaining > 0) {
+            uint8_t value = _window[(_written - _copyDistance) & WINDOW_MASK];
+            _window[_written++ & WINDOW_MASK] = value;
+            out[produced++] = value;
+            _copyRemaining--;
+            continue;
+        }
+
+        while (_bitCount <= 24 && consumed < length) {
+            _bits = (_bits << 8) | in[consumed++];
+            _bitCount += 8;
+        }
+        if (_bitCount < 1) {
+            break;
+        }
+
+        if ((_bits >> (_bitCount - 1)) & 1) {
+            if (_bitCount < 9) {
+                break;
+            }
+            _bitCount -= 9;
+            uint8_t value = (uint8_t)(_bits >> _bitCount);
+            _window[_written++ & WINDOW_MASK] = value;
+            out[produced++] = value;
+        } else {
+            if (_bitCount < 1 + LZSS_WINDOW_BITS + LZSS_LENGTH_BITS) {
+                break;
+            }
+            _bitCount -= 1 + LZSS_WINDOW_BITS + LZSS_LENGTH_BITS;
+            uint32_t token = _bits >> _bitCount;
+            _copyDistance = ((token >> LZSS_LENGTH_BITS) & WINDOW_MASK) + 1;
+            _copyRemaining = (token & ((1 << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_MATCH;
+            if (_copyDistance > _written) {
+                _corrupt = true;
+            }
+        }
+    }
+    return produced;
+}
@@ -29,11 +29,21 @@
 #include "watchdog_manager.h"
 #include "wifi_connection.h"
 #include "event_log.h"
+#include "log_shipper.h"
 #include "history_manager.h"
 #include "ntp_manager.h"
 #include "sensor_health_monitor.h"
 #include "valve_health_monitor.h"
 #include "serial_monitor.h"
+#include "sensor_filter.h"
+#include "adaptive_sampler.h"
+#include "window_open_detector.h"
+#include "sensor_scheduler.h"
+#include "serial_console.h"
+#include "console_commands.h"
+#include "command_coalescer.h"
+#include "sht_sensor.h"
+#include "ds18b20_sensor.h"
 
 // NOTE: Serial is now redefined to CapturedSerial via serial_redirect.h
 // All Serial.print() calls will go through TeeSerial
@@ -57,6 +67,13 @@ static const char* TAG_MQTT = "MQTT";
 
 // Global variables
 BME280Sensor bme280;
+SensorScheduler sensorScheduler;
+#if SENSOR_SHT_TYPE
+ShtSensor shtSensor(SENSOR_SHT_TYPE == 4 ? ShtSensor::SHT4X : ShtSensor::SHT3X, SENSOR_SHT_ADDRESS);
+#endif
+#if SENSOR_DS18B20_PIN >= 0
+Ds18b20Sensor radiatorReturnSensor(SENSOR_DS18B20_PIN);
+#endif
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
 ESPKNXIP knxInstance;  // Using our local instance
@@ -68,6 +85,25 @@ ConfigManager* configManager;
 float temperature = 0;
 float humidity = 0;
 float pressure = 0;
+float radiatorReturnTemperature = NAN;
+
+// Filter pipeline between the BME280 and its consumers (PID, KNX, MQTT)
+SensorFilterPipeline temperatureFilter;
+
+// Filtered room temperature the PID runs on; NaN until a sample passes, or after one is rejected
+float g_pidTemperature = NAN;
+
+// Set when g_pidTemperature holds a sample the PID has not consumed yet
+bool g_pidSampleFresh = false;
+
+// Varies the sensor sampling interval with room activity (when enabled)
+AdaptiveSampler adaptiveSampler;
+
+// Suspends PID control while a window is open (rapid heat loss)
+WindowOpenDetector windowOpenDetector;
+
+// Persists and echoes bursts of setpoint/preset/mode commands once they settle
+CommandCoalescer commandCoalescer;
 
 // Make WiFiManager persistent
 WiFiManager wifiManager;
@@ -90,7 +126,13 @@ void setupWiFi();
 void checkWiFiConnection();
 void updateSensorReadings();
 void updatePIDControl();
+float processRoomSample(const SensorSample& room);
 void storeLogToFlash(LogLevel level, const char* tag, const char* message, unsigned long timestamp);
+void applySensorFilterConfig();
+void applyAdaptiveSamplingConfig();
+void applyWindowOpenConfig();
+void applyLoggingConfig();
+void commitCoalescedCommands();
 
 // Create a global web server
 AsyncWebServer webServer(80);
@@ -101,6 +143,14 @@ unsigned long lastPIDUpdate = 0;
 // Add global instance of WatchdogManager
 WatchdogManager watchdogManager;
 
+// Batches EventLog entries for esp32_thermostat/logs
+LogShipper logShipper;
+
+// The MQTT task streams the batch; refused while it still has the previous one
+static bool publishLogBatch(void* context, const uint8_t* data, size_t length) {
+    return static_cast<MQTTManager*>(context)->queueLogBatch(data, length);
+}
+
 // Helper functions for setup
 // IMPORTANT: These functions must be called in a specific order due to dependencies:
 // 1. initializeLogger() - No dependencies, required by all other components
@@ -117,18 +167,27 @@ void initializeLogger() {
     Logger::getInstance().setLogLevel(LOG_INFO);
     LOG_I(TAG_MAIN, "ESP32 KNX Thermostat - With Adaptive PID Controller");
 
+    // Serial console: replies go through the captured Serial so the web monitor sees them too
+    SerialConsole::getInstance().begin(&Serial);
+    registerConsoleCommands();
+
     // Initialize EventLog for persistent logging
     EventLog::getInstance().begin();
     LOG_I(TAG_MAIN, "Event log initialized");
 
     // Register log callback for persistent logging
     Logger::getInstance().setLogCallback(storeLogToFlash);
+
+    // From here on LOG_x calls only enqueue; UART, web monitor and EventLog
+    // fan-out happens on the low-priority drain task
+    Logger::getInstance().startAsync();
 }
 void initializeConfig() {
     configManager = ConfigManager::getInstance();
     if (!configManager->begin()) {
         LOG_E(TAG_MAIN, "Failed to initialize configuration storage");
     }
+    applyLoggingConfig();
 }
 void initializeWatchdog() {
     if (!watchdogManager.begin()) {
@@ -138,7 +197,18 @@ void initializeWatchdog() {
 }
 void initializeSensor() {
     setupCustomLogHandler();
-    if (!bme280.begin()) {
+
+    // Register all sensors with the non-blocking scheduler; the BME280 is the room sensor
+    sensorScheduler.addSensor(&bme280, SENSOR_ROLE_ROOM);
+#if SENSOR_SHT_TYPE
+    sensorScheduler.addSensor(&shtSensor, SENSOR_ROLE_AUXILIARY);
+#endif
+#if SENSOR_DS18B20_PIN >= 0
+    sensorScheduler.addSensor(&radiatorReturnSensor, SENSOR_ROLE_RADIATOR_RETURN);
+#endif
+    sensorScheduler.begin();
+
+    if (!sensorScheduler.isPresent(sensorScheduler.findByRole(SENSOR_ROLE_ROOM))) {
         LOG_E(TAG_SENSOR, "Failed to initialize BME280 sensor!");
     }
 }
@@ -205,22 +275,11 @@ void initializeKNXAndMQTT() {
     knxManager.setMQTTManager(&mqttManager);
     mqttManager.setKNXManager(&knxManager);
 
-    // Setup MQTT logging callback for EventLog
+    // EventLog entries go to MQTT in batches (see LogShipper)
+    logShipper.begin(publishLogBatch, &mqttManager);
     EventLog::getInstance().setMQTTLoggingEnabled(true);
-    EventLog::getInstance().setMQTTCallback([](LogLevel level, const char* tag, const char* message) {
-        if (mqttClient.connected()) {
-            // Create JSON payload for the log
-            StaticJsonDocument<256> doc;
-            doc["timestamp"] = millis();
-            doc["level"] = EventLog::logLevelToString(level);
-            doc["tag"] = tag;
-            doc["message"] = message;
-
-            String payload;
-            serializeJson(doc, payload);
-
-            mqttClient.publish("esp32_thermostat/logs", payload.c_str());
-        }
+    EventLog::getInstance().setMQTTCallback([](const char* json, size_t length) {
+        return logShipper.add(json, length, millis());
     });
 
     // Register callback for KNX address configuration changes
@@ -247,6 +306,57 @@ void initializePID() {
     // Initialize health monitors
     SensorHealthMonitor::getInstance()->begin();
     ValveHealthMonitor::getInstance()->begin();
+
+    applySensorFilterConfig();
+    applyAdaptiveSamplingConfig();
+    applyWindowOpenConfig();
+}
+
+// Load the sensor filter settings from config (also called after /api/config updates)
+void applySensorFilterConfig() {
+    SensorFilterConfig filterConfig;
+    filterConfig.medianWindow = configManager->getFilterMedianWindow();
+    filterConfig.smoothing = configManager->getFilterSmoothing();
+    filterConfig.emaAlpha = configManager->getFilterEmaAlpha();
+    filterConfig.kalmanProcessNoise = configManager->getFilterKalmanQ();
+    filterConfig.kalmanMeasurementNoise = configManager->getFilterKalmanR();
+    filterConfig.outlierThreshold = configManager->getFilterOutlierThreshold();
+    temperatureFilter.configure(filterConfig);
+}
+
+// Load adaptive sampling bounds from config (also called after /api/config updates)
+void applyAdaptiveSamplingConfig() {
+    adaptiveSampler.configure(configManager->getAdaptiveSamplingEnabled(),
+                              configManager->getSensorMinInterval(),
+                              configManager->getSensorMaxInterval());
+}
+// Load window-open detection settings from config (also called after /api/config updates)
+void applyWindowOpenConfig() {
+    WindowOpenDetector::Event event =
+        windowOpenDetector.configure(configManager->getWindowOpenEnabled(),
+                                     configManager->getWindowOpenDropRate(),
+                                     configManager->getWindowOpenHoldTime() * 1000UL,
+                                     configManager->getWindowOpenValvePosition());
+    if (event == WindowOpenDetector::EVENT_CLOSED) {
+        EventLog::getInstance().addEntry(LOG_INFO, TAG_PID, "Window-open detection disabled, PID resumed");
+    }
+    mqttManager.publishWindowOpenState(windowOpenDetector.isActive());
+}
+// Load global and per-tag log levels from config (also called after /api/config and MQTT updates)
+void applyLoggingConfig() {
+    Logger& logger = Logger::getInstance();
+    logger.setLogLevel((LogLevel)configManager->getLogLevel());
+    logger.clearTagLevels();
+
+    String levels = configManager->getLogTagLevels();
+    const char* cursor = levels.c_str();
+    char tag[LOG_TAG_SIZE];
+    uint8_t level;
+    while (ConfigManager::nextLogTagLevel(cursor, tag, sizeof(tag), level)) {
+        logger.setTagLevel(tag, (LogLevel)level);
+    }
+    LOG_I(TAG_MAIN, "Log level %s%s%s", ConfigManager::logLevelName(configManager->getLogLevel()),
+          levels.length() > 0 ? ", per tag: " : "", levels.c_str());
 }
 void performInitialSetup() {
     // Log comprehensive memory and flash information
@@ -298,7 +408,8 @@ void performInitialSetup() {
           ESP.getChipModel(), ESP.getChipRevision(), ESP.getCpuFreqMHz());
     LOG_I(TAG_MAIN, "==============================================");
 
-    updateSensorReadings();
+    // First sensor cycle completes within the first loop iterations
+    sensorScheduler.requestCycle(millis());
     if (WiFi.status() == WL_CONNECTED) {
         lastConnectedTime = millis();
     }
@@ -326,6 +437,8 @@ void setup() {
 
 // In loop function
 void loop() {
+    unsigned long loopStart = micros();
+
     // Reset watchdog timer to prevent reboot
     // Update the watchdog manager at the beginning of each loop
     watchdogManager.update();
@@ -333,31 +446,42 @@ void loop() {
     // Replace old WiFi check with WiFiConnectionManager loop
     WiFiConnectionManager::getInstance().loop();
     EventLog::getInstance().loop();
+    logShipper.loop(millis(), mqttManager.isConnected());
 
-    // Clean up disconnected WebSocket clients
-    static unsigned long lastWsCleanup = 0;
-    if (millis() - lastWsCleanup > 1000) {
-        SerialMonitor::getInstance().cleanupClients();
-        lastWsCleanup = millis();
-    }
+    // Broadcast captured serial output and clean up disconnected WebSocket clients
+    SerialMonitor::getInstance().loop();
 
     // Handle KNX communications
     knxManager.loop();
 
-    // Monitor and decode KNX debug messages if enabled
-    monitorKnxDebugMessages();
+    // Serial console: whatever UART input has arrived (never waits), then lines from the web monitor
+    SerialConsole::getInstance().poll(*_realSerialForLogger);
+    SerialConsole::getInstance().loop();
 
     // Handle MQTT communications
     mqttManager.loop();
+
+    // Persist and echo setpoint/preset/mode commands once input has gone quiet
+    commitCoalescedCommands();
     
     // Update sensor readings and publish status
     unsigned long currentMillis = millis();
 
-    uint32_t sensorInterval = configManager->getSensorUpdateInterval();
+    // Setpoint changes and valve travel shorten the adaptive interval right away
+    adaptiveSampler.noteControlState(g_pid_input.setpoint_temp, knxManager.getValvePosition());
+    uint32_t sensorInterval = adaptiveSampler.isEnabled() ? adaptiveSampler.getInterval()
+                                                          : configManager->getSensorUpdateInterval();
     if (currentMillis - g_lastSensorUpdate > sensorInterval) {
-        updateSensorReadings();
+        sensorScheduler.requestCycle(currentMillis);
         g_lastSensorUpdate = currentMillis;
+    }
+
+    // Advance sensor conversions; at most one bus transaction per bus per iteration
+    sensorScheduler.loop(currentMillis);
+    if (sensorScheduler.consumeCycle()) {
+        updateSensorReadings();
         g_sensorUpdateCount++;
+        adaptiveSampler.recordSample(temperature, currentMillis);
 
         // Only add to history at the configured history interval
         unsigned long historyElapsed = currentMillis - g_lastHistoryUpdate;
@@ -372,17 +496,22 @@ void loop() {
         }
     }
 
-    // Periodic history diagnostic (every 5 minutes, logged as WARNING to persist in EventLog)
+    // Periodic history diagnostic (every 5 minutes). Only a stalled history is
+    // logged as WARNING (and so persisted in EventLog); routine reports stay at INFO.
     if (currentMillis - g_lastHistoryDiagnostic > 300000) {  // 5 minutes
+        static unsigned long lastDiagUpdateCount = 0;
         g_lastHistoryDiagnostic = currentMillis;
         HistoryManager* historyManager = HistoryManager::getInstance();
-        char diagMsg[256];
-        snprintf(diagMsg, sizeof(diagMsg),
-            "HISTORY DIAG: count=%d, updates=%lu, sensor_updates=%lu, millis=%lu, lastHist=%lu, lastSensor=%lu",
-            historyManager->getDataPointCount(), g_historyUpdateCount, g_sensorUpdateCount,
-            currentMillis, g_lastHistoryUpdate, g_lastSensorUpdate);
-        // Use WARNING level so it persists in EventLog
-        LOG_W("HIST_DIAG", "%s", diagMsg);
+        if (g_historyUpdateCount == lastDiagUpdateCount) {
+            LOG_W("HIST_DIAG", "History stalled: count=%d, updates=%lu, sensor_updates=%lu, lastHist=%lu, lastSensor=%lu",
+                  historyManager->getDataPointCount(), g_historyUpdateCount, g_sensorUpdateCount,
+                  g_lastHistoryUpdate, g_lastSensorUpdate);
+        } else {
+            LOG_I("HIST_DIAG", "HISTORY DIAG: count=%d, updates=%lu, sensor_updates=%lu, lastHist=%lu, lastSensor=%lu",
+                  historyManager->getDataPointCount(), g_historyUpdateCount, g_sensorUpdateCount,
+                  g_lastHistoryUpdate, g_lastSensorUpdate);
+        }
+        lastDiagUpdateCount = g_historyUpdateCount;
     }
 
     // Heap health monitoring - check every 30 seconds
@@ -398,7 +527,8 @@ void loop() {
             LOG_E(TAG_MAIN, "CRITICAL: Heap below 20KB (%lu bytes), scheduling restart", freeHeap);
             EventLog::getInstance().addEntry(LOG_ERROR, TAG_MAIN,
                 "CRITICAL: Low memory restart triggered");
-            delay(100);  // Allow log to flush
+            Logger::getInstance().flush(100);  // Allow log to flush
+            EventLog::getInstance().flush();
             ESP.restart();
         }
         // Warning threshold: 30KB free heap
@@ -428,12 +558,35 @@ void loop() {
         lastDiagnosticsUpdate = millis();
         LOG_D(TAG_MQTT, "Published diagnostics: RSSI=%d dBm, Uptime=%lu s", rssi, uptime);
     }
+
+    recordLoopTime(micros() - loopStart);
 }
 
+// Called when a SensorScheduler cycle has completed
 void updateSensorReadings() {
-    temperature = bme280.readTemperature();
-    humidity = bme280.readHumidity();
-    pressure = bme280.readPressure();
+    int radiatorIndex = sensorScheduler.findByRole(SENSOR_ROLE_RADIATOR_RETURN);
+    if (radiatorIndex >= 0) {
+        const SensorSample& radiator = sensorScheduler.getSample(radiatorIndex);
+        radiatorReturnTemperature = radiator.valid ? radiator.temperature : NAN;
+        LOG_D(TAG_SENSOR, "Radiator return: %.2f °C", radiatorReturnTemperature);
+    }
+
+    // Filter each sample as it arrives, so KNX, MQTT, history and the PID all
+    // see this sample's filter output
+    const SensorSample& room = sensorScheduler.getSample(sensorScheduler.findByRole(SENSOR_ROLE_ROOM));
+    g_pidTemperature = processRoomSample(room);
+    g_pidSampleFresh = !isnan(g_pidTemperature);
+    if (!room.valid) {
+        LOG_W(TAG_SENSOR, "Room sensor cycle failed - keeping previous readings");
+        return;
+    }
+
+    // A rejected reading (out of range or gated outlier) keeps the previous temperature
+    if (!isnan(g_pidTemperature)) {
+        temperature = g_pidTemperature;
+    }
+    humidity = room.humidity;
+    pressure = room.pressure;
 
     LOG_D(TAG_SENSOR, "Sensor readings updated:");
     LOG_D(TAG_SENSOR, "Temperature: %.2f °C", temperature);
@@ -451,25 +604,60 @@ void updateSensorReadings() {
     mqttManager.publishSensorData(temperature, humidity, pressure);
 
     // HA FIX #5: Sync climate state periodically (with sensor updates)
-    // This ensures HA stays in sync if mode/preset changes via web interface
+    // This ensures HA stays in sync if mode/preset changes via web interface.
+    // Skipped while a command burst is unsettled: NVS still holds the old value.
+    if (!commandCoalescer.isPending()) {
+        mqttManager.syncClimateState();
+    }
+}
+
+// One NVS write and one Home Assistant echo per burst of commands.
+// The controller already runs on the latest value; mode is stored by its handler.
+// The climate sync echoes the setpoint just stored, i.e. the burst's last one.
+void commitCoalescedCommands() {
+    CoalescedCommand command;
+    if (!commandCoalescer.take(millis(), command)) {
+        return;
+    }
+    if (command.changes & COALESCED_PRESET) {
+        configManager->setCurrentPreset(String(command.preset));
+        mqttManager.setClimatePreset(command.preset);
+    }
+    if (command.changes & COALESCED_MODE) {
+        mqttManager.setClimateMode(command.heat);
+    }
+    if (command.changes & COALESCED_SETPOINT) {
+        configManager->setSetpoint(command.setpoint);
+    }
     mqttManager.syncClimateState();
 }
 
-// Modified updatePIDControl function for main.cpp
-void updatePIDControl() {
-    ConfigManager* configManager = ConfigManager::getInstance();
+// Validate a new room sample, run it through the filter pipeline and the
+// window-open detector. Returns the filtered temperature, or NaN if rejected.
+float processRoomSample(const SensorSample& room) {
     SensorHealthMonitor* sensorHealth = SensorHealthMonitor::getInstance();
-
-    // Get current temperature from BME280
-    float currentTemp = bme280.readTemperature();
+    float currentTemp = room.valid ? room.temperature : NAN;
 
     // CRITICAL FIX: Validate sensor reading before processing (Audit Fix #1)
     // Reject NaN, infinity, and values outside physically possible range
     bool isValidReading = !(isnan(currentTemp) || isinf(currentTemp) ||
                            currentTemp < -40.0f || currentTemp > 85.0f);
 
-    // Item #9: Record sensor reading for health monitoring
-    sensorHealth->recordReading(isValidReading, currentTemp);
+    // Run valid samples through the filter pipeline; the outlier gate compares
+    // against the last good value before this reading is recorded
+    float rawTemp = currentTemp;
+    bool isOutlier = false;
+    if (isValidReading) {
+        isOutlier = !temperatureFilter.process(rawTemp, sensorHealth->getLastGoodValue(), currentTemp);
+    }
+
+    // Item #9: Record sensor reading for health monitoring (gated outliers count as failures)
+    sensorHealth->recordReading(isValidReading && !isOutlier, rawTemp);
+
+    if (isOutlier) {
+        LOG_W(TAG_PID, "Outlier sensor reading: %.2f°C - skipping PID update", rawTemp);
+        return NAN;
+    }
 
     if (!isValidReading) {
         LOG_E(TAG_PID, "Invalid sensor reading: %.2f°C - skipping PID update", currentTemp);
@@ -488,9 +676,9 @@ void updatePIDControl() {
                 "CRITICAL: Sensor failure - 10+ consecutive failures");
         }
 
-        // Skip this control cycle to prevent feeding bad data to PID
+        // Skip control until a good sample arrives to prevent feeding bad data to PID
         // Valve position remains unchanged from last valid cycle
-        return;
+        return NAN;
     }
 
     // Item #9: Check if sensor has recovered from failure
@@ -499,6 +687,36 @@ void updatePIDControl() {
         EventLog::getInstance().addEntry(LOG_INFO, TAG_SENSOR, "Sensor recovered");
     }
 
+    // Window-open detection runs on the filtered stream, one update per sample
+    WindowOpenDetector::Event windowEvent = windowOpenDetector.update(currentTemp, millis());
+    if (windowEvent == WindowOpenDetector::EVENT_OPENED) {
+        char message[64];
+        snprintf(message, sizeof(message), "Window open detected (%.2f C/min), PID suspended",
+                 windowOpenDetector.getSlope());
+        EventLog::getInstance().addEntry(LOG_WARNING, TAG_PID, message);
+        mqttManager.publishWindowOpenState(true);
+    } else if (windowEvent == WindowOpenDetector::EVENT_CLOSED) {
+        EventLog::getInstance().addEntry(LOG_INFO, TAG_PID, "Window-open hold expired, PID resumed");
+        mqttManager.publishWindowOpenState(false);
+    }
+
+    return currentTemp;
+}
+
+// Modified updatePIDControl function for main.cpp
+void updatePIDControl() {
+    ConfigManager* configManager = ConfigManager::getInstance();
+
+    // The input is the latest filtered room sample (updateSensorReadings), so
+    // the BME280 is read only at the (adaptive) sensor interval. The controller
+    // steps once per new sample: rerunning it on a held value would read a zero
+    // derivative, then the whole change in one tick, and fill the auto-tune
+    // history with duplicates. PID cycles in between keep the last output.
+    if (isnan(g_pidTemperature)) {
+        return;  // No sample yet, or the latest one was rejected
+    }
+    float currentTemp = g_pidTemperature;
+
     // HA FIX #1/#4: Check thermostat mode BEFORE running PID
     // When mode is "off", ensure valve is closed and skip PID control
     if (!configManager->getThermostatEnabled()) {
@@ -534,8 +752,14 @@ void updatePIDControl() {
         // Use manual override position
         finalValvePosition = configManager->getManualOverridePosition();
         LOG_D(TAG_PID, "Manual override active: %.1f%%", finalValvePosition);
-    } else {
-        // Update PID controller
+    } else if (windowOpenDetector.isActive()) {
+        // Hold the valve and freeze the PID so the integral does not wind up
+        finalValvePosition = windowOpenDetector.getValvePosition();
+        LOG_D(TAG_PID, "Window open: valve held at %.1f%% (%lu s remaining)", finalValvePosition,
+              windowOpenDetector.getRemainingMs(millis()) / 1000);
+    } else if (g_pidSampleFresh) {
+        // Update PID controller with the new sample
+        g_pidSampleFresh = false;
         updatePIDController(currentTemp, valvePosition);
 
         // Get new valve position from PID
@@ -548,6 +772,9 @@ void updatePIDControl() {
         LOG_D(TAG_PID, "Valve position: %.1f%%", finalValvePosition);
         LOG_D(TAG_PID, "PID params - Kp: %.3f, Ki: %.3f, Kd: %.3f",
               g_pid_input.Kp, g_pid_input.Ki, g_pid_input.Kd);
+    } else {
+        // No new sample since the last step: hold the last PID output
+        finalValvePosition = getPIDOutput();
     }
 
     // Apply final valve position to KNX
@@ -592,17 +819,16 @@ void updatePIDControl() {
     }
 
     // Save PID parameters to config with write coalescing to reduce flash wear
-    // Write to flash max once every 5 minutes if parameters have changed
+    // Write to flash max once every 5 minutes if parameters have changed.
+    // The setpoint is saved by commitCoalescedCommands() once per command burst.
     static float last_saved_kp = g_pid_input.Kp;
     static float last_saved_ki = g_pid_input.Ki;
     static float last_saved_kd = g_pid_input.Kd;
-    static float last_saved_setpoint = g_pid_input.setpoint_temp;
     static unsigned long lastConfigWrite = 0;
     static bool pendingConfigWrite = false;
     if (fabs(last_saved_kp - g_pid_input.Kp) > 0.001f ||
         fabs(last_saved_ki - g_pid_input.Ki) > 0.001f ||
-        fabs(last_saved_kd - g_pid_input.Kd) > 0.001f ||
-        fabs(last_saved_setpoint - g_pid_input.setpoint_temp) > 0.01f) {
+        fabs(last_saved_kd - g_pid_input.Kd) > 0.001f) {
         pendingConfigWrite = true;
     }
     // Audit Fix #4: Overflow-safe interval check
@@ -611,11 +837,9 @@ void updatePIDControl() {
         configManager->setPidKp(g_pid_input.Kp);
         configManager->setPidKi(g_pid_input.Ki);
         configManager->setPidKd(g_pid_input.Kd);
-        configManager->setSetpoint(g_pid_input.setpoint_temp);
         last_saved_kp = g_pid_input.Kp;
         last_saved_ki = g_pid_input.Ki;
         last_saved_kd = g_pid_input.Kd;
-        last_saved_setpoint = g_pid_input.setpoint_temp;
         lastConfigWrite = millis();
         pendingConfigWrite = false;
         LOG_I(TAG_PID, "PID parameters written to flash storage");
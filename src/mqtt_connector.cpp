@@ -0,0 +1,93 @@
+#include "mqtt_connector.h"
+
+MqttConnector::MqttConnector(uint32_t initialDelayMs, uint32_t maxDelayMs)
+    : _initialDelay(initialDelayMs),
+      _maxDelay(maxDelayMs < initialDelayMs ? initialDelayMs : maxDelayMs),
+      _state(MQTT_LINK_WAIT_NETWORK),
+      _backoffStart(0),
+      _retryDelay(0),
+      _random(0x2545F491u),
+      _failures(0),
+      _attempts(0),
+      _connects(0) {
+}
+
+void MqttConnector::seed(uint32_t value) {
+    // xorshift must not start at zero
+    _random = value != 0 ? value : 0x2545F491u;
+}
+
+// xorshift32
+uint32_t MqttConnector::nextRandom() {
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
+
+void MqttConnector::scheduleRetry(uint32_t now) {
+    if (_failures < 255) {
+        _failures++;
+    }
+
+    // Double per failure, without shifting past the cap
+    uint32_t delay = _initialDelay;
+    for (uint8_t i = 1; i < _failures && delay < _maxDelay; i++) {
+        delay = (delay > _maxDelay / 2) ? _maxDelay : delay * 2;
+    }
+    if (delay > _maxDelay) {
+        delay = _maxDelay;
+    }
+
+    uint32_t half = delay / 2;
+    _retryDelay = half + nextRandom() % (delay - half + 1);
+    _backoffStart = now;
+    _state = MQTT_LINK_BACKOFF;
+}
+
+bool MqttConnector::poll(uint32_t now, bool networkUp, bool clientConnected) {
+    if (!networkUp) {
+        // Waiting for WiFi is not a broker failure; the backoff stays as it was
+        _state = MQTT_LINK_WAIT_NETWORK;
+        return false;
+    }
+
+    switch (_state) {
+        case MQTT_LINK_WAIT_NETWORK:
+            _state = MQTT_LINK_BACKOFF;
+            _backoffStart = now;
+            _retryDelay = 0;
+            break;
+
+        case MQTT_LINK_ONLINE:
+            if (!clientConnected) {
+                scheduleRetry(now);
+            }
+            return false;
+
+        case MQTT_LINK_CONNECTING:
+            // Waiting for connectFinished()
+            return false;
+
+        case MQTT_LINK_BACKOFF:
+            break;
+    }
+
+    if (now - _backoffStart < _retryDelay) {
+        return false;
+    }
+    _state = MQTT_LINK_CONNECTING;
+    _attempts++;
+    return true;
+}
+
+void MqttConnector::connectFinished(bool success, uint32_t now) {
+    if (success) {
+        _state = MQTT_LINK_ONLINE;
+        _failures = 0;
+        _retryDelay = 0;
+        _connects++;
+    } else {
+        scheduleRetry(now);
+    }
+}
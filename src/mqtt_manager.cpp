@@ -6,19 +6,38 @@
 #include "serial_redirect.h"
 #include "sensor_health_monitor.h"
 #include "valve_health_monitor.h"
-#include <ArduinoJson.h>
+#include "ntp_manager.h"
+#include "logger.h"
+#include "adaptive_pid_controller.h"
+#include "command_coalescer.h"
 #include <WiFi.h>
 #include <esp_heap_caps.h>
 
 // Redirect Serial to CapturedSerial for web monitor
 #define Serial CapturedSerial
 
+static const char* TAG = "MQTT";
+
+// Debounced persistence and echo of climate commands (main.cpp)
+extern CommandCoalescer commandCoalescer;
+
+// The MQTT task shares core 0 with WiFi and the log drain, away from loop()
+static const uint32_t MQTT_TASK_STACK = 8192;
+static const UBaseType_t MQTT_TASK_PRIORITY = 1;
+static const BaseType_t MQTT_TASK_CORE = 0;
+static const uint32_t MQTT_TASK_IDLE_MS = 20;     // Longest pause between client loop() calls
+
 // Initialize static instance pointer
 MQTTManager* MQTTManager::_instance = nullptr;
 
 MQTTManager::MQTTManager(PubSubClient& mqttClient)
-    : _mqttClient(mqttClient), _knxManager(nullptr), _valvePosition(0), _lastReconnectAttempt(0),
-      _mqttServer(MQTT_SERVER), _mqttPort(MQTT_PORT) {
+    : _mqttClient(mqttClient), _knxManager(nullptr), _valvePosition(0),
+      _mqttServer(MQTT_SERVER), _mqttPort(MQTT_PORT), _lastBackfill(0),
+      _task(nullptr), _online(false), _droppedJobs(0), _aggregateEnabled(false),
+      _aggregateFormat(TELEGRAPH_JSON), _aggregateFields(TELEGRAPH_ALL_FIELDS),
+      _climateHeat(false), _logBatchLength(0), _droppedCommands(0) {
+    portMUX_INITIALIZE(&_climateLock);
+    _climatePreset[0] = '\0';
     // Store instance for static callback
     _instance = this;
 }
@@ -33,34 +52,156 @@ MQTTManager::~MQTTManager() {
 
 void MQTTManager::begin() {
     Serial.println("Setting up MQTT...");
-    
+
     // Set server and callback
     configureServerFromSettings();
+    applyAggregateConfig();
+    applyClimateConfig();
     _mqttClient.setCallback(mqttCallback);
-    _mqttClient.setBufferSize(1536);  // Increased buffer size for discovery messages (climate payload is ~992 bytes)
+    _mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
     _mqttClient.setSocketTimeout(2);
     _mqttClient.setKeepAlive(30);
 
+    // Readings taken while offline overflow from RAM into a LittleFS ring file
+    if (_outboxSpill.begin()) {
+        _outbox.setSpill(&_outboxSpill);
+    } else {
+        Serial.println("MQTT outbox: LittleFS not available, buffering in RAM only");
+    }
+
     // Initialize Home Assistant integration using unique_ptr
     _homeAssistant = std::unique_ptr<HomeAssistant>(new HomeAssistant(_mqttClient, "esp32_thermostat"));
     _homeAssistant->begin();
 
-    // Try to connect
-    reconnect();
-    
+    // Connecting is up to the MQTT task from here on
+    _connector.seed(esp_random());
+    startTask();
+
     Serial.println("MQTT initialized");
 }
 
 void MQTTManager::loop() {
-    if (!_mqttClient.connected()) {
-        unsigned long now = millis();
-        if (now - _lastReconnectAttempt >= MQTT_RECONNECT_INTERVAL_MS) {
-            _lastReconnectAttempt = now;
-            reconnect();
+    // Without a task the client is driven from here, as it used to be
+    if (_task == nullptr) {
+        serviceClient();
+    }
+    runCommands();
+}
+
+void MQTTManager::clientTask(void* param) {
+    MQTTManager* manager = static_cast<MQTTManager*>(param);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MQTT_TASK_IDLE_MS));
+        manager->serviceClient();
+    }
+}
+
+bool MQTTManager::startTask() {
+    if (_task != nullptr) {
+        return true;
+    }
+
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(clientTask, "mqtt", MQTT_TASK_STACK, this,
+                                MQTT_TASK_PRIORITY, &handle, MQTT_TASK_CORE) != pdPASS) {
+        LOG_E(TAG, "Failed to start MQTT task - running the client from the main loop");
+        return false;
+    }
+    _task = handle;
+    return true;
+}
+
+MQTTManager::Job MQTTManager::makeJob(JobType type) {
+    Job job;
+    memset(&job, 0, sizeof(job));
+    job.type = type;
+    return job;
+}
+
+// Any task: queue work for the MQTT task and wake it
+void MQTTManager::post(const Job& job) {
+    if (!_jobs.tryPush(job)) {
+        _droppedJobs.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TaskHandle_t task = _task;
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+// One pass of the MQTT task: connection upkeep, inbound traffic, queued publishes
+void MQTTManager::serviceClient() {
+    bool clientConnected = _mqttClient.connected();
+    if (!clientConnected && _online.load(std::memory_order_relaxed)) {
+        _online.store(false);
+        LOG_W(TAG, "Lost connection to broker");
+    }
+
+    if (_connector.poll(millis(), WiFi.status() == WL_CONNECTED, clientConnected)) {
+        clientConnected = reconnect();
+        _connector.connectFinished(clientConnected, millis());
+        if (!clientConnected) {
+            LOG_D(TAG, "Next connection attempt in %lu ms", (unsigned long)_connector.getRetryDelay());
+        }
+    }
+
+    if (clientConnected) {
+        _mqttClient.loop();
+    }
+
+    // Jobs run offline too: readings go to the outbox, state updates are dropped
+    Job* job;
+    while ((job = _jobs.front()) != nullptr) {
+        runJob(*job);
+        _jobs.pop();
+    }
+
+    if (_online.load(std::memory_order_relaxed)) {
+        if (_homeAssistant) {
+            _homeAssistant->loop(millis());
         }
+        sendLogBatch();
+        publishBackfill();
+    }
+}
+
+void MQTTManager::runJob(const Job& job) {
+    if (job.type == JOB_SENSOR_DATA) {
+        sendSensorData(job.values[0], job.values[1], job.values[2]);
+        return;
+    }
+    if (job.type == JOB_RESTART) {
+        _mqttClient.publish("esp32_thermostat/status", "Restarting...", true);
+        delay(500);
+        ESP.restart();
+    }
+    if (!_mqttClient.connected() || !_homeAssistant) {
         return;
     }
-    _mqttClient.loop();
+
+    switch (job.type) {
+        case JOB_PID_PARAMETERS:
+            _homeAssistant->updatePIDParameters(job.values[0], job.values[1], job.values[2]);
+            break;
+        case JOB_DIAGNOSTICS:
+            _homeAssistant->updateDiagnostics(job.integers[0], (uint32_t)job.integers[1]);
+            break;
+        case JOB_WINDOW_OPEN:
+            _mqttClient.publish("esp32_thermostat/window_open", job.integers[0] ? "ON" : "OFF", true);
+            break;
+        case JOB_VALVE_POSITION:
+            sendValvePosition(job.integers[0]);
+            break;
+        case JOB_CLIMATE_SYNC:
+            _homeAssistant->syncClimateState();
+            break;
+        case JOB_STATE_DOCUMENT:
+            _homeAssistant->switchStateDocument(job.integers[0] != 0);
+            break;
+        default:
+            break;
+    }
 }
 
 void MQTTManager::setKNXManager(KNXManager* knxManager) {
@@ -68,148 +209,214 @@ void MQTTManager::setKNXManager(KNXManager* knxManager) {
 }
 
 void MQTTManager::publishSensorData(float temperature, float humidity, float pressure) {
-    if (!_mqttClient.connected()) return;
+    Job job = makeJob(JOB_SENSOR_DATA);
+    job.values[0] = temperature;
+    job.values[1] = humidity;
+    job.values[2] = pressure;
+    post(job);
+}
 
-    // Update Home Assistant with all sensor values
-    if (_homeAssistant) {
-        _homeAssistant->updateStates(temperature, humidity, pressure, _valvePosition);
-    }
+void MQTTManager::updatePIDParameters(float kp, float ki, float kd) {
+    Job job = makeJob(JOB_PID_PARAMETERS);
+    job.values[0] = kp;
+    job.values[1] = ki;
+    job.values[2] = kd;
+    post(job);
+}
 
-    // Publish JSON aggregate if enabled
-    ConfigManager* configManager = ConfigManager::getInstance();
-    if (configManager && configManager->getMqttJsonAggregateEnabled()) {
-        // Get current PID parameters
-        float kp = configManager->getPidKp();
-        float ki = configManager->getPidKi();
-        float kd = configManager->getPidKd();
-        
-        // Get WiFi RSSI and uptime
-        int wifiRSSI = WiFi.RSSI();
-        unsigned long uptime = millis() / 1000; // Convert to seconds
-        
-        publishJsonAggregate(temperature, humidity, pressure, kp, ki, kd, wifiRSSI, uptime);
+void MQTTManager::updateDiagnostics(int wifiRSSI, unsigned long uptime) {
+    Job job = makeJob(JOB_DIAGNOSTICS);
+    job.integers[0] = wifiRSSI;
+    job.integers[1] = (int32_t)uptime;
+    post(job);
+}
+
+void MQTTManager::publishWindowOpenState(bool open) {
+    Job job = makeJob(JOB_WINDOW_OPEN);
+    job.integers[0] = open ? 1 : 0;
+    post(job);
+}
+
+void MQTTManager::setValvePosition(int position) {
+    // Constrain position to 0-100%
+    position = constrain(position, 0, 100);
+
+    if (_valvePosition.exchange(position) != position) {
+        Job job = makeJob(JOB_VALVE_POSITION);
+        job.integers[0] = position;
+        post(job);
     }
 }
 
-void MQTTManager::updatePIDParameters(float kp, float ki, float kd) {
-    if (!_mqttClient.connected()) return;
+int MQTTManager::getValvePosition() const {
+    return _valvePosition.load();
+}
 
-    // Update Home Assistant with PID parameters
-    if (_homeAssistant) {
-        _homeAssistant->updatePIDParameters(kp, ki, kd);
+// HA FIX #5: Sync climate state to Home Assistant
+void MQTTManager::syncClimateState() {
+    post(makeJob(JOB_CLIMATE_SYNC));
+}
+
+bool MQTTManager::queueLogBatch(const uint8_t* data, size_t length) {
+    if (length > sizeof(_logBatch) || _logBatchLength.load(std::memory_order_acquire) != 0) {
+        return false;
     }
+    memcpy(_logBatch, data, length);
+    _logBatchLength.store(length, std::memory_order_release);
+    TaskHandle_t task = _task;
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+    return true;
 }
 
-void MQTTManager::updateDiagnostics(int wifiRSSI, unsigned long uptime) {
-    if (!_mqttClient.connected()) return;
+// Stream the handed-over batch; it may exceed the PubSubClient buffer.
+// It stays until delivered, which holds LogShipper back meanwhile.
+void MQTTManager::sendLogBatch() {
+    size_t length = _logBatchLength.load(std::memory_order_acquire);
+    if (length == 0) {
+        return;
+    }
+    bool published = _mqttClient.beginPublish("esp32_thermostat/logs", length, false) &&
+                     _mqttClient.write(reinterpret_cast<const uint8_t*>(_logBatch), length) == length &&
+                     _mqttClient.endPublish();
+    if (published) {
+        _logBatchLength.store(0, std::memory_order_release);
+    }
+}
+
+bool MQTTManager::isConnected() {
+    return _online.load(std::memory_order_relaxed);
+}
 
-    // Update Home Assistant with diagnostic data
+void MQTTManager::sendSensorData(float temperature, float humidity, float pressure) {
+    if (!_mqttClient.connected()) {
+        queueOfflineReading(temperature, humidity, pressure);
+        return;
+    }
+
+    // Update Home Assistant with all sensor values
     if (_homeAssistant) {
-        _homeAssistant->updateDiagnostics(wifiRSSI, uptime);
+        _homeAssistant->updateStates(temperature, humidity, pressure, _valvePosition.load());
+    }
+
+    // Publish the aggregate if enabled; gains come from the running controller, not NVS
+    if (_aggregateEnabled.load(std::memory_order_relaxed)) {
+        unsigned long uptime = millis() / 1000; // Convert to seconds
+        sendAggregate(temperature, humidity, pressure, g_pid_input.Kp, g_pid_input.Ki, g_pid_input.Kd,
+                      WiFi.RSSI(), uptime);
     }
 }
 
-void MQTTManager::publishJsonAggregate(float temperature, float humidity, float pressure,
-                                        float kp, float ki, float kd, int wifiRSSI, unsigned long uptime) {
-    if (!_mqttClient.connected()) return;
+void MQTTManager::applyAggregateConfig() {
+    ConfigManager* configManager = ConfigManager::getInstance();
+    if (!configManager) return;
+    _aggregateFormat.store(configManager->getMqttAggregateFormat(), std::memory_order_relaxed);
+    _aggregateFields.store(configManager->getMqttAggregateFields(), std::memory_order_relaxed);
+    _aggregateEnabled.store(configManager->getMqttJsonAggregateEnabled(), std::memory_order_relaxed);
+}
 
+void MQTTManager::applyClimateConfig() {
     ConfigManager* configManager = ConfigManager::getInstance();
     if (!configManager) return;
+    char preset[sizeof(_climatePreset)];
+    setClimateMode(configManager->getThermostatEnabled());
+    setClimatePreset(configManager->getCurrentPreset(preset, sizeof(preset)));
+}
 
-    // Create JSON document (768 bytes to accommodate health data)
-    StaticJsonDocument<768> doc;
-
-    // Sensor data
-    doc["temperature"] = roundf(temperature * 100) / 100.0f; // Round to 2 decimals
-    doc["humidity"] = roundf(humidity * 100) / 100.0f;
-    doc["pressure"] = roundf(pressure * 100) / 100.0f;
-
-    // Valve data
-    doc["valve_position"] = _valvePosition;
-    doc["action"] = (_valvePosition > 0) ? "heating" : "idle";
-    doc["heating_state"] = (_valvePosition > 0) ? "ON" : "OFF";
-
-    // PID parameters
-    doc["pid"]["kp"] = roundf(kp * 100) / 100.0f; // Round to 2 decimals
-    doc["pid"]["ki"] = roundf(ki * 1000) / 1000.0f; // Round to 3 decimals
-    doc["pid"]["kd"] = roundf(kd * 1000) / 1000.0f; // Round to 3 decimals
-    doc["pid"]["setpoint"] = roundf(configManager->getSetpoint() * 10) / 10.0f; // Round to 1 decimal
-
-    // Control state
-    doc["mode"] = configManager->getThermostatEnabled() ? "heat" : "off";
-    doc["preset"] = configManager->getCurrentPreset();
-
-    // Diagnostics
-    doc["wifi"]["rssi"] = wifiRSSI;
-    doc["uptime"] = uptime;
-    doc["status"] = "online";
-
-    // Health monitoring data
-    SensorHealthMonitor* sensorHealth = SensorHealthMonitor::getInstance();
-    ValveHealthMonitor* valveHealth = ValveHealthMonitor::getInstance();
-
-    doc["health"]["sensor_healthy"] = sensorHealth->isSensorHealthy();
-    doc["health"]["sensor_failure_rate"] = roundf(sensorHealth->getFailureRate() * 10) / 10.0f;
-    doc["health"]["sensor_consecutive_failures"] = sensorHealth->getConsecutiveFailures();
-    doc["health"]["valve_healthy"] = valveHealth->isValveHealthy();
-    doc["health"]["valve_error_pct"] = roundf(valveHealth->getAverageError() * 10) / 10.0f;
-
-    // Memory health
-    uint32_t freeHeap = ESP.getFreeHeap();
-    size_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
-    doc["health"]["free_heap"] = freeHeap;
-    doc["health"]["heap_fragmentation"] = roundf(100.0f * (1.0f - (float)largestBlock / freeHeap) * 10) / 10.0f;
-
-    // Serialize JSON to string
-    String jsonPayload;
-    serializeJson(doc, jsonPayload);
-
-    // Publish to 'telegraph' topic
-    bool published = _mqttClient.publish("telegraph", jsonPayload.c_str());
-    if (!published) {
-        Serial.println("Failed to publish JSON aggregate to 'telegraph' topic");
-    }
+void MQTTManager::setClimateMode(bool heat) {
+    _climateHeat.store(heat, std::memory_order_relaxed);
 }
 
-void MQTTManager::setValvePosition(int position) {
-    // Constrain position to 0-100%
-    position = constrain(position, 0, 100);
+void MQTTManager::setClimatePreset(const char* preset) {
+    portENTER_CRITICAL(&_climateLock);
+    strncpy(_climatePreset, preset, sizeof(_climatePreset) - 1);
+    _climatePreset[sizeof(_climatePreset) - 1] = '\0';
+    portEXIT_CRITICAL(&_climateLock);
+}
 
-    if (position != _valvePosition) {
-        _valvePosition = position;
-
-        // Update Home Assistant if connected
-        if (_mqttClient.connected() && _homeAssistant) {
-            // For the valve position, create both a plain value
-            char valveStr[4];
-            itoa(_valvePosition, valveStr, 10);
-
-            // Publish to valve position topic
-            _mqttClient.publish("esp32_thermostat/valve/position", valveStr);
-
-            // HA FIX #2: Determine action based on mode AND valve position
-            // When mode is "off", action should be "off", not "idle"
-            ConfigManager* configManager = ConfigManager::getInstance();
-            const char* action;
-            if (!configManager->getThermostatEnabled()) {
-                action = "off";
-            } else if (_valvePosition > 0) {
-                action = "heating";
-            } else {
-                action = "idle";
-            }
-            _mqttClient.publish("esp32_thermostat/action", action, true);
-            Serial.print("Action: ");
-            Serial.println(action);
+// Offline the setting is picked up by reconnect()
+void MQTTManager::applyStateDocumentConfig() {
+    ConfigManager* configManager = ConfigManager::getInstance();
+    if (!configManager) return;
+    Job job = makeJob(JOB_STATE_DOCUMENT);
+    job.integers[0] = configManager->getMqttStateDocumentEnabled() ? 1 : 0;
+    post(job);
+}
 
-            Serial.print("Published valve position to MQTT: ");
-            Serial.println(_valvePosition);
-        }
+// MQTT task: only the selected field groups are gathered, into a buffer reused every cycle
+void MQTTManager::sendAggregate(float temperature, float humidity, float pressure,
+                                 float kp, float ki, float kd, int wifiRSSI, unsigned long uptime) {
+    uint8_t fields = _aggregateFields.load(std::memory_order_relaxed);
+    TelegraphFormat format = (TelegraphFormat)_aggregateFormat.load(std::memory_order_relaxed);
+
+    TelegraphSample sample;
+    sample.temperature = temperature;
+    sample.humidity = humidity;
+    sample.pressure = pressure;
+    sample.valvePosition = _valvePosition.load();
+    sample.kp = kp;
+    sample.ki = ki;
+    sample.kd = kd;
+    sample.setpoint = g_pid_input.setpoint_temp;
+    sample.wifiRSSI = wifiRSSI;
+    sample.uptime = uptime;
+
+    if (fields & TELEGRAPH_CONTROL) {
+        sample.heat = _climateHeat.load(std::memory_order_relaxed);
+        portENTER_CRITICAL(&_climateLock);
+        memcpy(sample.preset, _climatePreset, sizeof(sample.preset));
+        portEXIT_CRITICAL(&_climateLock);
+    }
+
+    if (fields & TELEGRAPH_HEALTH) {
+        SensorHealthMonitor* sensorHealth = SensorHealthMonitor::getInstance();
+        ValveHealthMonitor* valveHealth = ValveHealthMonitor::getInstance();
+        sample.sensorHealthy = sensorHealth->isSensorHealthy();
+        sample.sensorFailureRate = sensorHealth->getFailureRate();
+        sample.sensorConsecutiveFailures = sensorHealth->getConsecutiveFailures();
+        sample.valveHealthy = valveHealth->isValveHealthy();
+        sample.valveErrorPct = valveHealth->getAverageError();
+    }
+
+    if (fields & TELEGRAPH_MEMORY) {
+        uint32_t freeHeap = ESP.getFreeHeap();
+        size_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        sample.freeHeap = freeHeap;
+        sample.heapFragmentation = 100.0f * (1.0f - (float)largestBlock / freeHeap);
+    }
+
+    size_t length = encodeTelegraph(sample, fields, format, _aggregateBuffer, sizeof(_aggregateBuffer));
+    if (length == 0) {
+        LOG_W(TAG, "Aggregate does not fit in %u bytes", (unsigned)sizeof(_aggregateBuffer));
+        return;
+    }
+
+    // Streamed: it is larger than the MQTT buffer
+    bool published = _mqttClient.beginPublish(TELEGRAPH_TOPIC, length, false) &&
+                     _mqttClient.write(_aggregateBuffer, length) == length &&
+                     _mqttClient.endPublish();
+    if (!published) {
+        LOG_W(TAG, "Failed to publish aggregate to '%s'", TELEGRAPH_TOPIC);
     }
 }
 
-int MQTTManager::getValvePosition() const {
-    return _valvePosition;
+void MQTTManager::sendValvePosition(int position) {
+    // HA FIX #2: Determine action based on mode AND valve position
+    // When mode is "off", action should be "off", not "idle"
+    ConfigManager* configManager = ConfigManager::getInstance();
+    const char* action;
+    if (!configManager->getThermostatEnabled()) {
+        action = "off";
+    } else if (position > 0) {
+        action = "heating";
+    } else {
+        action = "idle";
+    }
+
+    // Deadband and heartbeat decide whether the topics go out
+    _homeAssistant->updateValvePosition(position, action);
+    LOG_D(TAG, "Valve position %d%%, action %s", position, action);
 }
 
 void MQTTManager::mqttCallback(char* topic, byte* payload, unsigned int length) {
@@ -219,150 +426,214 @@ void MQTTManager::mqttCallback(char* topic, byte* payload, unsigned int length)
     }
 }
 
+// Subscribed command topics, in strcmp order (checked at compile time)
+const MQTTManager::CommandRoute* MQTTManager::commandRoutes(size_t& count) {
+    static constexpr CommandRoute ROUTES[] = {
+        {"esp32_thermostat/log_level/set",   &MQTTManager::handleLogLevelCommand},
+        {"esp32_thermostat/mode/set",        &MQTTManager::handleModeCommand},
+        {"esp32_thermostat/preset/set",      &MQTTManager::handlePresetCommand},
+        {"esp32_thermostat/restart",         &MQTTManager::handleRestartCommand},
+        {"esp32_thermostat/temperature/set", &MQTTManager::handleSetpointCommand},
+        {"esp32_thermostat/valve/set",       &MQTTManager::handleValveCommand},
+        {MQTT_TOPIC_VALVE_COMMAND,           &MQTTManager::handleValveCommand},
+    };
+    static_assert(mqttRoutesSorted(ROUTES), "MQTT command routes must be sorted and unique");
+
+    count = sizeof(ROUTES) / sizeof(ROUTES[0]);
+    return ROUTES;
+}
+
+// MQTT task: hand a command to the main loop, which owns the state it changes
 void MQTTManager::processMessage(char* topic, byte* payload, unsigned int length) {
-    // Convert payload to string
-    char message[length + 1];
-    for (unsigned int i = 0; i < length; i++) {
-        message[i] = (char)payload[i];
-    }
-    message[length] = '\0';
-    
-    Serial.print("MQTT message received [");
-    Serial.print(topic);
-    Serial.print("]: ");
-    Serial.println(message);
-    
-    // Handle valve position command
-    if (strcmp(topic, MQTT_TOPIC_VALVE_COMMAND) == 0 || 
-        strcmp(topic, "esp32_thermostat/valve/set") == 0) {
-        
-        int position = atoi(message);
-        position = constrain(position, 0, 100);
-        
-        Serial.print("Parsed valve position: ");
-        Serial.println(position);
-        
-        // Update valve position locally
-        _valvePosition = position;
-        
-        // Update KNX if available
-        if (_knxManager) {
-            _knxManager->setValvePosition(position);
-        } else {
-            // If KNX manager not available, update MQTT directly
-            setValvePosition(position);
-        }
+    // Home Assistant birth messages and the discovery digest stay on this task
+    if (_homeAssistant && _homeAssistant->handleMessage(topic, payload, length)) {
+        return;
     }
-    
-    // Handle temperature setpoint
-    if (strcmp(topic, "esp32_thermostat/temperature/set") == 0) {
-        float setpoint = atof(message);
-        Serial.print("Setting temperature setpoint to: ");
-        Serial.println(setpoint);
 
-        // Update PID controller setpoint
-        extern void setTemperatureSetpoint(float);
-        setTemperatureSetpoint(setpoint);
-
-        // Publish the new setpoint back to MQTT
-        char setpointStr[8];
-        dtostrf(setpoint, 1, 1, setpointStr);
-        _mqttClient.publish("esp32_thermostat/temperature/setpoint", setpointStr, true);
-    }
-
-    // Handle preset mode from Home Assistant
-    if (strcmp(topic, "esp32_thermostat/preset/set") == 0) {
-        String preset = String(message);
-        Serial.println("=== MQTT PRESET RECEIVED ===");
-        Serial.print("  Preset: ");
-        Serial.println(preset);
-
-        // Get the temperature for this preset
-        extern ConfigManager* configManager;
-        if (configManager) {
-            String oldPreset = configManager->getCurrentPreset();
-            float presetTemp = configManager->getPresetTemperature(preset);
-            configManager->setCurrentPreset(preset);
-
-            // Update the setpoint to match the preset temperature
-            extern void setTemperatureSetpoint(float);
-            setTemperatureSetpoint(presetTemp);
-
-            // Publish the preset state back to MQTT
-            if (_homeAssistant) {
-                _homeAssistant->updatePresetMode(preset.c_str());
-            }
+    size_t routeCount;
+    const CommandRoute* routes = commandRoutes(routeCount);
+    const CommandRoute* route = findMqttRoute(routes, routeCount, topic);
+    if (route == nullptr) {
+        LOG_D(TAG, "Ignoring message on %s", topic);
+        return;
+    }
+    if (length > MQTT_COMMAND_PAYLOAD_MAX) {
+        LOG_W(TAG, "Dropped %u byte payload on %s (limit %d)",
+              length, topic, MQTT_COMMAND_PAYLOAD_MAX);
+        return;
+    }
 
-            // Also publish the new setpoint
-            char setpointStr[8];
-            dtostrf(presetTemp, 1, 1, setpointStr);
-            _mqttClient.publish("esp32_thermostat/temperature/setpoint", setpointStr, true);
-
-            Serial.print("  Changed: ");
-            Serial.print(oldPreset);
-            Serial.print(" -> ");
-            Serial.print(preset);
-            Serial.print(" (");
-            Serial.print(presetTemp);
-            Serial.println("°C)");
-            Serial.println("=== PRESET CHANGE COMPLETE ===");
-        } else {
-            Serial.println("  ERROR: ConfigManager not available!");
-        }
+    uint32_t pos;
+    if (!_commands.claim(pos)) {
+        _droppedCommands++;
+        LOG_W(TAG, "Command queue full, dropped message on %s", topic);
+        return;
+    }
+    Command& command = _commands.at(pos);
+    command.route = (uint8_t)(route - routes);
+    command.length = (uint8_t)length;
+    memcpy(command.payload, payload, length);
+    command.payload[length] = '\0';
+    LOG_D(TAG, "Received [%s]: %s", topic, command.payload);
+    _commands.publish(pos);
+}
+
+// Main loop: run the commands received since the last pass
+void MQTTManager::runCommands() {
+    size_t routeCount;
+    const CommandRoute* routes = commandRoutes(routeCount);
+    Command* command;
+    while ((command = _commands.front()) != nullptr) {
+        (this->*routes[command->route].handler)(command->payload, command->length);
+        _commands.pop();
     }
+}
+
+void MQTTManager::handleValveCommand(const char* payload, size_t length) {
+    int position = atoi(payload);
+    position = constrain(position, 0, 100);
+
+    Serial.print("Parsed valve position: ");
+    Serial.println(position);
+
+    // Update KNX if available
+    if (_knxManager) {
+        // Update valve position locally
+        _valvePosition.store(position);
+        _knxManager->setValvePosition(position);
+    } else {
+        // If KNX manager not available, update MQTT directly
+        setValvePosition(position);
+    }
+}
+
+void MQTTManager::handleSetpointCommand(const char* payload, size_t length) {
+    // Same validation and rounding as POST /api/setpoint and the console
+    float setpoint;
+    if (!ConfigManager::parseSetpoint(payload, setpoint)) {
+        LOG_W(TAG, "Ignoring setpoint '%s' (must be %.0f-%.0f C)", payload,
+              ConfigManager::MIN_SETPOINT, ConfigManager::MAX_SETPOINT);
+        return;
+    }
+    Serial.print("Setting temperature setpoint to: ");
+    Serial.println(setpoint);
+
+    // Update PID controller setpoint
+    extern void setTemperatureSetpoint(float);
+    setTemperatureSetpoint(setpoint);
 
-    // Handle mode command (heat/off) from Home Assistant
-    if (strcmp(topic, "esp32_thermostat/mode/set") == 0) {
-        String mode = String(message);
-        Serial.println("=== MQTT MODE RECEIVED ===");
-        Serial.print("  Mode: ");
-        Serial.println(mode);
+    // Saved and echoed back once the slider has settled
+    commandCoalescer.setpoint(setpoint, millis());
+}
+
+// Preset mode from Home Assistant
+void MQTTManager::handlePresetCommand(const char* payload, size_t length) {
+    String preset = String(payload);
+    Serial.println("=== MQTT PRESET RECEIVED ===");
+    Serial.print("  Preset: ");
+    Serial.println(preset);
+
+    // Get the temperature for this preset
+    extern ConfigManager* configManager;
+    if (configManager) {
+        String oldPreset = configManager->getCurrentPreset();
+        float presetTemp = configManager->getPresetTemperature(preset);
+
+        // Update the setpoint to match the preset temperature
+        extern void setTemperatureSetpoint(float);
+        setTemperatureSetpoint(presetTemp);
+
+        // Preset and setpoint are saved and echoed back once input settles
+        commandCoalescer.preset(preset.c_str(), presetTemp, millis());
+
+        Serial.print("  Changed: ");
+        Serial.print(oldPreset);
+        Serial.print(" -> ");
+        Serial.print(preset);
+        Serial.print(" (");
+        Serial.print(presetTemp);
+        Serial.println("°C)");
+        Serial.println("=== PRESET CHANGE COMPLETE ===");
+    } else {
+        Serial.println("  ERROR: ConfigManager not available!");
+    }
+}
 
-        extern ConfigManager* configManager;
-        if (configManager) {
-            bool enabled = (mode == "heat");
-            bool wasEnabled = configManager->getThermostatEnabled();
+// Mode command (heat/off) from Home Assistant
+void MQTTManager::handleModeCommand(const char* payload, size_t length) {
+    Serial.println("=== MQTT MODE RECEIVED ===");
+    Serial.print("  Mode: ");
+    Serial.println(payload);
+
+    extern ConfigManager* configManager;
+    if (configManager) {
+        bool enabled = (strcmp(payload, "heat") == 0);
+        bool wasEnabled = configManager->getThermostatEnabled();
+        // The controller reads the mode from NVS, so it is stored right away
+        if (enabled != wasEnabled) {
             configManager->setThermostatEnabled(enabled);
+        }
 
-            Serial.print("  Changed: ");
-            Serial.print(wasEnabled ? "heat" : "off");
-            Serial.print(" -> ");
-            Serial.println(enabled ? "heat" : "off");
+        Serial.print("  Changed: ");
+        Serial.print(wasEnabled ? "heat" : "off");
+        Serial.print(" -> ");
+        Serial.println(enabled ? "heat" : "off");
 
-            // If disabling, set valve to 0
-            if (!enabled && _knxManager) {
-                _knxManager->setValvePosition(0);
-                Serial.println("  Valve set to 0% (off mode)");
-            }
+        // If disabling, set valve to 0
+        if (!enabled && _knxManager) {
+            _knxManager->setValvePosition(0);
+            Serial.println("  Valve set to 0% (off mode)");
+        }
+
+        // Mode state confirmation goes out with the rest of the burst
+        commandCoalescer.mode(enabled, millis());
+        Serial.println("=== MODE CHANGE COMPLETE ===");
+    } else {
+        Serial.println("  ERROR: ConfigManager not available!");
+    }
+}
 
-            // Publish mode state confirmation
-            if (_homeAssistant) {
-                _homeAssistant->updateMode(mode.c_str());
+// Log level command: "debug" sets the global level,
+// "KNX=debug" one tag's level and "KNX=default" drops that override
+void MQTTManager::handleLogLevelCommand(const char* payload, size_t length) {
+    extern ConfigManager* configManager;
+    extern void applyLoggingConfig();
+    bool applied = false;
+    if (configManager) {
+        const char* separator = strchr(payload, '=');
+        if (separator == nullptr) {
+            int level = ConfigManager::parseLogLevel(payload);
+            if (level >= 0) {
+                configManager->setLogLevel(level);
+                applied = true;
             }
-            Serial.println("=== MODE CHANGE COMPLETE ===");
         } else {
-            Serial.println("  ERROR: ConfigManager not available!");
+            char tag[MQTT_COMMAND_PAYLOAD_MAX + 1];
+            size_t tagLength = separator - payload;
+            memcpy(tag, payload, tagLength);
+            tag[tagLength] = '\0';
+            const char* value = separator + 1;
+            bool clear = strcasecmp(value, "default") == 0;
+            int level = clear ? -1 : ConfigManager::parseLogLevel(value);
+            if (clear || level >= 0) {
+                applied = configManager->setLogTagLevel(tag, level);
+            }
         }
     }
-
-    // Handle system restart command
-    if (strcmp(topic, "esp32_thermostat/restart") == 0) {
-        Serial.println("Restart command received via MQTT");
-        _mqttClient.publish("esp32_thermostat/status", "Restarting...", true);
-        delay(500);
-        ESP.restart();
+    if (applied) {
+        applyLoggingConfig();
+    } else {
+        Serial.println("Invalid log level command (expected LEVEL, TAG=LEVEL or TAG=default)");
     }
 }
 
-bool MQTTManager::isConnected() {
-    return _mqttClient.connected();
+void MQTTManager::handleRestartCommand(const char* payload, size_t length) {
+    Serial.println("Restart command received via MQTT");
+    post(makeJob(JOB_RESTART));
 }
 
-void MQTTManager::reconnect() {
-    if (_mqttClient.connected() || WiFi.status() != WL_CONNECTED) {
-        return;
-    }
-
+// MQTT task: connect and subscribe (blocks this task only, up to the socket timeout)
+bool MQTTManager::reconnect() {
     Serial.println("Attempting MQTT connection...");
     configureServerFromSettings();
 
@@ -379,19 +650,24 @@ void MQTTManager::reconnect() {
     if (!_mqttClient.connect(clientId.c_str(), username, password)) {
         Serial.print("MQTT connection failed, rc=");
         Serial.println(_mqttClient.state());
-        return;
+        return false;
     }
 
     Serial.println("MQTT connected");
 
-    _mqttClient.subscribe(MQTT_TOPIC_VALVE_COMMAND);
-    _mqttClient.subscribe("esp32_thermostat/valve/set");
-    _mqttClient.subscribe("esp32_thermostat/temperature/set");
-    _mqttClient.subscribe("esp32_thermostat/preset/set");
-    _mqttClient.subscribe("esp32_thermostat/mode/set");
-    _mqttClient.subscribe("esp32_thermostat/restart");
+    size_t routeCount;
+    const CommandRoute* routes = commandRoutes(routeCount);
+    for (size_t i = 0; i < routeCount; i++) {
+        _mqttClient.subscribe(routes[i].topic);
+    }
 
     if (_homeAssistant) {
+        // Discovery is republished from the MQTT task only if the broker's copy is missing or stale
+        _homeAssistant->setStateDocumentEnabled(configManager->getMqttStateDocumentEnabled());
+        _homeAssistant->connected(millis());
+
+        // The broker may have lost non-retained state; send everything once more
+        _homeAssistant->resetPublishState();
         _homeAssistant->updateAvailability(true);
 
         int rssi = WiFi.RSSI();
@@ -399,14 +675,86 @@ void MQTTManager::reconnect() {
         _homeAssistant->updateDiagnostics(rssi, uptime);
         _homeAssistant->syncClimateState();
     }
+
+    _online.store(true);
+    return true;
 }
 
-// HA FIX #5: Sync climate state to Home Assistant
-void MQTTManager::syncClimateState() {
-    if (!_mqttClient.connected()) return;
+uint32_t MQTTManager::getStatePublishedCount() const {
+    return _homeAssistant ? _homeAssistant->getPublishedCount() : 0;
+}
 
-    if (_homeAssistant) {
-        _homeAssistant->syncClimateState();
+uint32_t MQTTManager::getStateSkippedCount() const {
+    return _homeAssistant ? _homeAssistant->getSkippedCount() : 0;
+}
+
+uint32_t MQTTManager::getDiscoveryPublishedCount() const {
+    return _homeAssistant ? _homeAssistant->getDiscoveryPublishedCount() : 0;
+}
+
+uint32_t MQTTManager::getDiscoverySkippedCount() const {
+    return _homeAssistant ? _homeAssistant->getDiscoverySkippedCount() : 0;
+}
+
+// Keep a reading taken while the broker is unreachable for publishBackfill()
+void MQTTManager::queueOfflineReading(float temperature, float humidity, float pressure) {
+    time_t now = NTPManager::getInstance().getCurrentTime();
+
+    TelemetryRecord record;
+    record.timestamp = (now > 0) ? (uint32_t)now : (millis() / 1000);
+    record.temperature = temperature;
+    record.humidity = humidity;
+    record.pressure = pressure;
+    record.valvePosition = (uint8_t)_valvePosition.load();
+    _outbox.add(record);
+}
+
+// Replay queued readings oldest first, one small batch per BACKFILL_INTERVAL_MS
+// so a long outage does not turn into a publish storm on reconnect
+void MQTTManager::publishBackfill() {
+    if (_outbox.empty() || millis() - _lastBackfill < BACKFILL_INTERVAL_MS) {
+        return;
+    }
+    _lastBackfill = millis();
+
+    TelemetryRecord records[BACKFILL_BATCH];
+    uint32_t dropped = _outbox.getDroppedCount();
+    size_t count = _outbox.peek(records, BACKFILL_BATCH);
+    if (_outbox.getDroppedCount() != dropped) {
+        LOG_W(TAG, "Dropped %lu spilled backfill records (spill file unreadable)",
+              (unsigned long)(_outbox.getDroppedCount() - dropped));
+    }
+    if (count == 0) {
+        return;
+    }
+
+    char payload[BACKFILL_BATCH * 96];
+    size_t length = MqttOutbox::formatBatch(records, count, payload, sizeof(payload));
+    if (length == 0) {
+        // Send the head record alone; if even that does not format, it would
+        // block the outbox forever, so drop it and carry on next interval
+        count = 1;
+        length = MqttOutbox::formatBatch(records, count, payload, sizeof(payload));
+        if (length == 0) {
+            _outbox.drop(1);
+            LOG_W(TAG, "Dropped unformattable backfill record (ts %lu)",
+                  (unsigned long)records[0].timestamp);
+            return;
+        }
+    }
+
+    bool published = _mqttClient.beginPublish("esp32_thermostat/backfill", length, false) &&
+                     _mqttClient.write(reinterpret_cast<const uint8_t*>(payload), length) == length &&
+                     _mqttClient.endPublish();
+    if (published) {
+        _outbox.pop(count);
+        if (_outbox.empty()) {
+            Serial.print("MQTT backfill complete: ");
+            Serial.print(_outbox.getSentCount());
+            Serial.print(" readings replayed, ");
+            Serial.print(_outbox.getEvictedCount());
+            Serial.println(" evicted");
+        }
     }
 }
 
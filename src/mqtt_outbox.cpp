@@ -0,0 +1,167 @@
+#include "mqtt_outbox.h"
+#include <math.h>
+#include <stdio.h>
+
+MqttOutbox::MqttOutbox()
+    : _ramHead(0),
+      _ramCount(0),
+      _spill(nullptr),
+      _spillHead(0),
+      _spillCount(0),
+      _spillReadFailures(0),
+      _queued(0),
+      _sent(0),
+      _evicted(0),
+      _dropped(0),
+      _spilled(0) {
+}
+
+void MqttOutbox::setSpill(OutboxSpill* spill) {
+    _spill = (spill != nullptr && spill->capacity() >= OUTBOX_SPILL_BATCH) ? spill : nullptr;
+    _spillHead = 0;
+    _spillCount = 0;
+    _spillReadFailures = 0;
+}
+
+void MqttOutbox::add(const TelemetryRecord& record) {
+    if (_ramCount == OUTBOX_RAM_RECORDS) {
+        spillOldest();
+    }
+    if (_ramCount == OUTBOX_RAM_RECORDS) {
+        // No spill store, or it failed: drop the oldest reading
+        _ramHead = (_ramHead + 1) % OUTBOX_RAM_RECORDS;
+        _ramCount--;
+        _evicted++;
+    }
+    _ram[(_ramHead + _ramCount) % OUTBOX_RAM_RECORDS] = record;
+    _ramCount++;
+    _queued++;
+}
+
+void MqttOutbox::spillOldest() {
+    if (_spill == nullptr) {
+        return;
+    }
+
+    // Make room in the spill store by evicting its oldest records
+    uint32_t capacity = _spill->capacity();
+    if (_spillCount + OUTBOX_SPILL_BATCH > capacity) {
+        uint32_t excess = _spillCount + OUTBOX_SPILL_BATCH - capacity;
+        _spillHead = (_spillHead + excess) % capacity;
+        _spillCount -= excess;
+        _evicted += excess;
+    }
+
+    TelemetryRecord batch[OUTBOX_SPILL_BATCH];
+    for (size_t i = 0; i < OUTBOX_SPILL_BATCH; i++) {
+        batch[i] = _ram[(_ramHead + i) % OUTBOX_RAM_RECORDS];
+    }
+    if (!writeSpill(batch, OUTBOX_SPILL_BATCH)) {
+        return;
+    }
+
+    _spillCount += OUTBOX_SPILL_BATCH;
+    _spilled += OUTBOX_SPILL_BATCH;
+    _ramHead = (_ramHead + OUTBOX_SPILL_BATCH) % OUTBOX_RAM_RECORDS;
+    _ramCount -= OUTBOX_SPILL_BATCH;
+}
+
+bool MqttOutbox::writeSpill(const TelemetryRecord* records, size_t count) {
+    uint32_t capacity = _spill->capacity();
+    uint32_t tail = (_spillHead + _spillCount) % capacity;
+    size_t first = capacity - tail;
+    if (first > count) {
+        first = count;
+    }
+    if (!_spill->write(tail, records, first)) {
+        return false;
+    }
+    return first == count || _spill->write(0, records + first, count - first);
+}
+
+size_t MqttOutbox::peek(TelemetryRecord* out, size_t max) {
+    if (_spillCount > 0) {
+        // Oldest records are in the spill store; stop at its wrap point
+        uint32_t capacity = _spill->capacity();
+        size_t count = _spillCount < max ? _spillCount : max;
+        if (count > capacity - _spillHead) {
+            count = capacity - _spillHead;
+        }
+        if (_spill->read(_spillHead, out, count)) {
+            _spillReadFailures = 0;
+            return count;
+        }
+        if (++_spillReadFailures < OUTBOX_SPILL_READ_RETRIES) {
+            return 0;
+        }
+
+        // The spill store stays unreadable: give up on it so RAM records can drain
+        _dropped += _spillCount;
+        _spillHead = 0;
+        _spillCount = 0;
+        _spillReadFailures = 0;
+    }
+
+    size_t count = _ramCount < max ? _ramCount : max;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = _ram[(_ramHead + i) % OUTBOX_RAM_RECORDS];
+    }
+    return count;
+}
+
+void MqttOutbox::pop(size_t count) {
+    _sent += removeOldest(count);
+}
+
+void MqttOutbox::drop(size_t count) {
+    _dropped += removeOldest(count);
+}
+
+size_t MqttOutbox::removeOldest(size_t count) {
+    if (_spillCount > 0) {
+        if (count > _spillCount) {
+            count = _spillCount;
+        }
+        _spillHead = (_spillHead + count) % _spill->capacity();
+        _spillCount -= count;
+    } else {
+        if (count > _ramCount) {
+            count = _ramCount;
+        }
+        _ramHead = (_ramHead + count) % OUTBOX_RAM_RECORDS;
+        _ramCount -= count;
+    }
+    return count;
+}
+
+// Append a reading with two decimals, or null (JSON has no NaN or infinity)
+static int formatReading(char* out, size_t size, float value) {
+    return isfinite(value) ? snprintf(out, size, "%.2f", value) : snprintf(out, size, "null");
+}
+
+size_t MqttOutbox::formatBatch(const TelemetryRecord* records, size_t count, char* out, size_t size) {
+    size_t length = 0;
+    int n;
+
+#define APPEND(call)                                        \
+    n = (call);                                             \
+    if (n < 0 || (size_t)n >= size - length) return 0;      \
+    length += n;
+
+    APPEND(snprintf(out, size, "["));
+    for (size_t i = 0; i < count; i++) {
+        const TelemetryRecord& record = records[i];
+        APPEND(snprintf(out + length, size - length, "%s{\"ts\":%lu,\"temperature\":",
+                        i > 0 ? "," : "", (unsigned long)record.timestamp));
+        APPEND(formatReading(out + length, size - length, record.temperature));
+        APPEND(snprintf(out + length, size - length, ",\"humidity\":"));
+        APPEND(formatReading(out + length, size - length, record.humidity));
+        APPEND(snprintf(out + length, size - length, ",\"pressure\":"));
+        APPEND(formatReading(out + length, size - length, record.pressure));
+        APPEND(snprintf(out + length, size - length, ",\"valve\":%u}", (unsigned)record.valvePosition));
+    }
+    APPEND(snprintf(out + length, size - length, "]"));
+
+#undef APPEND
+    return length;
+}
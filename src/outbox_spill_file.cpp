@@ -0,0 +1,42 @@
+#include "outbox_spill_file.h"
+#include <LittleFS.h>
+
+static const char* SPILL_FILE = "/mqtt_outbox.bin";
+
+bool OutboxSpillFile::begin() {
+    // Returns true if already mounted (by the web server or EventLog)
+    if (!LittleFS.begin(false, "/littlefs", 5, "spiffs")) {
+        return false;
+    }
+    File file = LittleFS.open(SPILL_FILE, "w");
+    if (!file) {
+        return false;
+    }
+    file.close();
+    return true;
+}
+
+bool OutboxSpillFile::write(uint32_t slot, const TelemetryRecord* records, size_t count) {
+    // Slots are filled in order from 0, so a write never starts past the end of the file
+    File file = LittleFS.open(SPILL_FILE, "r+");
+    if (!file) {
+        return false;
+    }
+    size_t length = count * sizeof(TelemetryRecord);
+    bool ok = file.seek(slot * sizeof(TelemetryRecord)) &&
+              file.write(reinterpret_cast<const uint8_t*>(records), length) == length;
+    file.close();
+    return ok;
+}
+
+bool OutboxSpillFile::read(uint32_t slot, TelemetryRecord* records, size_t count) {
+    File file = LittleFS.open(SPILL_FILE, "r");
+    if (!file) {
+        return false;
+    }
+    size_t length = count * sizeof(TelemetryRecord);
+    bool ok = file.seek(slot * sizeof(TelemetryRecord)) &&
+              file.read(reinterpret_cast<uint8_t*>(records), length) == length;
+    file.close();
+    return ok;
+}
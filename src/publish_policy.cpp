@@ -0,0 +1,122 @@
+#include "publish_policy.h"
+#include <math.h>
+#include <string.h>
+
+PublishPolicy::PublishPolicy(const TopicPolicy* policies, uint8_t count)
+    : _policies(policies),
+      _count(count > PUBLISH_POLICY_MAX_TOPICS ? PUBLISH_POLICY_MAX_TOPICS : count),
+      _published(0),
+      _skipped(0) {
+    invalidate();
+}
+
+void PublishPolicy::invalidate() {
+    memset(_states, 0, sizeof(_states));
+}
+
+uint32_t PublishPolicy::hashText(const char* text) {
+    uint32_t hash = 2166136261u;
+    while (*text != '\0') {
+        hash ^= (uint8_t)*text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool PublishPolicy::outsideDeadband(const TopicPolicy& policy, float last, float value) const {
+    if (isnan(last) || isnan(value)) {
+        return isnan(last) != isnan(value);
+    }
+    float delta = fabsf(value - last);
+    float threshold = policy.absDeadband;
+    float relative = policy.relDeadband * fabsf(last);
+    if (relative > threshold) {
+        threshold = relative;
+    }
+    return threshold > 0.0f ? delta >= threshold : delta > 0.0f;
+}
+
+bool PublishPolicy::decide(uint8_t topicId, bool changed, uint32_t now) {
+    const TopicPolicy& policy = _policies[topicId];
+    const TopicState& state = _states[topicId];
+    uint32_t elapsed = now - state.publishedAt;
+
+    if (changed && elapsed >= policy.minIntervalMs) {
+        return true;
+    }
+    if (policy.heartbeatMs > 0 && elapsed >= policy.heartbeatMs) {
+        return true;
+    }
+    _skipped++;
+    return false;
+}
+
+bool PublishPolicy::due(uint8_t topicId, float value, uint32_t now) {
+    if (topicId >= _count || !_states[topicId].valid) {
+        return true;
+    }
+    return decide(topicId, outsideDeadband(_policies[topicId], _states[topicId].last.value, value), now);
+}
+
+bool PublishPolicy::due(uint8_t topicId, const char* text, uint32_t now) {
+    if (topicId >= _count || !_states[topicId].valid) {
+        return true;
+    }
+    return decide(topicId, hashText(text) != _states[topicId].last.hash, now);
+}
+
+bool PublishPolicy::changed(uint8_t topicId, float value) const {
+    if (topicId >= _count || !_states[topicId].valid) {
+        return true;
+    }
+    return outsideDeadband(_policies[topicId], _states[topicId].last.value, value);
+}
+
+bool PublishPolicy::changed(uint8_t topicId, const char* text) const {
+    if (topicId >= _count || !_states[topicId].valid) {
+        return true;
+    }
+    return hashText(text) != _states[topicId].last.hash;
+}
+
+bool PublishPolicy::dueOnChange(uint8_t topicId, bool changed, uint32_t now) {
+    if (topicId >= _count || !_states[topicId].valid) {
+        return true;
+    }
+    return decide(topicId, changed, now);
+}
+
+void PublishPolicy::record(uint8_t topicId, uint32_t now) {
+    _states[topicId].publishedAt = now;
+    _states[topicId].valid = true;
+}
+
+void PublishPolicy::published(uint8_t topicId, float value, uint32_t now) {
+    _published++;
+    if (topicId < _count) {
+        _states[topicId].last.value = value;
+        record(topicId, now);
+    }
+}
+
+void PublishPolicy::published(uint8_t topicId, const char* text, uint32_t now) {
+    _published++;
+    if (topicId < _count) {
+        _states[topicId].last.hash = hashText(text);
+        record(topicId, now);
+    }
+}
+
+void PublishPolicy::carried(uint8_t topicId, float value, uint32_t now) {
+    if (topicId < _count) {
+        _states[topicId].last.value = value;
+        record(topicId, now);
+    }
+}
+
+void PublishPolicy::carried(uint8_t topicId, const char* text, uint32_t now) {
+    if (topicId < _count) {
+        _states[topicId].last.hash = hashText(text);
+        record(topicId, now);
+    }
+}
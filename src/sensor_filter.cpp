@@ -0,0 +1,168 @@
+#include "sensor_filter.h"
+#include "logger.h"
+#include <math.h>
+
+static const char* TAG = "FILTER";
+
+SensorFilterPipeline::SensorFilterPipeline() {
+    _config.medianWindow = 3;
+    _config.smoothing = SMOOTHING_EMA;
+    _config.emaAlpha = 0.5f;
+    _config.kalmanProcessNoise = 0.001f;
+    _config.kalmanMeasurementNoise = 0.01f;
+    _config.outlierThreshold = 2.0f;
+    reset();
+}
+
+void SensorFilterPipeline::configure(const SensorFilterConfig& config) {
+    SensorFilterConfig next = config;
+
+    // Only odd windows have a well-defined middle element
+    if (next.medianWindow >= 5) {
+        next.medianWindow = 5;
+    } else if (next.medianWindow >= 3) {
+        next.medianWindow = 3;
+    } else {
+        next.medianWindow = 1;
+    }
+    if (next.smoothing > SMOOTHING_KALMAN) {
+        next.smoothing = SMOOTHING_NONE;
+    }
+    if (!(next.emaAlpha > 0.0f) || next.emaAlpha > 1.0f) {
+        next.emaAlpha = 1.0f;
+    }
+    if (!(next.kalmanProcessNoise > 0.0f)) {
+        next.kalmanProcessNoise = 0.001f;
+    }
+    if (!(next.kalmanMeasurementNoise > 0.0f)) {
+        next.kalmanMeasurementNoise = 0.01f;
+    }
+    if (!(next.outlierThreshold >= 0.0f)) {
+        next.outlierThreshold = 0.0f;
+    }
+
+    bool restartMedian = next.medianWindow != _config.medianWindow;
+    bool restartSmoothing = next.smoothing != _config.smoothing;
+    _config = next;
+
+    if (_seeded && (restartMedian || restartSmoothing)) {
+        seed(_output);
+    }
+
+    LOG_I(TAG, "Filter configured: median=%u, smoothing=%u, alpha=%.2f, Q=%.4f, R=%.4f, gate=%.1f",
+          _config.medianWindow, _config.smoothing, _config.emaAlpha,
+          _config.kalmanProcessNoise, _config.kalmanMeasurementNoise, _config.outlierThreshold);
+}
+
+bool SensorFilterPipeline::process(float raw, float reference, float& filtered) {
+    _stats.samples++;
+
+    // Stage 1: outlier gate against the last known good value
+    if (_config.outlierThreshold > 0.0f && !isnan(reference) &&
+        fabsf(raw - reference) > _config.outlierThreshold) {
+        if (_consecutiveRejects < MAX_CONSECUTIVE_REJECTS) {
+            _consecutiveRejects++;
+            _stats.outliersRejected++;
+            _stats.lastRejected = raw;
+            LOG_D(TAG, "Outlier rejected: %.2f (reference %.2f, gate %.1f)",
+                  raw, reference, _config.outlierThreshold);
+            return false;
+        }
+
+        // The new level persisted - treat it as a genuine step change
+        LOG_I(TAG, "Step change accepted after %u rejections: %.2f -> %.2f",
+              _consecutiveRejects, reference, raw);
+        _stats.gateResyncs++;
+        _consecutiveRejects = 0;
+        seed(raw);
+        filtered = _output;
+        return true;
+    }
+    _consecutiveRejects = 0;
+
+    if (!_seeded) {
+        seed(raw);
+        filtered = _output;
+        return true;
+    }
+
+    // Stage 2 and 3: median spike rejection followed by smoothing
+    _output = smooth(median(raw));
+    filtered = _output;
+    return true;
+}
+
+void SensorFilterPipeline::reset() {
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.lastRejected = NAN;
+    for (uint8_t i = 0; i < MAX_MEDIAN_WINDOW; i++) {
+        _window[i] = 0.0f;
+    }
+    _windowIndex = 0;
+    _windowCount = 0;
+    _output = NAN;
+    _kalmanP = 0.0f;
+    _seeded = false;
+    _consecutiveRejects = 0;
+}
+
+void SensorFilterPipeline::seed(float value) {
+    for (uint8_t i = 0; i < MAX_MEDIAN_WINDOW; i++) {
+        _window[i] = value;
+    }
+    _windowIndex = 0;
+    _windowCount = _config.medianWindow;
+    _output = value;
+    _kalmanP = _config.kalmanMeasurementNoise;
+    _seeded = true;
+}
+
+float SensorFilterPipeline::median(float raw) {
+    uint8_t size = _config.medianWindow;
+    if (size <= 1) {
+        return raw;
+    }
+
+    _window[_windowIndex] = raw;
+    _windowIndex = (_windowIndex + 1) % size;
+    if (_windowCount < size) {
+        _windowCount++;
+    }
+
+    // Insertion sort on a copy - at most 5 elements
+    float sorted[MAX_MEDIAN_WINDOW];
+    for (uint8_t i = 0; i < _windowCount; i++) {
+        float v = _window[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = v;
+    }
+    float result = sorted[_windowCount / 2];
+
+    if (fabsf(result - raw) > SPIKE_REPORT_DELTA) {
+        _stats.spikesSuppressed++;
+    }
+    return result;
+}
+
+float SensorFilterPipeline::smooth(float value) {
+    switch (_config.smoothing) {
+        case SMOOTHING_EMA:
+            return _output + _config.emaAlpha * (value - _output);
+
+        case SMOOTHING_KALMAN: {
+            // Random-walk model: predict, then correct with the new measurement
+            _kalmanP += _config.kalmanProcessNoise;
+            float gain = _kalmanP / (_kalmanP + _config.kalmanMeasurementNoise);
+            _kalmanP *= (1.0f - gain);
+            return _output + gain * (value - _output);
+        }
+
+        case SMOOTHING_NONE:
+        default:
+            return value;
+    }
+}
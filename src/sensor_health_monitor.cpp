@@ -14,11 +14,10 @@ SensorHealthMonitor::SensorHealthMonitor()
       _lastGoodValue(NAN),
       _historyIndex(0),
       _historyCount(0),
+      _windowFailures(0),
       _wasUnhealthy(false) {
-    // Initialize history buffer
-    for (int i = 0; i < SENSOR_HISTORY_SIZE; i++) {
-        _readingHistory[i] = true; // Start optimistic
-    }
+    // Start optimistic: no failures in the window
+    memset(_failureBits, 0, sizeof(_failureBits));
 }
 
 SensorHealthMonitor* SensorHealthMonitor::getInstance() {
@@ -35,8 +34,18 @@ void SensorHealthMonitor::begin() {
 void SensorHealthMonitor::recordReading(bool isValid, float value) {
     _totalReadings++;
 
-    // Update circular buffer for failure rate
-    _readingHistory[_historyIndex] = isValid;
+    // Update circular bitset and the running failure count
+    uint32_t& word = _failureBits[_historyIndex >> 5];
+    uint32_t mask = 1UL << (_historyIndex & 31);
+    if (word & mask) {
+        _windowFailures--; // Evicting an old failure
+    }
+    if (isValid) {
+        word &= ~mask;
+    } else {
+        word |= mask;
+        _windowFailures++;
+    }
     _historyIndex = (_historyIndex + 1) % SENSOR_HISTORY_SIZE;
     if (_historyCount < SENSOR_HISTORY_SIZE) {
         _historyCount++;
@@ -90,14 +99,7 @@ float SensorHealthMonitor::getFailureRate() const {
         return 0.0f;
     }
 
-    int failureCount = 0;
-    for (int i = 0; i < _historyCount; i++) {
-        if (!_readingHistory[i]) {
-            failureCount++;
-        }
-    }
-
-    return (failureCount * 100.0f) / _historyCount;
+    return (_windowFailures * 100.0f) / _historyCount;
 }
 
 uint32_t SensorHealthMonitor::getTotalReadings() const {
@@ -133,10 +135,9 @@ void SensorHealthMonitor::reset() {
     _lastGoodValue = NAN;
     _historyIndex = 0;
     _historyCount = 0;
+    _windowFailures = 0;
     _wasUnhealthy = false;
 
-    // Reset history buffer to all successful
-    for (int i = 0; i < SENSOR_HISTORY_SIZE; i++) {
-        _readingHistory[i] = true;
-    }
+    // Reset history bitset to all successful
+    memset(_failureBits, 0, sizeof(_failureBits));
 }
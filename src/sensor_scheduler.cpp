@@ -0,0 +1,174 @@
+#include "sensor_scheduler.h"
+#include "logger.h"
+
+static const char* TAG = "SENSORS";
+
+SensorScheduler::SensorScheduler()
+    : _count(0),
+      _nextSlot(0),
+      _cycleActive(false),
+      _cycleReady(false),
+      _cycleStart(0),
+      _lastCycleDuration(0) {
+}
+
+int SensorScheduler::addSensor(SensorDriver* driver, SensorRole role) {
+    if (driver == nullptr || _count >= MAX_SENSORS) {
+        return -1;
+    }
+    Slot& slot = _slots[_count];
+    slot.driver = driver;
+    slot.role = role;
+    slot.state = SLOT_IDLE;
+    slot.present = false;
+    slot.conversionStart = 0;
+    slot.errors = 0;
+    slot.sample = SensorSample();
+    return _count++;
+}
+
+uint8_t SensorScheduler::begin() {
+    uint8_t found = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        _slots[i].present = _slots[i].driver->begin();
+        if (_slots[i].present) {
+            found++;
+            LOG_I(TAG, "%s sensor ready (slot %u)", _slots[i].driver->getName(), i);
+        } else {
+            LOG_W(TAG, "%s sensor not found (slot %u)", _slots[i].driver->getName(), i);
+        }
+    }
+    return found;
+}
+
+bool SensorScheduler::requestCycle(unsigned long now) {
+    if (_cycleActive) {
+        return false;
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+        _slots[i].state = _slots[i].present ? SLOT_PENDING : SLOT_DONE;
+    }
+    _cycleActive = true;
+    _cycleReady = false;
+    _cycleStart = now;
+    return true;
+}
+
+void SensorScheduler::loop(unsigned long now) {
+    if (!_cycleActive) {
+        return;
+    }
+
+    // One transaction per bus per call keeps the worst-case loop latency bounded
+    bool busUsed[SENSOR_BUS_COUNT] = {false};
+
+    for (uint8_t n = 0; n < _count; n++) {
+        uint8_t i = (_nextSlot + n) % _count;
+        Slot& slot = _slots[i];
+        SensorBus bus = slot.driver->getBus();
+
+        switch (slot.state) {
+            case SLOT_PENDING:
+                if (busUsed[bus]) {
+                    break;
+                }
+                busUsed[bus] = true;
+                if (slot.driver->startConversion()) {
+                    slot.state = SLOT_CONVERTING;
+                    slot.conversionStart = now;
+                } else {
+                    finishSlot(slot, false, now);
+                }
+                break;
+
+            case SLOT_CONVERTING: {
+                unsigned long elapsed = now - slot.conversionStart;
+                if (elapsed > slot.driver->getConversionTimeMs() + CONVERSION_TIMEOUT_MARGIN_MS) {
+                    LOG_W(TAG, "%s conversion timed out after %lu ms", slot.driver->getName(), elapsed);
+                    finishSlot(slot, false, now);
+                    break;
+                }
+                if (busUsed[bus] || !slot.driver->isReady(elapsed)) {
+                    break;
+                }
+                busUsed[bus] = true;
+                SensorSample sample;
+                bool success = slot.driver->readSample(sample);
+                if (success) {
+                    slot.sample = sample;
+                }
+                finishSlot(slot, success, now);
+                break;
+            }
+
+            case SLOT_IDLE:
+            case SLOT_DONE:
+            default:
+                break;
+        }
+    }
+
+    // Rotate so that no sensor permanently wins the bus
+    if (_count > 0) {
+        _nextSlot = (_nextSlot + 1) % _count;
+    }
+
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_slots[i].state == SLOT_PENDING || _slots[i].state == SLOT_CONVERTING) {
+            return;
+        }
+    }
+    _cycleActive = false;
+    _cycleReady = true;
+    _lastCycleDuration = now - _cycleStart;
+}
+
+bool SensorScheduler::consumeCycle() {
+    if (!_cycleReady) {
+        return false;
+    }
+    _cycleReady = false;
+    return true;
+}
+
+int SensorScheduler::findByRole(SensorRole role) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_slots[i].role == role) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const SensorSample& SensorScheduler::getSample(uint8_t index) const {
+    static const SensorSample empty;
+    return index < _count ? _slots[index].sample : empty;
+}
+
+SensorDriver* SensorScheduler::getDriver(uint8_t index) const {
+    return index < _count ? _slots[index].driver : nullptr;
+}
+
+SensorRole SensorScheduler::getRole(uint8_t index) const {
+    return index < _count ? _slots[index].role : SENSOR_ROLE_AUXILIARY;
+}
+
+bool SensorScheduler::isPresent(uint8_t index) const {
+    return index < _count && _slots[index].present;
+}
+
+uint32_t SensorScheduler::getErrorCount(uint8_t index) const {
+    return index < _count ? _slots[index].errors : 0;
+}
+
+void SensorScheduler::finishSlot(Slot& slot, bool success, unsigned long now) {
+    slot.state = SLOT_DONE;
+    if (success) {
+        slot.sample.timestamp = now;
+        slot.sample.valid = true;
+    } else {
+        slot.errors++;
+        slot.sample.valid = false;
+        LOG_D(TAG, "%s read failed (errors: %lu)", slot.driver->getName(), (unsigned long)slot.errors);
+    }
+}
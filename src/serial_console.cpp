@@ -0,0 +1,151 @@
+#include "serial_console.h"
+#include <stdarg.h>
+#include <string.h>
+
+SerialConsole::SerialConsole()
+    : _out(nullptr),
+      _commandCount(0),
+      _lineLength(0),
+      _lastWasCR(false),
+      _pendingReady(false) {
+    addCommand("help", "List commands", printHelp);
+}
+
+bool SerialConsole::addCommand(const char* name, const char* help, Handler handler) {
+    if (_commandCount >= SERIAL_CONSOLE_MAX_COMMANDS || handler == nullptr) {
+        return false;
+    }
+    for (uint8_t i = 0; i < _commandCount; i++) {
+        if (strcmp(_commands[i].name, name) == 0) {
+            return false;
+        }
+    }
+    _commands[_commandCount].name = name;
+    _commands[_commandCount].help = help;
+    _commands[_commandCount].handler = handler;
+    _commandCount++;
+    return true;
+}
+
+void SerialConsole::poll(Stream& in) {
+    // Only what is already buffered; available() never waits
+    while (in.available() > 0) {
+        int c = in.read();
+        if (c < 0) {
+            break;
+        }
+
+        if (c == '\r' || c == '\n') {
+            // CR/LF, LF/CR or a lone terminator all end exactly one line
+            bool pair = _lastWasCR && c == '\n';
+            _lastWasCR = c == '\r';
+            if (pair) {
+                continue;
+            }
+            in.print("\r\n");
+            _line[_lineLength] = '\0';
+            _lineLength = 0;
+            execute(_line);
+            continue;
+        }
+        _lastWasCR = false;
+
+        if (c == '\b' || c == 0x7F) {
+            if (_lineLength > 0) {
+                _lineLength--;
+                in.print("\b \b");
+            }
+        } else if (c >= ' ' && c < 0x7F && _lineLength < SERIAL_CONSOLE_LINE_SIZE - 1) {
+            _line[_lineLength++] = (char)c;
+            in.write((uint8_t)c);
+        }
+        // Other control characters and overlong input are dropped
+    }
+}
+
+bool SerialConsole::submit(const char* line, size_t len) {
+    if (_pendingReady.load(std::memory_order_acquire)) {
+        return false;
+    }
+    // Web input may end in a newline; the rest of the line must fit
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        len--;
+    }
+    if (len >= SERIAL_CONSOLE_LINE_SIZE) {
+        len = SERIAL_CONSOLE_LINE_SIZE - 1;
+    }
+    memcpy(_pending, line, len);
+    _pending[len] = '\0';
+    _pendingReady.store(true, std::memory_order_release);
+    return true;
+}
+
+void SerialConsole::loop() {
+    if (!_pendingReady.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (_out) {
+        printf(*_out, "> %s\n", _pending);
+    }
+    execute(_pending);
+    _pendingReady.store(false, std::memory_order_release);
+}
+
+bool SerialConsole::execute(char* line) {
+    char* argv[SERIAL_CONSOLE_MAX_ARGS];
+    int argc = 0;
+
+    // Split on spaces in place; extra words are ignored
+    char* p = line;
+    while (*p && argc < SERIAL_CONSOLE_MAX_ARGS) {
+        while (*p == ' ' || *p == '\t') {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        argv[argc++] = p;
+        while (*p && *p != ' ' && *p != '\t') {
+            p++;
+        }
+    }
+    if (argc > 0 && *p) {
+        *p = '\0';
+    }
+    if (argc == 0) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < _commandCount; i++) {
+        if (strcasecmp(_commands[i].name, argv[0]) == 0) {
+            if (_out) {
+                _commands[i].handler(argc, argv, *_out);
+            }
+            return true;
+        }
+    }
+    if (_out) {
+        printf(*_out, "Unknown command '%s' - type help\n", argv[0]);
+    }
+    return false;
+}
+
+void SerialConsole::printf(Print& out, const char* format, ...) {
+    char buffer[160];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len > 0) {
+        out.write((const uint8_t*)buffer, (size_t)len < sizeof(buffer) ? (size_t)len : sizeof(buffer) - 1);
+    }
+}
+
+void SerialConsole::printHelp(int argc, char** argv, Print& out) {
+    (void)argc;
+    (void)argv;
+    SerialConsole& console = getInstance();
+    for (uint8_t i = 0; i < console._commandCount; i++) {
+        printf(out, "  %-10s %s\n", console._commands[i].name, console._commands[i].help);
+    }
+}
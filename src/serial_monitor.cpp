@@ -4,6 +4,7 @@
 // Step 2: Include our headers
 #include "serial_monitor.h"
 #include "serial_redirect.h"
+#include "serial_console.h"
 #include <esp_log.h>
 
 // Now use the saved pointer from SerialCapture namespace
@@ -36,6 +37,18 @@ static int custom_vprintf(const char *fmt, va_list args) {
     return len;
 }
 
+SerialMonitor::SerialMonitor()
+    : _server(nullptr),
+      _ws(nullptr),
+      _head(0),
+      _sent(0),
+      _lastFlush(0),
+      _lastCleanup(0) {
+    portMUX_INITIALIZE(&_lock);
+    _line.length = 0;
+    memset(_clients, 0, sizeof(_clients));
+}
+
 void SerialMonitor::begin(AsyncWebServer* server) {
     _server = server;
 
@@ -59,67 +72,211 @@ void SerialMonitor::begin(AsyncWebServer* server) {
     _realSerial->println("[SERIAL_MON] Web serial monitor initialized");
 }
 
-void SerialMonitor::println(const String& line) {
-    // ALWAYS add to buffer (even if _ws doesn't exist yet)
-    _buffer.push_back(line);
-    if (_buffer.size() > MAX_BUFFER_SIZE) {
-        _buffer.erase(_buffer.begin());
+void SerialMonitor::println(const char* line, size_t len) {
+    if (len > SERIAL_MONITOR_LINE_SIZE) {
+        len = SERIAL_MONITOR_LINE_SIZE;
     }
 
-    // Only broadcast if WebSocket exists AND has clients
-    if (_ws && _ws->count() > 0) {
-        _ws->textAll(line);
-    }
+    // ALWAYS add to buffer (even if _ws doesn't exist yet)
+    portENTER_CRITICAL(&_lock);
+    store(line, len);
+    portEXIT_CRITICAL(&_lock);
     // NO debug output here - causes log spam
 }
 
+void SerialMonitor::store(const char* line, size_t len) {
+    // The line and its newline go in together so _head stays on a line boundary
+    size_t offset = _head & (SERIAL_MONITOR_BUFFER_SIZE - 1);
+    size_t first = SERIAL_MONITOR_BUFFER_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(_ring + offset, line, first);
+    memcpy(_ring, line + first, len - first);
+    _ring[(_head + len) & (SERIAL_MONITOR_BUFFER_SIZE - 1)] = '\n';
+    _head += len + 1;
+}
+
 void SerialMonitor::write(const char* data, size_t len) {
-    // Process character by character for line buffering
+    capture(_line, data, len);
+}
+
+void SerialMonitor::capture(LineBuffer& line, const char* data, size_t len) {
+    // Writers on different tasks share the line, so assemble it under the lock
+    portENTER_CRITICAL(&_lock);
     for (size_t i = 0; i < len; i++) {
-        processChar(data[i]);
+        char c = data[i];
+        if (c == '\n') {
+            // Line complete, queue for clients
+            if (line.length > 0) {
+                store(line.data, line.length);
+            }
+            line.length = 0;
+        } else if (c != '\r') {  // Ignore carriage returns
+            // Split an over-long line before it can overflow
+            if (line.length >= sizeof(line.data) - 1) {
+                store(line.data, line.length);
+                line.length = 0;
+            }
+            line.data[line.length++] = c;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+}
+
+size_t SerialMonitor::read(uint32_t& pos, uint32_t end, uint8_t* out, size_t size, uint32_t& skipped) {
+    size_t count = 0;
+    portENTER_CRITICAL(&_lock);
+    uint32_t oldest = _head > SERIAL_MONITOR_BUFFER_SIZE ? _head - SERIAL_MONITOR_BUFFER_SIZE : 0;
+    if ((int32_t)(pos - oldest) < 0) {
+        // Overwritten: resume at the first complete line still held
+        skipped += oldest - pos;
+        pos = oldest;
+        while (pos != _head && _ring[pos & (SERIAL_MONITOR_BUFFER_SIZE - 1)] != '\n') {
+            pos++;
+            skipped++;
+        }
+        if (pos != _head) {
+            pos++;
+            skipped++;
+        }
+    }
+    if ((int32_t)(end - pos) > 0) {
+        count = end - pos < size ? end - pos : size;
+        size_t offset = pos & (SERIAL_MONITOR_BUFFER_SIZE - 1);
+        size_t first = SERIAL_MONITOR_BUFFER_SIZE - offset;
+        if (first > count) {
+            first = count;
+        }
+        memcpy(out, _ring + offset, first);
+        memcpy(out + first, _ring, count - first);
+        pos += count;
+    }
+    portEXIT_CRITICAL(&_lock);
+    return count;
+}
+
+void SerialMonitor::loop() {
+    unsigned long now = millis();
+    if (now - _lastFlush >= SERIAL_MONITOR_FLUSH_MS) {
+        _lastFlush = now;
+        flush();
+    }
+
+    // Clean up disconnected WebSocket clients
+    if (_ws && now - _lastCleanup >= 1000) {
+        _lastCleanup = now;
+        _ws->cleanupClients();
     }
 }
 
-void SerialMonitor::processChar(char c) {
-    if (c == '\n') {
-        // Line complete, send to clients
-        if (_lineBuffer.length() > 0) {
-            println(_lineBuffer);
-            _lineBuffer = "";
+void SerialMonitor::flush() {
+    portENTER_CRITICAL(&_lock);
+    uint32_t end = _head;
+    portEXIT_CRITICAL(&_lock);
+
+    uint32_t pending = end - _sent;
+    if (pending == 0) {
+        return;
+    }
+
+    // Nobody listening: just move the cursor
+    if (!_ws || _ws->count() == 0) {
+        _sent = end;
+        return;
+    }
+
+    // One frame for everyone; the shared buffer is freed once the last client has sent it
+    AsyncWebSocketSharedBuffer frame = std::make_shared<std::vector<uint8_t>>(
+        pending < SERIAL_MONITOR_BUFFER_SIZE ? pending : SERIAL_MONITOR_BUFFER_SIZE);
+    uint32_t pos = _sent;
+    uint32_t overrun = 0;
+    frame->resize(read(pos, end, frame->data(), frame->size(), overrun));
+    _sent = pos;
+    if (overrun > 0) {
+        char note[64];
+        int len = snprintf(note, sizeof(note), "[serial monitor: %lu bytes lost]\n", (unsigned long)overrun);
+        frame->insert(frame->begin(), note, note + len);
+    }
+    if (frame->empty()) {
+        return;
+    }
+
+    for (AsyncWebSocketClient& client : _ws->getClients()) {
+        if (client.status() != WS_CONNECTED) {
+            continue;
         }
-    } else if (c != '\r') {  // Ignore carriage returns
-        _lineBuffer += c;
 
-        // Prevent buffer overflow
-        if (_lineBuffer.length() > MAX_LINE_LENGTH) {
-            println(_lineBuffer);
-            _lineBuffer = "";
+        // Slow client: skip this frame rather than queue behind it
+        ClientState* state = findClient(client.id());
+        if (client.queueIsFull()) {
+            if (state) {
+                state->skipped += frame->size();
+            }
+            continue;
+        }
+        if (state && state->skipped > 0) {
+            char note[64];
+            snprintf(note, sizeof(note), "[serial monitor: %lu bytes skipped, connection too slow]",
+                     (unsigned long)state->skipped);
+            client.text(note);
+            state->skipped = 0;
         }
+        client.text(frame);
     }
 }
 
+SerialMonitor::ClientState* SerialMonitor::findClient(uint32_t id) {
+    for (size_t i = 0; i < SERIAL_MONITOR_MAX_CLIENTS; i++) {
+        if (_clients[i].id == id) {
+            return &_clients[i];
+        }
+    }
+    return nullptr;
+}
+
 void SerialMonitor::onWebSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
                                      AwsEventType type, void* arg, uint8_t* data, size_t len) {
     switch (type) {
-        case WS_EVT_CONNECT:
+        case WS_EVT_CONNECT: {
             _realSerial->printf("[SERIAL_MON] Client #%u connected from %s\n",
                          client->id(), client->remoteIP().toString().c_str());
 
+            // Drop frames for this client when it falls behind instead of closing it
+            client->setCloseClientOnQueueFull(false);
+            ClientState* state = findClient(0);
+            if (state) {
+                state->id = client->id();
+                state->skipped = 0;
+            }
+
             sendBufferToClient(client);  // Send welcome + buffer history
             break;
+        }
 
-        case WS_EVT_DISCONNECT:
+        case WS_EVT_DISCONNECT: {
             _realSerial->printf("[SERIAL_MON] Client #%u disconnected\n", client->id());
-            // No need to remove from _clients
+            ClientState* state = findClient(client->id());
+            if (state) {
+                state->id = 0;
+            }
             break;
+        }
 
         case WS_EVT_ERROR:
             _realSerial->printf("[SERIAL_MON] WebSocket error from client #%u\n", client->id());
             break;
 
-        case WS_EVT_DATA:
-            // Optional: Handle commands from client
+        case WS_EVT_DATA: {
+            // A single-frame text message is one console line; it runs on the main loop
+            AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+            if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                if (!SerialConsole::getInstance().submit(reinterpret_cast<const char*>(data), len)) {
+                    client->text("[console busy, command ignored]");
+                }
+            }
             break;
+        }
 
         case WS_EVT_PONG:
             break;
@@ -127,21 +284,26 @@ void SerialMonitor::onWebSocketEvent(AsyncWebSocket* server, AsyncWebSocketClien
 }
 
 void SerialMonitor::sendBufferToClient(AsyncWebSocketClient* client) {
-    // Send welcome
-    client->text("=== Serial Monitor Connected ===");
-    delay(10);
-
-    // Send buffer history with throttling
-    for (size_t i = 0; i < _buffer.size(); i++) {
-        client->text(_buffer[i]);
-        if (i % 10 == 0) delay(5);  // Small delay every 10 messages
-    }
+    // Welcome and history in a single frame, up to what loop() has already broadcast
+    static const char WELCOME[] = "=== Serial Monitor Connected ===\n";
+    const size_t welcomeLength = sizeof(WELCOME) - 1;
+
+    // Start just before the oldest byte held so read() aligns to a complete line
+    uint32_t end = _sent;
+    uint32_t pos = end > SERIAL_MONITOR_BUFFER_SIZE ? end - SERIAL_MONITOR_BUFFER_SIZE - 1 : 0;
+    AsyncWebSocketSharedBuffer frame = std::make_shared<std::vector<uint8_t>>(
+        welcomeLength + (end - pos));
+    memcpy(frame->data(), WELCOME, welcomeLength);
+    uint32_t skipped = 0;
+    size_t count = read(pos, end, frame->data() + welcomeLength, frame->size() - welcomeLength, skipped);
+    frame->resize(welcomeLength + count);
+    client->text(frame);
 
-    _realSerial->printf("[SERIAL_MON] Sent %d lines to client\n", _buffer.size());
+    _realSerial->printf("[SERIAL_MON] Sent %u bytes of history to client\n", (unsigned)count);
 }
 
 // Helper function for Logger to send to web monitor
 // This avoids circular dependency between logger.h and serial_monitor.h
 void captureLogToWebMonitor(const char* msg) {
-    SerialMonitor::getInstance().println(String(msg));
+    SerialMonitor::getInstance().println(msg);
 }
@@ -0,0 +1,76 @@
+#include "sht_sensor.h"
+#include "logger.h"
+
+static const char* TAG = "SHT";
+
+// Single-shot, high repeatability, no clock stretching
+static const uint8_t SHT4X_CMD_MEASURE_HIGH = 0xFD;
+static const uint16_t SHT3X_CMD_MEASURE_HIGH = 0x2400;
+
+// Datasheet maximum conversion times (rounded up)
+static const uint32_t SHT4X_CONVERSION_MS = 10;
+static const uint32_t SHT3X_CONVERSION_MS = 16;
+
+ShtSensor::ShtSensor(Variant variant, uint8_t address, TwoWire& wire)
+    : _variant(variant), _address(address), _wire(wire) {
+}
+
+bool ShtSensor::begin() {
+    _wire.beginTransmission(_address);
+    if (_wire.endTransmission() != 0) {
+        LOG_W(TAG, "%s not responding at 0x%02X", getName(), _address);
+        return false;
+    }
+    return true;
+}
+
+bool ShtSensor::startConversion() {
+    _wire.beginTransmission(_address);
+    if (_variant == SHT4X) {
+        _wire.write(SHT4X_CMD_MEASURE_HIGH);
+    } else {
+        _wire.write((uint8_t)(SHT3X_CMD_MEASURE_HIGH >> 8));
+        _wire.write((uint8_t)(SHT3X_CMD_MEASURE_HIGH & 0xFF));
+    }
+    return _wire.endTransmission() == 0;
+}
+
+uint32_t ShtSensor::getConversionTimeMs() const {
+    return _variant == SHT4X ? SHT4X_CONVERSION_MS : SHT3X_CONVERSION_MS;
+}
+
+bool ShtSensor::readSample(SensorSample& sample) {
+    uint8_t data[6];
+    if (_wire.requestFrom(_address, (uint8_t)sizeof(data)) != sizeof(data)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = _wire.read();
+    }
+
+    if (crc8(&data[0], 2) != data[2] || crc8(&data[3], 2) != data[5]) {
+        LOG_D(TAG, "%s CRC mismatch", getName());
+        return false;
+    }
+
+    uint16_t rawTemp = ((uint16_t)data[0] << 8) | data[1];
+    uint16_t rawHum = ((uint16_t)data[3] << 8) | data[4];
+
+    sample.temperature = -45.0f + 175.0f * rawTemp / 65535.0f;
+    float humidity = _variant == SHT4X ? -6.0f + 125.0f * rawHum / 65535.0f
+                                       : 100.0f * rawHum / 65535.0f;
+    sample.humidity = constrain(humidity, 0.0f, 100.0f);
+    return true;
+}
+
+// Sensirion CRC-8: polynomial 0x31, init 0xFF
+uint8_t ShtSensor::crc8(const uint8_t* data, uint8_t len) {
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
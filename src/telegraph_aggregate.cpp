@@ -0,0 +1,128 @@
+#include "telegraph_aggregate.h"
+#include <math.h>
+#include <string.h>
+
+// Values are kept as float, so MessagePack carries float32 and JSON the
+// float's shortest digits on every platform
+#define ARDUINOJSON_USE_DOUBLE 0
+#include <ArduinoJson.h>
+
+TelegraphSample::TelegraphSample()
+    : temperature(NAN), humidity(NAN), pressure(NAN), valvePosition(0),
+      kp(NAN), ki(NAN), kd(NAN), setpoint(NAN), heat(false), wifiRSSI(0), uptime(0),
+      sensorHealthy(false), sensorFailureRate(NAN), sensorConsecutiveFailures(0),
+      valveHealthy(false), valveErrorPct(NAN), freeHeap(0), heapFragmentation(NAN) {
+    preset[0] = '\0';
+}
+
+namespace {
+
+const char* const FIELD_NAMES[TELEGRAPH_FIELD_GROUPS] = {
+    "sensors", "valve", "pid", "control", "diagnostics", "health", "memory"
+};
+
+// Top level (13 entries with every group), health (7), pid (4), wifi (1);
+// keys and the preset are referenced, not copied
+const size_t TELEGRAPH_DOC_CAPACITY =
+    JSON_OBJECT_SIZE(13) + JSON_OBJECT_SIZE(7) + JSON_OBJECT_SIZE(4) + JSON_OBJECT_SIZE(1);
+
+// Rounded to the given decimals; unknown (NaN) readings are null
+void setReading(JsonObject object, const char* key, float value, int decimals) {
+    if (!isfinite(value)) {
+        object[key] = nullptr;
+        return;
+    }
+    float scale = powf(10.0f, (float)decimals);
+    object[key] = roundf(value * scale) / scale;
+}
+
+}  // namespace
+
+size_t encodeTelegraph(const TelegraphSample& sample, uint8_t fields, TelegraphFormat format,
+                       uint8_t* out, size_t size) {
+    StaticJsonDocument<TELEGRAPH_DOC_CAPACITY> doc;
+    JsonObject root = doc.to<JsonObject>();
+
+    if (fields & TELEGRAPH_SENSORS) {
+        setReading(root, "temperature", sample.temperature, 2);
+        setReading(root, "humidity", sample.humidity, 2);
+        setReading(root, "pressure", sample.pressure, 2);
+    }
+
+    if (fields & TELEGRAPH_VALVE) {
+        bool heating = sample.valvePosition > 0;
+        root["valve_position"] = sample.valvePosition;
+        root["action"] = heating ? "heating" : "idle";
+        root["heating_state"] = heating ? "ON" : "OFF";
+    }
+
+    if (fields & TELEGRAPH_PID) {
+        JsonObject pid = root.createNestedObject("pid");
+        setReading(pid, "kp", sample.kp, 2);
+        setReading(pid, "ki", sample.ki, 3);
+        setReading(pid, "kd", sample.kd, 3);
+        setReading(pid, "setpoint", sample.setpoint, 1);
+    }
+
+    if (fields & TELEGRAPH_CONTROL) {
+        root["mode"] = sample.heat ? "heat" : "off";
+        root["preset"] = (const char*)sample.preset;
+    }
+
+    if (fields & TELEGRAPH_DIAGNOSTICS) {
+        root.createNestedObject("wifi")["rssi"] = sample.wifiRSSI;
+        root["uptime"] = sample.uptime;
+        root["status"] = "online";
+    }
+
+    if (fields & (TELEGRAPH_HEALTH | TELEGRAPH_MEMORY)) {
+        JsonObject health = root.createNestedObject("health");
+        if (fields & TELEGRAPH_HEALTH) {
+            health["sensor_healthy"] = sample.sensorHealthy;
+            setReading(health, "sensor_failure_rate", sample.sensorFailureRate, 1);
+            health["sensor_consecutive_failures"] = sample.sensorConsecutiveFailures;
+            health["valve_healthy"] = sample.valveHealthy;
+            setReading(health, "valve_error_pct", sample.valveErrorPct, 1);
+        }
+        if (fields & TELEGRAPH_MEMORY) {
+            health["free_heap"] = sample.freeHeap;
+            setReading(health, "heap_fragmentation", sample.heapFragmentation, 1);
+        }
+    }
+
+    if (doc.overflowed()) {
+        return 0;
+    }
+
+    if (format == TELEGRAPH_MSGPACK) {
+        return measureMsgPack(doc) <= size ? serializeMsgPack(doc, out, size) : 0;
+    }
+    return measureJson(doc) <= size ? serializeJson(doc, out, size) : 0;
+}
+
+const char* telegraphFieldName(uint8_t index) {
+    return index < TELEGRAPH_FIELD_GROUPS ? FIELD_NAMES[index] : "";
+}
+
+uint8_t telegraphFieldBit(const char* name) {
+    for (uint8_t i = 0; i < TELEGRAPH_FIELD_GROUPS; i++) {
+        if (strcmp(name, FIELD_NAMES[i]) == 0) {
+            return 1 << i;
+        }
+    }
+    return 0;
+}
+
+const char* telegraphFormatName(TelegraphFormat format) {
+    return format == TELEGRAPH_MSGPACK ? "msgpack" : "json";
+}
+
+int parseTelegraphFormat(const char* name) {
+    if (strcmp(name, "json") == 0) {
+        return TELEGRAPH_JSON;
+    }
+    if (strcmp(name, "msgpack") == 0) {
+        return TELEGRAPH_MSGPACK;
+    }
+    return -1;
+}
@@ -3,9 +3,6 @@
 #include <stdarg.h>
 #include <esp_log.h>
 
-// NOTE: Cannot redirect Serial here because monitorKnxDebugMessages() needs Serial.readStringUntil()
-// which TeeSerial doesn't implement (only write methods are implemented)
-
 String decodeKnxCommandType(uint8_t ct) {
   switch (ct) {
     case KNX_CT_READ:
@@ -102,26 +99,6 @@ String decodeKnxMessage(knx_command_type_t ct, uint16_t src, uint16_t dst, uint8
   return message;
 }
 
-// New function to decode the raw KNX debug messages from the serial output
-void monitorKnxDebugMessages() {
-    // Check if there's data available on Serial
-    while (Serial.available()) {
-        String line = Serial.readStringUntil('\n');
-        
-        // Skip KNX debug messages that contain specific patterns
-        if (line.indexOf("[KNXIP]") >= 0 && 
-            (line.indexOf("__loop_knx()") >= 0 || 
-             line.indexOf("Got packet") >= 0 ||
-             line.indexOf("LEN:") >= 0)) {
-            // Skip these common debug messages
-            continue;
-        }
-        
-        // Process other messages as needed
-        // ...
-    }
-}
-
 // Function to decode the raw KNX debug message
 void decodeRawKnxDebugMessage(String &message) {
   // Extract key information from the debug message
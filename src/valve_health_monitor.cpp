@@ -10,6 +10,9 @@ ValveHealthMonitor* ValveHealthMonitor::_instance = nullptr;
 ValveHealthMonitor::ValveHealthMonitor()
     : _historyIndex(0),
       _historyCount(0),
+      _errorSum(0),
+      _maxHead(0),
+      _maxCount(0),
       _stuckCount(0),
       _consecutiveStuckCount(0),
       _lastCommandedPosition(0.0f),
@@ -17,9 +20,7 @@ ValveHealthMonitor::ValveHealthMonitor()
       _lastError(0.0f),
       _wasStuck(false) {
     // Initialize error history
-    for (int i = 0; i < VALVE_HISTORY_SIZE; i++) {
-        _errorHistory[i] = 0.0f;
-    }
+    memset(_errorHistory, 0, sizeof(_errorHistory));
 }
 
 ValveHealthMonitor* ValveHealthMonitor::getInstance() {
@@ -40,12 +41,33 @@ void ValveHealthMonitor::recordCommand(float commanded, float actual) {
     // Calculate absolute position error
     _lastError = fabs(commanded - actual);
 
-    // Store in history
-    _errorHistory[_historyIndex] = _lastError;
-    _historyIndex = (_historyIndex + 1) % VALVE_HISTORY_SIZE;
-    if (_historyCount < VALVE_HISTORY_SIZE) {
+    // Store in history, keeping the running sum and max deque in step
+    float scaled = _lastError * ERROR_SCALE + 0.5f;
+    uint16_t fixedError = scaled >= 65535.0f ? 65535 : (uint16_t)scaled;
+    if (_historyCount == VALVE_HISTORY_SIZE) {
+        // Evict the oldest entry, which lives in the slot about to be overwritten
+        _errorSum -= _errorHistory[_historyIndex];
+        if (_maxCount > 0 && _maxDeque[_maxHead] == _historyIndex) {
+            _maxHead = (_maxHead + 1) % VALVE_HISTORY_SIZE;
+            _maxCount--;
+        }
+    } else {
         _historyCount++;
     }
+    _errorHistory[_historyIndex] = fixedError;
+    _errorSum += fixedError;
+
+    while (_maxCount > 0) {
+        int back = (_maxHead + _maxCount - 1) % VALVE_HISTORY_SIZE;
+        if (_errorHistory[_maxDeque[back]] > fixedError) {
+            break;
+        }
+        _maxCount--;
+    }
+    _maxDeque[(_maxHead + _maxCount) % VALVE_HISTORY_SIZE] = _historyIndex;
+    _maxCount++;
+
+    _historyIndex = (_historyIndex + 1) % VALVE_HISTORY_SIZE;
 
     // Check if valve is stuck (error exceeds critical threshold)
     if (_lastError > CRITICAL_THRESHOLD) {
@@ -91,27 +113,15 @@ float ValveHealthMonitor::getAverageError() const {
         return 0.0f;
     }
 
-    float sum = 0.0f;
-    for (int i = 0; i < _historyCount; i++) {
-        sum += _errorHistory[i];
-    }
-
-    return sum / _historyCount;
+    return (_errorSum / ERROR_SCALE) / _historyCount;
 }
 
 float ValveHealthMonitor::getMaxError() const {
-    if (_historyCount == 0) {
+    if (_maxCount == 0) {
         return 0.0f;
     }
 
-    float maxError = 0.0f;
-    for (int i = 0; i < _historyCount; i++) {
-        if (_errorHistory[i] > maxError) {
-            maxError = _errorHistory[i];
-        }
-    }
-
-    return maxError;
+    return _errorHistory[_maxDeque[_maxHead]] / ERROR_SCALE;
 }
 
 uint32_t ValveHealthMonitor::getStuckCount() const {
@@ -155,6 +165,9 @@ bool ValveHealthMonitor::hasRecovered() {
 void ValveHealthMonitor::reset() {
     _historyIndex = 0;
     _historyCount = 0;
+    _errorSum = 0;
+    _maxHead = 0;
+    _maxCount = 0;
     _stuckCount = 0;
     _consecutiveStuckCount = 0;
     _lastCommandedPosition = 0.0f;
@@ -163,7 +176,5 @@ void ValveHealthMonitor::reset() {
     _wasStuck = false;
 
     // Reset error history to zero
-    for (int i = 0; i < VALVE_HISTORY_SIZE; i++) {
-        _errorHistory[i] = 0.0f;
-    }
+    memset(_errorHistory, 0, sizeof(_errorHistory));
 }
@@ -1,6 +1,7 @@
 #include "watchdog_manager.h"
 #include "config_manager.h"
 #include "logger.h"
+#include "event_log.h"
 #include <ArduinoJson.h>  // Add this include for JSON support
 #include <Preferences.h>
 #include "config.h"
@@ -330,8 +331,9 @@ void WatchdogManager::reboot(RebootReason reason) {
   // Save the reboot reason before rebooting
   saveRebootReason(reason);
   
-  // Small delay to ensure logs are written
-  delay(100);
+  // Let the log drain task write out queued messages, then persist them
+  Logger::getInstance().flush(100);
+  EventLog::getInstance().flush();
   
   // Perform the reboot
   ESP.restart();
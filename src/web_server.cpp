@@ -21,10 +21,40 @@
 #include "valve_health_monitor.h"
 #include "serial_monitor.h"
 #include "mqtt_manager.h"
+#include "sensor_filter.h"
+#include "adaptive_sampler.h"
+#include "sensor_scheduler.h"
+#include "window_open_detector.h"
+#include "log_shipper.h"
+#include "command_coalescer.h"
 
 // External MQTT manager for syncing climate state to Home Assistant
 extern MQTTManager mqttManager;
 
+// Debounced persistence of setpoint/preset commands (main.cpp)
+extern CommandCoalescer commandCoalescer;
+
+// Temperature filter pipeline and its config loader (main.cpp)
+extern SensorFilterPipeline temperatureFilter;
+extern void applySensorFilterConfig();
+
+// Adaptive sensor sampling (main.cpp)
+extern AdaptiveSampler adaptiveSampler;
+extern void applyAdaptiveSamplingConfig();
+
+// Sensor driver scheduler (main.cpp)
+extern SensorScheduler sensorScheduler;
+
+// Window-open detector and its config loader (main.cpp)
+extern WindowOpenDetector windowOpenDetector;
+extern void applyWindowOpenConfig();
+
+// Batched MQTT log shipping (main.cpp)
+extern LogShipper logShipper;
+
+// Log level loader (main.cpp)
+extern void applyLoggingConfig();
+
 // History JSON buffer size - used by AsyncJsonResponse
 // Reduced from 24KB to 16KB since we use AsyncJsonResponse's internal buffer directly
 // (no more double-buffering with separate static document)
@@ -173,8 +203,9 @@ void WebServerManager::handlePIDParameterUpdates(const JsonDocument& jsonDoc) {
         Serial.print("Rounded Kd value: ");
         Serial.println(kd, 3);
     }
-    if (jsonDoc["pid"].containsKey("setpoint")) {
-        float setpoint = ConfigManager::roundToPrecision(jsonDoc["pid"]["setpoint"].as<float>(), 1);
+    float setpoint;
+    if (jsonDoc["pid"].containsKey("setpoint") &&
+        ConfigManager::validateSetpoint(jsonDoc["pid"]["setpoint"].as<float>(), setpoint)) {
         setTemperatureSetpoint(setpoint);
         Serial.print("Rounded setpoint value: ");
         Serial.println(setpoint, 1);
@@ -226,6 +257,55 @@ void WebServerManager::handleNTPUpdate(const JsonDocument& jsonDoc) {
     }
 }
 
+void WebServerManager::handleFilterUpdate(const JsonDocument& jsonDoc) {
+    if (!jsonDoc.containsKey("filter")) {
+        return;
+    }
+    applySensorFilterConfig();
+    Serial.println("Sensor filter settings applied from web interface");
+}
+
+void WebServerManager::handleSamplingUpdate(const JsonDocument& jsonDoc) {
+    if (!jsonDoc.containsKey("timing")) {
+        return;
+    }
+    if (jsonDoc["timing"].containsKey("adaptive_sampling") ||
+        jsonDoc["timing"].containsKey("sensor_min_interval") ||
+        jsonDoc["timing"].containsKey("sensor_max_interval")) {
+        applyAdaptiveSamplingConfig();
+    }
+}
+
+void WebServerManager::handleWindowOpenUpdate(const JsonDocument& jsonDoc) {
+    if (!jsonDoc.containsKey("window_open")) {
+        return;
+    }
+    applyWindowOpenConfig();
+    Serial.println("Window-open detection settings applied from web interface");
+}
+
+void WebServerManager::handleLoggingUpdate(const JsonDocument& jsonDoc) {
+    if (!jsonDoc.containsKey("logging")) {
+        return;
+    }
+    applyLoggingConfig();
+}
+
+void WebServerManager::handleMqttUpdate(const JsonDocument& jsonDoc) {
+    if (!jsonDoc.containsKey("mqtt")) {
+        return;
+    }
+    mqttManager.applyAggregateConfig();
+    mqttManager.applyStateDocumentConfig();
+}
+
+void WebServerManager::handlePresetUpdate(const JsonDocument& jsonDoc) {
+    if (!jsonDoc.containsKey("presets")) {
+        return;
+    }
+    mqttManager.applyClimateConfig();
+}
+
 // Fixed version of web server routes to handle static files properly
 void WebServerManager::setupDefaultRoutes() {
     if (!_server) return;
@@ -537,7 +617,7 @@ void WebServerManager::setupDefaultRoutes() {
 
         ConfigManager* configManager = ConfigManager::getInstance();
 
-        DynamicJsonDocument doc(2048);
+        DynamicJsonDocument doc(4096);
 
         // System information
         doc["system"]["uptime"] = millis() / 1000; // seconds
@@ -587,6 +667,26 @@ void WebServerManager::setupDefaultRoutes() {
         doc["sensor"]["humidity"] = humidity;
         doc["sensor"]["pressure"] = pressure;
 
+        // All sensors driven by the scheduler
+        JsonArray sensors = doc.createNestedArray("sensors");
+        static const char* const roleNames[] = {"room", "radiator_return", "auxiliary"};
+        for (uint8_t i = 0; i < sensorScheduler.getSensorCount(); i++) {
+            const SensorSample& sample = sensorScheduler.getSample(i);
+            JsonObject entry = sensors.createNestedObject();
+            entry["name"] = sensorScheduler.getDriver(i)->getName();
+            entry["role"] = roleNames[sensorScheduler.getRole(i)];
+            entry["present"] = sensorScheduler.isPresent(i);
+            entry["valid"] = sample.valid;
+            if (sample.valid) {
+                entry["temperature"] = sample.temperature;
+                if (!isnan(sample.humidity)) {
+                    entry["humidity"] = sample.humidity;
+                }
+            }
+            entry["errors"] = sensorScheduler.getErrorCount(i);
+        }
+        doc["sensor"]["last_cycle_ms"] = sensorScheduler.getLastCycleDuration();
+
         // PID Controller information
         doc["pid"]["setpoint"] = g_pid_input.setpoint_temp;
         doc["pid"]["valve_position"] = g_pid_input.valve_feedback;
@@ -595,10 +695,47 @@ void WebServerManager::setupDefaultRoutes() {
         doc["pid"]["kd"] = configManager->getPidKd();
         doc["pid"]["deadband"] = configManager->getPidDeadband();
 
+        // Window-open detection
+        doc["window_open"]["active"] = windowOpenDetector.isActive();
+        doc["window_open"]["slope"] = windowOpenDetector.getSlope();
+        doc["window_open"]["remaining"] = windowOpenDetector.getRemainingMs(millis()) / 1000;
+        doc["window_open"]["events"] = windowOpenDetector.getEventCount();
+
         // Diagnostic information
         doc["diagnostics"]["last_reboot_reason"] = configManager->getLastRebootReason();
         doc["diagnostics"]["reboot_count"] = configManager->getRebootCount();
         doc["diagnostics"]["consecutive_watchdog_reboots"] = configManager->getConsecutiveWatchdogReboots();
+        doc["diagnostics"]["log_dropped"] = Logger::getInstance().getDroppedCount();
+        doc["diagnostics"]["log_queued"] = Logger::getInstance().getQueuedCount();
+        doc["diagnostics"]["log_suppressed"] = Logger::getInstance().getSuppressedCount();
+        doc["diagnostics"]["log_ship"]["batches"] = logShipper.getBatchCount();
+        doc["diagnostics"]["log_ship"]["entries"] = logShipper.getEntryCount();
+        doc["diagnostics"]["log_ship"]["pending"] = logShipper.getPendingCount();
+        doc["diagnostics"]["log_ship"]["failures"] = logShipper.getFailureCount();
+        doc["diagnostics"]["log_ship"]["dropped"] =
+            logShipper.getDroppedCount() + EventLog::getInstance().getMQTTDroppedCount();
+        doc["diagnostics"]["mqtt_state"]["published"] = mqttManager.getStatePublishedCount();
+        doc["diagnostics"]["mqtt_state"]["skipped"] = mqttManager.getStateSkippedCount();
+        doc["diagnostics"]["mqtt_discovery"]["sent"] = mqttManager.getDiscoveryPublishedCount();
+        doc["diagnostics"]["mqtt_discovery"]["skipped"] = mqttManager.getDiscoverySkippedCount();
+        doc["diagnostics"]["commands"]["received"] = commandCoalescer.getReceivedCount();
+        doc["diagnostics"]["commands"]["committed"] = commandCoalescer.getCommittedCount();
+        const MqttOutbox& outbox = mqttManager.getOutbox();
+        doc["diagnostics"]["mqtt_outbox"]["pending"] = outbox.size();
+        doc["diagnostics"]["mqtt_outbox"]["spilled"] = outbox.getSpillPending();
+        doc["diagnostics"]["mqtt_outbox"]["queued"] = outbox.getQueuedCount();
+        doc["diagnostics"]["mqtt_outbox"]["sent"] = outbox.getSentCount();
+        doc["diagnostics"]["mqtt_outbox"]["evicted"] = outbox.getEvictedCount();
+        doc["diagnostics"]["mqtt_outbox"]["dropped"] = outbox.getDroppedCount();
+        const MqttConnector& link = mqttManager.getConnector();
+        static const char* const LINK_STATES[] = {"wait_network", "backoff", "connecting", "online"};
+        doc["diagnostics"]["mqtt_link"]["state"] = LINK_STATES[link.getState()];
+        doc["diagnostics"]["mqtt_link"]["attempts"] = link.getAttemptCount();
+        doc["diagnostics"]["mqtt_link"]["connects"] = link.getConnectCount();
+        doc["diagnostics"]["mqtt_link"]["failures"] = link.getFailureCount();
+        doc["diagnostics"]["mqtt_link"]["retry_ms"] = link.getRetryDelay();
+        doc["diagnostics"]["mqtt_link"]["jobs_dropped"] = mqttManager.getDroppedJobCount();
+        doc["diagnostics"]["mqtt_link"]["commands_dropped"] = mqttManager.getDroppedCommandCount();
 
         // Configuration
         doc["mqtt"]["server"] = configManager->getMqttServer();
@@ -667,6 +804,15 @@ void WebServerManager::setupDefaultRoutes() {
         unsigned long timeSinceGood = millis() - sensorHealth->getLastGoodReadingTime();
         doc["seconds_since_good_reading"] = timeSinceGood / 1000;
 
+        // What the filter pipeline removed before the PID saw it
+        const SensorFilterStats& filterStats = temperatureFilter.getStats();
+        doc["filter"]["samples"] = filterStats.samples;
+        doc["filter"]["outliers_rejected"] = filterStats.outliersRejected;
+        doc["filter"]["gate_resyncs"] = filterStats.gateResyncs;
+        doc["filter"]["spikes_suppressed"] = filterStats.spikesSuppressed;
+        doc["filter"]["last_rejected"] = filterStats.lastRejected;
+        doc["filter"]["filtered_value"] = temperatureFilter.getValue();
+
         String response;
         serializeJson(doc, response);
         request->send(200, "application/json", response);
@@ -730,6 +876,10 @@ void WebServerManager::setupDefaultRoutes() {
         doc["sensor"]["last_update_millis"] = g_lastSensorUpdate;
         doc["sensor"]["time_since_last_update_ms"] = now - g_lastSensorUpdate;
         doc["sensor"]["configured_interval_ms"] = configManager->getSensorUpdateInterval();
+        doc["sensor"]["adaptive_sampling"] = adaptiveSampler.isEnabled();
+        doc["sensor"]["current_interval_ms"] = adaptiveSampler.isEnabled() ?
+            adaptiveSampler.getInterval() : configManager->getSensorUpdateInterval();
+        doc["sensor"]["last_slope_c_per_min"] = adaptiveSampler.getLastSlope();
 
         doc["diagnostic"]["last_diagnostic_millis"] = g_lastHistoryDiagnostic;
 
@@ -751,11 +901,10 @@ void WebServerManager::setupDefaultRoutes() {
     // Set temperature setpoint
     _server->on("/api/setpoint", HTTP_POST, [](AsyncWebServerRequest *request) {
         if (request->hasParam("value", true)) {
-            float setpoint = request->getParam("value", true)->value().toFloat();
-
             // CRITICAL FIX: Validate setpoint range (Audit Fix #2)
-            // Must match ConfigManager validation (5-30°C)
-            if (isnan(setpoint) || setpoint < 5.0f || setpoint > 30.0f) {
+            // Shared with MQTT, the console and config import: 5-30°C, rounded to 0.1°C
+            float setpoint;
+            if (!ConfigManager::parseSetpoint(request->getParam("value", true)->value().c_str(), setpoint)) {
                 request->send(400, "application/json",
                     "{\"success\":false,\"message\":\"Setpoint must be between 5°C and 30°C\"}");
                 return;
@@ -764,14 +913,8 @@ void WebServerManager::setupDefaultRoutes() {
             // Update PID controller setpoint
             setTemperatureSetpoint(setpoint);
 
-            // Also save to ConfigManager so it persists and syncs
-            ConfigManager* configManager = ConfigManager::getInstance();
-            if (configManager) {
-                configManager->setSetpoint(setpoint);
-            }
-
-            // Sync to Home Assistant via MQTT
-            mqttManager.syncClimateState();
+            // Saved and synced to Home Assistant once the user stops adjusting
+            commandCoalescer.setpoint(setpoint, millis());
 
             request->send(200, "application/json", "{\"success\":true,\"setpoint\":" + String(setpoint) + "}");
         } else {
@@ -797,15 +940,11 @@ void WebServerManager::setupDefaultRoutes() {
                 // Get the temperature for this preset
                 float presetTemp = configManager->getPresetTemperature(preset);
 
-                // Save the current preset
-                configManager->setCurrentPreset(preset);
-
                 // Update setpoint to match preset temperature
-                configManager->setSetpoint(presetTemp);
                 setTemperatureSetpoint(presetTemp);
 
-                // Sync to Home Assistant via MQTT
-                mqttManager.syncClimateState();
+                // Preset and setpoint are saved and synced to Home Assistant once input settles
+                commandCoalescer.preset(preset.c_str(), presetTemp, millis());
 
                 request->send(200, "application/json",
                     "{\"success\":true,\"preset\":\"" + preset + "\",\"temperature\":" + String(presetTemp) + "}");
@@ -884,9 +1023,9 @@ void WebServerManager::setupDefaultRoutes() {
     // Get current configuration
     _server->on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request) {
         ConfigManager* configManager = ConfigManager::getInstance();
-        // Increased from 1024 to 2048 to accommodate webhook URL (up to 512 chars)
-        // and other configuration fields. Total estimated size: ~1500 bytes max
-        DynamicJsonDocument doc(2048);
+        // Increased from 1024 to 2048 to accommodate webhook URL (up to 512 chars),
+        // then to 3072 for the filter and window-open sections and 3328 for the aggregate field list
+        DynamicJsonDocument doc(3328);
 
         configManager->getJson(doc);
 
@@ -898,8 +1037,8 @@ void WebServerManager::setupDefaultRoutes() {
     // Export configuration as downloadable JSON file
     _server->on("/api/config/export", HTTP_GET, [](AsyncWebServerRequest *request) {
         ConfigManager* configManager = ConfigManager::getInstance();
-        // Increased from 1024 to 2048 to match /api/config endpoint
-        DynamicJsonDocument doc(2048);
+        // Sized to match /api/config endpoint
+        DynamicJsonDocument doc(3328);
 
         configManager->getJson(doc);
 
@@ -936,8 +1075,8 @@ void WebServerManager::setupDefaultRoutes() {
             // Process when upload is complete
             if (final) {
                 ConfigManager* configManager = ConfigManager::getInstance();
-                // Increased from 1024 to 2048 to match export endpoint
-                DynamicJsonDocument doc(2048);
+                // Sized to match export endpoint
+                DynamicJsonDocument doc(3328);
 
                 DeserializationError error = deserializeJson(doc, fileContent);
                 if (error) {
@@ -949,6 +1088,9 @@ void WebServerManager::setupDefaultRoutes() {
                 String errorMessage;
                 bool success = configManager->setFromJson(doc, errorMessage);
                 if (success) {
+                    mqttManager.applyAggregateConfig();
+                    mqttManager.applyStateDocumentConfig();
+                    mqttManager.applyClimateConfig();
                     request->send(200, "application/json",
                         "{\"success\":true,\"message\":\"Configuration imported successfully\"}");
                 } else {
@@ -966,9 +1108,9 @@ void WebServerManager::setupDefaultRoutes() {
         },
         NULL, // Upload handler is NULL
         [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            // Increased from 1024 to 2048 to accommodate webhook URL (up to 512 chars)
-            // and other configuration fields. Total estimated size: ~1500 bytes max
-            static DynamicJsonDocument jsonDoc(2048);
+            // Increased from 1024 to 2048 to accommodate webhook URL (up to 512 chars),
+            // then to 3072 for the filter and window-open sections and 3328 for the aggregate field list
+            static DynamicJsonDocument jsonDoc(3328);
             static String jsonBuffer;
 
             if (index == 0) {
@@ -1002,6 +1144,12 @@ void WebServerManager::setupDefaultRoutes() {
                     this->handleKNXAddressChange(jsonDoc, oldUseTestSetting);
                     this->handlePIDParameterUpdates(jsonDoc);
                     this->handleNTPUpdate(jsonDoc);
+                    this->handleFilterUpdate(jsonDoc);
+                    this->handleSamplingUpdate(jsonDoc);
+                    this->handleWindowOpenUpdate(jsonDoc);
+                    this->handleLoggingUpdate(jsonDoc);
+                    this->handleMqttUpdate(jsonDoc);
+                    this->handlePresetUpdate(jsonDoc);
                     request->send(200, "application/json", "{\"success\":true}");
                 } else {
                     request->send(500, "application/json",
@@ -1040,10 +1188,131 @@ void WebServerManager::setupDefaultRoutes() {
         }
     });
 
-    // Get event logs
+    // Recent log lines (all levels) from the in-RAM binary history, formatted while streaming.
+    // Registered before /api/logs, which would otherwise match this URL as a prefix.
+    _server->on("/api/logs/recent", HTTP_GET, [](AsyncWebServerRequest *request) {
+        Logger& logger = Logger::getInstance();
+        uint32_t next = logger.getHistoryStart();
+        uint32_t end = logger.getHistoryEnd();
+        AsyncWebServerResponse *response = request->beginChunkedResponse("text/plain",
+            [next, end](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+                Logger& logger = Logger::getInstance();
+                char line[LOG_LINE_SIZE];
+                size_t written = 0;
+                while ((int32_t)(end - next) > 0) {
+                    size_t len = logger.formatHistoryEntry(next, line, sizeof(line));
+                    if (len == 0) {
+                        // Overwritten while streaming: skip ahead to the oldest entry still held
+                        uint32_t start = logger.getHistoryStart();
+                        next = (int32_t)(start - next) > 0 ? start : next + 1;
+                        continue;
+                    }
+                    if (written + len + 1 > maxLen) {
+                        break;
+                    }
+                    memcpy(buffer + written, line, len);
+                    buffer[written + len] = '\n';
+                    written += len + 1;
+                    next++;
+                }
+                return written;
+            });
+        request->send(response);
+    });
+
+    // Get event logs: /api/logs?after=<seq>&level=<name>&tag=<tag>&limit=<n>&archive=1
+    // Streams a JSON array straight from the ring (after the compressed archive
+    // when archive=1), one entry at a time
     _server->on("/api/logs", HTTP_GET, [](AsyncWebServerRequest *request) {
-        String logsJson = EventLog::getInstance().getEntriesJSON();
-        request->send(200, "application/json", logsJson);
+        EventLog& eventLog = EventLog::getInstance();
+
+        uint32_t next = 0;
+        if (request->hasParam("after")) {
+            next = strtoul(request->getParam("after")->value().c_str(), nullptr, 10) + 1;
+        }
+        LogLevel minLevel = LOG_VERBOSE;
+        if (request->hasParam("level")) {
+            int level = ConfigManager::parseLogLevel(request->getParam("level")->value().c_str());
+            if (level < 0) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid level\"}");
+                return;
+            }
+            minLevel = (LogLevel)level;
+        }
+        String tag = request->hasParam("tag") ? request->getParam("tag")->value() : String();
+        long limit = EventLog::MAX_ENTRIES;
+        if (request->hasParam("limit")) {
+            limit = constrain(request->getParam("limit")->value().toInt(), 1L, (long)EventLog::MAX_ENTRIES);
+        }
+
+        // Fixed per-request state: the query and one pending entry, copied out across chunks
+        struct LogStream {
+            EventLogQuery query;
+            EventArchiveReader archive;
+            bool fromArchive;
+            char text[EventLog::MAX_ENTRY_JSON + 1];
+            uint16_t length;
+            uint16_t sent;
+            bool first;
+            bool done;
+        };
+        LogStream stream;
+        stream.query = eventLog.beginQuery(next, minLevel, tag.c_str(), (uint16_t)limit);
+        stream.fromArchive = request->hasParam("archive") && request->getParam("archive")->value() == "1";
+        if (stream.fromArchive) {
+            eventLog.beginArchiveQuery(stream.archive, next);
+        }
+        stream.length = 0;
+        stream.sent = 0;
+        stream.first = true;
+        stream.done = false;
+
+        AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+            [stream](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+                size_t written = 0;
+                while (written < maxLen) {
+                    if (stream.sent == stream.length) {
+                        if (stream.done) {
+                            break;
+                        }
+                        // Refill with the next entry, or close the array
+                        EventLog& eventLog = EventLog::getInstance();
+                        size_t length = 0;
+                        if (stream.fromArchive) {
+                            length = eventLog.readArchiveEntryJSON(stream.archive, stream.query,
+                                                                   stream.text + 1, EventLog::MAX_ENTRY_JSON);
+                            stream.fromArchive = length > 0;
+                        }
+                        if (length == 0) {
+                            length = eventLog.readEntryJSON(stream.query, stream.text + 1, EventLog::MAX_ENTRY_JSON);
+                        }
+                        if (length > 0) {
+                            stream.text[0] = stream.first ? '[' : ',';
+                            stream.length = length + 1;
+                        } else if (stream.first) {
+                            memcpy(stream.text, "[]", 2);
+                            stream.length = 2;
+                            stream.done = true;
+                        } else {
+                            stream.text[0] = ']';
+                            stream.length = 1;
+                            stream.done = true;
+                        }
+                        stream.first = false;
+                        stream.sent = 0;
+                    }
+                    size_t chunk = std::min((size_t)(stream.length - stream.sent), maxLen - written);
+                    memcpy(buffer + written, stream.text + stream.sent, chunk);
+                    stream.sent += chunk;
+                    written += chunk;
+                }
+                return written;
+            });
+        response->addHeader("X-Log-Next-Seq", String(eventLog.getNextSeq()));
+        if (stream.fromArchive) {
+            response->addHeader("X-Log-Archive-Bytes", String(eventLog.getArchiveSize()));
+        }
+        request->send(response);
     });
 
     // Clear event logs
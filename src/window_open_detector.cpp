@@ -0,0 +1,121 @@
+#include "window_open_detector.h"
+#include "logger.h"
+#include <math.h>
+
+static const char* TAG = "WINDOW";
+
+WindowOpenDetector::WindowOpenDetector()
+    : _enabled(false),
+      _dropRate(0.3f),
+      _holdMs(900000),
+      _valvePosition(0.0f),
+      _eventCount(0) {
+    reset();
+}
+
+WindowOpenDetector::Event WindowOpenDetector::configure(bool enabled, float dropRate, uint32_t holdMs,
+                                                        float valvePosition) {
+    _enabled = enabled;
+    _dropRate = fabsf(dropRate);
+    _holdMs = holdMs;
+    _valvePosition = constrain(valvePosition, 0.0f, 100.0f);
+
+    LOG_I(TAG, "Window-open detection %s (drop %.2f °C/min, hold %lu s, valve %.0f%%)",
+          enabled ? "enabled" : "disabled", _dropRate, (unsigned long)(_holdMs / 1000), _valvePosition);
+
+    if (!_enabled) {
+        bool wasActive = _active;
+        _active = false;
+        _armed = true;
+        if (wasActive) {
+            LOG_I(TAG, "Window-open hold ended - detection disabled");
+            return EVENT_CLOSED;
+        }
+    }
+    return EVENT_NONE;
+}
+
+WindowOpenDetector::Event WindowOpenDetector::update(float temperature, unsigned long now) {
+    if (isnan(temperature)) {
+        return EVENT_NONE;
+    }
+
+    // Append to the ring (at most one sample per SAMPLE_SPACING_MS),
+    // overwriting the oldest sample when full
+    bool spaced = _count == 0 ||
+                  now - _times[(_head + _count - 1) % MAX_SAMPLES] >= SAMPLE_SPACING_MS;
+    if (spaced) {
+        uint8_t tail = (_head + _count) % MAX_SAMPLES;
+        _temps[tail] = temperature;
+        _times[tail] = now;
+        if (_count < MAX_SAMPLES) {
+            _count++;
+        } else {
+            _head = (_head + 1) % MAX_SAMPLES;
+        }
+    }
+
+    // Drop old samples as long as the remaining span still covers the window
+    while (_count > 2) {
+        uint8_t next = (_head + 1) % MAX_SAMPLES;
+        if (now - _times[next] < SLOPE_WINDOW_MS) {
+            break;
+        }
+        _head = next;
+        _count--;
+    }
+
+    unsigned long span = now - _times[_head];
+    bool slopeValid = span >= MIN_SLOPE_SPAN_MS;
+    _slope = slopeValid ? (temperature - _temps[_head]) * 60000.0f / (float)span : 0.0f;
+
+    if (!_enabled) {
+        return EVENT_NONE;
+    }
+
+    if (_active) {
+        if (now - _activeSince >= _holdMs) {
+            _active = false;
+            LOG_I(TAG, "Window-open hold expired - resuming control (slope %.2f °C/min)", _slope);
+            return EVENT_CLOSED;
+        }
+        return EVENT_NONE;
+    }
+
+    if (!_armed) {
+        if (_slope > -_dropRate * RELEASE_RATIO) {
+            _armed = true;
+            LOG_D(TAG, "Window-open detector re-armed");
+        }
+        return EVENT_NONE;
+    }
+
+    if (slopeValid && _slope <= -_dropRate) {
+        _active = true;
+        _armed = false;
+        _activeSince = now;
+        _eventCount++;
+        LOG_W(TAG, "Rapid heat loss detected (%.2f °C/min) - suspending control for %lu s",
+              _slope, (unsigned long)(_holdMs / 1000));
+        return EVENT_OPENED;
+    }
+
+    return EVENT_NONE;
+}
+
+unsigned long WindowOpenDetector::getRemainingMs(unsigned long now) const {
+    if (!_active) {
+        return 0;
+    }
+    unsigned long elapsed = now - _activeSince;
+    return elapsed >= _holdMs ? 0 : _holdMs - elapsed;
+}
+
+void WindowOpenDetector::reset() {
+    _head = 0;
+    _count = 0;
+    _slope = 0.0f;
+    _active = false;
+    _armed = true;
+    _activeSince = 0;
+}
@@ -326,6 +326,13 @@ public:
 
 extern SerialMock Serial;
 
+// FreeRTOS critical sections (native tests are single-threaded)
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portMUX_INITIALIZE(mux) (*(mux) = 0)
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
 // Flash string helper (for ArduinoJson PROGMEM support)
 class __FlashStringHelper;
 #define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
@@ -142,6 +142,14 @@ public:
         return defaultValue;
     }
 
+    // Copies into value (NUL-terminated, truncated to maxLen); 0 if the key is missing
+    size_t getString(const char* key, char* value, size_t maxLen) {
+        if (!stringValues.count(key) || maxLen == 0) return 0;
+        size_t length = stringValues[key].copy(value, maxLen - 1);
+        value[length] = '\0';
+        return length + 1;
+    }
+
     size_t putString(const char* key, const std::string& value) {
         stringValues[key] = value;
         return value.length();
@@ -0,0 +1,164 @@
+/**
+ * @file test_adaptive_sampler.cpp
+ * @brief Unit tests for the adaptive sensor sampling scheduler
+ *
+ * Tests cover:
+ * - Interval bounds and configuration
+ * - Stretching while the room is stable
+ * - Collapse to the minimum on temperature transients
+ * - Setpoint and valve activity triggers
+ *
+ * Target Coverage: 80%
+ */
+
+#include <unity.h>
+#include "adaptive_sampler.h"
+
+static AdaptiveSampler* sampler = nullptr;
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    sampler = new AdaptiveSampler();
+    sampler->configure(true, 10000, 120000);
+}
+
+void tearDown(void) {
+    delete sampler;
+    sampler = nullptr;
+}
+
+// Feed a constant temperature at the current interval and return the final interval
+static uint32_t runStable(unsigned long& now, int samples) {
+    uint32_t interval = sampler->getInterval();
+    for (int i = 0; i < samples; i++) {
+        now += interval;
+        interval = sampler->recordSample(20.0f, now);
+    }
+    return interval;
+}
+
+// ===== TEST SUITE 1: Configuration =====
+
+void test_starts_at_minimum(void) {
+    TEST_ASSERT_TRUE(sampler->isEnabled());
+    TEST_ASSERT_EQUAL_UINT32(10000, sampler->getInterval());
+}
+
+void test_max_below_min_is_clamped(void) {
+    sampler->configure(true, 30000, 5000);
+    unsigned long now = 0;
+
+    TEST_ASSERT_EQUAL_UINT32(30000, runStable(now, 10));
+}
+
+void test_disabled_stays_at_minimum(void) {
+    sampler->configure(false, 10000, 120000);
+    unsigned long now = 0;
+
+    TEST_ASSERT_FALSE(sampler->isEnabled());
+    TEST_ASSERT_EQUAL_UINT32(10000, runStable(now, 10));
+}
+
+// ===== TEST SUITE 2: Stable Room =====
+
+void test_stable_room_stretches_interval(void) {
+    unsigned long now = 0;
+    sampler->recordSample(20.0f, now);
+
+    now += 10000;
+    uint32_t interval = sampler->recordSample(20.0f, now);
+
+    TEST_ASSERT_EQUAL_UINT32(15000, interval);
+}
+
+void test_stable_room_reaches_maximum(void) {
+    unsigned long now = 0;
+    sampler->recordSample(20.0f, now);
+
+    TEST_ASSERT_EQUAL_UINT32(120000, runStable(now, 20));
+}
+
+// ===== TEST SUITE 3: Activity =====
+
+void test_fast_slope_returns_to_minimum(void) {
+    unsigned long now = 0;
+    sampler->recordSample(20.0f, now);
+    runStable(now, 20);
+
+    // +0.5°C over two minutes = 0.25°C/min, well above the fast threshold
+    now += 120000;
+    uint32_t interval = sampler->recordSample(20.5f, now);
+
+    TEST_ASSERT_EQUAL_UINT32(10000, interval);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.25f, sampler->getLastSlope());
+}
+
+void test_moderate_slope_holds_interval(void) {
+    unsigned long now = 0;
+    sampler->recordSample(20.0f, now);
+    now += 10000;
+    sampler->recordSample(20.0f, now);  // stretch to 15000
+
+    // 0.01°C over 15s = 0.04°C/min: between quiet and fast thresholds
+    now += 15000;
+    uint32_t interval = sampler->recordSample(20.01f, now);
+
+    TEST_ASSERT_EQUAL_UINT32(15000, interval);
+}
+
+void test_setpoint_change_resets_interval(void) {
+    unsigned long now = 0;
+    sampler->noteControlState(20.0f, 30.0f);
+    sampler->recordSample(20.0f, now);
+    runStable(now, 20);
+
+    sampler->noteControlState(21.0f, 30.0f);
+
+    TEST_ASSERT_EQUAL_UINT32(10000, sampler->getInterval());
+}
+
+void test_valve_movement_resets_interval(void) {
+    unsigned long now = 0;
+    sampler->noteControlState(20.0f, 30.0f);
+    sampler->recordSample(20.0f, now);
+    runStable(now, 20);
+
+    sampler->noteControlState(20.0f, 32.0f);  // below threshold
+    TEST_ASSERT_EQUAL_UINT32(120000, sampler->getInterval());
+
+    sampler->noteControlState(20.0f, 40.0f);
+    TEST_ASSERT_EQUAL_UINT32(10000, sampler->getInterval());
+}
+
+void test_nan_sample_ignored(void) {
+    unsigned long now = 0;
+    sampler->recordSample(20.0f, now);
+    now += 10000;
+
+    TEST_ASSERT_EQUAL_UINT32(10000, sampler->recordSample(NAN, now));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Configuration
+    RUN_TEST(test_starts_at_minimum);
+    RUN_TEST(test_max_below_min_is_clamped);
+    RUN_TEST(test_disabled_stays_at_minimum);
+
+    // Suite 2: Stable Room
+    RUN_TEST(test_stable_room_stretches_interval);
+    RUN_TEST(test_stable_room_reaches_maximum);
+
+    // Suite 3: Activity
+    RUN_TEST(test_fast_slope_returns_to_minimum);
+    RUN_TEST(test_moderate_slope_holds_interval);
+    RUN_TEST(test_setpoint_change_resets_interval);
+    RUN_TEST(test_valve_movement_resets_interval);
+    RUN_TEST(test_nan_sample_ignored);
+
+    return UNITY_END();
+}
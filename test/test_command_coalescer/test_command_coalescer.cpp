@@ -0,0 +1,178 @@
+/**
+ * @file test_command_coalescer.cpp
+ * @brief Unit tests for the setpoint/preset/mode command coalescer
+ *
+ * Tests cover:
+ * - Nothing due before the quiet window, latest value wins
+ * - A slider burst committed once, max delay under continuous input
+ * - Preset implying a setpoint, mode alongside setpoint
+ * - Counters, millis() wraparound and commands stamped after take() read the clock
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "command_coalescer.h"
+
+static CommandCoalescer* coalescer = nullptr;
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    coalescer = new CommandCoalescer(1500, 10000);
+}
+
+void tearDown(void) {
+    delete coalescer;
+    coalescer = nullptr;
+}
+
+// ===== TEST SUITE 1: Debounce =====
+
+void test_nothing_pending_initially(void) {
+    CoalescedCommand command;
+    TEST_ASSERT_FALSE(coalescer->isPending());
+    TEST_ASSERT_FALSE(coalescer->take(100000, command));
+}
+
+void test_due_after_quiet_window(void) {
+    CoalescedCommand command;
+    coalescer->setpoint(21.5f, 1000);
+    TEST_ASSERT_TRUE(coalescer->isPending());
+    TEST_ASSERT_FALSE(coalescer->take(2499, command));
+    TEST_ASSERT_TRUE(coalescer->take(2500, command));
+    TEST_ASSERT_EQUAL_UINT8(COALESCED_SETPOINT, command.changes);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, command.setpoint);
+    TEST_ASSERT_FALSE(coalescer->isPending());
+    TEST_ASSERT_FALSE(coalescer->take(5000, command));
+}
+
+void test_slider_burst_commits_once_with_latest_value(void) {
+    // 20 steps of 0.5 °C, 200 ms apart
+    CoalescedCommand command;
+    uint32_t now = 0;
+    int commits = 0;
+    for (int i = 0; i < 20; i++, now += 200) {
+        coalescer->setpoint(18.0f + 0.5f * i, now);
+        commits += coalescer->take(now, command);
+    }
+    for (; now < 10000; now += 100) {
+        commits += coalescer->take(now, command);
+    }
+    TEST_ASSERT_EQUAL(1, commits);
+    TEST_ASSERT_EQUAL_FLOAT(27.5f, command.setpoint);
+    TEST_ASSERT_EQUAL_UINT32(20, coalescer->getReceivedCount());
+    TEST_ASSERT_EQUAL_UINT32(1, coalescer->getCommittedCount());
+}
+
+void test_max_delay_under_continuous_input(void) {
+    CoalescedCommand command;
+    uint32_t now = 0;
+    bool committed = false;
+    for (; now <= 10000 && !committed; now += 500) {
+        coalescer->setpoint(20.0f, now);
+        committed = coalescer->take(now, command);
+    }
+    TEST_ASSERT_TRUE(committed);
+    TEST_ASSERT_EQUAL_UINT32(10500, now);
+}
+
+// ===== TEST SUITE 2: Command kinds =====
+
+void test_preset_sets_setpoint(void) {
+    CoalescedCommand command;
+    coalescer->preset("eco", 18.0f, 0);
+    TEST_ASSERT_TRUE(coalescer->take(1500, command));
+    TEST_ASSERT_EQUAL_UINT8(COALESCED_PRESET | COALESCED_SETPOINT, command.changes);
+    TEST_ASSERT_EQUAL_STRING("eco", command.preset);
+    TEST_ASSERT_EQUAL_FLOAT(18.0f, command.setpoint);
+}
+
+void test_setpoint_after_preset_overrides_temperature(void) {
+    CoalescedCommand command;
+    coalescer->preset("comfort", 21.0f, 0);
+    coalescer->setpoint(22.5f, 500);
+    TEST_ASSERT_TRUE(coalescer->take(2000, command));
+    TEST_ASSERT_EQUAL_STRING("comfort", command.preset);
+    TEST_ASSERT_EQUAL_FLOAT(22.5f, command.setpoint);
+}
+
+void test_mode_and_setpoint_together(void) {
+    CoalescedCommand command;
+    coalescer->mode(true, 0);
+    coalescer->setpoint(20.0f, 100);
+    coalescer->mode(false, 200);
+    TEST_ASSERT_TRUE(coalescer->take(1700, command));
+    TEST_ASSERT_EQUAL_UINT8(COALESCED_MODE | COALESCED_SETPOINT, command.changes);
+    TEST_ASSERT_FALSE(command.heat);
+}
+
+void test_long_preset_name_truncated(void) {
+    CoalescedCommand command;
+    coalescer->preset("a_very_long_preset_name", 20.0f, 0);
+    coalescer->take(1500, command);
+    TEST_ASSERT_EQUAL_size_t(sizeof(command.preset) - 1, strlen(command.preset));
+}
+
+// ===== TEST SUITE 3: Timing edge cases =====
+
+void test_across_millis_wraparound(void) {
+    CoalescedCommand command;
+    uint32_t start = 0xFFFFFC00u;
+    coalescer->setpoint(19.0f, start);
+    TEST_ASSERT_FALSE(coalescer->take(start + 1499, command));
+    TEST_ASSERT_TRUE(coalescer->take(start + 1500, command));
+}
+
+void test_max_delay_never_below_quiet(void) {
+    CommandCoalescer odd(2000, 500);
+    CoalescedCommand command;
+    odd.setpoint(20.0f, 0);
+    TEST_ASSERT_FALSE(odd.take(1999, command));
+    TEST_ASSERT_TRUE(odd.take(2000, command));
+}
+
+void test_command_newer_than_take_clock(void) {
+    // The main loop read millis() just before another task stamped a command
+    CoalescedCommand command;
+    coalescer->setpoint(20.0f, 1000);
+    TEST_ASSERT_FALSE(coalescer->take(999, command));
+    TEST_ASSERT_FALSE(coalescer->take(2499, command));
+    TEST_ASSERT_TRUE(coalescer->take(2500, command));
+}
+
+void test_older_stamp_does_not_shorten_quiet_window(void) {
+    CoalescedCommand command;
+    coalescer->setpoint(20.0f, 1000);
+    coalescer->setpoint(20.5f, 990);
+    TEST_ASSERT_FALSE(coalescer->take(2499, command));
+    TEST_ASSERT_TRUE(coalescer->take(2500, command));
+    TEST_ASSERT_EQUAL_FLOAT(20.5f, command.setpoint);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Debounce
+    RUN_TEST(test_nothing_pending_initially);
+    RUN_TEST(test_due_after_quiet_window);
+    RUN_TEST(test_slider_burst_commits_once_with_latest_value);
+    RUN_TEST(test_max_delay_under_continuous_input);
+
+    // Suite 2: Command kinds
+    RUN_TEST(test_preset_sets_setpoint);
+    RUN_TEST(test_setpoint_after_preset_overrides_temperature);
+    RUN_TEST(test_mode_and_setpoint_together);
+    RUN_TEST(test_long_preset_name_truncated);
+
+    // Suite 3: Timing edge cases
+    RUN_TEST(test_across_millis_wraparound);
+    RUN_TEST(test_max_delay_never_below_quiet);
+    RUN_TEST(test_command_newer_than_take_clock);
+    RUN_TEST(test_older_stamp_does_not_shorten_quiet_window);
+
+    return UNITY_END();
+}
@@ -5,7 +5,7 @@
  * Tests cover:
  * - JSON serialization/deserialization
  * - Parameter storage with MockPreferences
- * - Validation logic (KNX addresses, MQTT port, PID parameters)
+ * - Validation logic (KNX addresses, MQTT port, PID parameters, setpoint commands)
  * - Export/import configuration
  * - Singleton pattern
  * - Default values
@@ -15,6 +15,7 @@
  */
 
 #include <unity.h>
+#include <math.h>
 #include <ArduinoJson.h>
 #include "config_manager.h"
 #include "MockPreferences.h"
@@ -383,6 +384,58 @@ void test_json_round_trip(void) {
     TEST_ASSERT_EQUAL_UINT8(7, config->getKnxArea());
 }
 
+/**
+ * Test 4.7: Per-tag log levels - set, replace and remove
+ */
+void test_log_tag_levels_storage(void) {
+    ConfigManager* config = ConfigManager::getInstance();
+    config->begin();
+    config->setLogTagLevels("");
+
+    TEST_ASSERT_TRUE(config->setLogTagLevel("KNX", 4));
+    TEST_ASSERT_TRUE(config->setLogTagLevel("PID", 2));
+    TEST_ASSERT_TRUE(config->setLogTagLevel("KNX", 5));
+    TEST_ASSERT_EQUAL_STRING("PID=2,KNX=5", config->getLogTagLevels().c_str());
+
+    TEST_ASSERT_TRUE(config->setLogTagLevel("PID", -1));
+    TEST_ASSERT_EQUAL_STRING("KNX=5", config->getLogTagLevels().c_str());
+
+    // Separators and overlong names are rejected
+    TEST_ASSERT_FALSE(config->setLogTagLevel("A=B", 3));
+    TEST_ASSERT_FALSE(config->setLogTagLevel("ThisTagIsWayTooLong", 3));
+
+    TEST_ASSERT_EQUAL_INT(4, ConfigManager::parseLogLevel("DEBUG"));
+    TEST_ASSERT_EQUAL_INT(2, ConfigManager::parseLogLevel("warn"));
+    TEST_ASSERT_EQUAL_INT(-1, ConfigManager::parseLogLevel("loud"));
+}
+
+/**
+ * Test 4.8: Import logging levels from JSON
+ */
+void test_import_logging_levels(void) {
+    ConfigManager* config = ConfigManager::getInstance();
+    config->begin();
+    config->setLogTagLevels("HISTORY=1");
+
+    StaticJsonDocument<512> doc;
+    doc["logging"]["level"] = "warning";
+    doc["logging"]["tags"]["KNX"] = "debug";
+    doc["logging"]["tags"]["PID"] = "default";
+
+    String errorMessage;
+    TEST_ASSERT_TRUE(config->setFromJson(doc, errorMessage));
+    TEST_ASSERT_EQUAL_UINT8(2, config->getLogLevel());
+    TEST_ASSERT_EQUAL_STRING("KNX=4", config->getLogTagLevels().c_str());
+
+    // An invalid level leaves the stored settings untouched
+    StaticJsonDocument<512> invalid;
+    invalid["logging"]["level"] = "info";
+    invalid["logging"]["tags"]["WIFI"] = "loud";
+    TEST_ASSERT_FALSE(config->setFromJson(invalid, errorMessage));
+    TEST_ASSERT_EQUAL_UINT8(2, config->getLogLevel());
+    TEST_ASSERT_EQUAL_STRING("KNX=4", config->getLogTagLevels().c_str());
+}
+
 // ===== TEST SUITE 5: Precision Rounding =====
 
 /**
@@ -443,6 +496,28 @@ void test_pid_parameter_precision(void) {
     TEST_ASSERT_FLOAT_WITHIN(0.1f, 21.8f, setpoint);
 }
 
+/**
+ * Test 5.4: Setpoint command validation
+ * Verify that every command path gets the same range check and 0.1°C rounding
+ */
+void test_setpoint_validation(void) {
+    float setpoint = 0.0f;
+    TEST_ASSERT_TRUE(ConfigManager::validateSetpoint(21.46f, setpoint));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 21.5f, setpoint);
+    TEST_ASSERT_TRUE(ConfigManager::validateSetpoint(4.96f, setpoint));   // Rounds into range
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 5.0f, setpoint);
+    TEST_ASSERT_FALSE(ConfigManager::validateSetpoint(30.06f, setpoint));
+    TEST_ASSERT_FALSE(ConfigManager::validateSetpoint(NAN, setpoint));
+
+    TEST_ASSERT_TRUE(ConfigManager::parseSetpoint("22.04", setpoint));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 22.0f, setpoint);
+    TEST_ASSERT_FALSE(ConfigManager::parseSetpoint("", setpoint));
+    TEST_ASSERT_FALSE(ConfigManager::parseSetpoint("21.5C", setpoint));
+    TEST_ASSERT_FALSE(ConfigManager::parseSetpoint("abc", setpoint));
+    TEST_ASSERT_FALSE(ConfigManager::parseSetpoint("35", setpoint));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 22.0f, setpoint);                     // Untouched on failure
+}
+
 // ===== TEST SUITE 6: Diagnostic Settings =====
 
 /**
@@ -676,11 +751,14 @@ int main(int argc, char **argv) {
     RUN_TEST(test_import_from_json_invalid_knx_area);
     RUN_TEST(test_import_from_json_invalid_setpoint);
     RUN_TEST(test_json_round_trip);
+    RUN_TEST(test_log_tag_levels_storage);
+    RUN_TEST(test_import_logging_levels);
 
     // Suite 5: Precision Rounding
     RUN_TEST(test_round_to_precision_basic);
     RUN_TEST(test_round_to_precision_decimals);
     RUN_TEST(test_pid_parameter_precision);
+    RUN_TEST(test_setpoint_validation);
 
     // Suite 6: Diagnostic Settings
     RUN_TEST(test_reboot_reason_tracking);
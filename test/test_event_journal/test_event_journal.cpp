@@ -0,0 +1,202 @@
+/**
+ * @file test_event_journal.cpp
+ * @brief Unit tests for the EventLog append-only journal format
+ *
+ * Tests cover:
+ * - Record encode/decode round trip and truncation of long fields
+ * - CRC-32 against the standard check value
+ * - Detection of corrupted and torn records
+ * - Resynchronising on the next record after garbage
+ * - Compact archive records with delta timestamps
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "event_journal.h"
+
+static uint8_t buffer[4 * EventJournal::MAX_RECORD_SIZE];
+static EventJournalRecord record;
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    memset(buffer, 0, sizeof(buffer));
+    memset(&record, 0, sizeof(record));
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: Encoding =====
+
+void test_crc32_check_value(void) {
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, EventJournal::crc32((const uint8_t*)check, strlen(check)));
+
+    // Chaining over two halves gives the same result
+    uint32_t crc = EventJournal::crc32((const uint8_t*)check, 4);
+    crc = EventJournal::crc32((const uint8_t*)check + 4, 5, crc);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc);
+}
+
+void test_header_round_trip(void) {
+    EventJournal::encodeHeader(buffer);
+    TEST_ASSERT_TRUE(EventJournal::checkHeader(buffer, EventJournal::HEADER_SIZE));
+    TEST_ASSERT_FALSE(EventJournal::checkHeader(buffer, EventJournal::HEADER_SIZE - 1));
+
+    buffer[4]++;  // Unknown version
+    TEST_ASSERT_FALSE(EventJournal::checkHeader(buffer, EventJournal::HEADER_SIZE));
+}
+
+void test_record_round_trip(void) {
+    size_t length = EventJournal::encode(buffer, 42, 123456, 2, "KNX", "Valve position 55%");
+    TEST_ASSERT_EQUAL_UINT32(EventJournal::RECORD_OVERHEAD + 3 + 18, length);
+
+    size_t consumed;
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_OK, EventJournal::decode(buffer, length, record, consumed));
+    TEST_ASSERT_EQUAL_UINT32(length, consumed);
+    TEST_ASSERT_EQUAL_UINT32(42, record.seq);
+    TEST_ASSERT_EQUAL_UINT32(123456, record.timestamp);
+    TEST_ASSERT_EQUAL_UINT8(2, record.level);
+    TEST_ASSERT_EQUAL_STRING("KNX", record.tag);
+    TEST_ASSERT_EQUAL_STRING("Valve position 55%", record.message);
+}
+
+void test_long_fields_truncated(void) {
+    char message[200];
+    memset(message, 'm', sizeof(message) - 1);
+    message[sizeof(message) - 1] = '\0';
+
+    size_t length = EventJournal::encode(buffer, 1, 0, 3, "AVERYLONGTAGNAMEINDEED", message);
+    TEST_ASSERT_EQUAL_UINT32(EventJournal::MAX_RECORD_SIZE, length);
+
+    size_t consumed;
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_OK, EventJournal::decode(buffer, length, record, consumed));
+    TEST_ASSERT_EQUAL_UINT32(EventJournal::MAX_TAG_LENGTH, strlen(record.tag));
+    TEST_ASSERT_EQUAL_UINT32(EventJournal::MAX_MESSAGE_LENGTH, strlen(record.message));
+}
+
+void test_null_fields_encode_empty(void) {
+    size_t length = EventJournal::encode(buffer, 7, 0, 1, nullptr, nullptr);
+
+    size_t consumed;
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_OK, EventJournal::decode(buffer, length, record, consumed));
+    TEST_ASSERT_EQUAL_STRING("", record.tag);
+    TEST_ASSERT_EQUAL_STRING("", record.message);
+}
+
+// ===== TEST SUITE 2: Damaged input =====
+
+void test_torn_record_incomplete(void) {
+    size_t length = EventJournal::encode(buffer, 1, 0, 1, "PID", "Output saturated");
+
+    size_t consumed;
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_INCOMPLETE, EventJournal::decode(buffer, 0, record, consumed));
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_INCOMPLETE, EventJournal::decode(buffer, 5, record, consumed));
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_INCOMPLETE, EventJournal::decode(buffer, length - 1, record, consumed));
+    TEST_ASSERT_EQUAL_UINT32(0, consumed);
+}
+
+void test_crc_mismatch_corrupt(void) {
+    size_t length = EventJournal::encode(buffer, 1, 0, 1, "PID", "Output saturated");
+    buffer[14] ^= 0x20;
+
+    size_t consumed;
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_CORRUPT, EventJournal::decode(buffer, length, record, consumed));
+    TEST_ASSERT_EQUAL_UINT32(1, consumed);
+}
+
+void test_impossible_length_corrupt(void) {
+    EventJournal::encode(buffer, 1, 0, 1, "PID", "x");
+    buffer[3] = 0xFF;  // Message longer than any record can hold
+
+    size_t consumed;
+    TEST_ASSERT_EQUAL(EventJournal::RESULT_CORRUPT, EventJournal::decode(buffer, sizeof(buffer), record, consumed));
+}
+
+void test_resync_after_garbage(void) {
+    const uint8_t garbage[] = {0x00, 0xE5, 0x13, 0x37, 0xFF};
+    memcpy(buffer, garbage, sizeof(garbage));
+    size_t length = sizeof(garbage);
+    length += EventJournal::encode(buffer + length, 9, 500, 1, "WIFI", "Disconnected");
+
+    // Step through the input the way EventLog reads the journal
+    size_t offset = 0;
+    int corrupt = 0;
+    int decoded = 0;
+    while (offset < length) {
+        size_t consumed;
+        EventJournal::Result result = EventJournal::decode(buffer + offset, length - offset, record, consumed);
+        TEST_ASSERT_NOT_EQUAL(EventJournal::RESULT_INCOMPLETE, result);
+        if (result == EventJournal::RESULT_OK) {
+            decoded++;
+        } else {
+            corrupt++;
+        }
+        offset += consumed;
+    }
+
+    TEST_ASSERT_EQUAL(1, decoded);
+    TEST_ASSERT_EQUAL((int)sizeof(garbage), corrupt);
+    TEST_ASSERT_EQUAL_UINT32(9, record.seq);
+    TEST_ASSERT_EQUAL_STRING("Disconnected", record.message);
+}
+
+// ===== TEST SUITE 3: Compact records =====
+
+void test_compact_round_trip(void) {
+    size_t first = EventJournal::encodeCompact(buffer, 1000, 1500, 2, "VALVE", "Position mismatch");
+    size_t second = EventJournal::encodeCompact(buffer + first, 1500, 1500 + 3600000, 3, "PID", "");
+    TEST_ASSERT_EQUAL_UINT32(3 + 2 + 5 + 17, first);   // 500 ms delta takes two varint bytes
+
+    TEST_ASSERT_EQUAL_UINT32(first, EventJournal::decodeCompact(buffer, first + second, 1000, record));
+    TEST_ASSERT_EQUAL_UINT32(1500, record.timestamp);
+    TEST_ASSERT_EQUAL_UINT8(2, record.level);
+    TEST_ASSERT_EQUAL_STRING("VALVE", record.tag);
+    TEST_ASSERT_EQUAL_STRING("Position mismatch", record.message);
+
+    TEST_ASSERT_EQUAL_UINT32(second, EventJournal::decodeCompact(buffer + first, second, 1500, record));
+    TEST_ASSERT_EQUAL_UINT32(1500 + 3600000, record.timestamp);
+    TEST_ASSERT_EQUAL_STRING("", record.message);
+}
+
+void test_compact_timestamp_going_backwards(void) {
+    // A reboot inside a page restarts millis()
+    size_t length = EventJournal::encodeCompact(buffer, 90000000, 1200, 3, "MAIN", "Booted");
+    TEST_ASSERT_EQUAL_UINT32(length, EventJournal::decodeCompact(buffer, length, 90000000, record));
+    TEST_ASSERT_EQUAL_UINT32(1200, record.timestamp);
+}
+
+void test_compact_short_input_rejected(void) {
+    size_t length = EventJournal::encodeCompact(buffer, 0, 10, 3, "KNX", "Telegram sent");
+    TEST_ASSERT_EQUAL_UINT32(0, EventJournal::decodeCompact(buffer, length - 1, 0, record));
+    TEST_ASSERT_EQUAL_UINT32(0, EventJournal::decodeCompact(buffer, 3, 0, record));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Encoding
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_record_round_trip);
+    RUN_TEST(test_long_fields_truncated);
+    RUN_TEST(test_null_fields_encode_empty);
+
+    // Suite 2: Damaged input
+    RUN_TEST(test_torn_record_incomplete);
+    RUN_TEST(test_crc_mismatch_corrupt);
+    RUN_TEST(test_impossible_length_corrupt);
+    RUN_TEST(test_resync_after_garbage);
+
+    // Suite 3: Compact records
+    RUN_TEST(test_compact_round_trip);
+    RUN_TEST(test_compact_timestamp_going_backwards);
+    RUN_TEST(test_compact_short_input_rejected);
+
+    return UNITY_END();
+}
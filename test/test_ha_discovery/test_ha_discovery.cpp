@@ -0,0 +1,300 @@
+/**
+ * @file test_ha_discovery.cpp
+ * @brief Unit tests for the Home Assistant discovery templates
+ *
+ * Tests cover:
+ * - Expanded payloads matching the previous String-built payloads byte for byte
+ * - Node id and version substitution
+ * - Predicted length matching the bytes written (needed by beginPublish)
+ * - Chunked writes and config topic formatting
+ * - Consolidated state document variants (value_json templates)
+ * - Payload hashes, the discovery digest and entity order
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "ha_discovery.h"
+
+static const char* NODE_ID = "esp32_thermostat";
+static const char* VERSION = "11.0";
+
+// Print that records everything written and how many write calls it took
+class CapturePrint : public Print {
+public:
+    std::string data;
+    int writes = 0;
+
+    size_t write(uint8_t c) override {
+        data += (char)c;
+        writes++;
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        data.append(reinterpret_cast<const char*>(buffer), size);
+        writes++;
+        return size;
+    }
+};
+
+static std::string expand(const char* payload, const char* nodeId, const char* version) {
+    CapturePrint out;
+    writeDiscoveryPayload(out, payload, nodeId, version);
+    return out.data;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: Payload contents =====
+
+void test_temperature_payload_exact(void) {
+    const char* expected =
+        "{\"name\":\"Temperature\",\"unique_id\":\"esp32_thermostat_temperature\","
+        "\"device_class\":\"temperature\",\"state_topic\":\"esp32_thermostat/temperature\","
+        "\"unit_of_measurement\":\"°C\",\"value_template\":\"{{ value }}\","
+        "\"availability_topic\":\"esp32_thermostat/status\",\"state_class\":\"measurement\","
+        "\"suggested_display_precision\":1,"
+        "\"origin\":{\"name\":\"ESP32-KNX-Thermostat\",\"sw_version\":\"11.0\","
+        "\"support_url\":\"https://github.com/yourusername/ESP32-KNX-Thermostat\"},"
+        "\"device\":{\"ids\":[\"esp32_thermostat\"],\"name\":\"ESP32 KNX Thermostat\",\"mf\":\"DIY\","
+        "\"mdl\":\"ESP32-KNX-Thermostat\",\"sw\":\"11.0\"}}";
+    TEST_ASSERT_EQUAL_STRING(expected, expand(HA_MEASUREMENT_SENSORS[0].payload, NODE_ID, VERSION).c_str());
+}
+
+void test_climate_payload_exact(void) {
+    const char* expected =
+        "{\"name\":\"Thermostat\",\"uniq_id\":\"esp32_thermostat_climate\","
+        "\"dev\":{\"ids\":[\"esp32_thermostat\"],\"name\":\"ESP32 KNX Thermostat\",\"mf\":\"DIY\","
+        "\"mdl\":\"ESP32-KNX-Thermostat\",\"sw\":\"11.0\"},"
+        "\"mode_cmd_t\":\"esp32_thermostat/mode/set\",\"mode_stat_t\":\"esp32_thermostat/mode/state\","
+        "\"modes\":[\"off\",\"heat\"],"
+        "\"temp_cmd_t\":\"esp32_thermostat/temperature/set\","
+        "\"temp_stat_t\":\"esp32_thermostat/temperature/setpoint\","
+        "\"curr_temp_t\":\"esp32_thermostat/temperature\","
+        "\"min_temp\":15,\"max_temp\":30,\"temp_step\":0.5,\"temp_unit\":\"C\","
+        "\"pr_mode_cmd_t\":\"esp32_thermostat/preset/set\",\"pr_mode_stat_t\":\"esp32_thermostat/preset/state\","
+        "\"pr_modes\":[\"eco\",\"comfort\",\"away\",\"sleep\",\"boost\"],"
+        "\"avty_t\":\"esp32_thermostat/status\",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\","
+        "\"act_t\":\"esp32_thermostat/action\",\"qos\":0,\"ret\":true}";
+    TEST_ASSERT_EQUAL_STRING(expected, expand(HA_CLIMATE_ENTITY.payload, NODE_ID, VERSION).c_str());
+}
+
+void test_pid_payload_exact(void) {
+    const char* expected =
+        "{\"name\":\"PID Ki\",\"unique_id\":\"esp32_thermostat_pid_ki\","
+        "\"state_topic\":\"esp32_thermostat/pid/ki\",\"value_template\":\"{{ value }}\","
+        "\"availability_topic\":\"esp32_thermostat/status\",\"icon\":\"mdi:chart-bell-curve\","
+        "\"origin\":{\"name\":\"ESP32-KNX-Thermostat\",\"sw_version\":\"11.0\","
+        "\"support_url\":\"https://github.com/yourusername/ESP32-KNX-Thermostat\"},"
+        "\"device\":{\"ids\":[\"esp32_thermostat\"],\"name\":\"ESP32 KNX Thermostat\",\"mf\":\"DIY\","
+        "\"mdl\":\"ESP32-KNX-Thermostat\",\"sw\":\"11.0\"}}";
+    TEST_ASSERT_EQUAL_STRING(expected, expand(HA_DIAGNOSTIC_SENSORS[1].payload, NODE_ID, VERSION).c_str());
+}
+
+void test_other_node_and_version_substituted(void) {
+    std::string payload = expand(HA_CLIMATE_ENTITY.payload, "esp32_thermostat_test5", "1.4-test5");
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"uniq_id\":\"esp32_thermostat_test5_climate\""));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"act_t\":\"esp32_thermostat_test5/action\""));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"sw\":\"1.4-test5\""));
+}
+
+void test_no_placeholder_left(void) {
+    const HADiscoveryEntity* groups[] = {HA_MEASUREMENT_SENSORS, &HA_CLIMATE_ENTITY, HA_DIAGNOSTIC_SENSORS};
+    size_t counts[] = {HA_MEASUREMENT_SENSOR_COUNT, 1, HA_DIAGNOSTIC_SENSOR_COUNT};
+    for (int g = 0; g < 3; g++) {
+        for (size_t i = 0; i < counts[g]; i++) {
+            const char* templates[] = {groups[g][i].payload, groups[g][i].jsonPayload};
+            for (int t = 0; t < 2; t++) {
+                std::string payload = expand(templates[t], NODE_ID, VERSION);
+                TEST_ASSERT_EQUAL_size_t(std::string::npos, payload.find(HA_DISCOVERY_NODE_ID[0]));
+                TEST_ASSERT_EQUAL_size_t(std::string::npos, payload.find(HA_DISCOVERY_VERSION[0]));
+                TEST_ASSERT_EQUAL_INT('{', payload.front());
+                TEST_ASSERT_EQUAL_INT('}', payload.back());
+            }
+        }
+    }
+}
+
+// ===== TEST SUITE 2: Streaming =====
+
+void test_length_matches_written(void) {
+    const HADiscoveryEntity* groups[] = {HA_MEASUREMENT_SENSORS, &HA_CLIMATE_ENTITY, HA_DIAGNOSTIC_SENSORS};
+    size_t counts[] = {HA_MEASUREMENT_SENSOR_COUNT, 1, HA_DIAGNOSTIC_SENSOR_COUNT};
+    for (int g = 0; g < 3; g++) {
+        for (size_t i = 0; i < counts[g]; i++) {
+            const char* templates[] = {groups[g][i].payload, groups[g][i].jsonPayload};
+            for (int t = 0; t < 2; t++) {
+                CapturePrint out;
+                size_t written = writeDiscoveryPayload(out, templates[t], NODE_ID, VERSION);
+                TEST_ASSERT_EQUAL_size_t(discoveryPayloadLength(templates[t], NODE_ID, VERSION), written);
+                TEST_ASSERT_EQUAL_size_t(written, out.data.size());
+            }
+        }
+    }
+}
+
+void test_writes_are_chunked(void) {
+    CapturePrint out;
+    size_t written = writeDiscoveryPayload(out, HA_CLIMATE_ENTITY.payload, NODE_ID, VERSION);
+    // 64-byte chunks: one write per chunk, not one per piece between placeholders
+    TEST_ASSERT_EQUAL((int)((written + 63) / 64), out.writes);
+}
+
+void test_long_node_id_spans_chunks(void) {
+    std::string nodeId(150, 'n');
+    std::string payload = expand(HA_CLIMATE_ENTITY.payload, nodeId.c_str(), VERSION);
+    TEST_ASSERT_EQUAL_size_t(discoveryPayloadLength(HA_CLIMATE_ENTITY.payload, nodeId.c_str(), VERSION),
+                             payload.size());
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), (nodeId + "/preset/state").c_str()));
+}
+
+// ===== TEST SUITE 3: Topics =====
+
+void test_sensor_topic(void) {
+    char topic[96];
+    size_t length = formatDiscoveryTopic(topic, sizeof(topic), HA_DIAGNOSTIC_SENSORS[3], NODE_ID);
+    TEST_ASSERT_EQUAL_STRING("homeassistant/sensor/esp32_thermostat/wifi_signal/config", topic);
+    TEST_ASSERT_EQUAL_size_t(strlen(topic), length);
+}
+
+void test_climate_topic(void) {
+    char topic[96];
+    formatDiscoveryTopic(topic, sizeof(topic), HA_CLIMATE_ENTITY, NODE_ID);
+    TEST_ASSERT_EQUAL_STRING("homeassistant/climate/esp32_thermostat/config", topic);
+}
+
+void test_topic_too_long(void) {
+    char topic[16];
+    TEST_ASSERT_EQUAL_size_t(0, formatDiscoveryTopic(topic, sizeof(topic), HA_CLIMATE_ENTITY, NODE_ID));
+}
+
+// ===== TEST SUITE 4: Consolidated state document =====
+
+void test_temperature_json_payload_exact(void) {
+    const char* expected =
+        "{\"name\":\"Temperature\",\"unique_id\":\"esp32_thermostat_temperature\","
+        "\"device_class\":\"temperature\",\"state_topic\":\"esp32_thermostat/state\","
+        "\"unit_of_measurement\":\"°C\",\"value_template\":\"{{ value_json.temperature }}\","
+        "\"availability_topic\":\"esp32_thermostat/status\",\"state_class\":\"measurement\","
+        "\"suggested_display_precision\":1,"
+        "\"origin\":{\"name\":\"ESP32-KNX-Thermostat\",\"sw_version\":\"11.0\","
+        "\"support_url\":\"https://github.com/yourusername/ESP32-KNX-Thermostat\"},"
+        "\"device\":{\"ids\":[\"esp32_thermostat\"],\"name\":\"ESP32 KNX Thermostat\",\"mf\":\"DIY\","
+        "\"mdl\":\"ESP32-KNX-Thermostat\",\"sw\":\"11.0\"}}";
+    TEST_ASSERT_EQUAL_STRING(expected, expand(HA_MEASUREMENT_SENSORS[0].jsonPayload, NODE_ID, VERSION).c_str());
+}
+
+void test_climate_json_reads_state_document(void) {
+    std::string payload = expand(HA_CLIMATE_ENTITY.jsonPayload, NODE_ID, VERSION);
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(),
+        "\"curr_temp_t\":\"esp32_thermostat/state\",\"curr_temp_tpl\":\"{{ value_json.temperature }}\""));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(),
+        "\"act_t\":\"esp32_thermostat/state\",\"act_tpl\":\"{{ value_json.action }}\""));
+    // Mode, preset and setpoint keep their retained topics
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"mode_stat_t\":\"esp32_thermostat/mode/state\""));
+    TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"temp_stat_t\":\"esp32_thermostat/temperature/setpoint\""));
+}
+
+void test_every_sensor_json_uses_state_topic(void) {
+    const HADiscoveryEntity* groups[] = {HA_MEASUREMENT_SENSORS, HA_DIAGNOSTIC_SENSORS};
+    size_t counts[] = {HA_MEASUREMENT_SENSOR_COUNT, HA_DIAGNOSTIC_SENSOR_COUNT};
+    const char* keys[] = {"temperature", "humidity", "pressure", "valve", "kp", "ki", "kd", "rssi", "uptime"};
+    int k = 0;
+    for (int g = 0; g < 2; g++) {
+        for (size_t i = 0; i < counts[g]; i++, k++) {
+            std::string payload = expand(groups[g][i].jsonPayload, NODE_ID, VERSION);
+            std::string value = std::string("\"value_template\":\"{{ value_json.") + keys[k] + " }}\"";
+            TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), "\"state_topic\":\"esp32_thermostat/state\""));
+            TEST_ASSERT_NOT_NULL(strstr(payload.c_str(), value.c_str()));
+        }
+    }
+}
+
+// ===== TEST SUITE 5: Hashes =====
+
+static uint32_t fnv1a(const std::string& text) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < text.size(); i++) {
+        hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void test_hash_is_fnv_of_expanded_payload(void) {
+    for (size_t i = 0; i < HA_DISCOVERY_ENTITY_COUNT; i++) {
+        const char* payload = discoveryEntity(i).payload;
+        TEST_ASSERT_EQUAL_HEX32(fnv1a(expand(payload, NODE_ID, VERSION)),
+                                discoveryPayloadHash(payload, NODE_ID, VERSION));
+    }
+}
+
+void test_hash_follows_content(void) {
+    const char* payload = HA_CLIMATE_ENTITY.payload;
+    uint32_t hash = discoveryPayloadHash(payload, NODE_ID, VERSION);
+    TEST_ASSERT_EQUAL_HEX32(hash, discoveryPayloadHash(payload, NODE_ID, VERSION));
+    TEST_ASSERT_NOT_EQUAL(hash, discoveryPayloadHash(payload, NODE_ID, "11.1"));
+    TEST_ASSERT_NOT_EQUAL(hash, discoveryPayloadHash(HA_CLIMATE_ENTITY.jsonPayload, NODE_ID, VERSION));
+}
+
+void test_digest_depends_on_every_hash_and_order(void) {
+    uint32_t hashes[] = {1, 2, 3};
+    uint32_t digest = discoveryDigest(hashes, 3);
+    uint32_t swapped[] = {2, 1, 3};
+    uint32_t changed[] = {1, 2, 4};
+    TEST_ASSERT_NOT_EQUAL(digest, discoveryDigest(swapped, 3));
+    TEST_ASSERT_NOT_EQUAL(digest, discoveryDigest(changed, 3));
+    TEST_ASSERT_NOT_EQUAL(digest, discoveryDigest(hashes, 2));
+    TEST_ASSERT_EQUAL_HEX32(digest, discoveryDigest(hashes, 3));
+}
+
+void test_entity_order(void) {
+    TEST_ASSERT_EQUAL_PTR(&HA_MEASUREMENT_SENSORS[0], &discoveryEntity(0));
+    TEST_ASSERT_EQUAL_PTR(&HA_CLIMATE_ENTITY, &discoveryEntity(HA_MEASUREMENT_SENSOR_COUNT));
+    TEST_ASSERT_EQUAL_PTR(&HA_DIAGNOSTIC_SENSORS[HA_DIAGNOSTIC_SENSOR_COUNT - 1],
+                          &discoveryEntity(HA_DISCOVERY_ENTITY_COUNT - 1));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Payload contents
+    RUN_TEST(test_temperature_payload_exact);
+    RUN_TEST(test_climate_payload_exact);
+    RUN_TEST(test_pid_payload_exact);
+    RUN_TEST(test_other_node_and_version_substituted);
+    RUN_TEST(test_no_placeholder_left);
+
+    // Suite 2: Streaming
+    RUN_TEST(test_length_matches_written);
+    RUN_TEST(test_writes_are_chunked);
+    RUN_TEST(test_long_node_id_spans_chunks);
+
+    // Suite 3: Topics
+    RUN_TEST(test_sensor_topic);
+    RUN_TEST(test_climate_topic);
+    RUN_TEST(test_topic_too_long);
+
+    // Suite 4: Consolidated state document
+    RUN_TEST(test_temperature_json_payload_exact);
+    RUN_TEST(test_climate_json_reads_state_document);
+    RUN_TEST(test_every_sensor_json_uses_state_topic);
+
+    // Suite 5: Hashes
+    RUN_TEST(test_hash_is_fnv_of_expanded_payload);
+    RUN_TEST(test_hash_follows_content);
+    RUN_TEST(test_digest_depends_on_every_hash_and_order);
+    RUN_TEST(test_entity_order);
+
+    return UNITY_END();
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_ha_state_document.cpp
+ * @brief Unit tests for the consolidated Home Assistant state document
+ *
+ * Tests cover:
+ * - Exact compact JSON output and per-field precision
+ * - null for values not known yet
+ * - Worst-case length within HA_STATE_DOCUMENT_SIZE and the MQTT buffer
+ * - Buffer too small
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "ha_state_document.h"
+#include "config.h"
+
+static HAStateDocument makeState() {
+    HAStateDocument state;
+    state.temperature = 21.5f;
+    state.humidity = 45.2f;
+    state.pressure = 1013.25f;
+    state.valvePosition = 40;
+    state.action = "heating";
+    state.kp = 2.0f;
+    state.ki = 0.1f;
+    state.kd = 0.05f;
+    state.wifiRSSI = -61;
+    state.uptime = 3600;
+    return state;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: Contents =====
+
+void test_document_exact(void) {
+    char out[HA_STATE_DOCUMENT_SIZE];
+    size_t length = formatStateDocument(out, sizeof(out), makeState());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"temperature\":21.50,\"humidity\":45.20,\"pressure\":1013.25,\"valve\":40,"
+        "\"action\":\"heating\",\"kp\":2.00,\"ki\":0.100,\"kd\":0.050,\"rssi\":-61,\"uptime\":3600}",
+        out);
+    TEST_ASSERT_EQUAL_size_t(strlen(out), length);
+}
+
+void test_unknown_values_are_null(void) {
+    HAStateDocument state;
+    char out[HA_STATE_DOCUMENT_SIZE];
+    formatStateDocument(out, sizeof(out), state);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"temperature\":null,\"humidity\":null,\"pressure\":null,\"valve\":0,"
+        "\"action\":\"idle\",\"kp\":null,\"ki\":null,\"kd\":null,\"rssi\":0,\"uptime\":0}",
+        out);
+}
+
+void test_failed_sensor_reading_is_null(void) {
+    HAStateDocument state = makeState();
+    state.humidity = NAN;
+    state.pressure = INFINITY;
+    char out[HA_STATE_DOCUMENT_SIZE];
+    formatStateDocument(out, sizeof(out), state);
+    TEST_ASSERT_NOT_NULL(strstr(out, "\"humidity\":null,\"pressure\":null,"));
+}
+
+// ===== TEST SUITE 2: Size =====
+
+void test_worst_case_fits(void) {
+    HAStateDocument state;
+    state.temperature = -40.25f;
+    state.humidity = 100.0f;
+    state.pressure = 1100.0f;
+    state.valvePosition = 100;
+    state.action = "heating";
+    state.kp = -100.0f;
+    state.ki = -10.125f;
+    state.kd = -10.125f;
+    state.wifiRSSI = -100;
+    state.uptime = 4294967295u;
+    char out[HA_STATE_DOCUMENT_SIZE];
+    size_t length = formatStateDocument(out, sizeof(out), state);
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_TRUE(length < MQTT_BUFFER_SIZE - 64);   // Room for the topic and header
+}
+
+void test_buffer_too_small(void) {
+    char out[40];
+    TEST_ASSERT_EQUAL_size_t(0, formatStateDocument(out, sizeof(out), makeState()));
+    TEST_ASSERT_EQUAL_size_t(0, formatStateDocument(out, 0, makeState()));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Contents
+    RUN_TEST(test_document_exact);
+    RUN_TEST(test_unknown_values_are_null);
+    RUN_TEST(test_failed_sensor_reading_is_null);
+
+    // Suite 2: Size
+    RUN_TEST(test_worst_case_fits);
+    RUN_TEST(test_buffer_too_small);
+
+    return UNITY_END();
+}
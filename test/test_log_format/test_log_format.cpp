@@ -0,0 +1,224 @@
+/**
+ * @file test_log_format.cpp
+ * @brief Unit tests for binary log records and the log history ring
+ *
+ * Tests cover:
+ * - Capturing integer, float, string and pointer arguments by value
+ * - Rejecting formats that cannot be deferred (RAM strings, %lld, %*d, ...)
+ * - Deferred rendering matching snprintf, including truncation
+ * - History wraparound and preformatted text entries
+ *
+ * Target Coverage: 85%
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "log_format.h"
+#include "log_history.h"
+
+// Stands in for heap/stack memory: strings in here are never kept by reference
+static char ramBuffer[64];
+
+static bool isStatic(const void* ptr) {
+    const char* p = static_cast<const char*>(ptr);
+    return !(p >= ramBuffer && p < ramBuffer + sizeof(ramBuffer));
+}
+
+static LogHistory* history = nullptr;
+static char rendered[128];
+static char expected[128];
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    LogFormat::setStaticCheck(isStatic);
+    history = new LogHistory();
+    memset(rendered, 0, sizeof(rendered));
+    memset(expected, 0, sizeof(expected));
+}
+
+void tearDown(void) {
+    delete history;
+    history = nullptr;
+}
+
+static bool capture(BinaryLogRecord& record, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool captured = LogFormat::capture(record, format, args);
+    va_end(args);
+    return captured;
+}
+
+// Capture, render and format the same arguments directly for comparison
+static bool roundTrip(const char* format, ...) {
+    BinaryLogRecord record;
+    va_list args;
+    va_start(args, format);
+    va_list direct;
+    va_copy(direct, args);
+    bool captured = LogFormat::capture(record, format, args);
+    vsnprintf(expected, sizeof(expected), format, direct);
+    va_end(direct);
+    va_end(args);
+    if (captured) {
+        LogFormat::render(rendered, sizeof(rendered), record);
+    }
+    return captured;
+}
+
+// ===== TEST SUITE 1: Capture =====
+
+void test_integer_args_round_trip(void) {
+    TEST_ASSERT_TRUE(roundTrip("a=%d b=%u c=%04x", -5, 7u, 0xBEEF));
+    TEST_ASSERT_EQUAL_STRING(expected, rendered);
+    TEST_ASSERT_TRUE(roundTrip("d=%ld e=%c f=%lu", -123456L, 'k', 4000000000UL));
+    TEST_ASSERT_EQUAL_STRING(expected, rendered);
+}
+
+void test_float_args_round_trip(void) {
+    TEST_ASSERT_TRUE(roundTrip("T=%.2f H=%.1f%% P=%6.1f", 21.345f, 45.2f, 1013.25f));
+    TEST_ASSERT_EQUAL_STRING(expected, rendered);
+}
+
+void test_static_string_kept_by_reference(void) {
+    BinaryLogRecord record;
+    static const char* state = "connected";
+    TEST_ASSERT_TRUE(capture(record, "MQTT %s (rc=%d)", state, 0));
+    TEST_ASSERT_EQUAL_UINT8(2, record.argc);
+    TEST_ASSERT_EQUAL_PTR(state, (const char*)record.args[0]);
+
+    LogFormat::render(rendered, sizeof(rendered), record);
+    TEST_ASSERT_EQUAL_STRING("MQTT connected (rc=0)", rendered);
+}
+
+void test_ram_string_rejected(void) {
+    BinaryLogRecord record;
+    strcpy(ramBuffer, "192.168.1.10");
+    TEST_ASSERT_FALSE(capture(record, "IP %s", ramBuffer));
+
+    // A format string in RAM is rejected as well
+    strcpy(ramBuffer, "value %d");
+    TEST_ASSERT_FALSE(capture(record, ramBuffer, 1));
+}
+
+void test_unsupported_conversions_rejected(void) {
+    BinaryLogRecord record;
+    TEST_ASSERT_FALSE(capture(record, "%lld", 1LL));
+    TEST_ASSERT_FALSE(capture(record, "%*d", 4, 1));
+    TEST_ASSERT_FALSE(capture(record, "%.*f", 2, 1.0));
+    TEST_ASSERT_FALSE(capture(record, "%d %d %d %d", 1, 2, 3, 4));
+    TEST_ASSERT_TRUE(capture(record, "%d %d %d", 1, 2, 3));
+}
+
+void test_without_static_check_nothing_captured(void) {
+    BinaryLogRecord record;
+    LogFormat::setStaticCheck(nullptr);
+    TEST_ASSERT_FALSE(capture(record, "plain message"));
+}
+
+// ===== TEST SUITE 2: Rendering =====
+
+void test_render_truncates(void) {
+    BinaryLogRecord record;
+    TEST_ASSERT_TRUE(capture(record, "count=%d", 123456));
+
+    char small[8];
+    size_t len = LogFormat::render(small, sizeof(small), record);
+    TEST_ASSERT_EQUAL_UINT32(7, len);
+    TEST_ASSERT_EQUAL_STRING("count=1", small);
+}
+
+void test_render_without_args(void) {
+    TEST_ASSERT_TRUE(roundTrip("100%% done"));
+    TEST_ASSERT_EQUAL_STRING("100% done", rendered);
+}
+
+// ===== TEST SUITE 3: History =====
+
+void test_history_binary_entry(void) {
+    BinaryLogRecord record;
+    TEST_ASSERT_TRUE(capture(record, "valve %d%%", 42));
+    record.timestamp = 1000;
+    record.level = 3;
+    record.tagId = 5;
+    history->append(record);
+
+    BinaryLogRecord out;
+    TEST_ASSERT_TRUE(history->read(0, out, rendered, sizeof(rendered)));
+    TEST_ASSERT_EQUAL_UINT32(1000, out.timestamp);
+    TEST_ASSERT_EQUAL_UINT8(5, out.tagId);
+    TEST_ASSERT_EQUAL_STRING("valve 42%", rendered);
+    TEST_ASSERT_FALSE(history->read(1, out, rendered, sizeof(rendered)));
+}
+
+void test_history_text_entry(void) {
+    const char* text = "Connected to 192.168.1.10";
+    history->appendText(2000, 3, 1, text, strlen(text));
+
+    BinaryLogRecord out;
+    TEST_ASSERT_TRUE(history->read(0, out, rendered, sizeof(rendered)));
+    TEST_ASSERT_EQUAL_UINT32(2000, out.timestamp);
+    TEST_ASSERT_EQUAL_STRING(text, rendered);
+}
+
+void test_history_wraps_keeping_newest(void) {
+    BinaryLogRecord record;
+    TEST_ASSERT_TRUE(capture(record, "n=%u", 0u));
+    for (uint32_t i = 0; i < LOG_HISTORY_DEPTH + 10; i++) {
+        record.args[0] = i;
+        history->append(record);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(10, history->getStart());
+    TEST_ASSERT_EQUAL_UINT32(LOG_HISTORY_DEPTH + 10, history->getEnd());
+
+    BinaryLogRecord out;
+    TEST_ASSERT_FALSE(history->read(9, out, rendered, sizeof(rendered)));
+    TEST_ASSERT_TRUE(history->read(10, out, rendered, sizeof(rendered)));
+    TEST_ASSERT_EQUAL_STRING("n=10", rendered);
+}
+
+void test_history_overwritten_text_placeholder(void) {
+    char text[200];
+    memset(text, 'x', sizeof(text));
+    history->appendText(0, 3, 1, "first", 5);
+    for (int i = 0; i < LOG_HISTORY_TEXT_SIZE / (int)sizeof(text) + 1; i++) {
+        history->appendText(0, 3, 1, text, sizeof(text));
+    }
+
+    BinaryLogRecord out;
+    TEST_ASSERT_TRUE(history->read(0, out, rendered, sizeof(rendered)));
+    TEST_ASSERT_EQUAL_STRING("[message text overwritten]", rendered);
+
+    // The newest text is intact
+    TEST_ASSERT_TRUE(history->read(history->getEnd() - 1, out, rendered, sizeof(rendered)));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(rendered) - 1, strlen(rendered));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Capture
+    RUN_TEST(test_integer_args_round_trip);
+    RUN_TEST(test_float_args_round_trip);
+    RUN_TEST(test_static_string_kept_by_reference);
+    RUN_TEST(test_ram_string_rejected);
+    RUN_TEST(test_unsupported_conversions_rejected);
+    RUN_TEST(test_without_static_check_nothing_captured);
+
+    // Suite 2: Rendering
+    RUN_TEST(test_render_truncates);
+    RUN_TEST(test_render_without_args);
+
+    // Suite 3: History
+    RUN_TEST(test_history_binary_entry);
+    RUN_TEST(test_history_text_entry);
+    RUN_TEST(test_history_wraps_keeping_newest);
+    RUN_TEST(test_history_overwritten_text_placeholder);
+
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_log_rate_limiter.cpp
+ * @brief Unit tests for the per-call-site log rate limiter
+ *
+ * Tests cover:
+ * - Burst, suppression and token refill for one call site
+ * - Repeat summaries handed back with the next message or by collect()
+ * - Independence of call sites differing in tag or format
+ * - Hash collisions never losing a pending summary
+ * - Bounded output during a log storm, including millis() wraparound
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include "log_rate_limiter.h"
+
+static const char* FORMAT_QUEUE = "KNX queue full (%d msgs), dropping sensor data";
+static const char* FORMAT_VALVE = "WARNING: Valve position mismatch (commanded=%.1f%%)";
+
+static LogRateLimiter limiter;
+static LogRepeatSummary summary;
+
+// Log count messages at one call site, spaced step ms apart; returns how many passed
+static int logMany(uint8_t tagId, const char* format, uint32_t& now, int count, uint32_t step) {
+    int passed = 0;
+    for (int i = 0; i < count; i++) {
+        if (limiter.check(tagId, format, 2, now, summary)) {
+            passed++;
+        }
+        now += step;
+    }
+    return passed;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    limiter.configure(3, 1000);
+    summary.count = 0;
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: One call site =====
+
+void test_burst_then_suppressed(void) {
+    uint32_t now = 5000;
+    TEST_ASSERT_EQUAL(3, logMany(1, FORMAT_QUEUE, now, 10, 10));
+    TEST_ASSERT_EQUAL_UINT32(7, limiter.getSuppressedCount());
+}
+
+void test_refill_carries_summary(void) {
+    uint32_t now = 0;
+    logMany(1, FORMAT_QUEUE, now, 10, 10);
+
+    // One token back after the refill interval; the suppressed count rides along
+    TEST_ASSERT_TRUE(limiter.check(1, FORMAT_QUEUE, 2, 1000, summary));
+    TEST_ASSERT_EQUAL_UINT32(7, summary.count);
+    TEST_ASSERT_EQUAL_PTR(FORMAT_QUEUE, summary.format);
+    TEST_ASSERT_EQUAL_UINT8(1, summary.tagId);
+    TEST_ASSERT_EQUAL_UINT32(30, summary.since);
+
+    // Bucket is empty again and the count starts over
+    TEST_ASSERT_FALSE(limiter.check(1, FORMAT_QUEUE, 2, 1001, summary));
+    TEST_ASSERT_TRUE(limiter.check(1, FORMAT_QUEUE, 2, 2000, summary));
+    TEST_ASSERT_EQUAL_UINT32(1, summary.count);
+}
+
+void test_full_bucket_after_long_pause(void) {
+    uint32_t now = 0;
+    logMany(1, FORMAT_QUEUE, now, 3, 0);
+    now = 60000;
+    TEST_ASSERT_EQUAL(3, logMany(1, FORMAT_QUEUE, now, 4, 0));
+}
+
+void test_collect_reports_quiet_site(void) {
+    uint32_t now = 0;
+    logMany(1, FORMAT_QUEUE, now, 8, 10);
+    limiter.check(2, FORMAT_VALVE, 3, now, summary);
+
+    // Still inside the refill interval: the storm might go on
+    TEST_ASSERT_FALSE(limiter.collect(500, summary));
+
+    TEST_ASSERT_TRUE(limiter.collect(1000, summary));
+    TEST_ASSERT_EQUAL_UINT32(5, summary.count);
+    TEST_ASSERT_EQUAL_UINT8(2, summary.level);
+    TEST_ASSERT_FALSE(limiter.collect(1000, summary));
+
+    // Reported once only; the next message carries no summary
+    TEST_ASSERT_TRUE(limiter.check(1, FORMAT_QUEUE, 2, 1000, summary));
+    TEST_ASSERT_EQUAL_UINT32(0, summary.count);
+}
+
+// ===== TEST SUITE 2: Several call sites =====
+
+void test_sites_are_independent(void) {
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL(3, logMany(1, FORMAT_QUEUE, now, 5, 0));
+    TEST_ASSERT_EQUAL(3, logMany(1, FORMAT_VALVE, now, 5, 0));
+    TEST_ASSERT_EQUAL(3, logMany(2, FORMAT_QUEUE, now, 5, 0));
+}
+
+void test_collision_keeps_pending_summary(void) {
+    // Find two formats sharing a slot
+    static const char buffer[4096] = {0};
+    const char* first = buffer;
+    const char* second = nullptr;
+    for (size_t i = 4; i < sizeof(buffer) && second == nullptr; i += 4) {
+        if (LogRateLimiter::slotIndex(1, buffer + i) == LogRateLimiter::slotIndex(1, first)) {
+            second = buffer + i;
+        }
+    }
+    TEST_ASSERT_NOT_NULL(second);
+
+    uint32_t now = 0;
+    logMany(1, first, now, 5, 0);
+
+    // The newcomer is not limited while the occupant has a count pending
+    TEST_ASSERT_EQUAL(10, logMany(1, second, now, 10, 0));
+
+    TEST_ASSERT_TRUE(limiter.collect(1000, summary));
+    TEST_ASSERT_EQUAL_PTR(first, summary.format);
+    TEST_ASSERT_EQUAL_UINT32(2, summary.count);
+
+    // Summary delivered: the slot may now change hands
+    now = 1000;
+    TEST_ASSERT_EQUAL(3, logMany(1, second, now, 10, 0));
+}
+
+void test_slots_spread_over_table(void) {
+    // Consecutive string literals should not pile into a few slots
+    static const char strings[LOG_RATE_SLOTS * 64] = {0};
+    bool used[LOG_RATE_SLOTS] = {false};
+    int distinct = 0;
+    for (int i = 0; i < LOG_RATE_SLOTS; i++) {
+        uint32_t slot = LogRateLimiter::slotIndex(3, strings + i * 48);
+        TEST_ASSERT_LESS_THAN(LOG_RATE_SLOTS, slot);
+        if (!used[slot]) {
+            used[slot] = true;
+            distinct++;
+        }
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(LOG_RATE_SLOTS / 2, distinct);
+}
+
+// ===== TEST SUITE 3: Log storms =====
+
+void test_storm_output_bounded(void) {
+    // 1000 messages per second for a minute
+    uint32_t now = 0;
+    int passed = logMany(1, FORMAT_QUEUE, now, 60000, 1);
+    TEST_ASSERT_LESS_OR_EQUAL(3 + 60, passed);
+    TEST_ASSERT_EQUAL_UINT32(60000 - passed, limiter.getSuppressedCount());
+}
+
+void test_storm_across_millis_wraparound(void) {
+    uint32_t now = 0xFFFFFFFF - 2500;
+    int passed = logMany(1, FORMAT_QUEUE, now, 5000, 1);
+    TEST_ASSERT_EQUAL(3 + 4, passed);
+}
+
+void test_default_configuration(void) {
+    LogRateLimiter defaults;
+    uint32_t now = 0;
+    int passed = 0;
+    for (int i = 0; i < 100; i++) {
+        if (defaults.check(1, FORMAT_QUEUE, 2, now, summary)) {
+            passed++;
+        }
+    }
+    TEST_ASSERT_EQUAL(LOG_RATE_BURST, passed);
+    TEST_ASSERT_FALSE(defaults.collect(LOG_RATE_REFILL_MS - 1, summary));
+    TEST_ASSERT_TRUE(defaults.collect(LOG_RATE_REFILL_MS, summary));
+    TEST_ASSERT_EQUAL_UINT32(100 - LOG_RATE_BURST, summary.count);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: One call site
+    RUN_TEST(test_burst_then_suppressed);
+    RUN_TEST(test_refill_carries_summary);
+    RUN_TEST(test_full_bucket_after_long_pause);
+    RUN_TEST(test_collect_reports_quiet_site);
+
+    // Suite 2: Several call sites
+    RUN_TEST(test_sites_are_independent);
+    RUN_TEST(test_collision_keeps_pending_summary);
+    RUN_TEST(test_slots_spread_over_table);
+
+    // Suite 3: Log storms
+    RUN_TEST(test_storm_output_bounded);
+    RUN_TEST(test_storm_across_millis_wraparound);
+    RUN_TEST(test_default_configuration);
+
+    return UNITY_END();
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_log_shipper.cpp
+ * @brief Unit tests for batched MQTT log shipping
+ *
+ * Tests cover:
+ * - Batch payload format (one JSON array per publish)
+ * - Size and time thresholds
+ * - Refusing entries while full, dropping entries that can never fit
+ * - Retry after a failed publish and immediate resend on reconnect
+ * - Publish count reduction against one publish per entry
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+#include "log_shipper.h"
+
+static LogShipper* shipper = nullptr;
+
+// Fake publisher: records the last payload, can be told to fail
+static std::string lastPayload;
+static int publishCount = 0;
+static bool publishFails = false;
+
+static bool fakePublish(void* context, const uint8_t* data, size_t length) {
+    (void)context;
+    publishCount++;
+    if (publishFails) {
+        return false;
+    }
+    lastPayload.assign(reinterpret_cast<const char*>(data), length);
+    return true;
+}
+
+static bool addEntry(uint32_t seq, uint32_t now) {
+    char json[96];
+    int len = snprintf(json, sizeof(json),
+                       "{\"seq\":%u,\"timestamp\":%u,\"level\":\"INFO\",\"tag\":\"MAIN\",\"message\":\"tick\"}",
+                       (unsigned)seq, (unsigned)now);
+    return shipper->add(json, (size_t)len, now);
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    shipper = new LogShipper();
+    shipper->begin(fakePublish, nullptr);
+    lastPayload.clear();
+    publishCount = 0;
+    publishFails = false;
+    shipper->loop(0, true);     // Settle the connection state
+}
+
+void tearDown(void) {
+    delete shipper;
+    shipper = nullptr;
+}
+
+// ===== TEST SUITE 1: Batching =====
+
+void test_nothing_published_when_empty(void) {
+    shipper->loop(LOG_SHIP_INTERVAL_MS * 3, true);
+    TEST_ASSERT_EQUAL(0, publishCount);
+}
+
+void test_batch_is_json_array(void) {
+    TEST_ASSERT_TRUE(shipper->add("{\"a\":1}", 7, 100));
+    TEST_ASSERT_TRUE(shipper->add("{\"b\":2}", 7, 200));
+    shipper->loop(100 + LOG_SHIP_INTERVAL_MS, true);
+
+    TEST_ASSERT_EQUAL(1, publishCount);
+    TEST_ASSERT_EQUAL_STRING("[{\"a\":1},{\"b\":2}]", lastPayload.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, shipper->getBatchCount());
+    TEST_ASSERT_EQUAL_UINT32(2, shipper->getEntryCount());
+    TEST_ASSERT_EQUAL(0, shipper->getPendingCount());
+}
+
+void test_time_threshold_from_oldest_entry(void) {
+    addEntry(1, 1000);
+    addEntry(2, 5000);
+    shipper->loop(1000 + LOG_SHIP_INTERVAL_MS - 1, true);
+    TEST_ASSERT_EQUAL(0, publishCount);
+
+    shipper->loop(1000 + LOG_SHIP_INTERVAL_MS, true);
+    TEST_ASSERT_EQUAL(1, publishCount);
+}
+
+void test_size_threshold_publishes_early(void) {
+    uint32_t seq = 0;
+    while (publishCount == 0) {
+        addEntry(++seq, 10);
+        shipper->loop(10, true);
+        TEST_ASSERT_TRUE(seq < LOG_SHIP_BUFFER_SIZE);
+    }
+    TEST_ASSERT_EQUAL(1, publishCount);
+    TEST_ASSERT_TRUE(lastPayload.size() >= LOG_SHIP_BUFFER_SIZE * 3 / 4);
+    TEST_ASSERT_TRUE(lastPayload.size() <= LOG_SHIP_BUFFER_SIZE);
+}
+
+// ===== TEST SUITE 2: Back-pressure and failures =====
+
+void test_full_buffer_refuses_entries(void) {
+    uint32_t seq = 0;
+    while (addEntry(++seq, 10)) {
+        TEST_ASSERT_TRUE(seq < LOG_SHIP_BUFFER_SIZE);
+    }
+    uint16_t pending = shipper->getPendingCount();
+    TEST_ASSERT_TRUE(pending > 0);
+
+    // Offline: nothing is lost, nothing more is taken
+    shipper->loop(20, false);
+    TEST_ASSERT_FALSE(addEntry(seq, 20));
+    TEST_ASSERT_EQUAL(pending, shipper->getPendingCount());
+
+    // Back online: the full batch goes out at once and there is room again
+    shipper->loop(30, true);
+    TEST_ASSERT_EQUAL(1, publishCount);
+    TEST_ASSERT_TRUE(addEntry(seq, 30));
+}
+
+void test_oversized_entry_dropped(void) {
+    static char huge[LOG_SHIP_BUFFER_SIZE];
+    memset(huge, 'x', sizeof(huge));
+    TEST_ASSERT_TRUE(shipper->add(huge, sizeof(huge), 10));
+    TEST_ASSERT_EQUAL_UINT32(1, shipper->getDroppedCount());
+    TEST_ASSERT_EQUAL(0, shipper->getPendingCount());
+}
+
+void test_failed_batch_retried_after_interval(void) {
+    addEntry(1, 0);
+    publishFails = true;
+    shipper->loop(LOG_SHIP_INTERVAL_MS, true);
+    TEST_ASSERT_EQUAL(1, publishCount);
+    TEST_ASSERT_EQUAL_UINT32(1, shipper->getFailureCount());
+    TEST_ASSERT_EQUAL(1, shipper->getPendingCount());
+
+    // Entries keep collecting behind the failed batch
+    addEntry(2, LOG_SHIP_INTERVAL_MS + 10);
+    shipper->loop(LOG_SHIP_INTERVAL_MS + LOG_SHIP_RETRY_MS - 1, true);
+    TEST_ASSERT_EQUAL(1, publishCount);
+
+    publishFails = false;
+    shipper->loop(LOG_SHIP_INTERVAL_MS + LOG_SHIP_RETRY_MS, true);
+    TEST_ASSERT_EQUAL(2, publishCount);
+    TEST_ASSERT_EQUAL_UINT32(2, shipper->getEntryCount());
+    TEST_ASSERT_NOT_NULL(strstr(lastPayload.c_str(), "\"seq\":1,"));
+    TEST_ASSERT_NOT_NULL(strstr(lastPayload.c_str(), "\"seq\":2,"));
+}
+
+void test_reconnect_resends_immediately(void) {
+    addEntry(1, 0);
+    publishFails = true;
+    shipper->loop(LOG_SHIP_INTERVAL_MS, true);
+    publishFails = false;
+
+    shipper->loop(LOG_SHIP_INTERVAL_MS + 10, false);
+    TEST_ASSERT_EQUAL(1, publishCount);
+
+    // Well inside the retry interval, but the link just came back
+    shipper->loop(LOG_SHIP_INTERVAL_MS + 20, true);
+    TEST_ASSERT_EQUAL(2, publishCount);
+    TEST_ASSERT_EQUAL(0, shipper->getPendingCount());
+}
+
+void test_no_publisher_keeps_entries(void) {
+    LogShipper idle;
+    TEST_ASSERT_TRUE(idle.add("{}", 2, 0));
+    idle.loop(LOG_SHIP_INTERVAL_MS * 2, true);
+    TEST_ASSERT_EQUAL(1, idle.getPendingCount());
+}
+
+// ===== TEST SUITE 3: Publish reduction =====
+
+void test_publish_count_reduced_tenfold(void) {
+    // One entry per second for 200 s: one publish per entry would be 200
+    const uint32_t entries = 200;
+    for (uint32_t i = 0; i < entries; i++) {
+        uint32_t now = i * 1000;
+        TEST_ASSERT_TRUE(addEntry(i + 1, now));
+        shipper->loop(now, true);
+    }
+    shipper->loop(entries * 1000 + LOG_SHIP_INTERVAL_MS, true);
+
+    TEST_ASSERT_EQUAL_UINT32(entries, shipper->getEntryCount());
+    TEST_ASSERT_TRUE(publishCount * 10 <= (int)entries);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Batching
+    RUN_TEST(test_nothing_published_when_empty);
+    RUN_TEST(test_batch_is_json_array);
+    RUN_TEST(test_time_threshold_from_oldest_entry);
+    RUN_TEST(test_size_threshold_publishes_early);
+
+    // Suite 2: Back-pressure and failures
+    RUN_TEST(test_full_buffer_refuses_entries);
+    RUN_TEST(test_oversized_entry_dropped);
+    RUN_TEST(test_failed_batch_retried_after_interval);
+    RUN_TEST(test_reconnect_resends_immediately);
+    RUN_TEST(test_no_publisher_keeps_entries);
+
+    // Suite 3: Publish reduction
+    RUN_TEST(test_publish_count_reduced_tenfold);
+
+    return UNITY_END();
+}
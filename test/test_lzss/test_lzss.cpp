@@ -0,0 +1,226 @@
+/**
+ * @file test_lzss.cpp
+ * @brief Unit tests and host benchmark for the LZSS codec used by the event archive
+ *
+ * Tests cover:
+ * - Round trips of empty, short, repetitive and incompressible input
+ * - Streaming in small pieces on both sides giving identical results
+ * - Rejecting back-references before the start of a stream
+ * - Compression ratio and speed on pages of typical event log records
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "lzss.h"
+#include "event_journal.h"
+
+static uint8_t input[8192];
+static uint8_t compressed[10240];
+static uint8_t output[8192];
+static size_t compressedLength;
+
+static bool collect(void* context, const uint8_t* data, size_t length) {
+    (void)context;
+    if (compressedLength + length > sizeof(compressed)) {
+        return false;
+    }
+    memcpy(compressed + compressedLength, data, length);
+    compressedLength += length;
+    return true;
+}
+
+static size_t compress(const uint8_t* data, size_t length, size_t step) {
+    LzssEncoder encoder;
+    compressedLength = 0;
+    encoder.begin(collect, nullptr);
+    for (size_t offset = 0; offset < length; offset += step) {
+        size_t chunk = length - offset < step ? length - offset : step;
+        TEST_ASSERT_TRUE(encoder.write(data + offset, chunk));
+    }
+    TEST_ASSERT_TRUE(encoder.finish());
+    TEST_ASSERT_EQUAL_UINT32(compressedLength, encoder.getOutputSize());
+    return compressedLength;
+}
+
+// Decode rawLength bytes, feeding inStep input bytes and taking outStep output bytes at a time
+static void decompress(size_t rawLength, size_t inStep, size_t outStep) {
+    LzssDecoder decoder;
+    decoder.begin();
+    size_t in = 0;
+    size_t out = 0;
+    while (out < rawLength) {
+        size_t available = compressedLength - in < inStep ? compressedLength - in : inStep;
+        size_t room = rawLength - out < outStep ? rawLength - out : outStep;
+        size_t consumed;
+        size_t produced = decoder.decode(compressed + in, available, consumed, output + out, room);
+        TEST_ASSERT_FALSE(decoder.isCorrupt());
+        TEST_ASSERT_TRUE(produced > 0 || consumed > 0);
+        in += consumed;
+        out += produced;
+    }
+}
+
+// An archive page of compact records resembling typical thermostat events
+static size_t buildLogPage(uint8_t* out, size_t size, uint32_t seed) {
+    static const char* tags[] = {"PID", "KNX", "MQTT", "SENSOR", "VALVE", "WIFI", "HIST_DIAG"};
+    static const char* formats[] = {
+        "PID update: temp=%.2f, setpoint=21.50, output=%.1f",
+        "KNX queue full, dropping sensor data",
+        "Valve position mismatch: commanded %d%%, reported %d%%",
+        "MQTT reconnect attempt %d failed, rc=-2",
+        "Sensor readings: T=%.2f°C, H=%.1f%%",
+        "WiFi signal weak: RSSI %d dBm",
+        "History buffer at %d entries, largest free block %d"
+    };
+
+    size_t length = 0;
+    uint32_t state = seed;
+    uint32_t timestamp = 0;
+    for (uint32_t seq = 0; length + EventJournal::MAX_COMPACT_SIZE <= size; seq++) {
+        state = state * 1103515245 + 12345;
+        int kind = (state >> 16) % 7;
+        char message[120];
+        snprintf(message, sizeof(message), formats[kind], 19.0 + (state % 400) / 100.0,
+                 (int)((state >> 8) % 100), (int)((state >> 4) % 100));
+        uint32_t previous = timestamp;
+        timestamp += 1000 * (state % 600);
+        length += EventJournal::encodeCompact(out + length, previous, timestamp,
+                                              kind == 1 ? 2 : 3, tags[kind], message);
+    }
+    return length;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    memset(compressed, 0, sizeof(compressed));
+    memset(output, 0, sizeof(output));
+    compressedLength = 0;
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: Round trips =====
+
+void test_empty_input(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, compress(input, 0, 1));
+}
+
+void test_short_text_round_trip(void) {
+    const char* text = "abcabcabcabcabc x";
+    size_t length = strlen(text);
+    compress((const uint8_t*)text, length, length);
+    decompress(length, compressedLength, length);
+    TEST_ASSERT_EQUAL_MEMORY(text, output, length);
+}
+
+void test_repetitive_input_compresses(void) {
+    memset(input, 'A', 4096);
+    size_t size = compress(input, 4096, 4096);
+
+    // Every maximum-length match costs 1 + window + length bits
+    TEST_ASSERT_LESS_THAN(4096 / 8, size);
+    decompress(4096, compressedLength, 4096);
+    TEST_ASSERT_EQUAL_MEMORY(input, output, 4096);
+}
+
+void test_incompressible_input_bounded(void) {
+    uint32_t state = 1;
+    for (size_t i = 0; i < 4096; i++) {
+        state = state * 1103515245 + 12345;
+        input[i] = (uint8_t)(state >> 16);
+    }
+    size_t size = compress(input, 4096, 4096);
+
+    // Never worse than one flag bit per byte
+    TEST_ASSERT_LESS_OR_EQUAL(4096 * 9 / 8 + 1, size);
+    decompress(4096, compressedLength, 4096);
+    TEST_ASSERT_EQUAL_MEMORY(input, output, 4096);
+}
+
+void test_streaming_matches_one_shot(void) {
+    size_t length = buildLogPage(input, 4096, 7);
+    compress(input, length, length);
+    uint8_t oneShot[sizeof(compressed)];
+    size_t oneShotLength = compressedLength;
+    memcpy(oneShot, compressed, compressedLength);
+
+    compress(input, length, 3);
+    TEST_ASSERT_EQUAL_UINT32(oneShotLength, compressedLength);
+    TEST_ASSERT_EQUAL_MEMORY(oneShot, compressed, compressedLength);
+
+    // Byte-at-a-time input and tiny output buffers
+    decompress(length, 1, 5);
+    TEST_ASSERT_EQUAL_MEMORY(input, output, length);
+}
+
+void test_reference_before_start_is_corrupt(void) {
+    // Flag 0 with a distance of 5 as the very first token
+    const uint8_t bogus[] = {0x02, 0x00, 0x00};
+    LzssDecoder decoder;
+    decoder.begin();
+    size_t consumed;
+    decoder.decode(bogus, sizeof(bogus), consumed, output, sizeof(output));
+    TEST_ASSERT_TRUE(decoder.isCorrupt());
+}
+
+// ===== TEST SUITE 2: Benchmark =====
+
+void test_log_page_ratio_and_speed(void) {
+    const int pages = 50;
+    size_t rawTotal = 0;
+    size_t compressedTotal = 0;
+    clock_t encodeTicks = 0;
+    clock_t decodeTicks = 0;
+
+    for (int page = 0; page < pages; page++) {
+        size_t length = buildLogPage(input, 4096, page + 1);
+
+        clock_t start = clock();
+        compress(input, length, length);
+        encodeTicks += clock() - start;
+
+        start = clock();
+        decompress(length, compressedLength, length);
+        decodeTicks += clock() - start;
+
+        TEST_ASSERT_EQUAL_MEMORY(input, output, length);
+        rawTotal += length;
+        compressedTotal += compressedLength;
+    }
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "LZSS %d/%d on %u bytes of log records: ratio %.1f%%, encode %.1f us/KB, decode %.1f us/KB (host)",
+             LZSS_WINDOW_BITS, LZSS_LENGTH_BITS, (unsigned)rawTotal, 100.0 * compressedTotal / rawTotal,
+             1e6 * encodeTicks / CLOCKS_PER_SEC / (rawTotal / 1024.0),
+             1e6 * decodeTicks / CLOCKS_PER_SEC / (rawTotal / 1024.0));
+    TEST_MESSAGE(report);
+
+    // Log records are mostly repeated tags and format text
+    TEST_ASSERT_LESS_THAN(rawTotal * 6 / 10, compressedTotal);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Round trips
+    RUN_TEST(test_empty_input);
+    RUN_TEST(test_short_text_round_trip);
+    RUN_TEST(test_repetitive_input_compresses);
+    RUN_TEST(test_incompressible_input_bounded);
+    RUN_TEST(test_streaming_matches_one_shot);
+    RUN_TEST(test_reference_before_start_is_corrupt);
+
+    // Suite 2: Benchmark
+    RUN_TEST(test_log_page_ratio_and_speed);
+
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+/**
+ * @file test_mpsc_ring.cpp
+ * @brief Unit tests for the bounded MPSC ring used by the async logger
+ *
+ * Tests cover:
+ * - FIFO order and empty/full detection
+ * - Wraparound over many laps
+ * - In-place claim/publish, including out-of-order publishing
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include "mpsc_ring.h"
+
+typedef MpscRing<int, 4> SmallRing;
+
+static SmallRing* ring = nullptr;
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    ring = new SmallRing();
+}
+
+void tearDown(void) {
+    delete ring;
+    ring = nullptr;
+}
+
+// ===== TEST SUITE 1: Basic Operations =====
+
+void test_starts_empty(void) {
+    int value;
+    TEST_ASSERT_NULL(ring->front());
+    TEST_ASSERT_FALSE(ring->tryPop(value));
+    TEST_ASSERT_EQUAL_UINT32(0, ring->size());
+    TEST_ASSERT_EQUAL_UINT32(4, SmallRing::capacity());
+}
+
+void test_fifo_order(void) {
+    TEST_ASSERT_TRUE(ring->tryPush(1));
+    TEST_ASSERT_TRUE(ring->tryPush(2));
+    TEST_ASSERT_TRUE(ring->tryPush(3));
+
+    int value;
+    TEST_ASSERT_TRUE(ring->tryPop(value));
+    TEST_ASSERT_EQUAL_INT(1, value);
+    TEST_ASSERT_TRUE(ring->tryPop(value));
+    TEST_ASSERT_EQUAL_INT(2, value);
+    TEST_ASSERT_TRUE(ring->tryPop(value));
+    TEST_ASSERT_EQUAL_INT(3, value);
+    TEST_ASSERT_FALSE(ring->tryPop(value));
+}
+
+void test_full_rejects_push(void) {
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring->tryPush(i));
+    }
+    TEST_ASSERT_FALSE(ring->tryPush(99));
+    TEST_ASSERT_EQUAL_UINT32(4, ring->size());
+
+    // Freeing one slot accepts exactly one more
+    int value;
+    ring->tryPop(value);
+    TEST_ASSERT_TRUE(ring->tryPush(4));
+    TEST_ASSERT_FALSE(ring->tryPush(5));
+}
+
+void test_wraparound_many_laps(void) {
+    int expected = 0;
+    int next = 0;
+    for (int lap = 0; lap < 1000; lap++) {
+        while (ring->tryPush(next)) {
+            next++;
+        }
+        int value;
+        while (ring->tryPop(value)) {
+            TEST_ASSERT_EQUAL_INT(expected, value);
+            expected++;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(next, expected);
+    TEST_ASSERT_EQUAL_INT(4000, expected);
+}
+
+// ===== TEST SUITE 2: In-Place Claim/Publish =====
+
+void test_claim_invisible_until_published(void) {
+    uint32_t pos;
+    TEST_ASSERT_TRUE(ring->claim(pos));
+    ring->at(pos) = 42;
+
+    TEST_ASSERT_NULL(ring->front());
+    TEST_ASSERT_EQUAL_UINT32(1, ring->size());
+
+    ring->publish(pos);
+    TEST_ASSERT_NOT_NULL(ring->front());
+    TEST_ASSERT_EQUAL_INT(42, *ring->front());
+}
+
+void test_out_of_order_publish_keeps_fifo(void) {
+    uint32_t first;
+    uint32_t second;
+    TEST_ASSERT_TRUE(ring->claim(first));
+    TEST_ASSERT_TRUE(ring->claim(second));
+
+    // The second producer finishes first; the consumer must wait for the first
+    ring->at(second) = 2;
+    ring->publish(second);
+    TEST_ASSERT_NULL(ring->front());
+
+    ring->at(first) = 1;
+    ring->publish(first);
+
+    int value;
+    TEST_ASSERT_TRUE(ring->tryPop(value));
+    TEST_ASSERT_EQUAL_INT(1, value);
+    TEST_ASSERT_TRUE(ring->tryPop(value));
+    TEST_ASSERT_EQUAL_INT(2, value);
+}
+
+void test_front_pop_zero_copy(void) {
+    ring->tryPush(7);
+
+    int* head = ring->front();
+    TEST_ASSERT_NOT_NULL(head);
+    *head = 8;  // Consumer owns the slot until pop()
+    TEST_ASSERT_EQUAL_INT(8, *ring->front());
+
+    ring->pop();
+    TEST_ASSERT_NULL(ring->front());
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Basic Operations
+    RUN_TEST(test_starts_empty);
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_rejects_push);
+    RUN_TEST(test_wraparound_many_laps);
+
+    // Suite 2: In-Place Claim/Publish
+    RUN_TEST(test_claim_invisible_until_published);
+    RUN_TEST(test_out_of_order_publish_keeps_fifo);
+    RUN_TEST(test_front_pop_zero_copy);
+
+    return UNITY_END();
+}
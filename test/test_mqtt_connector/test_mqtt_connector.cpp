@@ -0,0 +1,166 @@
+/**
+ * @file test_mqtt_connector.cpp
+ * @brief Unit tests for the MQTT connection state machine
+ *
+ * Tests cover:
+ * - Immediate first attempt once WiFi is up, waiting for WiFi
+ * - Exponential backoff bounds, cap and jitter spread
+ * - Reset after a successful connect, dropped connections
+ * - Attempt/connect counters and millis() wraparound
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include "mqtt_connector.h"
+
+static MqttConnector* connector = nullptr;
+
+// Poll once a millisecond until an attempt is due; returns when it was due
+static uint32_t waitForAttempt(uint32_t from, uint32_t limit) {
+    for (uint32_t now = from; now - from <= limit; now++) {
+        if (connector->poll(now, true, false)) {
+            return now;
+        }
+    }
+    TEST_FAIL_MESSAGE("No attempt within limit");
+    return 0;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    connector = new MqttConnector(1000, 60000);
+    connector->seed(12345);
+}
+
+void tearDown(void) {
+    delete connector;
+    connector = nullptr;
+}
+
+// ===== TEST SUITE 1: Connecting =====
+
+void test_waits_for_network(void) {
+    TEST_ASSERT_FALSE(connector->poll(0, false, false));
+    TEST_ASSERT_FALSE(connector->poll(100000, false, false));
+    TEST_ASSERT_EQUAL(MQTT_LINK_WAIT_NETWORK, connector->getState());
+    TEST_ASSERT_EQUAL_UINT32(0, connector->getAttemptCount());
+}
+
+void test_first_attempt_is_immediate(void) {
+    TEST_ASSERT_TRUE(connector->poll(500, true, false));
+    TEST_ASSERT_EQUAL(MQTT_LINK_CONNECTING, connector->getState());
+    TEST_ASSERT_FALSE(connector->poll(501, true, false));
+}
+
+void test_successful_connect(void) {
+    connector->poll(0, true, false);
+    connector->connectFinished(true, 10);
+    TEST_ASSERT_TRUE(connector->isOnline());
+    TEST_ASSERT_FALSE(connector->poll(20, true, true));
+    TEST_ASSERT_TRUE(connector->isOnline());
+    TEST_ASSERT_EQUAL_UINT32(1, connector->getConnectCount());
+}
+
+// ===== TEST SUITE 2: Backoff =====
+
+void test_failure_waits_within_jitter_bounds(void) {
+    connector->poll(0, true, false);
+    connector->connectFinished(false, 0);
+    uint32_t delay = connector->getRetryDelay();
+    TEST_ASSERT_TRUE(delay >= 500 && delay <= 1000);
+    TEST_ASSERT_FALSE(connector->poll(delay - 1, true, false));
+    TEST_ASSERT_TRUE(connector->poll(delay, true, false));
+}
+
+void test_delay_doubles_up_to_cap(void) {
+    uint32_t now = 0;
+    uint32_t expectedMax = 1000;
+    connector->poll(now, true, false);
+    for (int i = 0; i < 12; i++) {
+        connector->connectFinished(false, now);
+        uint32_t delay = connector->getRetryDelay();
+        TEST_ASSERT_TRUE(delay >= expectedMax / 2);
+        TEST_ASSERT_TRUE(delay <= expectedMax);
+        now = waitForAttempt(now, delay);
+        expectedMax = expectedMax * 2 > 60000 ? 60000 : expectedMax * 2;
+    }
+    TEST_ASSERT_EQUAL(12, connector->getFailureCount());
+    TEST_ASSERT_EQUAL_UINT32(13, connector->getAttemptCount());
+}
+
+void test_jitter_spreads_devices(void) {
+    // Two thermostats failing at the same moment should not retry together
+    MqttConnector other(1000, 60000);
+    other.seed(99991);
+    connector->poll(0, true, false);
+    other.poll(0, true, false);
+    bool differed = false;
+    for (int i = 0; i < 5; i++) {
+        connector->connectFinished(false, 0);
+        other.connectFinished(false, 0);
+        differed |= connector->getRetryDelay() != other.getRetryDelay();
+        connector->poll(connector->getRetryDelay(), true, false);
+        other.poll(other.getRetryDelay(), true, false);
+    }
+    TEST_ASSERT_TRUE(differed);
+}
+
+void test_success_resets_backoff(void) {
+    uint32_t now = 0;
+    connector->poll(now, true, false);
+    for (int i = 0; i < 6; i++) {
+        connector->connectFinished(false, now);
+        now = waitForAttempt(now, connector->getRetryDelay());
+    }
+    connector->connectFinished(true, now);
+    TEST_ASSERT_EQUAL(0, connector->getFailureCount());
+
+    // Losing the connection starts over at the initial delay
+    connector->poll(now + 1, true, false);
+    TEST_ASSERT_EQUAL(MQTT_LINK_BACKOFF, connector->getState());
+    TEST_ASSERT_TRUE(connector->getRetryDelay() <= 1000);
+}
+
+void test_network_loss_keeps_backoff(void) {
+    connector->poll(0, true, false);
+    connector->connectFinished(false, 0);
+    connector->poll(100, true, false);
+    connector->poll(200, false, false);
+    TEST_ASSERT_EQUAL(MQTT_LINK_WAIT_NETWORK, connector->getState());
+    TEST_ASSERT_EQUAL(1, connector->getFailureCount());
+
+    // Immediate attempt once WiFi is back
+    TEST_ASSERT_TRUE(connector->poll(300, true, false));
+}
+
+void test_backoff_across_millis_wraparound(void) {
+    uint32_t start = 0xFFFFFF00u;
+    connector->poll(start, true, false);
+    connector->connectFinished(false, start);
+    uint32_t delay = connector->getRetryDelay();
+    TEST_ASSERT_FALSE(connector->poll(start + delay - 1, true, false));
+    TEST_ASSERT_TRUE(connector->poll(start + delay, true, false));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Connecting
+    RUN_TEST(test_waits_for_network);
+    RUN_TEST(test_first_attempt_is_immediate);
+    RUN_TEST(test_successful_connect);
+
+    // Suite 2: Backoff
+    RUN_TEST(test_failure_waits_within_jitter_bounds);
+    RUN_TEST(test_delay_doubles_up_to_cap);
+    RUN_TEST(test_jitter_spreads_devices);
+    RUN_TEST(test_success_resets_backoff);
+    RUN_TEST(test_network_loss_keeps_backoff);
+    RUN_TEST(test_backoff_across_millis_wraparound);
+
+    return UNITY_END();
+}
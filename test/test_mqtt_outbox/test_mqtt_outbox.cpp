@@ -0,0 +1,313 @@
+/**
+ * @file test_mqtt_outbox.cpp
+ * @brief Unit tests for the MQTT store-and-forward outbox
+ *
+ * Tests cover:
+ * - FIFO order in RAM and oldest-first eviction without a spill store
+ * - Spilling to a backing store, wraparound, and eviction when it is full
+ * - Draining spill records before RAM records, spill failures, giving up on an unreadable spill store
+ * - Backfill batch JSON formatting (null for NaN and infinity, overflow detection)
+ * - Dropping unformattable records, metrics
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "mqtt_outbox.h"
+
+// In-memory spill store with a switch to make it fail
+class MemorySpill : public OutboxSpill {
+public:
+    static const uint32_t SLOTS = 48;
+    TelemetryRecord slots[SLOTS];
+    bool fail = false;
+    int writes = 0;
+
+    uint32_t capacity() const override { return SLOTS; }
+
+    bool write(uint32_t slot, const TelemetryRecord* records, size_t count) override {
+        TEST_ASSERT_TRUE(slot + count <= SLOTS);
+        if (fail) {
+            return false;
+        }
+        memcpy(&slots[slot], records, count * sizeof(TelemetryRecord));
+        writes++;
+        return true;
+    }
+
+    bool read(uint32_t slot, TelemetryRecord* records, size_t count) override {
+        TEST_ASSERT_TRUE(slot + count <= SLOTS);
+        if (fail) {
+            return false;
+        }
+        memcpy(records, &slots[slot], count * sizeof(TelemetryRecord));
+        return true;
+    }
+};
+
+static MqttOutbox* outbox = nullptr;
+static MemorySpill* spill = nullptr;
+
+static TelemetryRecord makeRecord(uint32_t timestamp) {
+    TelemetryRecord record;
+    record.timestamp = timestamp;
+    record.temperature = 20.0f + timestamp * 0.01f;
+    record.humidity = 45.0f;
+    record.pressure = 1013.25f;
+    record.valvePosition = timestamp % 100;
+    return record;
+}
+
+static void addRange(uint32_t first, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        outbox->add(makeRecord(first + i));
+    }
+}
+
+// Drain everything in batches of up to 10; checks timestamps are consecutive from first
+static uint32_t drainExpecting(uint32_t first) {
+    TelemetryRecord batch[10];
+    uint32_t expected = first;
+    size_t count;
+    while ((count = outbox->peek(batch, 10)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL_UINT32(expected++, batch[i].timestamp);
+        }
+        outbox->pop(count);
+    }
+    return expected - first;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    outbox = new MqttOutbox();
+    spill = new MemorySpill();
+}
+
+void tearDown(void) {
+    delete outbox;
+    delete spill;
+    outbox = nullptr;
+    spill = nullptr;
+}
+
+// ===== TEST SUITE 1: RAM only =====
+
+void test_empty_outbox(void) {
+    TelemetryRecord batch[4];
+    TEST_ASSERT_TRUE(outbox->empty());
+    TEST_ASSERT_EQUAL(0, outbox->peek(batch, 4));
+}
+
+void test_fifo_order(void) {
+    addRange(100, 25);
+    TEST_ASSERT_EQUAL(25, outbox->size());
+    TEST_ASSERT_EQUAL_UINT32(25, drainExpecting(100));
+    TEST_ASSERT_TRUE(outbox->empty());
+    TEST_ASSERT_EQUAL_UINT32(25, outbox->getSentCount());
+}
+
+void test_peek_does_not_remove(void) {
+    addRange(1, 3);
+    TelemetryRecord batch[2];
+    TEST_ASSERT_EQUAL(2, outbox->peek(batch, 2));
+    TEST_ASSERT_EQUAL(2, outbox->peek(batch, 2));
+    TEST_ASSERT_EQUAL(3, outbox->size());
+}
+
+void test_ram_full_evicts_oldest(void) {
+    addRange(0, OUTBOX_RAM_RECORDS + 5);
+    TEST_ASSERT_EQUAL(OUTBOX_RAM_RECORDS, outbox->size());
+    TEST_ASSERT_EQUAL_UINT32(5, outbox->getEvictedCount());
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS, drainExpecting(5));
+}
+
+// ===== TEST SUITE 2: Spill store =====
+
+void test_overflow_spills_instead_of_evicting(void) {
+    outbox->setSpill(spill);
+    addRange(0, OUTBOX_RAM_RECORDS + 1);
+    TEST_ASSERT_EQUAL(OUTBOX_RAM_RECORDS + 1, outbox->size());
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_SPILL_BATCH, outbox->getSpillPending());
+    TEST_ASSERT_EQUAL_UINT32(0, outbox->getEvictedCount());
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS + 1, drainExpecting(0));
+}
+
+void test_full_spill_evicts_oldest(void) {
+    outbox->setSpill(spill);
+    uint32_t total = OUTBOX_RAM_RECORDS + MemorySpill::SLOTS + 40;
+    addRange(0, total);
+
+    uint32_t kept = outbox->size();
+    TEST_ASSERT_TRUE(kept <= OUTBOX_RAM_RECORDS + MemorySpill::SLOTS);
+    TEST_ASSERT_EQUAL_UINT32(total - kept, outbox->getEvictedCount());
+    TEST_ASSERT_EQUAL_UINT32(kept, drainExpecting(total - kept));
+}
+
+void test_spill_wraps_while_draining(void) {
+    outbox->setSpill(spill);
+    uint32_t next = 0;
+    uint32_t drained = 0;
+    TelemetryRecord batch[10];
+
+    // Keep adding faster than draining so the spill ring wraps several times
+    for (int round = 0; round < 40; round++) {
+        addRange(next, 6);
+        next += 6;
+        size_t count = outbox->peek(batch, 4);
+        for (size_t i = 0; i < count; i++) {
+            TEST_ASSERT_EQUAL_UINT32(drained + outbox->getEvictedCount(), batch[i].timestamp);
+            drained++;
+        }
+        outbox->pop(count);
+    }
+    uint32_t evicted = outbox->getEvictedCount();
+    drainExpecting(drained + evicted);
+    TEST_ASSERT_EQUAL_UINT32(next, outbox->getSentCount() + evicted);
+}
+
+void test_spill_write_failure_falls_back_to_eviction(void) {
+    outbox->setSpill(spill);
+    spill->fail = true;
+    addRange(0, OUTBOX_RAM_RECORDS + 3);
+    TEST_ASSERT_EQUAL(OUTBOX_RAM_RECORDS, outbox->size());
+    TEST_ASSERT_EQUAL_UINT32(3, outbox->getEvictedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, outbox->getSpillPending());
+}
+
+void test_spill_read_failure_keeps_records(void) {
+    outbox->setSpill(spill);
+    addRange(0, OUTBOX_RAM_RECORDS + 1);
+    spill->fail = true;
+    TelemetryRecord batch[10];
+    TEST_ASSERT_EQUAL(0, outbox->peek(batch, 10));
+    TEST_ASSERT_EQUAL(OUTBOX_RAM_RECORDS + 1, outbox->size());
+    spill->fail = false;
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS + 1, drainExpecting(0));
+}
+
+void test_unreadable_spill_is_dropped(void) {
+    outbox->setSpill(spill);
+    addRange(0, OUTBOX_RAM_RECORDS + 1);
+    spill->fail = true;
+    TelemetryRecord batch[10];
+    for (int i = 1; i < OUTBOX_SPILL_READ_RETRIES; i++) {
+        TEST_ASSERT_EQUAL(0, outbox->peek(batch, 10));
+    }
+    // The last retry gives up on the spill store and returns RAM records
+    TEST_ASSERT_EQUAL(10, outbox->peek(batch, 10));
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_SPILL_BATCH, batch[0].timestamp);
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_SPILL_BATCH, outbox->getDroppedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, outbox->getSpillPending());
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS + 1 - OUTBOX_SPILL_BATCH,
+                             drainExpecting(OUTBOX_SPILL_BATCH));
+}
+
+// ===== TEST SUITE 3: Batch format =====
+
+void test_format_batch(void) {
+    TelemetryRecord records[2] = {makeRecord(1700000000), makeRecord(1700000030)};
+    records[0].temperature = 21.05f;
+    records[0].valvePosition = 35;
+    records[1].humidity = NAN;
+    records[1].pressure = NAN;
+    records[1].temperature = 21.1f;
+    records[1].valvePosition = 0;
+
+    char out[256];
+    size_t length = MqttOutbox::formatBatch(records, 2, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING(
+        "[{\"ts\":1700000000,\"temperature\":21.05,\"humidity\":45.00,\"pressure\":1013.25,\"valve\":35},"
+        "{\"ts\":1700000030,\"temperature\":21.10,\"humidity\":null,\"pressure\":null,\"valve\":0}]",
+        out);
+    TEST_ASSERT_EQUAL_size_t(strlen(out), length);
+}
+
+void test_format_batch_infinity_is_null(void) {
+    TelemetryRecord record = makeRecord(7);
+    record.temperature = INFINITY;
+    record.pressure = -INFINITY;
+
+    char out[128];
+    MqttOutbox::formatBatch(&record, 1, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING(
+        "[{\"ts\":7,\"temperature\":null,\"humidity\":45.00,\"pressure\":null,\"valve\":7}]", out);
+}
+
+void test_format_batch_too_small(void) {
+    TelemetryRecord record = makeRecord(1);
+    char out[40];
+    TEST_ASSERT_EQUAL_size_t(0, MqttOutbox::formatBatch(&record, 1, out, sizeof(out)));
+}
+
+void test_format_batch_worst_case_fits(void) {
+    // MQTTManager reserves 96 bytes per record
+    TelemetryRecord records[10];
+    for (int i = 0; i < 10; i++) {
+        records[i].timestamp = 4294967295u;
+        records[i].temperature = -40.55f;
+        records[i].humidity = 100.0f;
+        records[i].pressure = 1100.99f;
+        records[i].valvePosition = 100;
+    }
+    char out[10 * 96];
+    TEST_ASSERT_TRUE(MqttOutbox::formatBatch(records, 10, out, sizeof(out)) > 0);
+}
+
+// ===== TEST SUITE 4: Metrics =====
+
+void test_metrics(void) {
+    outbox->setSpill(spill);
+    addRange(0, OUTBOX_RAM_RECORDS + OUTBOX_SPILL_BATCH);
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS + OUTBOX_SPILL_BATCH, outbox->getQueuedCount());
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_SPILL_BATCH, outbox->getSpilledCount());
+    drainExpecting(0);
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS + OUTBOX_SPILL_BATCH, outbox->getSentCount());
+    TEST_ASSERT_EQUAL_UINT32(0, outbox->getDroppedCount());
+}
+
+void test_drop_skips_head_record(void) {
+    outbox->setSpill(spill);
+    addRange(0, OUTBOX_RAM_RECORDS + 1);
+    outbox->drop(1);                    // From the spill store
+    TEST_ASSERT_EQUAL_UINT32(1, outbox->getDroppedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, outbox->getSentCount());
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS, drainExpecting(1));
+    TEST_ASSERT_EQUAL_UINT32(OUTBOX_RAM_RECORDS, outbox->getSentCount());
+    TEST_ASSERT_EQUAL_UINT32(1, outbox->getDroppedCount());
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: RAM only
+    RUN_TEST(test_empty_outbox);
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_peek_does_not_remove);
+    RUN_TEST(test_ram_full_evicts_oldest);
+
+    // Suite 2: Spill store
+    RUN_TEST(test_overflow_spills_instead_of_evicting);
+    RUN_TEST(test_full_spill_evicts_oldest);
+    RUN_TEST(test_spill_wraps_while_draining);
+    RUN_TEST(test_spill_write_failure_falls_back_to_eviction);
+    RUN_TEST(test_spill_read_failure_keeps_records);
+    RUN_TEST(test_unreadable_spill_is_dropped);
+
+    // Suite 3: Batch format
+    RUN_TEST(test_format_batch);
+    RUN_TEST(test_format_batch_infinity_is_null);
+    RUN_TEST(test_format_batch_too_small);
+    RUN_TEST(test_format_batch_worst_case_fits);
+
+    // Suite 4: Metrics
+    RUN_TEST(test_metrics);
+    RUN_TEST(test_drop_skips_head_record);
+
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_mqtt_topic_router.cpp
+ * @brief Unit tests for the sorted MQTT topic table lookup
+ *
+ * Tests cover:
+ * - Compile-time sort check (constexpr compare, duplicates, order)
+ * - Binary search hits at every position, misses and prefixes
+ * - Dispatch through member function pointers, as MQTTManager does
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include "mqtt_topic_router.h"
+
+class Receiver {
+public:
+    typedef void (Receiver::*Handler)(const char* payload, size_t length);
+    typedef MqttRoute<Handler> Route;
+
+    int valve = -1;
+    int restarts = 0;
+    size_t lastLength = 0;
+
+    static const Route* routes(size_t& count) {
+        static constexpr Route ROUTES[] = {
+            {"esp32_thermostat/mode/set",  &Receiver::onMode},
+            {"esp32_thermostat/restart",   &Receiver::onRestart},
+            {"esp32_thermostat/valve/set", &Receiver::onValve},
+            {"thermostat/valve/set",       &Receiver::onValve},
+        };
+        static_assert(mqttRoutesSorted(ROUTES), "routes must be sorted");
+        count = sizeof(ROUTES) / sizeof(ROUTES[0]);
+        return ROUTES;
+    }
+
+    bool dispatch(const char* topic, const char* payload, size_t length) {
+        size_t count;
+        const Route* table = routes(count);
+        const Route* route = findMqttRoute(table, count, topic);
+        if (route == nullptr) {
+            return false;
+        }
+        (this->*route->handler)(payload, length);
+        return true;
+    }
+
+private:
+    void onMode(const char* payload, size_t length) { lastLength = length; }
+    void onRestart(const char* payload, size_t length) { restarts++; }
+    void onValve(const char* payload, size_t length) {
+        valve = 0;
+        for (size_t i = 0; i < length; i++) {
+            valve = valve * 10 + (payload[i] - '0');
+        }
+    }
+};
+
+struct NamedRoute {
+    const char* topic;
+    int id;
+};
+
+static const NamedRoute NAMED[] = {
+    {"a", 0}, {"a/b", 1}, {"a/c", 2}, {"b", 3}, {"b/a", 4},
+};
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: Sort check =====
+
+void test_compare_matches_strcmp_sign(void) {
+    static_assert(mqttTopicCompare("a", "a") == 0, "equal");
+    static_assert(mqttTopicCompare("a", "b") < 0, "less");
+    static_assert(mqttTopicCompare("ab", "a") > 0, "longer is greater");
+    static_assert(mqttTopicCompare("a/set", "a_set") < 0, "byte order");
+    TEST_ASSERT_TRUE(mqttTopicCompare("thermostat/x", "esp32/x") > 0);
+}
+
+void test_sorted_table_detection(void) {
+    static constexpr NamedRoute SORTED[] = {{"a", 0}, {"b", 1}, {"c", 2}};
+    static constexpr NamedRoute UNSORTED[] = {{"a", 0}, {"c", 1}, {"b", 2}};
+    static constexpr NamedRoute DUPLICATE[] = {{"a", 0}, {"b", 1}, {"b", 2}};
+    static constexpr NamedRoute SINGLE[] = {{"z", 0}};
+    static_assert(mqttRoutesSorted(SORTED), "sorted");
+    static_assert(!mqttRoutesSorted(UNSORTED), "unsorted");
+    static_assert(!mqttRoutesSorted(DUPLICATE), "duplicate");
+    static_assert(mqttRoutesSorted(SINGLE), "single");
+    TEST_ASSERT_TRUE(mqttRoutesSorted(NAMED));
+}
+
+// ===== TEST SUITE 2: Lookup =====
+
+void test_finds_every_entry(void) {
+    for (int i = 0; i < 5; i++) {
+        const NamedRoute* route = findMqttRoute(NAMED, NAMED[i].topic);
+        TEST_ASSERT_NOT_NULL(route);
+        TEST_ASSERT_EQUAL(i, route->id);
+    }
+}
+
+void test_misses(void) {
+    TEST_ASSERT_NULL(findMqttRoute(NAMED, ""));
+    TEST_ASSERT_NULL(findMqttRoute(NAMED, "a/"));
+    TEST_ASSERT_NULL(findMqttRoute(NAMED, "a/bc"));
+    TEST_ASSERT_NULL(findMqttRoute(NAMED, "0"));
+    TEST_ASSERT_NULL(findMqttRoute(NAMED, "c"));
+}
+
+void test_empty_table(void) {
+    TEST_ASSERT_NULL(findMqttRoute(NAMED, 0, "a"));
+}
+
+// ===== TEST SUITE 3: Member dispatch =====
+
+void test_dispatch_to_member_handlers(void) {
+    Receiver receiver;
+    TEST_ASSERT_TRUE(receiver.dispatch("esp32_thermostat/valve/set", "42", 2));
+    TEST_ASSERT_EQUAL(42, receiver.valve);
+    TEST_ASSERT_TRUE(receiver.dispatch("thermostat/valve/set", "7", 1));
+    TEST_ASSERT_EQUAL(7, receiver.valve);
+    TEST_ASSERT_TRUE(receiver.dispatch("esp32_thermostat/restart", "", 0));
+    TEST_ASSERT_EQUAL(1, receiver.restarts);
+    TEST_ASSERT_TRUE(receiver.dispatch("esp32_thermostat/mode/set", "heat", 4));
+    TEST_ASSERT_EQUAL_size_t(4, receiver.lastLength);
+}
+
+void test_dispatch_unknown_topic(void) {
+    Receiver receiver;
+    TEST_ASSERT_FALSE(receiver.dispatch("esp32_thermostat/valve/position", "1", 1));
+    TEST_ASSERT_EQUAL(-1, receiver.valve);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Sort check
+    RUN_TEST(test_compare_matches_strcmp_sign);
+    RUN_TEST(test_sorted_table_detection);
+
+    // Suite 2: Lookup
+    RUN_TEST(test_finds_every_entry);
+    RUN_TEST(test_misses);
+    RUN_TEST(test_empty_table);
+
+    // Suite 3: Member dispatch
+    RUN_TEST(test_dispatch_to_member_handlers);
+    RUN_TEST(test_dispatch_unknown_topic);
+
+    return UNITY_END();
+}
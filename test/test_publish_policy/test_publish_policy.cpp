@@ -0,0 +1,266 @@
+/**
+ * @file test_publish_policy.cpp
+ * @brief Unit tests for the per-topic MQTT publish policy
+ *
+ * Tests cover:
+ * - First publish, absolute and relative deadbands, NaN transitions
+ * - Minimum interval and heartbeat, including millis() wraparound
+ * - Text payload change detection
+ * - invalidate() and published/skipped counters
+ * - Traffic reduction for stable sensor values
+ * - Combined messages: per-part change checks, carried parts, counters
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "publish_policy.h"
+
+enum TestTopic : uint8_t {
+    T_TEMPERATURE,
+    T_PRESSURE,
+    T_VALVE,
+    T_MODE,
+    T_UPTIME,
+    T_DOCUMENT,
+    T_COUNT
+};
+
+static const TopicPolicy POLICIES[] = {
+    {0.05f, 0.0f, 10000, 300000},   // Temperature
+    {0.0f, 0.01f, 0, 0},            // Pressure: 1% relative, no heartbeat
+    {1.0f, 0.0f, 0, 300000},        // Valve
+    {0.0f, 0.0f, 0, 600000},        // Mode (text)
+    {0.0f, 0.0f, 300000, 0},        // Uptime: rate only
+    {0.0f, 0.0f, 10000, 300000},    // Combined document
+};
+
+static PublishPolicy* policy = nullptr;
+
+// Check and, when due, record as sent; returns whether it was due
+static bool offer(uint8_t id, float value, uint32_t now) {
+    if (!policy->due(id, value, now)) {
+        return false;
+    }
+    policy->published(id, value, now);
+    return true;
+}
+
+static bool offerText(uint8_t id, const char* text, uint32_t now) {
+    if (!policy->due(id, text, now)) {
+        return false;
+    }
+    policy->published(id, text, now);
+    return true;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    policy = new PublishPolicy(POLICIES, T_COUNT);
+}
+
+void tearDown(void) {
+    delete policy;
+    policy = nullptr;
+}
+
+// ===== TEST SUITE 1: Deadbands =====
+
+void test_first_value_always_due(void) {
+    TEST_ASSERT_TRUE(policy->due(T_TEMPERATURE, 21.0f, 0));
+    TEST_ASSERT_TRUE(policy->due(T_MODE, "heat", 0));
+}
+
+void test_absolute_deadband(void) {
+    offer(T_TEMPERATURE, 21.00f, 0);
+    TEST_ASSERT_FALSE(offer(T_TEMPERATURE, 21.04f, 20000));
+    TEST_ASSERT_FALSE(offer(T_TEMPERATURE, 20.97f, 40000));
+    TEST_ASSERT_TRUE(offer(T_TEMPERATURE, 21.06f, 60000));
+}
+
+void test_deadband_measured_from_last_published(void) {
+    // Slow drift below the deadband per step still publishes once it adds up
+    offer(T_TEMPERATURE, 21.00f, 0);
+    TEST_ASSERT_FALSE(offer(T_TEMPERATURE, 21.03f, 20000));
+    TEST_ASSERT_TRUE(offer(T_TEMPERATURE, 21.06f, 40000));
+}
+
+void test_relative_deadband(void) {
+    offer(T_PRESSURE, 1000.0f, 0);
+    TEST_ASSERT_FALSE(offer(T_PRESSURE, 1009.0f, 1000));
+    TEST_ASSERT_TRUE(offer(T_PRESSURE, 1010.5f, 2000));
+}
+
+void test_nan_transitions(void) {
+    offer(T_VALVE, 20.0f, 0);
+    TEST_ASSERT_TRUE(offer(T_VALVE, NAN, 1000));
+    TEST_ASSERT_FALSE(offer(T_VALVE, NAN, 2000));
+    TEST_ASSERT_TRUE(offer(T_VALVE, 20.0f, 3000));
+}
+
+void test_text_change(void) {
+    offerText(T_MODE, "heat", 0);
+    TEST_ASSERT_FALSE(offerText(T_MODE, "heat", 1000));
+    TEST_ASSERT_TRUE(offerText(T_MODE, "off", 2000));
+    TEST_ASSERT_FALSE(offerText(T_MODE, "off", 3000));
+    TEST_ASSERT_NOT_EQUAL(PublishPolicy::hashText("heat"), PublishPolicy::hashText("off"));
+}
+
+// ===== TEST SUITE 2: Timing =====
+
+void test_min_interval_holds_back_change(void) {
+    offer(T_TEMPERATURE, 21.0f, 0);
+    TEST_ASSERT_FALSE(offer(T_TEMPERATURE, 22.0f, 9999));
+    TEST_ASSERT_TRUE(offer(T_TEMPERATURE, 22.0f, 10000));
+}
+
+void test_heartbeat_republishes_unchanged(void) {
+    offer(T_VALVE, 40.0f, 0);
+    TEST_ASSERT_FALSE(offer(T_VALVE, 40.0f, 299999));
+    TEST_ASSERT_TRUE(offer(T_VALVE, 40.0f, 300000));
+    TEST_ASSERT_FALSE(offer(T_VALVE, 40.0f, 300001));
+}
+
+void test_no_heartbeat_when_zero(void) {
+    offer(T_PRESSURE, 1000.0f, 0);
+    TEST_ASSERT_FALSE(offer(T_PRESSURE, 1000.0f, 100000000));
+}
+
+void test_rate_only_topic(void) {
+    offer(T_UPTIME, 60.0f, 60000);
+    TEST_ASSERT_FALSE(offer(T_UPTIME, 120.0f, 120000));
+    TEST_ASSERT_TRUE(offer(T_UPTIME, 360.0f, 360000));
+}
+
+void test_heartbeat_across_millis_wraparound(void) {
+    uint32_t start = 0xFFFFFF00u;
+    offer(T_VALVE, 10.0f, start);
+    TEST_ASSERT_FALSE(offer(T_VALVE, 10.0f, start + 1000));
+    TEST_ASSERT_TRUE(offer(T_VALVE, 10.0f, start + 300000));
+}
+
+// ===== TEST SUITE 3: Bookkeeping =====
+
+void test_invalidate_makes_everything_due(void) {
+    offer(T_TEMPERATURE, 21.0f, 0);
+    offerText(T_MODE, "heat", 0);
+    policy->invalidate();
+    TEST_ASSERT_TRUE(policy->due(T_TEMPERATURE, 21.0f, 1));
+    TEST_ASSERT_TRUE(policy->due(T_MODE, "heat", 1));
+}
+
+void test_counters(void) {
+    offer(T_VALVE, 10.0f, 0);
+    offer(T_VALVE, 10.0f, 1000);
+    offer(T_VALVE, 10.0f, 2000);
+    offer(T_VALVE, 50.0f, 3000);
+    TEST_ASSERT_EQUAL_UINT32(2, policy->getPublishedCount());
+    TEST_ASSERT_EQUAL_UINT32(2, policy->getSkippedCount());
+}
+
+void test_unknown_topic_always_due(void) {
+    TEST_ASSERT_TRUE(offer(T_COUNT + 3, 1.0f, 0));
+    TEST_ASSERT_TRUE(offer(T_COUNT + 3, 1.0f, 1));
+}
+
+void test_stable_values_cut_traffic_by_80_percent(void) {
+    // One hour of 30 s sensor cycles: temperature jitters by +-0.02,
+    // valve and mode do not change. Unfiltered this is 3 messages per cycle.
+    uint32_t sent = 0;
+    uint32_t offered = 0;
+    for (uint32_t now = 0; now < 3600000; now += 30000) {
+        float jitter = ((now / 30000) % 3 == 0) ? 0.02f : -0.02f;
+        sent += offer(T_TEMPERATURE, 21.0f + jitter, now);
+        sent += offer(T_VALVE, 35.0f, now);
+        sent += offerText(T_MODE, "heat", now);
+        offered += 3;
+    }
+    TEST_ASSERT_TRUE(sent * 5 <= offered);
+}
+
+// ===== TEST SUITE 4: Combined messages =====
+
+// Send temperature and valve in one document when either changed
+static bool offerDocument(float temperature, float valve, uint32_t now) {
+    bool changed = policy->changed(T_TEMPERATURE, temperature) || policy->changed(T_VALVE, valve);
+    if (!policy->dueOnChange(T_DOCUMENT, changed, now)) {
+        return false;
+    }
+    policy->carried(T_TEMPERATURE, temperature, now);
+    policy->carried(T_VALVE, valve, now);
+    policy->published(T_DOCUMENT, 0.0f, now);
+    return true;
+}
+
+void test_changed_does_not_count(void) {
+    TEST_ASSERT_TRUE(policy->changed(T_TEMPERATURE, 21.0f));
+    TEST_ASSERT_TRUE(policy->changed(T_MODE, "heat"));
+    policy->carried(T_TEMPERATURE, 21.0f, 0);
+    policy->carried(T_MODE, "heat", 0);
+    TEST_ASSERT_FALSE(policy->changed(T_TEMPERATURE, 21.02f));
+    TEST_ASSERT_TRUE(policy->changed(T_TEMPERATURE, 21.1f));
+    TEST_ASSERT_FALSE(policy->changed(T_MODE, "heat"));
+    TEST_ASSERT_TRUE(policy->changed(T_MODE, "off"));
+    TEST_ASSERT_EQUAL_UINT32(0, policy->getPublishedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, policy->getSkippedCount());
+}
+
+void test_document_sent_when_any_part_changed(void) {
+    TEST_ASSERT_TRUE(offerDocument(21.0f, 30.0f, 0));
+    TEST_ASSERT_FALSE(offerDocument(21.02f, 30.0f, 30000));
+    TEST_ASSERT_TRUE(offerDocument(21.02f, 45.0f, 60000));
+    // Held back by the document's own minimum interval
+    TEST_ASSERT_FALSE(offerDocument(22.0f, 45.0f, 65000));
+    TEST_ASSERT_TRUE(offerDocument(22.0f, 45.0f, 90000));
+}
+
+void test_document_counts_one_message(void) {
+    offerDocument(21.0f, 30.0f, 0);
+    offerDocument(21.0f, 30.0f, 30000);
+    offerDocument(25.0f, 30.0f, 60000);
+    TEST_ASSERT_EQUAL_UINT32(2, policy->getPublishedCount());
+    TEST_ASSERT_EQUAL_UINT32(1, policy->getSkippedCount());
+}
+
+void test_document_heartbeat(void) {
+    offerDocument(21.0f, 30.0f, 0);
+    TEST_ASSERT_FALSE(offerDocument(21.0f, 30.0f, 299999));
+    TEST_ASSERT_TRUE(offerDocument(21.0f, 30.0f, 300000));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Deadbands
+    RUN_TEST(test_first_value_always_due);
+    RUN_TEST(test_absolute_deadband);
+    RUN_TEST(test_deadband_measured_from_last_published);
+    RUN_TEST(test_relative_deadband);
+    RUN_TEST(test_nan_transitions);
+    RUN_TEST(test_text_change);
+
+    // Suite 2: Timing
+    RUN_TEST(test_min_interval_holds_back_change);
+    RUN_TEST(test_heartbeat_republishes_unchanged);
+    RUN_TEST(test_no_heartbeat_when_zero);
+    RUN_TEST(test_rate_only_topic);
+    RUN_TEST(test_heartbeat_across_millis_wraparound);
+
+    // Suite 3: Bookkeeping
+    RUN_TEST(test_invalidate_makes_everything_due);
+    RUN_TEST(test_counters);
+    RUN_TEST(test_unknown_topic_always_due);
+    RUN_TEST(test_stable_values_cut_traffic_by_80_percent);
+
+    // Suite 4: Combined messages
+    RUN_TEST(test_changed_does_not_count);
+    RUN_TEST(test_document_sent_when_any_part_changed);
+    RUN_TEST(test_document_counts_one_message);
+    RUN_TEST(test_document_heartbeat);
+
+    return UNITY_END();
+}
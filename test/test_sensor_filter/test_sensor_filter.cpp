@@ -0,0 +1,253 @@
+/**
+ * @file test_sensor_filter.cpp
+ * @brief Unit tests for the sensor filter pipeline
+ *
+ * Tests cover:
+ * - Seeding and pass-through configuration
+ * - Median-of-N spike rejection
+ * - EMA and Kalman smoothing convergence
+ * - Outlier gating and step-change resync
+ * - Configuration clamping and statistics
+ *
+ * Target Coverage: 80%
+ */
+
+#include <unity.h>
+#include <cmath>
+#include "sensor_filter.h"
+
+static SensorFilterPipeline* filter = nullptr;
+
+static SensorFilterConfig makeConfig(uint8_t median, uint8_t smoothing, float alpha, float gate) {
+    SensorFilterConfig config;
+    config.medianWindow = median;
+    config.smoothing = smoothing;
+    config.emaAlpha = alpha;
+    config.kalmanProcessNoise = 0.001f;
+    config.kalmanMeasurementNoise = 0.01f;
+    config.outlierThreshold = gate;
+    return config;
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    filter = new SensorFilterPipeline();
+}
+
+void tearDown(void) {
+    delete filter;
+    filter = nullptr;
+}
+
+// ===== TEST SUITE 1: Basic Behaviour =====
+
+void test_initially_empty(void) {
+    TEST_ASSERT_FALSE(filter->hasValue());
+    TEST_ASSERT_TRUE(std::isnan(filter->getValue()));
+    TEST_ASSERT_EQUAL_UINT32(0, filter->getStats().samples);
+}
+
+void test_first_sample_seeds_output(void) {
+    float out = 0.0f;
+    TEST_ASSERT_TRUE(filter->process(21.3f, NAN, out));
+
+    TEST_ASSERT_TRUE(filter->hasValue());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 21.3f, out);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 21.3f, filter->getValue());
+}
+
+void test_pass_through_when_disabled(void) {
+    filter->configure(makeConfig(1, SMOOTHING_NONE, 1.0f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    filter->process(25.0f, 20.0f, out);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 25.0f, out);
+}
+
+// ===== TEST SUITE 2: Median Stage =====
+
+void test_median_rejects_single_spike(void) {
+    filter->configure(makeConfig(3, SMOOTHING_NONE, 1.0f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    filter->process(20.0f, 20.0f, out);
+    filter->process(23.0f, 20.0f, out);  // single-sample spike
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 20.0f, out);
+    TEST_ASSERT_EQUAL_UINT32(1, filter->getStats().spikesSuppressed);
+}
+
+void test_median_follows_sustained_change(void) {
+    filter->configure(makeConfig(3, SMOOTHING_NONE, 1.0f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    filter->process(21.0f, 20.0f, out);
+    filter->process(21.0f, 21.0f, out);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 21.0f, out);
+}
+
+void test_median_window_five(void) {
+    filter->configure(makeConfig(5, SMOOTHING_NONE, 1.0f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    filter->process(24.0f, 20.0f, out);
+    filter->process(16.0f, 20.0f, out);
+
+    // Window holds 20,20,20,24,16 after seeding - median stays at 20
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 20.0f, out);
+}
+
+// ===== TEST SUITE 3: Smoothing Stage =====
+
+void test_ema_moves_towards_new_value(void) {
+    filter->configure(makeConfig(1, SMOOTHING_EMA, 0.5f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    filter->process(22.0f, 20.0f, out);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 21.0f, out);
+}
+
+void test_ema_converges(void) {
+    filter->configure(makeConfig(1, SMOOTHING_EMA, 0.5f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    for (int i = 0; i < 20; i++) {
+        filter->process(22.0f, 22.0f, out);
+    }
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 22.0f, out);
+}
+
+void test_kalman_reduces_noise(void) {
+    filter->configure(makeConfig(1, SMOOTHING_KALMAN, 1.0f, 0.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    float maxDeviation = 0.0f;
+    for (int i = 0; i < 50; i++) {
+        float noisy = 20.0f + ((i % 2) ? 0.2f : -0.2f);
+        filter->process(noisy, 20.0f, out);
+        if (i > 10) {
+            maxDeviation = fmaxf(maxDeviation, fabsf(out - 20.0f));
+        }
+    }
+
+    // Alternating +/-0.2 noise should be attenuated well below its amplitude
+    TEST_ASSERT_TRUE(maxDeviation < 0.1f);
+}
+
+// ===== TEST SUITE 4: Outlier Gate =====
+
+void test_gate_rejects_outlier(void) {
+    filter->configure(makeConfig(1, SMOOTHING_NONE, 1.0f, 2.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    TEST_ASSERT_FALSE(filter->process(60.0f, 20.0f, out));
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 20.0f, filter->getValue());
+    TEST_ASSERT_EQUAL_UINT32(1, filter->getStats().outliersRejected);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 60.0f, filter->getStats().lastRejected);
+}
+
+void test_gate_accepts_persistent_step(void) {
+    filter->configure(makeConfig(3, SMOOTHING_EMA, 0.5f, 2.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    TEST_ASSERT_FALSE(filter->process(15.0f, 20.0f, out));
+    TEST_ASSERT_FALSE(filter->process(15.0f, 20.0f, out));
+    TEST_ASSERT_TRUE(filter->process(15.0f, 20.0f, out));
+
+    // Resync re-seeds every stage at the new level
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 15.0f, out);
+    TEST_ASSERT_EQUAL_UINT32(1, filter->getStats().gateResyncs);
+    TEST_ASSERT_EQUAL_UINT32(2, filter->getStats().outliersRejected);
+}
+
+void test_gate_counter_resets_on_good_sample(void) {
+    filter->configure(makeConfig(1, SMOOTHING_NONE, 1.0f, 2.0f));
+    float out = 0.0f;
+
+    filter->process(20.0f, NAN, out);
+    filter->process(30.0f, 20.0f, out);
+    filter->process(20.1f, 20.0f, out);
+    filter->process(30.0f, 20.1f, out);
+
+    TEST_ASSERT_EQUAL_UINT32(0, filter->getStats().gateResyncs);
+    TEST_ASSERT_EQUAL_UINT32(2, filter->getStats().outliersRejected);
+}
+
+void test_gate_ignored_without_reference(void) {
+    filter->configure(makeConfig(1, SMOOTHING_NONE, 1.0f, 2.0f));
+    float out = 0.0f;
+
+    TEST_ASSERT_TRUE(filter->process(50.0f, NAN, out));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 50.0f, out);
+}
+
+// ===== TEST SUITE 5: Configuration =====
+
+void test_configure_clamps_invalid_values(void) {
+    filter->configure(makeConfig(4, 7, 3.0f, -1.0f));
+    const SensorFilterConfig& config = filter->getConfig();
+
+    TEST_ASSERT_EQUAL_UINT8(3, config.medianWindow);
+    TEST_ASSERT_EQUAL_UINT8(SMOOTHING_NONE, config.smoothing);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, config.emaAlpha);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, config.outlierThreshold);
+}
+
+void test_reset_clears_state_and_stats(void) {
+    float out = 0.0f;
+    filter->process(20.0f, NAN, out);
+    filter->process(21.0f, 20.0f, out);
+
+    filter->reset();
+
+    TEST_ASSERT_FALSE(filter->hasValue());
+    TEST_ASSERT_EQUAL_UINT32(0, filter->getStats().samples);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Basic Behaviour
+    RUN_TEST(test_initially_empty);
+    RUN_TEST(test_first_sample_seeds_output);
+    RUN_TEST(test_pass_through_when_disabled);
+
+    // Suite 2: Median Stage
+    RUN_TEST(test_median_rejects_single_spike);
+    RUN_TEST(test_median_follows_sustained_change);
+    RUN_TEST(test_median_window_five);
+
+    // Suite 3: Smoothing Stage
+    RUN_TEST(test_ema_moves_towards_new_value);
+    RUN_TEST(test_ema_converges);
+    RUN_TEST(test_kalman_reduces_noise);
+
+    // Suite 4: Outlier Gate
+    RUN_TEST(test_gate_rejects_outlier);
+    RUN_TEST(test_gate_accepts_persistent_step);
+    RUN_TEST(test_gate_counter_resets_on_good_sample);
+    RUN_TEST(test_gate_ignored_without_reference);
+
+    // Suite 5: Configuration
+    RUN_TEST(test_configure_clamps_invalid_values);
+    RUN_TEST(test_reset_clears_state_and_stats);
+
+    return UNITY_END();
+}
@@ -302,6 +302,25 @@ void test_failure_rate_with_wraparound(void) {
     TEST_ASSERT_FLOAT_WITHIN(1.0f, 0.0f, monitor->getFailureRate());
 }
 
+void test_failure_rate_exact_after_partial_eviction(void) {
+    SensorHealthMonitor* monitor = SensorHealthMonitor::getInstance();
+
+    // 30 failures followed by 270 successes fill the window
+    for (int i = 0; i < 30; i++) {
+        monitor->recordReading(false, NAN);
+    }
+    for (int i = 0; i < 270; i++) {
+        monitor->recordReading(true, 22.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 10.0f, monitor->getFailureRate());
+
+    // Ten more successes evict exactly ten of the old failures
+    for (int i = 0; i < 10; i++) {
+        monitor->recordReading(true, 22.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f / 3.0f, monitor->getFailureRate());
+}
+
 // ===== TEST SUITE 7: Edge Cases =====
 
 void test_nan_value(void) {
@@ -375,6 +394,7 @@ int main(int argc, char **argv) {
     // Suite 6: History Buffer
     RUN_TEST(test_history_buffer_size);
     RUN_TEST(test_failure_rate_with_wraparound);
+    RUN_TEST(test_failure_rate_exact_after_partial_eviction);
 
     // Suite 7: Edge Cases
     RUN_TEST(test_nan_value);
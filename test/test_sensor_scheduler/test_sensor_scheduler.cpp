@@ -0,0 +1,305 @@
+/**
+ * @file test_sensor_scheduler.cpp
+ * @brief Unit tests for the non-blocking sensor scheduler
+ *
+ * Tests cover:
+ * - Cycle lifecycle (request, completion, consume once)
+ * - Overlapping conversions on different buses
+ * - One transaction per bus per loop iteration
+ * - Missing sensors, read failures and conversion timeouts
+ *
+ * Target Coverage: 80%
+ */
+
+#include <unity.h>
+#include "sensor_scheduler.h"
+
+/**
+ * @brief Scriptable driver that records every bus transaction
+ */
+class FakeSensor : public SensorDriver {
+public:
+    FakeSensor(const char* name, SensorBus bus, uint32_t conversionMs)
+        : name(name), bus(bus), conversionMs(conversionMs),
+          present(true), acceptStart(true), readOk(true), neverReady(false),
+          value(20.0f), starts(0), reads(0) {}
+
+    const char* getName() const override { return name; }
+    SensorBus getBus() const override { return bus; }
+    bool begin() override { return present; }
+    uint32_t getConversionTimeMs() const override { return conversionMs; }
+
+    bool startConversion() override {
+        starts++;
+        return acceptStart;
+    }
+
+    bool isReady(unsigned long elapsedMs) override {
+        return !neverReady && SensorDriver::isReady(elapsedMs);
+    }
+
+    bool readSample(SensorSample& sample) override {
+        reads++;
+        sample.temperature = value;
+        return readOk;
+    }
+
+    const char* name;
+    SensorBus bus;
+    uint32_t conversionMs;
+    bool present;
+    bool acceptStart;
+    bool readOk;
+    bool neverReady;
+    float value;
+    int starts;
+    int reads;
+};
+
+static SensorScheduler* scheduler = nullptr;
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    scheduler = new SensorScheduler();
+}
+
+void tearDown(void) {
+    delete scheduler;
+    scheduler = nullptr;
+}
+
+// Run loop() in fixed steps until the cycle completes; returns the completion time
+static unsigned long runCycle(unsigned long start, unsigned long step, unsigned long limit) {
+    unsigned long now = start;
+    while (now - start <= limit) {
+        scheduler->loop(now);
+        if (!scheduler->isBusy()) {
+            return now;
+        }
+        now += step;
+    }
+    return now;
+}
+
+// ===== TEST SUITE 1: Cycle Lifecycle =====
+
+void test_single_sensor_cycle(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    room.value = 21.5f;
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    TEST_ASSERT_EQUAL_UINT8(1, scheduler->begin());
+
+    TEST_ASSERT_TRUE(scheduler->requestCycle(1000));
+    TEST_ASSERT_TRUE(scheduler->isBusy());
+
+    scheduler->loop(1000);  // start
+    scheduler->loop(1001);  // read
+
+    TEST_ASSERT_FALSE(scheduler->isBusy());
+    const SensorSample& sample = scheduler->getSample(0);
+    TEST_ASSERT_TRUE(sample.valid);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, sample.temperature);
+    TEST_ASSERT_EQUAL_UINT32(1001, sample.timestamp);
+}
+
+void test_consume_cycle_once(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    scheduler->begin();
+
+    TEST_ASSERT_FALSE(scheduler->consumeCycle());
+    scheduler->requestCycle(0);
+    runCycle(0, 1, 100);
+
+    TEST_ASSERT_TRUE(scheduler->consumeCycle());
+    TEST_ASSERT_FALSE(scheduler->consumeCycle());
+}
+
+void test_request_rejected_while_busy(void) {
+    FakeSensor probe("PROBE", SENSOR_BUS_ONEWIRE, 750);
+    scheduler->addSensor(&probe, SENSOR_ROLE_RADIATOR_RETURN);
+    scheduler->begin();
+
+    TEST_ASSERT_TRUE(scheduler->requestCycle(0));
+    scheduler->loop(0);
+    TEST_ASSERT_FALSE(scheduler->requestCycle(10));
+    TEST_ASSERT_EQUAL_INT(1, probe.starts);
+}
+
+void test_find_by_role(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    FakeSensor probe("PROBE", SENSOR_BUS_ONEWIRE, 750);
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    scheduler->addSensor(&probe, SENSOR_ROLE_RADIATOR_RETURN);
+
+    TEST_ASSERT_EQUAL_INT(0, scheduler->findByRole(SENSOR_ROLE_ROOM));
+    TEST_ASSERT_EQUAL_INT(1, scheduler->findByRole(SENSOR_ROLE_RADIATOR_RETURN));
+    TEST_ASSERT_EQUAL_INT(-1, scheduler->findByRole(SENSOR_ROLE_AUXILIARY));
+}
+
+void test_table_full(void) {
+    FakeSensor sensor("S", SENSOR_BUS_I2C, 0);
+    for (uint8_t i = 0; i < SensorScheduler::MAX_SENSORS; i++) {
+        TEST_ASSERT_EQUAL_INT(i, scheduler->addSensor(&sensor, SENSOR_ROLE_AUXILIARY));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, scheduler->addSensor(&sensor, SENSOR_ROLE_AUXILIARY));
+}
+
+// ===== TEST SUITE 2: Interleaving =====
+
+void test_conversions_overlap_across_buses(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    FakeSensor probe("PROBE", SENSOR_BUS_ONEWIRE, 750);
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    scheduler->addSensor(&probe, SENSOR_ROLE_RADIATOR_RETURN);
+    scheduler->begin();
+
+    scheduler->requestCycle(0);
+    scheduler->loop(0);
+
+    // Both buses get their first transaction in the same iteration
+    TEST_ASSERT_EQUAL_INT(1, room.starts);
+    TEST_ASSERT_EQUAL_INT(1, probe.starts);
+
+    unsigned long done = runCycle(10, 10, 2000);
+    TEST_ASSERT_EQUAL_UINT32(750, done);
+    TEST_ASSERT_EQUAL_UINT32(750, scheduler->getLastCycleDuration());
+    TEST_ASSERT_EQUAL_INT(1, room.reads);
+    TEST_ASSERT_EQUAL_INT(1, probe.reads);
+}
+
+void test_one_transaction_per_bus_per_loop(void) {
+    FakeSensor a("A", SENSOR_BUS_I2C, 0);
+    FakeSensor b("B", SENSOR_BUS_I2C, 0);
+    scheduler->addSensor(&a, SENSOR_ROLE_ROOM);
+    scheduler->addSensor(&b, SENSOR_ROLE_AUXILIARY);
+    scheduler->begin();
+
+    scheduler->requestCycle(0);
+    for (unsigned long now = 0; scheduler->isBusy() && now < 10; now++) {
+        int before = a.starts + a.reads + b.starts + b.reads;
+        scheduler->loop(now);
+        int after = a.starts + a.reads + b.starts + b.reads;
+        TEST_ASSERT_LESS_OR_EQUAL(1, after - before);
+    }
+
+    TEST_ASSERT_FALSE(scheduler->isBusy());
+    TEST_ASSERT_EQUAL_INT(1, a.reads);
+    TEST_ASSERT_EQUAL_INT(1, b.reads);
+}
+
+void test_round_robin_start_position(void) {
+    FakeSensor a("A", SENSOR_BUS_I2C, 0);
+    FakeSensor b("B", SENSOR_BUS_I2C, 0);
+    scheduler->addSensor(&a, SENSOR_ROLE_ROOM);
+    scheduler->addSensor(&b, SENSOR_ROLE_AUXILIARY);
+    scheduler->begin();
+
+    // First cycle starts with slot 0; one loop() rotates the start to slot 1
+    scheduler->requestCycle(0);
+    scheduler->loop(0);
+    TEST_ASSERT_EQUAL_INT(1, a.starts);
+    TEST_ASSERT_EQUAL_INT(0, b.starts);
+    runCycle(1, 1, 100);
+
+    int aBefore = a.starts;
+    int bBefore = b.starts;
+    scheduler->requestCycle(200);
+    scheduler->loop(200);
+
+    // Exactly one sensor got the bus, and it was not always slot 0
+    TEST_ASSERT_EQUAL_INT(1, (a.starts - aBefore) + (b.starts - bBefore));
+}
+
+// ===== TEST SUITE 3: Failures =====
+
+void test_missing_sensor_skipped(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    FakeSensor probe("PROBE", SENSOR_BUS_ONEWIRE, 750);
+    probe.present = false;
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    scheduler->addSensor(&probe, SENSOR_ROLE_RADIATOR_RETURN);
+
+    TEST_ASSERT_EQUAL_UINT8(1, scheduler->begin());
+    TEST_ASSERT_FALSE(scheduler->isPresent(1));
+
+    scheduler->requestCycle(0);
+    runCycle(0, 1, 100);
+
+    TEST_ASSERT_EQUAL_INT(0, probe.starts);
+    TEST_ASSERT_FALSE(scheduler->getSample(1).valid);
+    TEST_ASSERT_TRUE(scheduler->getSample(0).valid);
+}
+
+void test_read_failure_counts_error(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    scheduler->begin();
+
+    scheduler->requestCycle(0);
+    runCycle(0, 1, 100);
+    TEST_ASSERT_TRUE(scheduler->getSample(0).valid);
+
+    room.readOk = false;
+    scheduler->requestCycle(100);
+    runCycle(100, 1, 100);
+
+    TEST_ASSERT_FALSE(scheduler->getSample(0).valid);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler->getErrorCount(0));
+}
+
+void test_start_failure_counts_error(void) {
+    FakeSensor room("ROOM", SENSOR_BUS_I2C, 0);
+    room.acceptStart = false;
+    scheduler->addSensor(&room, SENSOR_ROLE_ROOM);
+    scheduler->begin();
+
+    scheduler->requestCycle(0);
+    scheduler->loop(0);
+
+    TEST_ASSERT_FALSE(scheduler->isBusy());
+    TEST_ASSERT_EQUAL_INT(0, room.reads);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler->getErrorCount(0));
+}
+
+void test_conversion_timeout(void) {
+    FakeSensor probe("PROBE", SENSOR_BUS_ONEWIRE, 750);
+    probe.neverReady = true;
+    scheduler->addSensor(&probe, SENSOR_ROLE_RADIATOR_RETURN);
+    scheduler->begin();
+
+    scheduler->requestCycle(0);
+    unsigned long done = runCycle(0, 100, 5000);
+
+    TEST_ASSERT_FALSE(scheduler->isBusy());
+    TEST_ASSERT_GREATER_THAN(750 + SensorScheduler::CONVERSION_TIMEOUT_MARGIN_MS, done);
+    TEST_ASSERT_EQUAL_INT(0, probe.reads);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler->getErrorCount(0));
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Cycle Lifecycle
+    RUN_TEST(test_single_sensor_cycle);
+    RUN_TEST(test_consume_cycle_once);
+    RUN_TEST(test_request_rejected_while_busy);
+    RUN_TEST(test_find_by_role);
+    RUN_TEST(test_table_full);
+
+    // Suite 2: Interleaving
+    RUN_TEST(test_conversions_overlap_across_buses);
+    RUN_TEST(test_one_transaction_per_bus_per_loop);
+    RUN_TEST(test_round_robin_start_position);
+
+    // Suite 3: Failures
+    RUN_TEST(test_missing_sensor_skipped);
+    RUN_TEST(test_read_failure_counts_error);
+    RUN_TEST(test_start_failure_counts_error);
+    RUN_TEST(test_conversion_timeout);
+
+    return UNITY_END();
+}
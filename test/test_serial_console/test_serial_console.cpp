@@ -0,0 +1,211 @@
+/**
+ * @file test_serial_console.cpp
+ * @brief Unit tests for the non-blocking serial command console
+ *
+ * Tests cover:
+ * - Line editing: partial lines, echo, backspace, CR/LF handling, overlong input
+ * - Splitting lines into arguments and dispatching to registered commands
+ * - Unknown commands and the command table limits
+ * - Lines handed over from another task with submit()/loop()
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <string>
+#include "serial_console.h"
+
+// Collects everything written to it
+class CaptureOutput : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+};
+
+// Serves a fixed string as received bytes
+class FakeUart : public Stream {
+public:
+    std::string input;
+    size_t position = 0;
+    std::string echo;
+    int available() override { return (int)(input.size() - position); }
+    int read() override { return position < input.size() ? (uint8_t)input[position++] : -1; }
+    size_t write(uint8_t c) override {
+        echo += (char)c;
+        return 1;
+    }
+    void feed(const char* text) {
+        input.append(text);
+    }
+};
+
+static CaptureOutput output;
+static FakeUart uart;
+static std::string lastArgs;
+static int calls = 0;
+
+static void recordArgs(int argc, char** argv, Print& out) {
+    calls++;
+    lastArgs.clear();
+    for (int i = 0; i < argc; i++) {
+        lastArgs += (i > 0 ? "|" : "");
+        lastArgs += argv[i];
+    }
+    out.print("ok\n");
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    static bool registered = false;
+    if (!registered) {
+        SerialConsole::getInstance().addCommand("echo", "Print the arguments", recordArgs);
+        registered = true;
+    }
+    SerialConsole::getInstance().begin(&output);
+    output.text.clear();
+    uart.input.clear();
+    uart.position = 0;
+    uart.echo.clear();
+    lastArgs.clear();
+    calls = 0;
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: Line editing =====
+
+void test_partial_line_does_not_run(void) {
+    SerialConsole& console = SerialConsole::getInstance();
+    uart.feed("echo a");
+    console.poll(uart);
+    TEST_ASSERT_EQUAL(0, calls);
+    TEST_ASSERT_EQUAL_STRING("echo a", uart.echo.c_str());
+
+    // The rest arrives on a later loop pass
+    uart.feed("b\n");
+    console.poll(uart);
+    TEST_ASSERT_EQUAL(1, calls);
+    TEST_ASSERT_EQUAL_STRING("echo|ab", lastArgs.c_str());
+}
+
+void test_backspace_edits_line(void) {
+    uart.feed("echo xy\b\x7Fz\r");
+    SerialConsole::getInstance().poll(uart);
+    TEST_ASSERT_EQUAL_STRING("echo|z", lastArgs.c_str());
+    TEST_ASSERT_EQUAL_STRING("echo xy\b \b\b \bz\r\n", uart.echo.c_str());
+}
+
+void test_crlf_runs_once(void) {
+    uart.feed("echo 1\r\necho 2\n\recho 3\r\n");
+    SerialConsole::getInstance().poll(uart);
+    TEST_ASSERT_EQUAL(3, calls);
+    TEST_ASSERT_EQUAL_STRING("echo|3", lastArgs.c_str());
+}
+
+void test_overlong_line_truncated(void) {
+    std::string line = "echo ";
+    line.append(200, 'x');
+    line += "\n";
+    uart.feed(line.c_str());
+    SerialConsole::getInstance().poll(uart);
+    TEST_ASSERT_EQUAL(1, calls);
+    TEST_ASSERT_EQUAL_UINT32(SERIAL_CONSOLE_LINE_SIZE - 1, lastArgs.size());
+}
+
+// ===== TEST SUITE 2: Dispatch =====
+
+void test_arguments_split_on_whitespace(void) {
+    char line[] = "  ECHO  one\ttwo   three  ";
+    TEST_ASSERT_TRUE(SerialConsole::getInstance().execute(line));
+    TEST_ASSERT_EQUAL_STRING("ECHO|one|two|three", lastArgs.c_str());
+}
+
+void test_extra_arguments_ignored(void) {
+    char line[] = "echo 1 2 3 4 5 6 7 8";
+    SerialConsole::getInstance().execute(line);
+    TEST_ASSERT_EQUAL_STRING("echo|1|2|3|4|5", lastArgs.c_str());
+}
+
+void test_unknown_and_empty_lines(void) {
+    SerialConsole& console = SerialConsole::getInstance();
+    char unknown[] = "reboot now";
+    TEST_ASSERT_FALSE(console.execute(unknown));
+    TEST_ASSERT_TRUE(output.text.find("Unknown command 'reboot'") != std::string::npos);
+
+    char empty[] = "   ";
+    TEST_ASSERT_FALSE(console.execute(empty));
+    TEST_ASSERT_EQUAL(0, calls);
+}
+
+void test_help_lists_commands(void) {
+    char line[] = "help";
+    SerialConsole::getInstance().execute(line);
+    TEST_ASSERT_TRUE(output.text.find("help") != std::string::npos);
+    TEST_ASSERT_TRUE(output.text.find("Print the arguments") != std::string::npos);
+}
+
+void test_duplicate_and_full_table_rejected(void) {
+    SerialConsole& console = SerialConsole::getInstance();
+    TEST_ASSERT_FALSE(console.addCommand("echo", "Again", recordArgs));
+
+    static const char* names[] = {"c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7", "c8",
+                                  "c9", "c10", "c11", "c12", "c13", "c14", "c15", "c16"};
+    int added = 0;
+    for (const char* name : names) {
+        if (console.addCommand(name, "", recordArgs)) {
+            added++;
+        }
+    }
+    TEST_ASSERT_EQUAL(SERIAL_CONSOLE_MAX_COMMANDS - 2, added);
+}
+
+// ===== TEST SUITE 3: Lines from another task =====
+
+void test_submitted_line_runs_in_loop(void) {
+    SerialConsole& console = SerialConsole::getInstance();
+    TEST_ASSERT_TRUE(console.submit("echo web\n", 9));
+    TEST_ASSERT_EQUAL(0, calls);
+
+    // Only one line may wait at a time
+    TEST_ASSERT_FALSE(console.submit("echo other", 10));
+
+    console.loop();
+    TEST_ASSERT_EQUAL(1, calls);
+    TEST_ASSERT_EQUAL_STRING("echo|web", lastArgs.c_str());
+    TEST_ASSERT_TRUE(output.text.find("> echo web\n") == 0);
+
+    console.loop();
+    TEST_ASSERT_EQUAL(1, calls);
+    TEST_ASSERT_TRUE(console.submit("echo again", 10));
+    console.loop();
+    TEST_ASSERT_EQUAL(2, calls);
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Line editing
+    RUN_TEST(test_partial_line_does_not_run);
+    RUN_TEST(test_backspace_edits_line);
+    RUN_TEST(test_crlf_runs_once);
+    RUN_TEST(test_overlong_line_truncated);
+
+    // Suite 2: Dispatch
+    RUN_TEST(test_arguments_split_on_whitespace);
+    RUN_TEST(test_extra_arguments_ignored);
+    RUN_TEST(test_unknown_and_empty_lines);
+    RUN_TEST(test_help_lists_commands);
+    RUN_TEST(test_duplicate_and_full_table_rejected);
+
+    // Suite 3: Lines from another task
+    RUN_TEST(test_submitted_line_runs_in_loop);
+
+    return UNITY_END();
+}
@@ -0,0 +1,304 @@
+/**
+ * @file test_telegraph_aggregate.cpp
+ * @brief Unit tests for the 'telegraph' aggregate encoder
+ *
+ * Tests cover:
+ * - Exact JSON output, per-field rounding and null for unknown values
+ * - Field group selection, including the shared "health" map
+ * - MessagePack byte layout: maps, strings, float32, integer widths, nil
+ * - MessagePack size against JSON and worst case within TELEGRAPH_BUFFER_SIZE
+ * - Buffer too small
+ * - Group and format names
+ *
+ * Target Coverage: 90%
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "telegraph_aggregate.h"
+
+static TelegraphSample makeSample() {
+    TelegraphSample sample;
+    sample.temperature = 21.5f;
+    sample.humidity = 45.2f;
+    sample.pressure = 1013.25f;
+    sample.valvePosition = 40;
+    sample.kp = 2.0f;
+    sample.ki = 0.1f;
+    sample.kd = 0.05f;
+    sample.setpoint = 21.0f;
+    sample.heat = true;
+    strcpy(sample.preset, "comfort");
+    sample.wifiRSSI = -61;
+    sample.uptime = 3600;
+    sample.sensorHealthy = true;
+    sample.sensorFailureRate = 0.0f;
+    sample.sensorConsecutiveFailures = 0;
+    sample.valveHealthy = true;
+    sample.valveErrorPct = 1.5f;
+    sample.freeHeap = 151234;
+    sample.heapFragmentation = 12.5f;
+    return sample;
+}
+
+static uint8_t out[TELEGRAPH_BUFFER_SIZE];
+
+static size_t encodeJson(const TelegraphSample& sample, uint8_t fields) {
+    memset(out, 0, sizeof(out));
+    return encodeTelegraph(sample, fields, TELEGRAPH_JSON, out, sizeof(out) - 1);
+}
+
+static size_t encodeMsgPack(const TelegraphSample& sample, uint8_t fields) {
+    memset(out, 0, sizeof(out));
+    return encodeTelegraph(sample, fields, TELEGRAPH_MSGPACK, out, sizeof(out));
+}
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// ===== TEST SUITE 1: JSON =====
+
+void test_json_all_fields_exact(void) {
+    size_t length = encodeJson(makeSample(), TELEGRAPH_ALL_FIELDS);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"temperature\":21.5,\"humidity\":45.2,\"pressure\":1013.25,"
+        "\"valve_position\":40,\"action\":\"heating\",\"heating_state\":\"ON\","
+        "\"pid\":{\"kp\":2,\"ki\":0.1,\"kd\":0.05,\"setpoint\":21},"
+        "\"mode\":\"heat\",\"preset\":\"comfort\",\"wifi\":{\"rssi\":-61},\"uptime\":3600,"
+        "\"status\":\"online\",\"health\":{\"sensor_healthy\":true,\"sensor_failure_rate\":0,"
+        "\"sensor_consecutive_failures\":0,\"valve_healthy\":true,\"valve_error_pct\":1.5,"
+        "\"free_heap\":151234,\"heap_fragmentation\":12.5}}",
+        (const char*)out);
+    TEST_ASSERT_EQUAL_size_t(strlen((const char*)out), length);
+}
+
+void test_json_values_rounded(void) {
+    TelegraphSample sample = makeSample();
+    sample.temperature = 21.456f;
+    sample.ki = 0.12345f;
+    sample.setpoint = 20.96f;
+    encodeJson(sample, TELEGRAPH_SENSORS | TELEGRAPH_PID);
+    TEST_ASSERT_NOT_NULL(strstr((const char*)out, "\"temperature\":21.46,"));
+    TEST_ASSERT_NOT_NULL(strstr((const char*)out, "\"ki\":0.123,"));
+    TEST_ASSERT_NOT_NULL(strstr((const char*)out, "\"setpoint\":21}"));
+}
+
+void test_json_unknown_values_are_null(void) {
+    TelegraphSample sample;
+    encodeJson(sample, TELEGRAPH_SENSORS | TELEGRAPH_PID);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"temperature\":null,\"humidity\":null,\"pressure\":null,"
+        "\"pid\":{\"kp\":null,\"ki\":null,\"kd\":null,\"setpoint\":null}}",
+        (const char*)out);
+}
+
+void test_json_idle_valve_and_off_mode(void) {
+    TelegraphSample sample = makeSample();
+    sample.valvePosition = 0;
+    sample.heat = false;
+    encodeJson(sample, TELEGRAPH_VALVE | TELEGRAPH_CONTROL);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"valve_position\":0,\"action\":\"idle\",\"heating_state\":\"OFF\","
+        "\"mode\":\"off\",\"preset\":\"comfort\"}",
+        (const char*)out);
+}
+
+// ===== TEST SUITE 2: Field Selection =====
+
+void test_no_fields_is_empty_object(void) {
+    TEST_ASSERT_EQUAL_size_t(2, encodeJson(makeSample(), 0));
+    TEST_ASSERT_EQUAL_STRING("{}", (const char*)out);
+
+    TEST_ASSERT_EQUAL_size_t(1, encodeMsgPack(makeSample(), 0));
+    TEST_ASSERT_EQUAL_HEX8(0x80, out[0]);
+}
+
+void test_memory_alone_shares_health_map(void) {
+    encodeJson(makeSample(), TELEGRAPH_MEMORY);
+    TEST_ASSERT_EQUAL_STRING("{\"health\":{\"free_heap\":151234,\"heap_fragmentation\":12.5}}",
+                             (const char*)out);
+}
+
+void test_health_alone_has_no_memory_keys(void) {
+    encodeJson(makeSample(), TELEGRAPH_HEALTH);
+    TEST_ASSERT_NOT_NULL(strstr((const char*)out, "\"valve_error_pct\":1.5}}"));
+    TEST_ASSERT_NULL(strstr((const char*)out, "free_heap"));
+}
+
+void test_diagnostics_only(void) {
+    encodeJson(makeSample(), TELEGRAPH_DIAGNOSTICS);
+    TEST_ASSERT_EQUAL_STRING("{\"wifi\":{\"rssi\":-61},\"uptime\":3600,\"status\":\"online\"}",
+                             (const char*)out);
+}
+
+// ===== TEST SUITE 3: MessagePack =====
+
+void test_msgpack_sensors_layout(void) {
+    TelegraphSample sample = makeSample();
+    size_t length = encodeMsgPack(sample, TELEGRAPH_SENSORS);
+
+    // fixmap(3), fixstr(11) "temperature", float32 21.5 = 0x41AC0000
+    const uint8_t head[] = {0x83, 0xab, 't', 'e', 'm', 'p', 'e', 'r', 'a', 't', 'u', 'r', 'e',
+                            0xca, 0x41, 0xac, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(head, out, sizeof(head));
+
+    // 3 keys (12 + 9 + 9 bytes) and 3 float32 values after the map header
+    TEST_ASSERT_EQUAL_size_t(1 + 12 + 9 + 9 + 3 * 5, length);
+}
+
+void test_msgpack_integer_widths(void) {
+    TelegraphSample sample = makeSample();
+
+    // rssi -61 needs int8; uptime 3600 uint16
+    encodeMsgPack(sample, TELEGRAPH_DIAGNOSTICS);
+    const uint8_t expected[] = {
+        0x83,
+        0xa4, 'w', 'i', 'f', 'i', 0x81, 0xa4, 'r', 's', 's', 'i', 0xd0, 0xc3,
+        0xa6, 'u', 'p', 't', 'i', 'm', 'e', 0xcd, 0x0e, 0x10,
+        0xa6, 's', 't', 'a', 't', 'u', 's', 0xa6, 'o', 'n', 'l', 'i', 'n', 'e'
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, sizeof(expected));
+
+    // Small values are fixints; a large uptime is uint32
+    sample.wifiRSSI = -20;
+    sample.uptime = 100000;
+    encodeMsgPack(sample, TELEGRAPH_DIAGNOSTICS);
+    TEST_ASSERT_EQUAL_HEX8(0xec, out[12]);
+    TEST_ASSERT_EQUAL_HEX8(0xce, out[20]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, out[21]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, out[22]);
+    TEST_ASSERT_EQUAL_HEX8(0x86, out[23]);
+    TEST_ASSERT_EQUAL_HEX8(0xa0, out[24]);
+}
+
+void test_msgpack_nil_and_booleans(void) {
+    TelegraphSample sample = makeSample();
+    sample.sensorFailureRate = NAN;
+    sample.valveHealthy = false;
+    encodeMsgPack(sample, TELEGRAPH_HEALTH);
+
+    // fixmap(1) "health" fixmap(5) "sensor_healthy" true "sensor_failure_rate" nil ...
+    TEST_ASSERT_EQUAL_HEX8(0x81, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x85, out[8]);
+    TEST_ASSERT_EQUAL_HEX8(0xc3, out[9 + 15]);
+    TEST_ASSERT_EQUAL_HEX8(0xc0, out[9 + 15 + 1 + 20]);
+    TEST_ASSERT_EQUAL_HEX8(0xc2, out[89]);
+}
+
+void test_msgpack_values_rounded_like_json(void) {
+    TelegraphSample sample = makeSample();
+    sample.temperature = 21.456f;
+    encodeMsgPack(sample, TELEGRAPH_SENSORS);
+    uint32_t bits = ((uint32_t)out[14] << 24) | ((uint32_t)out[15] << 16) |
+                    ((uint32_t)out[16] << 8) | out[17];
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    TEST_ASSERT_EQUAL_FLOAT(21.46f, value);
+}
+
+void test_msgpack_smaller_than_json(void) {
+    TelegraphSample sample = makeSample();
+    size_t json = encodeJson(sample, TELEGRAPH_ALL_FIELDS);
+    size_t msgpack = encodeMsgPack(sample, TELEGRAPH_ALL_FIELDS);
+    TEST_ASSERT_TRUE(msgpack > 0);
+    // Same keys in both formats; the saving comes from the values and punctuation
+    TEST_ASSERT_TRUE(msgpack * 100 <= json * 85);
+}
+
+// ===== TEST SUITE 4: Limits =====
+
+void test_worst_case_fits_buffer(void) {
+    TelegraphSample sample = makeSample();
+    sample.temperature = -40.0f;
+    sample.humidity = 100.0f;
+    sample.pressure = 1100.0f;
+    sample.valvePosition = 100;
+    sample.kp = -1000.0f;
+    sample.ki = -1000.0f;
+    sample.kd = -1000.0f;
+    sample.setpoint = 30.0f;
+    strcpy(sample.preset, "123456789012345");
+    sample.wifiRSSI = -2147483647;
+    sample.uptime = 4294967295UL;
+    sample.sensorFailureRate = 100.0f;
+    sample.sensorConsecutiveFailures = 4294967295UL;
+    sample.valveErrorPct = -100.0f;
+    sample.freeHeap = 4294967295UL;
+    sample.heapFragmentation = -100.0f;
+
+    size_t json = encodeJson(sample, TELEGRAPH_ALL_FIELDS);
+    TEST_ASSERT_TRUE(json > 0);
+    TEST_ASSERT_TRUE(encodeMsgPack(sample, TELEGRAPH_ALL_FIELDS) > 0);
+}
+
+void test_buffer_too_small(void) {
+    TelegraphSample sample = makeSample();
+    size_t json = encodeJson(sample, TELEGRAPH_ALL_FIELDS);
+    size_t msgpack = encodeMsgPack(sample, TELEGRAPH_ALL_FIELDS);
+
+    TEST_ASSERT_EQUAL_size_t(0, encodeTelegraph(sample, TELEGRAPH_ALL_FIELDS, TELEGRAPH_JSON, out, json - 1));
+    TEST_ASSERT_EQUAL_size_t(json, encodeTelegraph(sample, TELEGRAPH_ALL_FIELDS, TELEGRAPH_JSON, out, json));
+    TEST_ASSERT_EQUAL_size_t(0, encodeTelegraph(sample, TELEGRAPH_ALL_FIELDS, TELEGRAPH_MSGPACK, out, msgpack - 1));
+    TEST_ASSERT_EQUAL_size_t(msgpack, encodeTelegraph(sample, TELEGRAPH_ALL_FIELDS, TELEGRAPH_MSGPACK, out, msgpack));
+    TEST_ASSERT_EQUAL_size_t(0, encodeTelegraph(sample, TELEGRAPH_ALL_FIELDS, TELEGRAPH_MSGPACK, out, 0));
+}
+
+// ===== TEST SUITE 5: Names =====
+
+void test_field_names_round_trip(void) {
+    for (uint8_t i = 0; i < TELEGRAPH_FIELD_GROUPS; i++) {
+        TEST_ASSERT_EQUAL_HEX8(1 << i, telegraphFieldBit(telegraphFieldName(i)));
+    }
+    TEST_ASSERT_EQUAL_HEX8(TELEGRAPH_MEMORY, telegraphFieldBit("memory"));
+    TEST_ASSERT_EQUAL_HEX8(0, telegraphFieldBit("bogus"));
+    TEST_ASSERT_EQUAL_STRING("", telegraphFieldName(TELEGRAPH_FIELD_GROUPS));
+}
+
+void test_format_names(void) {
+    TEST_ASSERT_EQUAL_INT(TELEGRAPH_JSON, parseTelegraphFormat("json"));
+    TEST_ASSERT_EQUAL_INT(TELEGRAPH_MSGPACK, parseTelegraphFormat("msgpack"));
+    TEST_ASSERT_EQUAL_INT(-1, parseTelegraphFormat("cbor"));
+    TEST_ASSERT_EQUAL_STRING("json", telegraphFormatName(TELEGRAPH_JSON));
+    TEST_ASSERT_EQUAL_STRING("msgpack", telegraphFormatName(TELEGRAPH_MSGPACK));
+}
+
+// ===== Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: JSON
+    RUN_TEST(test_json_all_fields_exact);
+    RUN_TEST(test_json_values_rounded);
+    RUN_TEST(test_json_unknown_values_are_null);
+    RUN_TEST(test_json_idle_valve_and_off_mode);
+
+    // Suite 2: Field Selection
+    RUN_TEST(test_no_fields_is_empty_object);
+    RUN_TEST(test_memory_alone_shares_health_map);
+    RUN_TEST(test_health_alone_has_no_memory_keys);
+    RUN_TEST(test_diagnostics_only);
+
+    // Suite 3: MessagePack
+    RUN_TEST(test_msgpack_sensors_layout);
+    RUN_TEST(test_msgpack_integer_widths);
+    RUN_TEST(test_msgpack_nil_and_booleans);
+    RUN_TEST(test_msgpack_values_rounded_like_json);
+    RUN_TEST(test_msgpack_smaller_than_json);
+
+    // Suite 4: Limits
+    RUN_TEST(test_worst_case_fits_buffer);
+    RUN_TEST(test_buffer_too_small);
+
+    // Suite 5: Names
+    RUN_TEST(test_field_names_round_trip);
+    RUN_TEST(test_format_names);
+
+    return UNITY_END();
+}
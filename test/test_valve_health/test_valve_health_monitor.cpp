@@ -241,6 +241,24 @@ void test_average_error_sliding_window(void) {
     TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, avg2);
 }
 
+void test_max_error_expires_from_window(void) {
+    ValveHealthMonitor* monitor = ValveHealthMonitor::getInstance();
+
+    monitor->recordCommand(100.0f, 70.0f); // 30% error
+    monitor->recordCommand(50.0f, 35.0f);  // 15% error
+
+    // Push the 30% entry out of the window; the 15% entry is still inside
+    for (int i = 0; i < 99; i++) {
+        monitor->recordCommand(50.0f, 48.0f); // 2% error
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 15.0f, monitor->getMaxError());
+
+    // Push the 15% entry out as well
+    monitor->recordCommand(50.0f, 48.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, monitor->getMaxError());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, monitor->getAverageError());
+}
+
 // ===== TEST SUITE 6: Recovery Tracking =====
 
 void test_recovery_from_stuck_condition(void) {
@@ -377,6 +395,7 @@ int main(int argc, char **argv) {
     RUN_TEST(test_history_buffer_wraparound);
     RUN_TEST(test_max_error_updates_correctly_in_buffer);
     RUN_TEST(test_average_error_sliding_window);
+    RUN_TEST(test_max_error_expires_from_window);
 
     // Suite 6: Recovery
     RUN_TEST(test_recovery_from_stuck_condition);
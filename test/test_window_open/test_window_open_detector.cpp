@@ -0,0 +1,221 @@
+/**
+ * @file test_window_open_detector.cpp
+ * @brief Unit tests for the window-open / rapid heat-loss detector
+ *
+ * Tests cover:
+ * - Slope estimate over the sliding window, including 1 s updates
+ * - Detection threshold and minimum window span
+ * - Hold time and hysteresis before re-arming
+ * - Disabled detector and NaN handling
+ *
+ * Target Coverage: 80%
+ */
+
+#include <unity.h>
+#include "window_open_detector.h"
+
+static WindowOpenDetector* detector = nullptr;
+
+static const unsigned long STEP_MS = 10000;  // PID update interval
+
+// ===== Test Fixtures =====
+
+void setUp(void) {
+    detector = new WindowOpenDetector();
+    detector->configure(true, 0.3f, 600000, 0.0f);
+}
+
+void tearDown(void) {
+    delete detector;
+    detector = nullptr;
+}
+
+// Feed samples changing at a constant rate; returns the last event seen
+static WindowOpenDetector::Event feed(unsigned long& now, float& temp, float ratePerMin, int samples) {
+    WindowOpenDetector::Event last = WindowOpenDetector::EVENT_NONE;
+    for (int i = 0; i < samples; i++) {
+        WindowOpenDetector::Event event = detector->update(temp, now);
+        if (event != WindowOpenDetector::EVENT_NONE) {
+            last = event;
+        }
+        now += STEP_MS;
+        temp += ratePerMin * STEP_MS / 60000.0f;
+    }
+    return last;
+}
+
+// ===== TEST SUITE 1: Slope Estimate =====
+
+void test_stable_temperature_no_event(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_NONE, feed(now, temp, 0.0f, 30));
+    TEST_ASSERT_FALSE(detector->isActive());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, detector->getSlope());
+}
+
+void test_slope_matches_rate(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    feed(now, temp, -0.1f, 20);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -0.1f, detector->getSlope());
+}
+
+void test_short_span_does_not_trigger(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    // Steep drop, but only 50 s of data
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_NONE, feed(now, temp, -2.0f, 6));
+    TEST_ASSERT_FALSE(detector->isActive());
+}
+
+void test_one_second_updates_span_window(void) {
+    // Fastest allowed PID interval: 16 slots would only cover 16 s undecimated
+    unsigned long now = 0;
+    float temp = 21.0f;
+    WindowOpenDetector::Event last = WindowOpenDetector::EVENT_NONE;
+    for (int i = 0; i < 180; i++) {
+        WindowOpenDetector::Event event = detector->update(temp, now);
+        if (event != WindowOpenDetector::EVENT_NONE) {
+            last = event;
+        }
+        if (i == 60) {
+            TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, detector->getSlope());
+        }
+        now += 1000;
+        if (i >= 60) {
+            temp -= 0.5f / 60.0f;
+        }
+    }
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_OPENED, last);
+    TEST_ASSERT_TRUE(detector->isActive());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, -0.5f, detector->getSlope());
+}
+
+// ===== TEST SUITE 2: Detection =====
+
+void test_fast_drop_triggers(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    feed(now, temp, 0.0f, 12);
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_OPENED, feed(now, temp, -0.5f, 12));
+    TEST_ASSERT_TRUE(detector->isActive());
+    TEST_ASSERT_EQUAL_UINT32(1, detector->getEventCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, detector->getValvePosition());
+}
+
+void test_slow_drop_below_threshold_ignored(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_NONE, feed(now, temp, -0.2f, 40));
+    TEST_ASSERT_FALSE(detector->isActive());
+}
+
+void test_hold_expires(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    feed(now, temp, -0.5f, 12);
+    TEST_ASSERT_TRUE(detector->isActive());
+    TEST_ASSERT_TRUE(detector->getRemainingMs(now) > 0);
+
+    // Window closed, temperature stable for the rest of the hold
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_CLOSED, feed(now, temp, 0.0f, 61));
+    TEST_ASSERT_FALSE(detector->isActive());
+    TEST_ASSERT_EQUAL_UINT32(0, detector->getRemainingMs(now));
+}
+
+// ===== TEST SUITE 3: Hysteresis =====
+
+void test_no_retrigger_while_still_dropping(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    feed(now, temp, -0.5f, 12);
+    TEST_ASSERT_TRUE(detector->isActive());
+
+    // Keep dropping through and beyond the hold: closes once, never reopens
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_CLOSED, feed(now, temp, -0.5f, 80));
+    TEST_ASSERT_FALSE(detector->isActive());
+    TEST_ASSERT_EQUAL_UINT32(1, detector->getEventCount());
+}
+
+void test_rearms_after_recovery(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    feed(now, temp, -0.5f, 12);
+    feed(now, temp, 0.0f, 61);
+    TEST_ASSERT_FALSE(detector->isActive());
+
+    // A second window opening is detected again
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_OPENED, feed(now, temp, -0.5f, 12));
+    TEST_ASSERT_EQUAL_UINT32(2, detector->getEventCount());
+}
+
+// ===== TEST SUITE 4: Configuration =====
+
+void test_disabled_never_triggers(void) {
+    detector->configure(false, 0.3f, 600000, 0.0f);
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_NONE, feed(now, temp, -1.0f, 20));
+    TEST_ASSERT_FALSE(detector->isActive());
+}
+
+void test_disable_ends_active_hold(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+
+    feed(now, temp, -0.5f, 12);
+    TEST_ASSERT_TRUE(detector->isActive());
+
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_CLOSED, detector->configure(false, 0.3f, 600000, 0.0f));
+    TEST_ASSERT_FALSE(detector->isActive());
+
+    // Nothing to end the second time
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_NONE, detector->configure(false, 0.3f, 600000, 0.0f));
+}
+
+void test_nan_sample_ignored(void) {
+    unsigned long now = 0;
+    float temp = 21.0f;
+    feed(now, temp, 0.0f, 12);
+
+    TEST_ASSERT_EQUAL(WindowOpenDetector::EVENT_NONE, detector->update(NAN, now));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, detector->getSlope());
+}
+
+// ===== Main Test Runner =====
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    // Suite 1: Slope Estimate
+    RUN_TEST(test_stable_temperature_no_event);
+    RUN_TEST(test_slope_matches_rate);
+    RUN_TEST(test_short_span_does_not_trigger);
+    RUN_TEST(test_one_second_updates_span_window);
+
+    // Suite 2: Detection
+    RUN_TEST(test_fast_drop_triggers);
+    RUN_TEST(test_slow_drop_below_threshold_ignored);
+    RUN_TEST(test_hold_expires);
+
+    // Suite 3: Hysteresis
+    RUN_TEST(test_no_retrigger_while_still_dropping);
+    RUN_TEST(test_rearms_after_recovery);
+
+    // Suite 4: Configuration
+    RUN_TEST(test_disabled_never_triggers);
+    RUN_TEST(test_disable_ends_active_hold);
+    RUN_TEST(test_nan_sample_ignored);
+
+    return UNITY_END();
+}